@@ -17,6 +17,7 @@ from .state import (
 )
 from .config import AIConfig
 from .mood_mapper import MoodMapper
+from .user_context import UserContextSnapshot, UserContextCache, user_context_cache
 from .context_encoder import ContextEncoder
 from .reward_calculator import RewardCalculator, Outcome, RewardWeights
 from .implicit_feedback import ImplicitFeedbackInferencer
@@ -26,22 +27,47 @@ from .action_masker import ActionMasker
 from .task_selector import TaskSelector
 from .hybrid_recommender import HybridRecommender, RecommendationResult
 
-# DQN Components (Browser Extension) - Optional, requires PyTorch
-DQN_AVAILABLE = False
-try:
-    from .dqn_agent import DQNAgent, DQNNetwork
-    from .feature_encoder import FeatureEncoder, feature_encoder
-    from .replay_buffer import ReplayBuffer, PrioritizedReplayBuffer
-    DQN_AVAILABLE = True
-except ImportError as e:
-    # PyTorch not installed - DQN features disabled
-    print(f"[AI] DQN components not available (PyTorch not installed): {e}")
-    DQNAgent = None
-    DQNNetwork = None
-    FeatureEncoder = None
-    feature_encoder = None
-    ReplayBuffer = None
-    PrioritizedReplayBuffer = None
+# DQN serving (NumPy) and DQN training (PyTorch) load on first use, so
+# importing the Q-learning pieces above doesn't pull NumPy or torch into
+# every web worker. `from ai import DQNAgent` still works.
+import importlib
+import importlib.util
+
+_LAZY_ATTRIBUTES = {
+    "DQNWeights": ".dqn_weights",
+    "DQNWeightRegistry": ".dqn_weights",
+    "DQNInferenceServer": ".dqn_inference",
+    "DQNAgent": ".dqn_agent",
+    "DQNNetwork": ".dqn_agent",
+    "FeatureEncoder": ".feature_encoder",
+    "feature_encoder": ".feature_encoder",
+    "ReplayBuffer": ".replay_buffer",
+    "PrioritizedReplayBuffer": ".replay_buffer",
+}
+
+# Whether the DQN components can load (checked without importing torch)
+DQN_AVAILABLE = (
+    importlib.util.find_spec("torch") is not None
+    and importlib.util.find_spec("numpy") is not None
+)
+
+
+def __getattr__(name):
+    """Import DQN components on first access (PEP 562)."""
+    module_name = _LAZY_ATTRIBUTES.get(name)
+    if module_name is None:
+        raise AttributeError(f"module {__name__!r} has no attribute {name!r}")
+    try:
+        value = getattr(importlib.import_module(module_name, __name__), name)
+    except ImportError as e:
+        if name in ("DQNWeights", "DQNWeightRegistry", "DQNInferenceServer"):
+            raise
+        # PyTorch not installed - DQN features disabled
+        print(f"[AI] DQN components not available (PyTorch not installed): {e}")
+        value = None
+    globals()[name] = value
+    return value
+
 
 __all__ = [
     # Actions
@@ -64,6 +90,9 @@ __all__ = [
     # Mood
     "MoodMapper",
     # Context
+    "UserContextSnapshot",
+    "UserContextCache",
+    "user_context_cache",
     "ContextEncoder",
     # Reward
     "RewardCalculator",
@@ -82,6 +111,10 @@ __all__ = [
     # Hybrid Recommender
     "HybridRecommender",
     "RecommendationResult",
+    # DQN Serving
+    "DQNWeights",
+    "DQNWeightRegistry",
+    "DQNInferenceServer",
     # DQN Components (optional)
     "DQN_AVAILABLE",
     "DQNAgent",
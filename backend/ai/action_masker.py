@@ -8,6 +8,7 @@ from sqlalchemy.orm import Session
 
 from .actions import ActionType, ACTION_TYPES, get_all_actions
 from .state import UserState
+from .user_context import UserContextSnapshot
 
 
 class ActionMasker:
@@ -25,7 +26,8 @@ class ActionMasker:
         self,
         state: UserState,
         db: Session = None,
-        user_id: Optional[int] = None
+        user_id: Optional[int] = None,
+        context: Optional[UserContextSnapshot] = None
     ) -> List[ActionType]:
         """
         Get list of valid actions for the current state.
@@ -34,6 +36,7 @@ class ActionMasker:
             state: Current user state
             db: Optional database session for additional checks
             user_id: User ID for multi-user filtering
+            context: Preloaded user snapshot (used instead of db when given)
 
         Returns:
             List of allowed ActionType values
@@ -59,7 +62,13 @@ class ActionMasker:
             pass
 
         # Rule 5: Check database for task availability if provided
-        if db and user_id is not None:
+        if context is not None:
+            valid = self._filter_by_counts(
+                valid, state,
+                context.count_pending_with_priority(4),
+                context.pending_count,
+            )
+        elif db and user_id is not None:
             valid = self._filter_by_task_availability(valid, state, db, user_id)
 
         # Ensure at least one action remains
@@ -90,10 +99,6 @@ class ActionMasker:
             Task.is_deleted == False
         ).count()
 
-        # If no high-priority tasks and low workload, remove DEEP_FOCUS
-        if high_priority_count == 0 and state.workload_pressure == "low":
-            valid_actions.discard(ActionType.DEEP_FOCUS)
-
         # Check for any pending tasks
         any_tasks = db.query(Task).filter(
             Task.user_id == user_id,
@@ -101,8 +106,22 @@ class ActionMasker:
             Task.is_deleted == False
         ).count()
 
+        return self._filter_by_counts(valid_actions, state, high_priority_count, any_tasks)
+
+    def _filter_by_counts(
+        self,
+        valid_actions: set,
+        state: UserState,
+        high_priority_count: int,
+        pending_count: int
+    ) -> set:
+        """Apply the task-availability rules given pending task counts."""
+        # If no high-priority tasks and low workload, remove DEEP_FOCUS
+        if high_priority_count == 0 and state.workload_pressure == "low":
+            valid_actions.discard(ActionType.DEEP_FOCUS)
+
         # If no tasks at all, only allow non-task actions
-        if any_tasks == 0:
+        if pending_count == 0:
             valid_actions.discard(ActionType.DEEP_FOCUS)
             valid_actions.discard(ActionType.LIGHT_TASK)
 
@@ -1,13 +1,15 @@
 """
 Q-Learning Schedule Agent
-Core RL agent with thread-safe singleton pattern and atomic persistence.
+Core RL agent with thread-safe per-user registry and atomic persistence.
 """
 
 import json
 import math
 import os
 import random
+import tempfile
 import threading
+import time
 from datetime import datetime
 from typing import Dict, List, Optional, Tuple
 from pathlib import Path
@@ -15,6 +17,9 @@ from pathlib import Path
 from .actions import ActionType, get_all_actions
 from .state import UserState, StateSerializer
 from .config import AIConfig
+from .agent_storage import encode_agent_state, decode_agent_state, is_binary
+from .reward_stats import RewardStats
+from core.metrics import AGENT_CACHE, AGENT_SAVE_SECONDS, span
 
 
 class ScheduleAgent:
@@ -22,7 +27,7 @@ class ScheduleAgent:
     Q-Learning agent for task recommendation.
 
     Features:
-    - Thread-safe singleton per user
+    - Thread-safe singleton per user (lock-free lookups, coalesced loads)
     - Epsilon-greedy action selection with decay
     - Adaptive learning rate based on visit counts
     - Variance-based confidence estimation
@@ -32,13 +37,14 @@ class ScheduleAgent:
     Critical implementation notes:
     - State keys MUST be pipe-separated strings (JSON-safe)
     - Uses os.replace() for atomic writes
-    - Instance caching with threading.Lock
+    - Registry lock is held only for dict bookkeeping, never during disk I/O
+    - Each agent has its own lock guarding Q-table mutation and snapshots
     """
 
     # Class-level cache and lock
     _instances: Dict[int, "ScheduleAgent"] = {}
+    _loading: Dict[int, threading.Event] = {}  # user_id -> set when load finishes
     _lock: threading.Lock = threading.Lock()
-    _last_persist: Dict[int, datetime] = {}
 
     def __init__(self, user_id: int):
         """
@@ -49,17 +55,24 @@ class ScheduleAgent:
         self.user_id = user_id
         self.q_table: Dict[str, Dict[str, float]] = {}  # state_key -> {action: q_value}
         self.visit_counts: Dict[str, Dict[str, int]] = {}  # state_key -> {action: count}
-        self.reward_history: Dict[str, Dict[str, List[float]]] = {}  # state_key -> {action: [rewards]}
+        self.reward_stats: Dict[str, Dict[str, RewardStats]] = {}  # state_key -> {action: stats}
         self.epsilon = AIConfig.INITIAL_EPSILON
         self.total_recommendations = 0
         self._initialized = False
+        self._lock = threading.RLock()  # Guards this agent's tables
+        self._save_lock = threading.Lock()  # Serializes save() calls (snapshot to rename)
+        self._version = 0  # Bumped on every update (dirty tracking)
+        self._saved_version = 0
 
     @classmethod
     def get_instance(cls, user_id: int) -> "ScheduleAgent":
         """
         Get or create a singleton agent instance for a user.
 
-        Thread-safe with locking.
+        Warm lookups read the registry without locking. A cold user is
+        loaded outside the registry lock, so a slow disk read never blocks
+        other users; concurrent first-touches of the same user wait on one
+        shared load instead of each reading the file.
 
         Args:
             user_id: User ID
@@ -67,12 +80,43 @@ class ScheduleAgent:
         Returns:
             ScheduleAgent instance for this user
         """
-        with cls._lock:
-            if user_id not in cls._instances:
+        agent = cls._instances.get(user_id)
+        if agent is not None:
+            AGENT_CACHE.inc(result="hit")
+            return agent
+
+        while True:
+            with cls._lock:
+                agent = cls._instances.get(user_id)
+                if agent is not None:
+                    AGENT_CACHE.inc(result="hit")
+                    return agent
+
+                loading = cls._loading.get(user_id)
+                if loading is None:
+                    # This thread owns the load
+                    loading = threading.Event()
+                    cls._loading[user_id] = loading
+                    owner = True
+                else:
+                    owner = False
+
+            if not owner:
+                loading.wait()
+                continue  # Re-check (the owner may have failed)
+
+            AGENT_CACHE.inc(result="miss")
+            try:
                 agent = cls(user_id)
-                agent.load()
-                cls._instances[user_id] = agent
-            return cls._instances[user_id]
+                with span("agent.load"):
+                    agent.load()
+                with cls._lock:
+                    cls._instances[user_id] = agent
+                return agent
+            finally:
+                with cls._lock:
+                    cls._loading.pop(user_id, None)
+                loading.set()
 
     def recommend(
         self,
@@ -98,18 +142,19 @@ class ScheduleAgent:
             # Safety fallback
             valid_actions = [ActionType.BREAK]
 
-        # Initialize Q-values for new state if needed
-        if state_key not in self.q_table:
-            self._initialize_state(state_key)
+        with self._lock:
+            # Initialize Q-values for new state if needed
+            if state_key not in self.q_table:
+                self._initialize_state(state_key)
 
-        # Epsilon-greedy selection
-        if random.random() < self.epsilon:
-            # Explore: random valid action
-            action = random.choice(valid_actions)
-            confidence = 0.0  # Low confidence for exploration
-        else:
-            # Exploit: best Q-value among valid actions
-            action, confidence = self._get_best_action(state_key, valid_actions)
+            # Epsilon-greedy selection
+            if random.random() < self.epsilon:
+                # Explore: random valid action
+                action = random.choice(valid_actions)
+                confidence = 0.0  # Low confidence for exploration
+            else:
+                # Exploit: best Q-value among valid actions
+                action, confidence = self._get_best_action(state_key, valid_actions)
 
         return action, confidence
 
@@ -156,8 +201,8 @@ class ScheduleAgent:
         if visit_count == 0:
             return 0.0
 
-        # Get reward history for this state-action pair
-        rewards = self.reward_history.get(state_key, {}).get(action_key, [])
+        # Get reward statistics for this state-action pair
+        stats = self.reward_stats.get(state_key, {}).get(action_key)
 
         # Base confidence from visit count
         base_confidence = min(
@@ -165,9 +210,11 @@ class ScheduleAgent:
             visit_count * AIConfig.BASE_CONFIDENCE_PER_VISIT
         )
 
-        # If we have enough samples, adjust by variance
-        if len(rewards) >= AIConfig.MIN_VISITS_FOR_VARIANCE:
-            variance = self._calculate_variance(rewards)
+        # If we have enough samples, adjust by variance (gated on visits:
+        # with decay, stats.count is an effective size that stays below the
+        # number of rewards seen)
+        if stats is not None and visit_count >= AIConfig.MIN_VISITS_FOR_VARIANCE:
+            variance = stats.variance
 
             # Higher variance = lower confidence
             # Variance of rewards typically ranges from 0 to ~1
@@ -179,17 +226,6 @@ class ScheduleAgent:
 
         return min(AIConfig.MAX_CONFIDENCE, confidence)
 
-    def _calculate_variance(self, values: List[float]) -> float:
-        """Calculate variance of a list of values."""
-        if len(values) < 2:
-            return 0.0
-
-        mean = sum(values) / len(values)
-        squared_diffs = [(x - mean) ** 2 for x in values]
-        variance = sum(squared_diffs) / len(values)
-
-        return variance
-
     def _initialize_state(self, state_key: str) -> None:
         """Initialize Q-values for a new state (optimistic initialization)."""
         self.q_table[state_key] = {
@@ -200,8 +236,8 @@ class ScheduleAgent:
             action.value: 0
             for action in get_all_actions()
         }
-        self.reward_history[state_key] = {
-            action.value: []
+        self.reward_stats[state_key] = {
+            action.value: RewardStats()
             for action in get_all_actions()
         }
 
@@ -217,7 +253,8 @@ class ScheduleAgent:
         Q(s,a) ← Q(s,a) + α(r - Q(s,a))
 
         Uses adaptive learning rate based on visit count.
-        Also tracks reward history for variance-based confidence.
+        Also folds the reward into streaming statistics for variance-based
+        confidence.
 
         Args:
             state: State where action was taken
@@ -227,40 +264,37 @@ class ScheduleAgent:
         state_key = StateSerializer.to_key(state)
         action_key = action.value
 
-        # Initialize if needed
-        if state_key not in self.q_table:
-            self._initialize_state(state_key)
+        with self._lock:
+            # Initialize if needed
+            if state_key not in self.q_table:
+                self._initialize_state(state_key)
 
-        # Get current Q-value and visit count
-        current_q = self.q_table[state_key].get(action_key, AIConfig.INITIAL_Q_VALUE)
-        visit_count = self.visit_counts[state_key].get(action_key, 0)
+            # Get current Q-value and visit count
+            current_q = self.q_table[state_key].get(action_key, AIConfig.INITIAL_Q_VALUE)
+            visit_count = self.visit_counts[state_key].get(action_key, 0)
 
-        # Adaptive learning rate using config helper
-        alpha = AIConfig.get_learning_rate(visit_count)
+            # Adaptive learning rate using config helper
+            alpha = AIConfig.get_learning_rate(visit_count)
 
-        # Q-learning update (stateless - no next state discount)
-        # Q(s,a) ← Q(s,a) + α(r - Q(s,a))
-        new_q = current_q + alpha * (reward - current_q)
+            # Q-learning update (stateless - no next state discount)
+            # Q(s,a) ← Q(s,a) + α(r - Q(s,a))
+            new_q = current_q + alpha * (reward - current_q)
 
-        # Update Q-table and visit counts
-        self.q_table[state_key][action_key] = new_q
-        self.visit_counts[state_key][action_key] = visit_count + 1
+            # Update Q-table and visit counts
+            self.q_table[state_key][action_key] = new_q
+            self.visit_counts[state_key][action_key] = visit_count + 1
 
-        # Track reward history for variance calculation
-        # Keep last 20 rewards to avoid memory bloat
-        if state_key not in self.reward_history:
-            self.reward_history[state_key] = {}
-        if action_key not in self.reward_history[state_key]:
-            self.reward_history[state_key][action_key] = []
+            # Track reward mean/variance in O(1) (Welford, optional forgetting)
+            state_stats = self.reward_stats.setdefault(state_key, {})
+            stats = state_stats.get(action_key)
+            if stats is None:
+                stats = state_stats[action_key] = RewardStats()
+            stats.update(reward, AIConfig.REWARD_STATS_DECAY)
 
-        reward_list = self.reward_history[state_key][action_key]
-        reward_list.append(reward)
-        if len(reward_list) > 20:
-            reward_list.pop(0)  # Remove oldest
-
-        # Increment total and update epsilon
-        self.total_recommendations += 1
-        self._update_epsilon()
+            # Increment total and update epsilon
+            self.total_recommendations += 1
+            self._update_epsilon()
+            self._version += 1
 
     def _update_epsilon(self) -> None:
         """
@@ -280,85 +314,182 @@ class ScheduleAgent:
             AIConfig.INITIAL_EPSILON - (decay_steps * decay_rate)
         )
 
+    @property
+    def is_dirty(self) -> bool:
+        """Whether the agent changed since it was last saved or loaded."""
+        return self._version != self._saved_version
+
     def save(self) -> None:
         """
         Save agent state to disk with atomic write.
 
-        Uses .tmp file + os.replace() to prevent corruption.
+        Writes a uniquely named temp file in the agent directory, then
+        os.replace() onto the real path, so a crash never leaves a partial
+        file and concurrent savers (threads or worker processes) never
+        share a temp file. The agent lock is held only while serializing
+        the snapshot, so update() calls are not blocked by disk I/O; the
+        save lock keeps this process's saves in snapshot order, so an older
+        snapshot can't replace a newer one.
+
+        Writes the compact binary format (agent_storage) unless
+        AIConfig.AGENT_STORAGE_FORMAT is "json".
         """
-        filepath = self._get_filepath()
-        tmp_filepath = f"{filepath}.tmp"
+        started = time.perf_counter()
+        binary = AIConfig.AGENT_STORAGE_FORMAT == "binary"
+        filepath = self._get_filepath(binary)
 
         # Ensure directory exists
         os.makedirs(os.path.dirname(filepath), exist_ok=True)
 
-        # Prepare data (all keys are strings for JSON)
-        data = {
-            "user_id": self.user_id,
-            "q_table": self.q_table,
-            "visit_counts": self.visit_counts,
-            "reward_history": self.reward_history,
-            "epsilon": self.epsilon,
-            "total_recommendations": self.total_recommendations,
-            "saved_at": datetime.now().isoformat(),
-        }
-
-        # Write to temp file first
-        with open(tmp_filepath, "w") as f:
-            json.dump(data, f, indent=2)
+        with self._save_lock:
+            self._write_snapshot(filepath, binary)
+
+        AGENT_SAVE_SECONDS.observe(time.perf_counter() - started)
+
+    def _write_snapshot(self, filepath: str, binary: bool) -> None:
+        """Serialize under the agent lock, then write and rename (caller holds _save_lock)."""
+        # Snapshot under the agent lock (all keys are strings for JSON)
+        with self._lock:
+            data = {
+                "user_id": self.user_id,
+                "q_table": self.q_table,
+                "visit_counts": self.visit_counts,
+                "reward_stats": {
+                    state_key: {
+                        action_key: stats.to_list()
+                        for action_key, stats in per_state.items()
+                        if stats.count > 0
+                    }
+                    for state_key, per_state in self.reward_stats.items()
+                },
+                "epsilon": self.epsilon,
+                "total_recommendations": self.total_recommendations,
+                "saved_at": datetime.now().isoformat(),
+            }
+            if binary:
+                payload = encode_agent_state(data)
+            else:
+                payload = json.dumps(data, separators=(",", ":")).encode("utf-8")
+            snapshot_version = self._version
+
+        # Write to a temp file of our own first
+        fd, tmp_filepath = tempfile.mkstemp(
+            dir=os.path.dirname(filepath), prefix=f"{os.path.basename(filepath)}.", suffix=".tmp"
+        )
+        try:
+            with os.fdopen(fd, "wb") as f:
+                f.write(payload)
 
-        # Atomic rename
-        os.replace(tmp_filepath, filepath)
+            # Atomic rename
+            os.replace(tmp_filepath, filepath)
+        except BaseException:
+            try:
+                os.unlink(tmp_filepath)
+            except OSError:
+                pass
+            raise
 
-        # Update last persist time
-        ScheduleAgent._last_persist[self.user_id] = datetime.now()
+        # Updates made while writing keep the agent dirty
+        self._saved_version = snapshot_version
 
     def load(self) -> bool:
         """
         Load agent state from disk.
 
+        Reads whichever of the binary and legacy JSON files is newest.
+
         Returns:
             True if loaded successfully, False if initialized fresh
         """
-        filepath = self._get_filepath()
+        candidates = [
+            path for path in (self._get_filepath(True), self._get_filepath(False))
+            if os.path.exists(path)
+        ]
 
-        if not os.path.exists(filepath):
+        if not candidates:
             self._initialized = True
             return False
 
+        filepath = max(candidates, key=os.path.getmtime)
+
         try:
-            with open(filepath, "r") as f:
-                data = json.load(f)
+            with open(filepath, "rb") as f:
+                blob = f.read()
+
+            if is_binary(blob):
+                data = decode_agent_state(blob)
+            else:
+                data = json.loads(blob)
 
             self.q_table = data.get("q_table", {})
             self.visit_counts = data.get("visit_counts", {})
-            self.reward_history = data.get("reward_history", {})
+            self.reward_stats = self._load_reward_stats(data)
             self.epsilon = data.get("epsilon", AIConfig.INITIAL_EPSILON)
             self.total_recommendations = data.get("total_recommendations", 0)
             self._initialized = True
+            self._saved_version = self._version
             return True
 
-        except (json.JSONDecodeError, KeyError, IOError) as e:
-            # Corrupted file - start fresh
+        except (ValueError, KeyError, IOError) as e:
+            # Corrupted file - start fresh (JSONDecodeError is a ValueError)
             self._initialized = True
             return False
 
-    def _get_filepath(self) -> str:
+    @staticmethod
+    def _load_reward_stats(data: Dict) -> Dict[str, Dict[str, RewardStats]]:
+        """
+        Rebuild reward statistics from a snapshot dict.
+
+        Files written before streaming statistics stored raw reward lists
+        under "reward_history"; those are replayed into RewardStats once.
+        """
+        if "reward_stats" in data:
+            return {
+                state_key: {
+                    action_key: RewardStats.from_list(values)
+                    for action_key, values in per_state.items()
+                }
+                for state_key, per_state in data["reward_stats"].items()
+            }
+
+        return {
+            state_key: {
+                action_key: RewardStats.from_history(rewards, AIConfig.REWARD_STATS_DECAY)
+                for action_key, rewards in per_state.items()
+                if rewards
+            }
+            for state_key, per_state in data.get("reward_history", {}).items()
+        }
+
+    def _get_filepath(self, binary: bool = False) -> str:
         """Get the file path for this agent's model."""
         base_dir = os.path.dirname(os.path.dirname(__file__))
+        extension = "bin" if binary else "json"
         return os.path.join(
             base_dir,
             AIConfig.MODEL_DIRECTORY,
-            f"agent_{self.user_id}.json"
+            f"agent_{self.user_id}.{extension}"
         )
 
     def get_stats(self) -> Dict:
         """Get agent statistics for monitoring."""
-        total_states = len(self.q_table)
-        total_visits = sum(
-            sum(counts.values())
-            for counts in self.visit_counts.values()
-        )
+        with self._lock:
+            total_states = len(self.q_table)
+            total_visits = sum(
+                sum(counts.values())
+                for counts in self.visit_counts.values()
+            )
+            observed = [
+                stats
+                for per_state in self.reward_stats.values()
+                for stats in per_state.values()
+                if stats.count > 0
+            ]
+            reward_weight = sum(stats.count for stats in observed)
+            avg_reward = (
+                sum(stats.mean * stats.count for stats in observed) / reward_weight
+                if reward_weight else 0.0
+            )
 
         return {
             "user_id": self.user_id,
@@ -366,6 +497,8 @@ class ScheduleAgent:
             "total_visits": total_visits,
             "total_recommendations": self.total_recommendations,
             "current_epsilon": round(self.epsilon, 4),
+            "tracked_pairs": len(observed),
+            "avg_reward": round(avg_reward, 4),
             "phase": self._get_phase(),
             "phase_thresholds": {
                 "bootstrap": AIConfig.BOOTSTRAP_THRESHOLD,
@@ -385,32 +518,45 @@ class ScheduleAgent:
     @classmethod
     def persist_all(cls) -> int:
         """
-        Persist all cached agents that haven't been saved recently.
+        Persist all cached agents that changed since their last save.
+
+        Unchanged agents are skipped, so periodic persistence only writes
+        users who actually received feedback.
 
         Returns:
             Number of agents saved
         """
         saved_count = 0
-        current_time = datetime.now()
-        persist_threshold = AIConfig.PERSIST_INTERVAL_SECONDS
 
+        # Copy the registry so saving never holds the registry lock
         with cls._lock:
-            for user_id, agent in cls._instances.items():
-                last_save = cls._last_persist.get(user_id)
+            agents = list(cls._instances.values())
 
-                if last_save is None or \
-                   (current_time - last_save).total_seconds() >= persist_threshold:
-                    try:
-                        agent.save()
-                        saved_count += 1
-                    except IOError:
-                        pass  # Log error in production
+        for agent in agents:
+            if not agent.is_dirty:
+                continue
+            try:
+                agent.save()
+                saved_count += 1
+            except IOError:
+                pass  # Log error in production
 
         return saved_count
 
+    @classmethod
+    def count_dirty(cls) -> int:
+        """Number of cached agents with unsaved changes."""
+        with cls._lock:
+            agents = list(cls._instances.values())
+        return sum(1 for agent in agents if agent.is_dirty)
+
+    @classmethod
+    def is_cached(cls, user_id: int) -> bool:
+        """Whether a user's agent is already loaded."""
+        return user_id in cls._instances
+
     @classmethod
     def clear_cache(cls) -> None:
         """Clear all cached instances (for testing)."""
         with cls._lock:
             cls._instances.clear()
-            cls._last_persist.clear()
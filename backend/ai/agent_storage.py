@@ -0,0 +1,188 @@
+"""
+Agent Storage
+Compact binary on-disk format for ScheduleAgent Q-tables.
+
+Replaces pretty-printed JSON (one nested dict per state) with a small
+header plus flat columnar arrays:
+
+    magic "PQAG" | u16 version | u32 header_len | header (JSON)
+    then per section: u32 byte_len | little-endian array bytes
+
+The header holds scalars and the key dictionaries (state keys, action keys);
+the sections are laid out state-major over (state, action) pairs:
+
+    q_values        float64  (NaN = pair absent)
+    visit_counts    uint32
+    reward_count    float64  (RewardStats columns; count 0 = absent)
+    reward_mean     float64
+    reward_m2       float64
+
+encode/decode round-trip the same dict shape ScheduleAgent writes as JSON,
+so the agent can load either format.
+"""
+
+import json
+import math
+import struct
+import sys
+from array import array
+from typing import Any, Dict, List
+
+
+MAGIC = b"PQAG"
+FORMAT_VERSION = 2
+
+_HEADER = struct.Struct("<4sHI")
+_SECTION = struct.Struct("<I")
+
+
+def _pack(values: array) -> bytes:
+    """Serialize an array little-endian, prefixed with its byte length."""
+    if sys.byteorder != "little":
+        values = array(values.typecode, values)
+        values.byteswap()
+    raw = values.tobytes()
+    return _SECTION.pack(len(raw)) + raw
+
+
+def _unpack(blob: bytes, offset: int, typecode: str):
+    """
+    Read one length-prefixed section starting at offset.
+
+    Raises:
+        ValueError: If the section runs past the end of the bytes
+    """
+    if offset + _SECTION.size > len(blob):
+        raise ValueError("Truncated agent file")
+    (length,) = _SECTION.unpack_from(blob, offset)
+    offset += _SECTION.size
+    if offset + length > len(blob):
+        raise ValueError("Truncated agent file")
+    values = array(typecode)
+    values.frombytes(blob[offset:offset + length])
+    if sys.byteorder != "little":
+        values.byteswap()
+    return values, offset + length
+
+
+def is_binary(blob: bytes) -> bool:
+    """Check whether bytes start with the binary agent magic."""
+    return blob[:len(MAGIC)] == MAGIC
+
+
+def encode_agent_state(data: Dict[str, Any]) -> bytes:
+    """
+    Encode an agent snapshot dict into the binary format.
+
+    Args:
+        data: Dict with q_table, visit_counts, reward_stats ([count, mean, m2]
+            per pair) and scalars
+
+    Returns:
+        Encoded bytes
+    """
+    q_table: Dict[str, Dict[str, float]] = data.get("q_table", {})
+    visit_counts: Dict[str, Dict[str, int]] = data.get("visit_counts", {})
+    reward_stats: Dict[str, Dict[str, List[float]]] = data.get("reward_stats", {})
+
+    states = sorted(set(q_table) | set(visit_counts) | set(reward_stats))
+    action_set = set()
+    for table in (q_table, visit_counts, reward_stats):
+        for per_state in table.values():
+            action_set.update(per_state)
+    actions = sorted(action_set)
+
+    q_values = array("d")
+    visits = array("I")
+    reward_count = array("d")
+    reward_mean = array("d")
+    reward_m2 = array("d")
+
+    for state_key in states:
+        state_q = q_table.get(state_key, {})
+        state_visits = visit_counts.get(state_key, {})
+        state_rewards = reward_stats.get(state_key, {})
+        for action_key in actions:
+            q_values.append(state_q.get(action_key, math.nan))
+            visits.append(int(state_visits.get(action_key, 0)))
+            count, mean, m2 = state_rewards.get(action_key, (0.0, 0.0, 0.0))
+            reward_count.append(count)
+            reward_mean.append(mean)
+            reward_m2.append(m2)
+
+    header = {
+        key: value for key, value in data.items()
+        if key not in ("q_table", "visit_counts", "reward_stats")
+    }
+    header["states"] = states
+    header["actions"] = actions
+    header_bytes = json.dumps(header, separators=(",", ":")).encode("utf-8")
+
+    return b"".join([
+        _HEADER.pack(MAGIC, FORMAT_VERSION, len(header_bytes)),
+        header_bytes,
+        _pack(q_values),
+        _pack(visits),
+        _pack(reward_count),
+        _pack(reward_mean),
+        _pack(reward_m2),
+    ])
+
+
+def decode_agent_state(blob: bytes) -> Dict[str, Any]:
+    """
+    Decode binary agent bytes into the JSON-equivalent snapshot dict.
+
+    Raises:
+        ValueError: If the bytes are not a supported agent file
+    """
+    if len(blob) < _HEADER.size:
+        raise ValueError("Truncated agent file")
+
+    magic, version, header_len = _HEADER.unpack_from(blob, 0)
+    if magic != MAGIC:
+        raise ValueError("Not a binary agent file")
+    if version != FORMAT_VERSION:
+        raise ValueError(f"Unsupported agent format version {version}")
+
+    offset = _HEADER.size
+    if offset + header_len > len(blob):
+        raise ValueError("Truncated agent file")
+    header = json.loads(blob[offset:offset + header_len].decode("utf-8"))
+    offset += header_len
+
+    q_values, offset = _unpack(blob, offset, "d")
+    visits, offset = _unpack(blob, offset, "I")
+    reward_count, offset = _unpack(blob, offset, "d")
+    reward_mean, offset = _unpack(blob, offset, "d")
+    reward_m2, offset = _unpack(blob, offset, "d")
+
+    states = header.pop("states")
+    actions = header.pop("actions")
+    pairs = len(states) * len(actions)
+    columns = (q_values, visits, reward_count, reward_mean, reward_m2)
+    if any(len(column) != pairs for column in columns):
+        raise ValueError("Corrupted agent file: array size mismatch")
+
+    q_table: Dict[str, Dict[str, float]] = {}
+    visit_counts: Dict[str, Dict[str, int]] = {}
+    reward_stats: Dict[str, Dict[str, List[float]]] = {}
+
+    pair = 0
+    for state_key in states:
+        state_q = q_table.setdefault(state_key, {})
+        state_visits = visit_counts.setdefault(state_key, {})
+        state_rewards = reward_stats.setdefault(state_key, {})
+        for action_key in actions:
+            if not math.isnan(q_values[pair]):
+                state_q[action_key] = q_values[pair]
+            state_visits[action_key] = visits[pair]
+
+            if reward_count[pair] > 0:
+                state_rewards[action_key] = [reward_count[pair], reward_mean[pair], reward_m2[pair]]
+            pair += 1
+
+    header["q_table"] = q_table
+    header["visit_counts"] = visit_counts
+    header["reward_stats"] = reward_stats
+    return header
@@ -5,6 +5,8 @@ Configurable settings for the Q-Learning recommender.
 All "magic numbers" are centralized here with explanations for each value.
 """
 
+import os
+
 
 class AIConfig:
     """Configuration for the AI recommendation system."""
@@ -121,6 +123,13 @@ class AIConfig:
     # confidence = base - (variance * VARIANCE_PENALTY)
     VARIANCE_PENALTY: float = 0.3
 
+    # Forgetting factor for streaming reward statistics (1.0 = no forgetting).
+    # With decay d the mean/variance track roughly the last 1 / (1 - d)
+    # rewards. 0.95 (~20 rewards) matches the 20-reward window the agent
+    # kept before streaming statistics, so confidence still follows recent
+    # behaviour rather than all-time variance.
+    REWARD_STATS_DECAY: float = 0.95
+
     # =============================================================================
     # TIME BLOCK BOUNDARIES (24-hour format)
     # =============================================================================
@@ -179,6 +188,130 @@ class AIConfig:
     # Directory for saved agent models (relative to backend/)
     MODEL_DIRECTORY: str = "data/user_models"
 
+    # On-disk format for agent models: "binary" (compact columnar .bin)
+    # or "json" (legacy). Loading accepts either regardless of this setting.
+    AGENT_STORAGE_FORMAT: str = "binary"
+
+    # =============================================================================
+    # STARTUP WARM-UP
+    # =============================================================================
+    # After the server starts accepting traffic, a one-off background job
+    # loads the agents of recently active users so their first request after
+    # a deploy doesn't pay for the model file read.
+
+    # Disable to load every agent on first use only
+    AGENT_WARMUP_ENABLED: bool = True
+
+    # Wait after startup before warming (lets the first requests through)
+    AGENT_WARMUP_DELAY_SECONDS: float = 5.0
+
+    # Users with a recommendation in this many days count as recently active
+    AGENT_WARMUP_RECENT_DAYS: int = 3
+
+    # Upper bound on agents preloaded (most recently active first)
+    AGENT_WARMUP_MAX_USERS: int = 200
+
+    # =============================================================================
+    # DQN BATCHED INFERENCE
+    # =============================================================================
+    # Concurrent DQN inference requests are collected into micro-batches and
+    # answered with a single forward pass per model.
+
+    # How long the first request in a batch waits for others to join
+    # 2 ms adds negligible latency but amortizes PyTorch dispatch overhead
+    DQN_INFERENCE_WINDOW_MS: float = 2.0
+
+    # Flush immediately once this many requests are pending
+    DQN_INFERENCE_MAX_BATCH: int = 64
+
+    # Upper bound a caller waits for its result before giving up
+    DQN_INFERENCE_TIMEOUT_SECONDS: float = 1.0
+
+    # =============================================================================
+    # DQN SERVING WEIGHTS
+    # =============================================================================
+    # Inference-only NumPy exports of trained DQNs (see ai/dqn_weights.py),
+    # kept apart from the torch training checkpoints.
+
+    # Directory for per-user serving weights (relative to backend/)
+    DQN_SERVING_DIRECTORY: str = "data/dqn_serving"
+
+    # Max memory-mapped user models kept open per process
+    DQN_REGISTRY_MAX_MODELS: int = 1024
+
+    # =============================================================================
+    # DQN TRAINER (out-of-band, see train_dqn.py)
+    # =============================================================================
+    # Gradient steps run in a separate process that tails labelled
+    # RecommendationLog rows, so training never competes with request handling.
+
+    # Seconds between polls for newly labelled recommendations
+    DQN_TRAINER_POLL_SECONDS: float = 60.0
+
+    # How far back the trainer backfills its replay buffers on startup
+    DQN_TRAINER_LOOKBACK_DAYS: int = 30
+
+    # Rows read per keyset page while tailing
+    DQN_TRAINER_INGEST_PAGE_SIZE: int = 1000
+
+    # A recommendation's state is the latest browsing session this close before it
+    DQN_TRAINER_SESSION_WINDOW_MINUTES: int = 120
+
+    # Per-user replay capacity and minimum transitions before training a user
+    DQN_TRAINER_BUFFER_CAPACITY: int = 2000
+    DQN_TRAINER_MIN_TRANSITIONS: int = 32
+
+    # Gradient steps per round, per-user minibatch size, users per stacked model
+    DQN_TRAINER_STEPS_PER_ROUND: int = 50
+    DQN_TRAINER_BATCH_SIZE: int = 32
+    DQN_TRAINER_MAX_USERS_PER_BATCH: int = 256
+
+    # =============================================================================
+    # USER CONTEXT SNAPSHOT CACHE
+    # =============================================================================
+    # One recommendation reads tasks/mood/schedule once into a snapshot that
+    # every pipeline stage shares. Snapshots are reused for a short time and
+    # invalidated on task, mood and schedule writes.
+
+    # Max age of a cached snapshot (0 disables caching)
+    CONTEXT_CACHE_TTL_SECONDS: float = 30.0
+
+    # =============================================================================
+    # LLM CALLS
+    # =============================================================================
+    # Generations are bounded by a timeout and a concurrency limit. Identical
+    # in-flight prompts share one call, and parsed responses are cached by a
+    # hash of the normalized prompt inputs.
+
+    # Per-call timeout before falling back to rule-based output
+    LLM_TIMEOUT_SECONDS: float = 20.0
+
+    # Max concurrent generations per process (sync and async paths each)
+    LLM_MAX_CONCURRENCY: int = 4
+
+    # How long an identical request reuses a response (0 disables caching)
+    LLM_CACHE_TTL_SECONDS: float = 600.0
+
+    # Cached responses kept (least recently used evicted first)
+    LLM_CACHE_MAX_ENTRIES: int = 256
+
+    # Width of the time bucket in cache keys; requests in different buckets
+    # never share a response
+    LLM_CACHE_TIME_BUCKET_MINUTES: int = 30
+
+    # Streaming endpoints: give up on the model (and finish with the
+    # rule-based fallback) if no chunk arrives for this long
+    LLM_STREAM_STALL_SECONDS: float = 8.0
+
+    # Streamed blocks/subtasks are committed in batches of this size
+    LLM_STREAM_PERSIST_BATCH_SIZE: int = 3
+
+    # Rule-based fallback scheduler: "best_fit" packs medium/low-load tasks
+    # into the tightest gap that holds them, leaving long gaps for long
+    # tasks; high-load tasks still take the earliest gap (the morning peak).
+    # "first_fit" places every task in the earliest gap that holds it.
+    FALLBACK_SLOT_STRATEGY: str = "best_fit"
+
     # =============================================================================
     # IMPLICIT FEEDBACK DETECTION
     # =============================================================================
@@ -190,6 +323,64 @@ class AIConfig:
     # User likely ignored the recommendation
     IGNORE_DETECTION_HOURS: int = 2
 
+    # Run outcome inference every 30 minutes
+    FEEDBACK_INFER_INTERVAL_SECONDS: int = 1800
+
+    # Streaming outcome inference: logs per keyset page (one commit per page)
+    FEEDBACK_INFER_PAGE_SIZE: int = 200
+
+    # Parallel workers for the periodic inference job, each owning the users
+    # with user_id % workers == index. Keep 1 on SQLite (single writer).
+    FEEDBACK_INFER_WORKERS: int = 1
+
+    # =============================================================================
+    # BACKGROUND SCHEDULER
+    # =============================================================================
+    # Periodic jobs (persistence, inference, rollups, archival) run in a thread pool off
+    # the event loop. A tick is skipped while the previous run is in progress.
+
+    # Random +/- fraction of the interval added to each tick so several
+    # replicas don't hit the database in lockstep
+    BACKGROUND_JITTER_FRACTION: float = 0.1
+
+    # Threads available to periodic jobs (one per job avoids queueing)
+    BACKGROUND_MAX_WORKERS: int = 4
+
+    # =============================================================================
+    # DAILY ROLLUPS
+    # =============================================================================
+    # Writes mark (user, day) rollups dirty; the refresh job rebuilds them.
+    # Insights can lag a write by up to one interval.
+    ROLLUP_REFRESH_INTERVAL_SECONDS: int = 60
+
+    # Dirty days rebuilt per commit
+    ROLLUP_REFRESH_BATCH_SIZE: int = 100
+
+    # Longest date range the insights endpoints accept
+    INSIGHTS_MAX_RANGE_DAYS: int = 366
+
+    # =============================================================================
+    # DATA RETENTION (COLD STORAGE)
+    # =============================================================================
+    # Resolved recommendation logs and browsing sessions older than this move
+    # from the hot tables to gzip JSON-lines parts under ARCHIVE_DIRECTORY
+    # (tasks/archive.py). 0 (the default) keeps a table's rows in the
+    # database forever. Keep both above DQN_TRAINER_LOOKBACK_DAYS so the
+    # trainer's first ingest still finds its window in the database.
+    RECOMMENDATION_LOG_RETENTION_DAYS: int = int(os.getenv("RECOMMENDATION_LOG_RETENTION_DAYS", "0"))
+    BROWSING_SESSION_RETENTION_DAYS: int = int(os.getenv("BROWSING_SESSION_RETENTION_DAYS", "0"))
+
+    # Root for archive parts. Nothing is archived (or deleted) until this is
+    # set to an absolute path on durable storage, e.g. a mounted volume: the
+    # container filesystem is discarded on every redeploy
+    ARCHIVE_DIRECTORY: str = os.getenv("ARCHIVE_DIRECTORY", "")
+
+    # Run the archive job every 6 hours
+    ARCHIVE_INTERVAL_SECONDS: int = 6 * 3600
+
+    # Rows per archive batch (one part file per month and one commit each)
+    ARCHIVE_BATCH_SIZE: int = 5000
+
     # =============================================================================
     # HELPER METHODS
     # =============================================================================
@@ -11,6 +11,7 @@ from sqlalchemy import func
 from .state import UserState
 from .mood_mapper import MoodMapper
 from .config import AIConfig
+from .user_context import UserContextSnapshot
 
 
 class ContextEncoder:
@@ -33,7 +34,8 @@ class ContextEncoder:
         self,
         db: Session,
         current_time: Optional[datetime] = None,
-        user_id: Optional[int] = None
+        user_id: Optional[int] = None,
+        context: Optional[UserContextSnapshot] = None
     ) -> UserState:
         """
         Encode current context into UserState.
@@ -42,6 +44,7 @@ class ContextEncoder:
             db: Database session
             current_time: Current datetime (defaults to now)
             user_id: User ID (required for multi-user mode)
+            context: Preloaded user snapshot (skips the per-feature queries)
 
         Returns:
             UserState with all features encoded
@@ -56,8 +59,8 @@ class ContextEncoder:
         day_of_week = self._map_weekday_to_day_of_week(current_time.weekday())
 
         # Extract user state features from database
-        energy_level = self._calculate_energy_level(db, user_id, time_block, current_time)
-        workload_pressure = self._calculate_workload_pressure(db, user_id, current_time)
+        energy_level = self._calculate_energy_level(db, user_id, time_block, current_time, context)
+        workload_pressure = self._calculate_workload_pressure(db, user_id, current_time, context)
 
         return UserState(
             time_block=time_block,
@@ -83,7 +86,8 @@ class ContextEncoder:
         db: Session,
         user_id: int,
         time_block: str,
-        current_time: datetime
+        current_time: datetime,
+        context: Optional[UserContextSnapshot] = None
     ) -> str:
         """
         Calculate energy level from mood, time, and activity.
@@ -99,11 +103,16 @@ class ContextEncoder:
         from models.mood import MoodEntry
         from models.task import Task
 
+        today_start = current_time.replace(hour=0, minute=0, second=0, microsecond=0)
+
         # Get latest mood entry for this user (within last 24 hours)
-        latest_mood = db.query(MoodEntry).filter(
-            MoodEntry.user_id == user_id,
-            MoodEntry.timestamp >= current_time.replace(hour=0, minute=0, second=0)
-        ).order_by(MoodEntry.timestamp.desc()).first()
+        if context is not None:
+            latest_mood = context.latest_mood_since(today_start)
+        else:
+            latest_mood = db.query(MoodEntry).filter(
+                MoodEntry.user_id == user_id,
+                MoodEntry.timestamp >= today_start
+            ).order_by(MoodEntry.timestamp.desc()).first()
 
         # Base mood score
         if latest_mood:
@@ -112,13 +121,15 @@ class ContextEncoder:
             mood_score = AIConfig.DEFAULT_MOOD_SCORE
 
         # Get tasks completed today for this user
-        today_start = current_time.replace(hour=0, minute=0, second=0, microsecond=0)
-        tasks_completed_today = db.query(Task).filter(
-            Task.user_id == user_id,
-            Task.status == "completed",
-            Task.completed_at >= today_start,
-            Task.is_deleted == False
-        ).count()
+        if context is not None:
+            tasks_completed_today = context.tasks_completed_today
+        else:
+            tasks_completed_today = db.query(Task).filter(
+                Task.user_id == user_id,
+                Task.status == "completed",
+                Task.completed_at >= today_start,
+                Task.is_deleted == False
+            ).count()
 
         # Apply circadian rhythm boost (morning with few tasks = fresh energy)
         if time_block == "morning" and tasks_completed_today < AIConfig.MORNING_BOOST_MAX_TASKS:
@@ -151,7 +162,8 @@ class ContextEncoder:
         self,
         db: Session,
         user_id: int,
-        current_time: datetime
+        current_time: datetime,
+        context: Optional[UserContextSnapshot] = None
     ) -> str:
         """
         Calculate workload pressure from pending tasks.
@@ -166,6 +178,15 @@ class ContextEncoder:
         from models.task import Task
         from datetime import timedelta
 
+        deadline_threshold = current_time + timedelta(hours=24)
+
+        if context is not None:
+            if context.count_pending_with_priority(4) > 0:
+                return "high"
+            if context.has_deadline_before(deadline_threshold):
+                return "high"
+            return "low"
+
         # Check for high-priority pending tasks for this user
         high_priority_count = db.query(Task).filter(
             Task.user_id == user_id,
@@ -178,7 +199,6 @@ class ContextEncoder:
             return "high"
 
         # Check for urgent deadlines (within 24 hours)
-        deadline_threshold = current_time + timedelta(hours=24)
         urgent_deadline_count = db.query(Task).filter(
             Task.user_id == user_id,
             Task.status == "pending",
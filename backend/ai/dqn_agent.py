@@ -14,6 +14,12 @@ import os
 
 from .replay_buffer import ReplayBuffer
 from .feature_encoder import FeatureEncoder
+from .dqn_weights import DQNWeights
+
+
+# Bump when the training checkpoint layout changes (independent of
+# dqn_weights.SERVING_FORMAT_VERSION)
+TRAINING_FORMAT_VERSION = 1
 
 
 class DQNNetwork(nn.Module):
@@ -70,6 +76,161 @@ class DQNNetwork(nn.Module):
         return q_values
 
 
+class StackedDQN(nn.Module):
+    """
+    Many users' DQNNetworks trained as one batched model.
+
+    Each layer's weights are stacked along a leading user axis and applied
+    with one batched matmul, so a training step for N users is three bmm
+    calls instead of N separate forward/backward passes. Users stay
+    independent: the loss is a sum of per-user losses, gradients are
+    clipped per user, and Adam's updates are elementwise.
+    """
+
+    LAYERS = ("fc1", "fc2", "fc3")
+
+    def __init__(self, networks: List[DQNNetwork]):
+        """
+        Stack copies of the given networks' parameters.
+
+        Args:
+            networks: Networks with identical shapes (one per user)
+        """
+        super(StackedDQN, self).__init__()
+
+        for name in self.LAYERS:
+            weights = torch.stack([getattr(net, name).weight.detach() for net in networks])
+            biases = torch.stack([getattr(net, name).bias.detach() for net in networks])
+            # (users, in, out) and (users, 1, out) for baddbmm
+            setattr(self, f"{name}_weight", nn.Parameter(weights.transpose(1, 2).contiguous()))
+            setattr(self, f"{name}_bias", nn.Parameter(biases.unsqueeze(1).clone()))
+
+    def forward(self, states: torch.Tensor) -> torch.Tensor:
+        """
+        Forward pass for every user at once.
+
+        Args:
+            states: State tensor (num_users, batch_size, state_dim)
+
+        Returns:
+            Q-values (num_users, batch_size, action_dim)
+        """
+        x = F.relu(torch.baddbmm(self.fc1_bias, states, self.fc1_weight))
+        x = F.relu(torch.baddbmm(self.fc2_bias, x, self.fc2_weight))
+        return torch.baddbmm(self.fc3_bias, x, self.fc3_weight)
+
+    def clip_grad_norm_(self, max_norm: float):
+        """Clip each user's gradient to max_norm (matches per-agent clipping)."""
+        grads = [p.grad for p in self.parameters() if p.grad is not None]
+        if not grads:
+            return
+        norms = torch.sqrt(sum(g.pow(2).flatten(1).sum(1) for g in grads))
+        scale = (max_norm / (norms + 1e-6)).clamp(max=1.0)
+        for g in grads:
+            g.mul_(scale.view(-1, *([1] * (g.dim() - 1))))
+
+    def copy_users_from(self, source: "StackedDQN", users: torch.Tensor):
+        """Overwrite the selected users' parameters with source's (bool mask over users)."""
+        with torch.no_grad():
+            for name, param in self.named_parameters():
+                param[users] = getattr(source, name)[users]
+
+    def copy_to(self, networks: List[DQNNetwork]):
+        """Write the stacked parameters back into per-user networks."""
+        with torch.no_grad():
+            for i, net in enumerate(networks):
+                for name in self.LAYERS:
+                    getattr(net, name).weight.copy_(getattr(self, f"{name}_weight")[i].T)
+                    getattr(net, name).bias.copy_(getattr(self, f"{name}_bias")[i, 0])
+
+
+class StackedAdam:
+    """
+    Adam for a StackedDQN that keeps each user's own optimizer state.
+
+    torch.optim.Adam keeps one step count per parameter tensor, but a
+    stacked tensor holds users at different steps. This applies the same
+    update (no weight decay or amsgrad) with a per-user step count, starting
+    from each agent's own optimizer state and writing it back afterwards,
+    so Adam's moments carry over from one training round to the next.
+    """
+
+    def __init__(self, stacked: StackedDQN, agents: List["DQNAgent"]):
+        """
+        Args:
+            stacked: Stacked policy built from the agents' policy networks
+            agents: The agents, in stacking order (hyperparameters from the first)
+        """
+        group = agents[0].optimizer.param_groups[0]
+        self.lr = group["lr"]
+        self.beta1, self.beta2 = group["betas"]
+        self.eps = group["eps"]
+        self.stacked = stacked
+
+        self.steps = torch.tensor(
+            [float(agent.optimizer.state.get(agent.policy_net.fc1.weight, {}).get("step", 0)) for agent in agents]
+        )
+        self.exp_avg = {}
+        self.exp_avg_sq = {}
+        for name, param, per_user in self._params(agents):
+            for moments, key in ((self.exp_avg, "exp_avg"), (self.exp_avg_sq, "exp_avg_sq")):
+                moments[name] = torch.stack([
+                    self._to_stacked(state.get(key, torch.zeros_like(user_param)), name)
+                    for user_param, state in per_user
+                ])
+
+    def _params(self, agents: List["DQNAgent"]):
+        """(stacked name, stacked param, [(agent param, agent Adam state)]) per layer tensor."""
+        for layer in StackedDQN.LAYERS:
+            for kind in ("weight", "bias"):
+                name = f"{layer}_{kind}"
+                per_user = []
+                for agent in agents:
+                    user_param = getattr(getattr(agent.policy_net, layer), kind)
+                    per_user.append((user_param, agent.optimizer.state.get(user_param, {})))
+                yield name, getattr(self.stacked, name), per_user
+
+    @staticmethod
+    def _to_stacked(tensor: torch.Tensor, name: str) -> torch.Tensor:
+        """One user's tensor in StackedDQN layout (weights transposed, biases (1, out))."""
+        return tensor.detach().T if name.endswith("weight") else tensor.detach().unsqueeze(0)
+
+    @staticmethod
+    def _from_stacked(tensor: torch.Tensor, name: str) -> torch.Tensor:
+        """Inverse of _to_stacked for one user's slice."""
+        return tensor.T.clone() if name.endswith("weight") else tensor[0].clone()
+
+    def zero_grad(self):
+        """Drop the stacked gradients."""
+        for param in self.stacked.parameters():
+            param.grad = None
+
+    def step(self):
+        """One Adam update for every user (same arithmetic as torch.optim.Adam)."""
+        self.steps += 1
+        bias_correction1 = (1 - self.beta1 ** self.steps).view(-1, 1, 1)
+        bias_correction2 = (1 - self.beta2 ** self.steps).view(-1, 1, 1)
+        with torch.no_grad():
+            for name, param in self.stacked.named_parameters():
+                if param.grad is None:
+                    continue
+                exp_avg, exp_avg_sq = self.exp_avg[name], self.exp_avg_sq[name]
+                exp_avg.mul_(self.beta1).add_(param.grad, alpha=1 - self.beta1)
+                exp_avg_sq.mul_(self.beta2).addcmul_(param.grad, param.grad, value=1 - self.beta2)
+                denom = (exp_avg_sq.sqrt() / bias_correction2.sqrt()).add_(self.eps)
+                param.sub_(self.lr / bias_correction1 * exp_avg / denom)
+
+    def copy_to(self, agents: List["DQNAgent"]):
+        """Store each user's moments and step count in their agent's optimizer."""
+        for name, _, per_user in self._params(agents):
+            for i, (user_param, _) in enumerate(per_user):
+                agents[i].optimizer.state[user_param] = {
+                    "step": torch.tensor(float(self.steps[i])),
+                    "exp_avg": self._from_stacked(self.exp_avg[name][i], name),
+                    "exp_avg_sq": self._from_stacked(self.exp_avg_sq[name][i], name),
+                }
+
+
 class DQNAgent:
     """
     DQN Agent for task recommendation.
@@ -130,7 +291,7 @@ class DQNAgent:
         self.optimizer = optim.Adam(self.policy_net.parameters(), lr=lr)
 
         # Replay buffer
-        self.replay_buffer = ReplayBuffer(capacity=buffer_capacity)
+        self.replay_buffer = ReplayBuffer(capacity=buffer_capacity, state_dim=state_dim)
 
         # Feature encoder
         self.feature_encoder = FeatureEncoder()
@@ -197,6 +358,64 @@ class DQNAgent:
 
         return q_values
 
+    def get_q_values_batch(self, states: np.ndarray) -> np.ndarray:
+        """
+        Get Q-values for a batch of states in one forward pass.
+
+        Args:
+            states: State features (batch_size, state_dim)
+
+        Returns:
+            Q-values (batch_size, action_dim)
+        """
+        states = np.ascontiguousarray(states, dtype=np.float32)
+        with torch.no_grad():
+            state_tensor = torch.from_numpy(states).to(self.device)
+            q_values = self.policy_net(state_tensor).cpu().numpy()
+
+        return q_values
+
+    def select_actions_batch(
+        self,
+        states: np.ndarray,
+        action_masks: Optional[np.ndarray] = None,
+        epsilons: Optional[np.ndarray] = None
+    ) -> Tuple[np.ndarray, np.ndarray]:
+        """
+        Vectorized epsilon-greedy selection for many states at once.
+
+        Args:
+            states: State features (batch_size, state_dim)
+            action_masks: Boolean (batch_size, action_dim) of allowed actions;
+                rows with no allowed action are left unmasked
+            epsilons: Per-row exploration rate (uses self.epsilon if None)
+
+        Returns:
+            Tuple of (actions (batch_size,), q_values (batch_size, action_dim))
+        """
+        q_values = self.get_q_values_batch(states)
+        batch_size = q_values.shape[0]
+
+        if action_masks is None:
+            action_masks = np.ones_like(q_values, dtype=bool)
+        else:
+            action_masks = np.asarray(action_masks, dtype=bool).copy()
+            action_masks[~action_masks.any(axis=1)] = True
+
+        # Greedy action (exploit) over allowed actions
+        masked_q = np.where(action_masks, q_values, -np.inf)
+        actions = masked_q.argmax(axis=1)
+
+        # Epsilon-greedy exploration: uniform over each row's allowed actions
+        if epsilons is None:
+            epsilons = np.full(batch_size, self.epsilon)
+        explore = np.random.random(batch_size) < epsilons
+        if explore.any():
+            noise = np.where(action_masks[explore], np.random.random(action_masks[explore].shape), -1.0)
+            actions[explore] = noise.argmax(axis=1)
+
+        return actions, q_values
+
     def store_transition(
         self,
         state: np.ndarray,
@@ -231,12 +450,13 @@ class DQNAgent:
         # Sample mini-batch
         states, actions, rewards, next_states, dones = self.replay_buffer.sample(self.batch_size)
 
-        # Convert to tensors
-        states = torch.FloatTensor(states).to(self.device)
-        actions = torch.LongTensor(actions).to(self.device)
-        rewards = torch.FloatTensor(rewards).to(self.device)
-        next_states = torch.FloatTensor(next_states).to(self.device)
-        dones = torch.FloatTensor(dones).to(self.device)
+        # Convert to tensors (zero-copy: the buffer already yields contiguous
+        # float32/int64 arrays)
+        states = torch.from_numpy(states).to(self.device)
+        actions = torch.from_numpy(actions).to(self.device)
+        rewards = torch.from_numpy(rewards).to(self.device)
+        next_states = torch.from_numpy(next_states).to(self.device)
+        dones = torch.from_numpy(dones).to(self.device)
 
         # Compute current Q-values
         current_q_values = self.policy_net(states).gather(1, actions.unsqueeze(1)).squeeze(1)
@@ -282,6 +502,7 @@ class DQNAgent:
         os.makedirs(os.path.dirname(path), exist_ok=True)
 
         torch.save({
+            'format_version': TRAINING_FORMAT_VERSION,
             'policy_net_state_dict': self.policy_net.state_dict(),
             'target_net_state_dict': self.target_net.state_dict(),
             'optimizer_state_dict': self.optimizer.state_dict(),
@@ -299,6 +520,8 @@ class DQNAgent:
             path: File path to load model from
         """
         checkpoint = torch.load(path, map_location=self.device)
+        if checkpoint.get('format_version', 1) > TRAINING_FORMAT_VERSION:
+            raise ValueError(f"Unsupported checkpoint format: {checkpoint['format_version']}")
 
         self.policy_net.load_state_dict(checkpoint['policy_net_state_dict'])
         self.target_net.load_state_dict(checkpoint['target_net_state_dict'])
@@ -308,6 +531,29 @@ class DQNAgent:
 
         print(f"Model loaded from {path}")
 
+    def export_weights(self) -> DQNWeights:
+        """
+        Export the policy network for torch-free serving.
+
+        Returns:
+            DQNWeights copy of the current policy network
+        """
+        return DQNWeights.from_state_dict(
+            self.policy_net.state_dict(),
+            epsilon=self.epsilon,
+            training_step=self.training_step
+        )
+
+    def export(self, path_prefix: str):
+        """
+        Write serving weights (`<prefix>.npy` + `<prefix>.json`).
+
+        Args:
+            path_prefix: Path without suffix
+        """
+        self.export_weights().save(path_prefix)
+        print(f"Serving weights exported to {path_prefix}")
+
     def get_training_stats(self) -> dict:
         """
         Get training statistics.
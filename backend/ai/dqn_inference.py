@@ -0,0 +1,281 @@
+"""
+DQN Inference Server
+Micro-batching front end for DQNAgent action selection.
+
+Concurrent recommendation calls each used to pay a full PyTorch forward pass
+for a single state. Requests are instead queued, collected for a short window
+(or until a batch fills), and answered with one batched forward pass per model.
+
+No route serves DQN actions yet: /ai/recommendation uses the tabular
+HybridRecommender. A DQN-backed recommendation path should hold one server
+per worker process, built with DQNWeightRegistry().require as the resolver,
+and call select_action() with the FeatureEncoder state and the masked
+action indices.
+"""
+
+import queue
+import threading
+import time
+from concurrent.futures import Future
+from dataclasses import dataclass
+from typing import Callable, Dict, List, Optional
+
+import numpy as np
+
+from core.metrics import Histogram
+
+from .config import AIConfig
+
+
+@dataclass
+class InferenceResult:
+    """Result delivered to each caller's future."""
+    action: int
+    q_values: np.ndarray
+    batch_size: int
+
+
+@dataclass
+class _PendingRequest:
+    """A queued inference request."""
+    user_id: int
+    state: np.ndarray
+    available_actions: Optional[List[int]]
+    epsilon: Optional[float]
+    future: Future
+    enqueued_at: float
+
+
+class DQNInferenceServer:
+    """
+    Collects pending (user, state, available_actions) requests and serves
+    them in batches on a background worker thread.
+
+    Usage:
+        server = DQNInferenceServer(lambda user_id: agents[user_id])
+        action = server.select_action(user_id, state, available_actions)
+
+    Requests for users that resolve to the same DQNAgent share one forward
+    pass; distinct agents in the same window each get their own batch.
+    """
+
+    # Bucket boundaries for batch sizes (requests) and latency (milliseconds)
+    BATCH_SIZE_BUCKETS = [1, 2, 4, 8, 16, 32, 64, 128]
+    LATENCY_BUCKETS_MS = [0.5, 1, 2, 5, 10, 25, 50, 100, 250]
+
+    def __init__(
+        self,
+        agent_resolver: Callable[[int], "DQNAgent"],
+        window_ms: float = AIConfig.DQN_INFERENCE_WINDOW_MS,
+        max_batch_size: int = AIConfig.DQN_INFERENCE_MAX_BATCH
+    ):
+        """
+        Initialize the inference server (worker starts lazily).
+
+        Args:
+            agent_resolver: Maps a user_id to the DQNAgent (or torch-free
+                DQNWeights, e.g. DQNWeightRegistry.require) that serves them
+            window_ms: Max time the first queued request waits for company
+            max_batch_size: Flush as soon as this many requests are queued
+        """
+        self.agent_resolver = agent_resolver
+        self.window_seconds = window_ms / 1000.0
+        self.max_batch_size = max_batch_size
+
+        self._queue: "queue.Queue[Optional[_PendingRequest]]" = queue.Queue()
+        self._thread: Optional[threading.Thread] = None
+        self._start_lock = threading.Lock()
+        self._running = False
+
+        # Per-server (not in the /metrics registry); read through get_stats()
+        self.batch_size_histogram = Histogram(
+            "dqn_inference_batch_size", "Requests per served batch", buckets=self.BATCH_SIZE_BUCKETS
+        )
+        self.queue_latency_histogram = Histogram(
+            "dqn_inference_queue_latency_ms", "Time requests wait for their batch", buckets=self.LATENCY_BUCKETS_MS
+        )
+        self.forward_latency_histogram = Histogram(
+            "dqn_inference_forward_latency_ms", "Batched forward pass duration", buckets=self.LATENCY_BUCKETS_MS
+        )
+
+    def start(self):
+        """Start the background worker if it isn't running."""
+        with self._start_lock:
+            if self._running:
+                return
+            self._running = True
+            self._thread = threading.Thread(
+                target=self._run, name="dqn-inference", daemon=True
+            )
+            self._thread.start()
+
+    def stop(self, timeout: float = 1.0):
+        """Stop the worker; requests still queued are failed."""
+        with self._start_lock:
+            if not self._running:
+                return
+            self._running = False
+            self._queue.put(None)  # Wake the worker
+        if self._thread:
+            self._thread.join(timeout)
+            self._thread = None
+
+        # Fail anything that arrived after the worker exited
+        while True:
+            try:
+                pending = self._queue.get_nowait()
+            except queue.Empty:
+                break
+            if pending is not None and not pending.future.done():
+                pending.future.set_exception(RuntimeError("DQN inference server stopped"))
+
+    def submit(
+        self,
+        user_id: int,
+        state: np.ndarray,
+        available_actions: Optional[List[int]] = None,
+        epsilon: Optional[float] = None
+    ) -> Future:
+        """
+        Queue an inference request.
+
+        Args:
+            user_id: User whose agent should answer
+            state: State features (state_dim,)
+            available_actions: Allowed action indices (None = all)
+            epsilon: Exploration rate (uses the agent's epsilon if None)
+
+        Returns:
+            Future resolving to an InferenceResult
+        """
+        if not self._running:
+            self.start()
+
+        future: Future = Future()
+        self._queue.put(_PendingRequest(
+            user_id=user_id,
+            state=np.asarray(state, dtype=np.float32),
+            available_actions=available_actions,
+            epsilon=epsilon,
+            future=future,
+            enqueued_at=time.perf_counter(),
+        ))
+        return future
+
+    def select_action(
+        self,
+        user_id: int,
+        state: np.ndarray,
+        available_actions: Optional[List[int]] = None,
+        epsilon: Optional[float] = None,
+        timeout: float = AIConfig.DQN_INFERENCE_TIMEOUT_SECONDS
+    ) -> int:
+        """
+        Blocking equivalent of DQNAgent.select_action served from a batch.
+
+        Returns:
+            Selected action index
+        """
+        return self.submit(user_id, state, available_actions, epsilon).result(timeout).action
+
+    def get_q_values(
+        self,
+        user_id: int,
+        state: np.ndarray,
+        timeout: float = AIConfig.DQN_INFERENCE_TIMEOUT_SECONDS
+    ) -> np.ndarray:
+        """
+        Blocking equivalent of DQNAgent.get_q_values served from a batch.
+
+        Returns:
+            Q-values for all actions
+        """
+        return self.submit(user_id, state, epsilon=0.0).result(timeout).q_values
+
+    def _run(self):
+        """Worker loop: gather a batch, then serve it."""
+        while self._running:
+            first = self._queue.get()
+            if first is None:
+                continue
+
+            batch = [first]
+            deadline = first.enqueued_at + self.window_seconds
+
+            while len(batch) < self.max_batch_size:
+                remaining = deadline - time.perf_counter()
+                if remaining <= 0:
+                    break
+                try:
+                    item = self._queue.get(timeout=remaining)
+                except queue.Empty:
+                    break
+                if item is None:
+                    break
+                batch.append(item)
+
+            self._serve_batch(batch)
+
+    def _serve_batch(self, batch: List[_PendingRequest]):
+        """Resolve agents, run one forward pass per agent and fill futures."""
+        self.batch_size_histogram.observe(len(batch))
+
+        # Group requests by the agent that serves them
+        groups: Dict[int, List[_PendingRequest]] = {}
+        agents: Dict[int, "DQNAgent"] = {}
+        for request in batch:
+            try:
+                agent = self.agent_resolver(request.user_id)
+            except Exception as e:
+                request.future.set_exception(e)
+                continue
+            key = id(agent)
+            agents[key] = agent
+            groups.setdefault(key, []).append(request)
+
+        for key, requests in groups.items():
+            agent = agents[key]
+            started = time.perf_counter()
+            try:
+                states = np.stack([r.state for r in requests])
+
+                masks = np.zeros((len(requests), agent.action_dim), dtype=bool)
+                for row, request in enumerate(requests):
+                    if request.available_actions:
+                        masks[row, request.available_actions] = True
+                    else:
+                        masks[row] = True
+
+                epsilons = np.array([
+                    agent.epsilon if r.epsilon is None else r.epsilon
+                    for r in requests
+                ])
+
+                actions, q_values = agent.select_actions_batch(states, masks, epsilons)
+            except Exception as e:
+                for request in requests:
+                    request.future.set_exception(e)
+                continue
+
+            finished = time.perf_counter()
+            self.forward_latency_histogram.observe((finished - started) * 1000.0)
+
+            for row, request in enumerate(requests):
+                self.queue_latency_histogram.observe((started - request.enqueued_at) * 1000.0)
+                request.future.set_result(InferenceResult(
+                    action=int(actions[row]),
+                    q_values=q_values[row],
+                    batch_size=len(requests),
+                ))
+
+    def get_stats(self) -> Dict:
+        """Get batch size and latency histograms for tuning the window."""
+        return {
+            "running": self._running,
+            "window_ms": self.window_seconds * 1000.0,
+            "max_batch_size": self.max_batch_size,
+            "pending": self._queue.qsize(),
+            "batch_size": self.batch_size_histogram.snapshot(),
+            "queue_latency_ms": self.queue_latency_histogram.snapshot(),
+            "forward_latency_ms": self.forward_latency_histogram.snapshot(),
+        }
@@ -0,0 +1,375 @@
+"""
+DQN Trainer
+Out-of-band training of per-user DQNs from labelled recommendations.
+
+Runs in its own process (see train_dqn.py) instead of calling
+DQNAgent.train_step inside API workers. Each round it:
+
+1. Tails RecommendationLog rows whose outcome was recorded since the last
+   poll (keyset on (outcome_recorded_at, id)) and turns them into
+   transitions. The state is the user's latest BrowsingSession, encoded
+   with FeatureEncoder. The next state is the latest session before the
+   outcome was recorded.
+2. Trains every user with enough transitions as one StackedDQN, so a
+   gradient step for hundreds of users is a few batched matmuls.
+3. Saves each user's training checkpoint and publishes serving weights
+   through DQNWeightRegistry. Serving workers pick those up on their next
+   lookup.
+
+Logs and sessions past the retention window live in cold storage
+(tasks/archive.py). ingest_archive() feeds them through the same
+transition builder.
+"""
+
+import os
+from bisect import bisect_left, bisect_right
+from datetime import datetime, timedelta, timezone
+from typing import Callable, Dict, List, Optional, Sequence, Set, Tuple
+
+import numpy as np
+from sqlalchemy import and_, or_
+from sqlalchemy.orm import Session
+
+from .actions import ActionType
+from .config import AIConfig
+from .dqn_weights import DQNWeightRegistry
+from .feature_encoder import FeatureEncoder
+from .replay_buffer import ReplayBuffer
+from .reward_calculator import Outcome, RewardCalculator
+
+
+# Action index of each ActionType in the DQN output layer
+ACTION_INDEX: Dict[str, int] = {action.value: i for i, action in enumerate(ActionType)}
+
+
+class DQNTrainer:
+    """
+    Tails labelled recommendations into per-user replay buffers and trains
+    the users' networks in stacked batches.
+    """
+
+    def __init__(
+        self,
+        registry: Optional[DQNWeightRegistry] = None,
+        checkpoint_directory: str = AIConfig.MODEL_DIRECTORY,
+        lookback_days: int = AIConfig.DQN_TRAINER_LOOKBACK_DAYS
+    ):
+        """
+        Args:
+            registry: Where serving weights are published
+            checkpoint_directory: Where per-user training checkpoints live
+            lookback_days: Backfill window for the first ingest
+        """
+        self.registry = registry or DQNWeightRegistry()
+        self.checkpoint_directory = checkpoint_directory
+        self.lookback_days = lookback_days
+        self.encoder = FeatureEncoder()
+        self.rewards = RewardCalculator()
+        self.buffers: Dict[int, ReplayBuffer] = {}
+        self._fresh: Set[int] = set()  # Users with transitions not yet trained on
+        self._cursor: Optional[Tuple[datetime, int]] = None  # Last (outcome_recorded_at, id) ingested
+
+    def checkpoint_path(self, user_id: int) -> str:
+        """Training checkpoint path for a user."""
+        return os.path.join(self.checkpoint_directory, f"dqn_user_{user_id}.pt")
+
+    # =========================================================================
+    # Ingestion
+    # =========================================================================
+
+    def ingest(self, db: Session, page_size: int = AIConfig.DQN_TRAINER_INGEST_PAGE_SIZE) -> int:
+        """
+        Add transitions for recommendations labelled since the last call.
+
+        Args:
+            db: Database session
+            page_size: Rows per keyset page
+
+        Returns:
+            Number of transitions added
+        """
+        from models.recommendation_log import RecommendationLog
+
+        added = 0
+        while True:
+            query = db.query(RecommendationLog).filter(
+                RecommendationLog.user_id != None,
+                RecommendationLog.outcome != None,
+                RecommendationLog.outcome_recorded_at != None,
+            )
+            if self._cursor is None:
+                since = datetime.now(timezone.utc) - timedelta(days=self.lookback_days)
+                query = query.filter(RecommendationLog.outcome_recorded_at >= since)
+            else:
+                last_at, last_id = self._cursor
+                query = query.filter(or_(
+                    RecommendationLog.outcome_recorded_at > last_at,
+                    and_(
+                        RecommendationLog.outcome_recorded_at == last_at,
+                        RecommendationLog.id > last_id,
+                    ),
+                ))
+
+            page = query.order_by(
+                RecommendationLog.outcome_recorded_at, RecommendationLog.id
+            ).limit(page_size).all()
+            if not page:
+                break
+
+            added += self._add_page(page, lambda user_id, start, end: self._query_sessions(db, user_id, start, end))
+            self._cursor = (page[-1].outcome_recorded_at, page[-1].id)
+            if len(page) < page_size:
+                break
+
+        return added
+
+    def ingest_archive(
+        self,
+        archive: "ColdArchive",
+        since: Optional[datetime] = None,
+        page_size: int = AIConfig.DQN_TRAINER_INGEST_PAGE_SIZE
+    ) -> int:
+        """
+        Add transitions for recommendations moved to cold storage.
+
+        Archived logs are always resolved, and their sessions are archived
+        with them, so this backfills history older than the hot tables
+        keep. Call it before the first ingest(): buffers keep the newest
+        transitions once full.
+
+        Args:
+            archive: Cold storage reader (tasks/archive.py)
+            since: Only logs recommended at or after this time
+            page_size: Logs per transition batch
+
+        Returns:
+            Number of transitions added
+        """
+        from types import SimpleNamespace
+
+        window = timedelta(minutes=AIConfig.DQN_TRAINER_SESSION_WINDOW_MINUTES)
+        sessions: Dict[int, List[Tuple]] = {}
+        for row in archive.iter_rows("browsing_sessions", start=since - window if since else None):
+            if row["user_id"] is not None:
+                sessions.setdefault(row["user_id"], []).append(
+                    tuple(row[name] for name in FeatureEncoder.SESSION_COLUMNS)
+                )
+        for rows in sessions.values():
+            rows.sort(key=lambda row: row[0])
+        times = {user_id: [row[0] for row in rows] for user_id, rows in sessions.items()}
+
+        def load_sessions(user_id: int, start: datetime, end: datetime) -> List[Tuple]:
+            user_times = times.get(user_id, [])
+            return sessions.get(user_id, [])[bisect_left(user_times, start):bisect_right(user_times, end)]
+
+        added = 0
+        page = []
+        for row in archive.iter_rows("recommendation_logs", start=since):
+            if row["user_id"] is None or row["outcome"] is None or row["outcome_recorded_at"] is None:
+                continue
+            page.append(SimpleNamespace(**row))
+            if len(page) >= page_size:
+                added += self._add_page(page, load_sessions)
+                page = []
+        if page:
+            added += self._add_page(page, load_sessions)
+        return added
+
+    def _add_page(
+        self,
+        logs: List["RecommendationLog"],
+        load_sessions: Callable[[int, datetime, datetime], Sequence[Tuple]]
+    ) -> int:
+        """Turn one page of logs into transitions, one session load per user."""
+        by_user: Dict[int, List["RecommendationLog"]] = {}
+        for log in logs:
+            if log.action_type in ACTION_INDEX:
+                by_user.setdefault(log.user_id, []).append(log)
+
+        window = timedelta(minutes=AIConfig.DQN_TRAINER_SESSION_WINDOW_MINUTES)
+        added = 0
+        for user_id, user_logs in by_user.items():
+            # The user's sessions covering the logs' time span (sorted by time)
+            session_rows = load_sessions(
+                user_id,
+                min(log.timestamp for log in user_logs) - window,
+                max(log.outcome_recorded_at for log in user_logs),
+            )
+            if not session_rows:
+                continue
+            times = [row[0] for row in session_rows]
+            features = self.encoder.encode_session_rows(session_rows)
+
+            rows = [self._transition(log, times, features) for log in user_logs]
+            rows = [row for row in rows if row is not None]
+            if not rows:
+                continue
+
+            states, actions, rewards, next_states, dones = (np.array(col) for col in zip(*rows))
+            buffer = self.buffers.get(user_id)
+            if buffer is None:
+                buffer = ReplayBuffer(
+                    capacity=AIConfig.DQN_TRAINER_BUFFER_CAPACITY,
+                    state_dim=self.encoder.get_feature_dim()
+                )
+                self.buffers[user_id] = buffer
+            buffer.push_batch(states, actions, rewards, next_states, dones)
+            self._fresh.add(user_id)
+            added += len(rows)
+
+        return added
+
+    def _query_sessions(self, db: Session, user_id: int, start: datetime, end: datetime) -> List[Tuple]:
+        """A user's session rows in [start, end], sorted by time."""
+        from models.extension_metadata import BrowsingSession
+
+        # Column query straight into the vectorized encoder (no ORM objects)
+        return db.query(*FeatureEncoder.session_columns()).filter(
+            BrowsingSession.user_id == user_id,
+            BrowsingSession.timestamp >= start,
+            BrowsingSession.timestamp <= end,
+        ).order_by(BrowsingSession.timestamp).all()
+
+    def _transition(
+        self,
+        log: "RecommendationLog",
+        times: List[datetime],
+        features: np.ndarray
+    ) -> Optional[Tuple[np.ndarray, int, float, np.ndarray, bool]]:
+        """Build (state, action, reward, next_state, done) for one log, or None."""
+        window = timedelta(minutes=AIConfig.DQN_TRAINER_SESSION_WINDOW_MINUTES)
+
+        state_i = bisect_right(times, log.timestamp) - 1
+        if state_i < 0 or log.timestamp - times[state_i] > window:
+            return None  # No browsing context for this recommendation
+
+        reward = log.reward
+        if reward is None:
+            # Implicitly inferred outcomes don't carry a reward yet
+            try:
+                outcome = Outcome(log.outcome)
+            except ValueError:
+                return None
+            reward = self.rewards.calculate_reward(
+                outcome,
+                mood_before=log.mood_before,
+                mood_after=log.mood_after,
+                user_rating=log.user_rating,
+                suggested_duration_minutes=log.suggested_duration_minutes,
+            )
+
+        next_i = bisect_right(times, log.outcome_recorded_at) - 1
+        done = next_i <= state_i
+        next_state = features[state_i] if done else features[next_i]
+
+        return features[state_i], ACTION_INDEX[log.action_type], float(reward), next_state, done
+
+    # =========================================================================
+    # Training
+    # =========================================================================
+
+    def train_round(
+        self,
+        steps: int = AIConfig.DQN_TRAINER_STEPS_PER_ROUND,
+        batch_size: int = AIConfig.DQN_TRAINER_BATCH_SIZE,
+        min_transitions: int = AIConfig.DQN_TRAINER_MIN_TRANSITIONS,
+        max_users: int = AIConfig.DQN_TRAINER_MAX_USERS_PER_BATCH
+    ) -> Dict[int, float]:
+        """
+        Train every user with new transitions (and enough of them) and
+        publish their weights.
+
+        Users whose buffers haven't grown since they were last trained are
+        skipped, so idle users aren't refit on the same data and their
+        epsilon only decays with new experience.
+
+        Args:
+            steps: Gradient steps per user
+            batch_size: Minibatch size per user per step
+            min_transitions: Users with fewer transitions are skipped
+            max_users: Users per stacked model
+
+        Returns:
+            Final loss per trained user
+        """
+        user_ids = sorted(
+            user_id for user_id in self._fresh
+            if self.buffers[user_id].is_ready(min_transitions)
+        )
+
+        losses: Dict[int, float] = {}
+        for i in range(0, len(user_ids), max_users):
+            chunk = user_ids[i:i + max_users]
+            losses.update(self._train_users(chunk, steps, batch_size))
+            self._fresh.difference_update(chunk)
+        return losses
+
+    def _train_users(self, user_ids: List[int], steps: int, batch_size: int) -> Dict[int, float]:
+        """Train one stacked batch of users, then save and publish each."""
+        import torch
+        import torch.nn.functional as F
+        from .dqn_agent import StackedAdam, StackedDQN
+
+        agents = [self._load_agent(user_id) for user_id in user_ids]
+        reference = agents[0]
+
+        policy = StackedDQN([agent.policy_net for agent in agents])
+        target = StackedDQN([agent.target_net for agent in agents])
+        target.requires_grad_(False)
+        # Continues each user's own Adam state from their checkpoint
+        optimizer = StackedAdam(policy, agents)
+
+        # Each user keeps their own target sync schedule, continuing from the
+        # steps already in their checkpoint (as DQNAgent.train_step would)
+        training_steps = torch.tensor([agent.training_step for agent in agents])
+        update_freqs = torch.tensor([agent.target_update_freq for agent in agents])
+
+        user_losses = torch.zeros(len(agents))
+        for step in range(steps):
+            samples = [self.buffers[user_id].sample(batch_size) for user_id in user_ids]
+            states, actions, rewards, next_states, dones = (
+                torch.from_numpy(np.stack(column)) for column in zip(*samples)
+            )
+
+            current_q = policy(states).gather(2, actions.unsqueeze(2)).squeeze(2)
+            with torch.no_grad():
+                next_q = target(next_states).max(2)[0]
+                target_q = rewards + (1 - dones) * reference.gamma * next_q
+
+            # Sum of per-user mean losses: each user's gradient is what a
+            # standalone DQNAgent.train_step would compute
+            user_losses = F.smooth_l1_loss(current_q, target_q, reduction="none").mean(dim=1)
+            optimizer.zero_grad()
+            user_losses.sum().backward()
+            policy.clip_grad_norm_(1.0)
+            optimizer.step()
+
+            due = (training_steps + step + 1) % update_freqs == 0
+            if due.any():
+                target.copy_users_from(policy, due)
+
+        policy.copy_to([agent.policy_net for agent in agents])
+        target.copy_to([agent.target_net for agent in agents])
+        optimizer.copy_to(agents)
+
+        losses = {}
+        for user_id, agent, loss in zip(user_ids, agents, user_losses.tolist()):
+            agent.training_step += steps
+            agent.epsilon = max(agent.epsilon_min, agent.epsilon * agent.epsilon_decay ** steps)
+            agent.save(self.checkpoint_path(user_id))
+            self.registry.publish(user_id, agent.export_weights())
+            losses[user_id] = loss
+        return losses
+
+    def _load_agent(self, user_id: int) -> "DQNAgent":
+        """Load a user's training checkpoint, or start a fresh agent."""
+        from .dqn_agent import DQNAgent
+
+        agent = DQNAgent(
+            state_dim=self.encoder.get_feature_dim(),
+            batch_size=AIConfig.DQN_TRAINER_BATCH_SIZE,
+        )
+        path = self.checkpoint_path(user_id)
+        if os.path.exists(path):
+            agent.load(path)
+        return agent
@@ -0,0 +1,320 @@
+"""
+DQN Serving Weights
+Inference-only export of DQNNetwork and a registry of per-user weights.
+
+Training checkpoints (DQNAgent.save) are pickled torch files with optimizer
+and target-network state; serving one needs the full PyTorch stack and a
+DQNNetwork build. The serving artifact is just the policy network's six
+weight/bias matrices in one flat float32 .npy file plus a small JSON
+manifest. It is evaluated with NumPy (no torch import) and loaded with
+np.load(mmap_mode="r"), so opening a user's model is a header read and the
+weights are paged in on first use.
+
+Serving and training artifacts are versioned independently: the manifest
+records SERVING_FORMAT_VERSION and the training step it was exported from.
+"""
+
+import json
+import os
+import threading
+from collections import OrderedDict
+from typing import Dict, List, Optional, Tuple
+
+import numpy as np
+
+from .config import AIConfig
+
+
+# Bump when the serving layout (.npy + manifest) changes
+SERVING_FORMAT_VERSION = 1
+
+# Parameter order in the flat array (matches DQNNetwork's Linear layers)
+PARAM_NAMES = ("fc1.weight", "fc1.bias", "fc2.weight", "fc2.bias", "fc3.weight", "fc3.bias")
+
+
+def _param_shapes(state_dim: int, hidden_dim: int, action_dim: int) -> List[Tuple[int, ...]]:
+    """Shapes of PARAM_NAMES (torch Linear stores weight as (out, in))."""
+    return [
+        (hidden_dim, state_dim), (hidden_dim,),
+        (hidden_dim, hidden_dim), (hidden_dim,),
+        (action_dim, hidden_dim), (action_dim,),
+    ]
+
+
+class DQNWeights:
+    """
+    NumPy evaluation of a 3-layer ReLU MLP exported from DQNNetwork.
+
+    Duck-types the DQNAgent methods used for serving (get_q_values,
+    get_q_values_batch, select_action, select_actions_batch, action_dim,
+    epsilon), so it can stand in for an agent in DQNInferenceServer.
+    """
+
+    def __init__(
+        self,
+        params: List[np.ndarray],
+        epsilon: float = 0.0,
+        training_step: int = 0,
+        flat: Optional[np.ndarray] = None
+    ):
+        """
+        Args:
+            params: Arrays in PARAM_NAMES order (views into `flat` if given)
+            epsilon: Exploration rate at export time
+            training_step: Training step the weights were exported from
+            flat: Backing flat array (kept so memory maps stay open)
+        """
+        self.w1, self.b1, self.w2, self.b2, self.w3, self.b3 = params
+        self.hidden_dim, self.state_dim = self.w1.shape
+        self.action_dim = self.w3.shape[0]
+        self.epsilon = epsilon
+        self.training_step = training_step
+        self._flat = flat
+
+    @classmethod
+    def from_state_dict(
+        cls,
+        state_dict: Dict,
+        epsilon: float = 0.0,
+        training_step: int = 0
+    ) -> "DQNWeights":
+        """
+        Build from a DQNNetwork state_dict (torch tensors or arrays).
+
+        Args:
+            state_dict: policy_net.state_dict()
+            epsilon: Exploration rate to serve with
+            training_step: Training step of the source model
+        """
+        params = []
+        for name in PARAM_NAMES:
+            value = state_dict[name]
+            if hasattr(value, "detach"):
+                value = value.detach().cpu().numpy()
+            params.append(np.ascontiguousarray(value, dtype=np.float32))
+        return cls(params, epsilon=epsilon, training_step=training_step)
+
+    # =========================================================================
+    # Inference
+    # =========================================================================
+
+    def get_q_values_batch(self, states: np.ndarray) -> np.ndarray:
+        """
+        Q-values for a batch of states.
+
+        Args:
+            states: State features (batch_size, state_dim)
+
+        Returns:
+            Q-values (batch_size, action_dim)
+        """
+        x = np.asarray(states, dtype=np.float32)
+        x = np.maximum(x @ self.w1.T + self.b1, 0.0)
+        x = np.maximum(x @ self.w2.T + self.b2, 0.0)
+        return x @ self.w3.T + self.b3
+
+    def get_q_values(self, state: np.ndarray) -> np.ndarray:
+        """Q-values for one state."""
+        return self.get_q_values_batch(np.asarray(state, dtype=np.float32)[None, :])[0]
+
+    def select_actions_batch(
+        self,
+        states: np.ndarray,
+        action_masks: Optional[np.ndarray] = None,
+        epsilons: Optional[np.ndarray] = None
+    ) -> Tuple[np.ndarray, np.ndarray]:
+        """
+        Vectorized epsilon-greedy selection (same contract as DQNAgent).
+
+        Returns:
+            Tuple of (actions (batch_size,), q_values (batch_size, action_dim))
+        """
+        q_values = self.get_q_values_batch(states)
+        batch_size = q_values.shape[0]
+
+        if action_masks is None:
+            action_masks = np.ones_like(q_values, dtype=bool)
+        else:
+            action_masks = np.asarray(action_masks, dtype=bool).copy()
+            action_masks[~action_masks.any(axis=1)] = True
+
+        masked_q = np.where(action_masks, q_values, -np.inf)
+        actions = masked_q.argmax(axis=1)
+
+        if epsilons is None:
+            epsilons = np.full(batch_size, self.epsilon)
+        explore = np.random.random(batch_size) < epsilons
+        if explore.any():
+            noise = np.where(action_masks[explore], np.random.random(action_masks[explore].shape), -1.0)
+            actions[explore] = noise.argmax(axis=1)
+
+        return actions, q_values
+
+    def select_action(
+        self,
+        state: np.ndarray,
+        available_actions: Optional[List[int]] = None,
+        epsilon: Optional[float] = None
+    ) -> int:
+        """Epsilon-greedy action for one state."""
+        mask = None
+        if available_actions:
+            mask = np.zeros((1, self.action_dim), dtype=bool)
+            mask[0, available_actions] = True
+        eps = np.array([self.epsilon if epsilon is None else epsilon])
+        actions, _ = self.select_actions_batch(np.asarray(state, dtype=np.float32)[None, :], mask, eps)
+        return int(actions[0])
+
+    # =========================================================================
+    # Persistence
+    # =========================================================================
+
+    def save(self, path_prefix: str) -> None:
+        """
+        Write `<prefix>.npy` (flat float32 weights) and `<prefix>.json`.
+
+        Both are written to temp files and renamed, manifest last, so a
+        reader never sees a manifest pointing at a partial weight file.
+        """
+        os.makedirs(os.path.dirname(path_prefix) or ".", exist_ok=True)
+        params = [self.w1, self.b1, self.w2, self.b2, self.w3, self.b3]
+        flat = np.concatenate([np.asarray(p, dtype=np.float32).ravel() for p in params])
+
+        weights_tmp = f"{path_prefix}.npy.tmp"
+        with open(weights_tmp, "wb") as f:
+            np.save(f, flat)
+        os.replace(weights_tmp, f"{path_prefix}.npy")
+
+        manifest = {
+            "format_version": SERVING_FORMAT_VERSION,
+            "state_dim": self.state_dim,
+            "hidden_dim": self.hidden_dim,
+            "action_dim": self.action_dim,
+            "param_count": int(flat.size),
+            "epsilon": float(self.epsilon),
+            "training_step": int(self.training_step),
+        }
+        manifest_tmp = f"{path_prefix}.json.tmp"
+        with open(manifest_tmp, "w") as f:
+            json.dump(manifest, f)
+        os.replace(manifest_tmp, f"{path_prefix}.json")
+
+    @classmethod
+    def load(cls, path_prefix: str, mmap: bool = True) -> "DQNWeights":
+        """
+        Load weights written by save().
+
+        Args:
+            path_prefix: Path without the .npy/.json suffix
+            mmap: Memory-map the weights instead of reading them
+
+        Raises:
+            ValueError: On an unknown format version or size mismatch
+        """
+        with open(f"{path_prefix}.json") as f:
+            manifest = json.load(f)
+        if manifest.get("format_version") != SERVING_FORMAT_VERSION:
+            raise ValueError(f"Unsupported serving format: {manifest.get('format_version')}")
+
+        flat = np.load(f"{path_prefix}.npy", mmap_mode="r" if mmap else None)
+        shapes = _param_shapes(manifest["state_dim"], manifest["hidden_dim"], manifest["action_dim"])
+        expected = sum(int(np.prod(shape)) for shape in shapes)
+        if flat.dtype != np.float32 or flat.shape != (expected,):
+            raise ValueError(f"Weight file has shape {flat.shape}, expected ({expected},)")
+
+        params, offset = [], 0
+        for shape in shapes:
+            size = int(np.prod(shape))
+            params.append(flat[offset:offset + size].reshape(shape))
+            offset += size
+
+        return cls(
+            params,
+            epsilon=manifest.get("epsilon", 0.0),
+            training_step=manifest.get("training_step", 0),
+            flat=flat,
+        )
+
+
+class DQNWeightRegistry:
+    """
+    Per-user serving weights, opened on demand and kept in an LRU.
+
+    A re-export is picked up on the next get() (the manifest's mtime is
+    checked), so trainers can publish while API workers keep serving.
+
+    Usage:
+        registry = DQNWeightRegistry()
+        server = DQNInferenceServer(registry.require)
+    """
+
+    def __init__(
+        self,
+        directory: str = AIConfig.DQN_SERVING_DIRECTORY,
+        max_models: int = AIConfig.DQN_REGISTRY_MAX_MODELS
+    ):
+        self.directory = directory
+        self.max_models = max_models
+        self._models: "OrderedDict[int, Tuple[int, DQNWeights]]" = OrderedDict()  # user_id -> (mtime_ns, weights)
+        self._lock = threading.Lock()
+        self.loads = 0
+        self.hits = 0
+
+    def path_prefix(self, user_id: int) -> str:
+        """Artifact path (without suffix) for a user."""
+        return os.path.join(self.directory, f"user_{user_id}.dqn")
+
+    def publish(self, user_id: int, weights: DQNWeights) -> None:
+        """Write a user's serving weights (visible to readers on their next get)."""
+        weights.save(self.path_prefix(user_id))
+        with self._lock:
+            self._models.pop(user_id, None)
+
+    def get(self, user_id: int) -> Optional[DQNWeights]:
+        """
+        Get a user's serving weights.
+
+        Returns:
+            DQNWeights, or None if the user has no exported model
+        """
+        manifest_path = f"{self.path_prefix(user_id)}.json"
+        try:
+            mtime_ns = os.stat(manifest_path).st_mtime_ns
+        except FileNotFoundError:
+            with self._lock:
+                self._models.pop(user_id, None)
+            return None
+
+        with self._lock:
+            entry = self._models.get(user_id)
+            if entry is not None and entry[0] == mtime_ns:
+                self._models.move_to_end(user_id)
+                self.hits += 1
+                return entry[1]
+
+        weights = DQNWeights.load(self.path_prefix(user_id))
+
+        with self._lock:
+            self.loads += 1
+            self._models[user_id] = (mtime_ns, weights)
+            self._models.move_to_end(user_id)
+            while len(self._models) > self.max_models:
+                self._models.popitem(last=False)
+        return weights
+
+    def require(self, user_id: int) -> DQNWeights:
+        """get() that raises KeyError for users without a model (for resolvers)."""
+        weights = self.get(user_id)
+        if weights is None:
+            raise KeyError(f"No DQN serving weights for user {user_id}")
+        return weights
+
+    def get_stats(self) -> Dict:
+        """Get open model count and load/hit counts."""
+        with self._lock:
+            return {
+                "open_models": len(self._models),
+                "max_models": self.max_models,
+                "loads": self.loads,
+                "hits": self.hits,
+            }
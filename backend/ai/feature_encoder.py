@@ -6,7 +6,7 @@ Replaces discrete state encoding with continuous features for better generalizat
 
 import numpy as np
 from datetime import datetime
-from typing import Dict, List, Tuple
+from typing import Dict, List, Optional, Sequence, Tuple
 import math
 
 
@@ -28,6 +28,20 @@ class FeatureEncoder:
     - workload_pressure: Estimated pressure (0-1)
     """
 
+    # BrowsingSession columns encode_session_rows expects, in order
+    SESSION_COLUMNS = (
+        'timestamp',
+        'work_time',
+        'leisure_time',
+        'social_time',
+        'neutral_time',
+        'avg_focus_duration_minutes',
+        'distraction_rate_per_hour',
+        'tab_switches',
+        'unique_domains',
+        'duration_minutes',
+    )
+
     def __init__(self):
         # Normalization constants
         self.MAX_FOCUS_MINUTES = 30.0
@@ -117,13 +131,172 @@ class FeatureEncoder:
         """
         Encode multiple sessions into a batch of feature vectors.
 
+        Pulls the dicts apart into columns once and runs the vectorized
+        encode_columns path instead of encoding row by row.
+
         Args:
             sessions: List of session dictionaries
 
         Returns:
             numpy array of shape (batch_size, 12)
         """
-        return np.array([self.encode_session(session) for session in sessions])
+        timestamps = []
+        for session in sessions:
+            timestamp = session.get('timestamp', datetime.now())
+            if isinstance(timestamp, str):
+                timestamp = datetime.fromisoformat(timestamp.replace('Z', '+00:00'))
+            timestamps.append(timestamp)
+        hour, day_of_week = self.timestamp_columns(timestamps)
+
+        categories = [session.get('category_distribution', {}) for session in sessions]
+        metrics = [session.get('metrics', {}) for session in sessions]
+
+        def column(rows, key, default=0.0):
+            return np.fromiter((row.get(key, default) for row in rows), dtype=np.float64, count=len(rows))
+
+        return self.encode_columns(
+            hour=hour,
+            day_of_week=day_of_week,
+            work_time=column(categories, 'work'),
+            leisure_time=column(categories, 'leisure'),
+            social_time=column(categories, 'social'),
+            neutral_time=column(categories, 'neutral'),
+            avg_focus_duration=column(metrics, 'avg_focus_duration_minutes'),
+            distraction_rate=column(metrics, 'distraction_rate_per_hour'),
+            tab_switches=column(metrics, 'tab_switches'),
+            unique_domains=column(metrics, 'unique_domains'),
+            duration_minutes=column(sessions, 'duration_minutes', 60),
+        )
+
+    # =========================================================================
+    # Columnar encoding
+    # =========================================================================
+
+    def encode_columns(
+        self,
+        hour: np.ndarray,
+        day_of_week: np.ndarray,
+        work_time: np.ndarray,
+        leisure_time: np.ndarray,
+        social_time: np.ndarray,
+        neutral_time: np.ndarray,
+        avg_focus_duration: np.ndarray,
+        distraction_rate: np.ndarray,
+        tab_switches: np.ndarray,
+        unique_domains: np.ndarray,
+        duration_minutes: np.ndarray,
+        out: Optional[np.ndarray] = None
+    ) -> np.ndarray:
+        """
+        Encode N sessions given as columns (same output as encode_session).
+
+        Arithmetic runs in float64 like the scalar path and is rounded to
+        float32 once when written into the output matrix. Missing values
+        (NaN, e.g. NULL columns) count as 0, or as 60 for duration.
+
+        Args:
+            hour: Hour of day (0-23)
+            day_of_week: Weekday (Monday = 0)
+            work_time, leisure_time, social_time, neutral_time: Minutes per category
+            avg_focus_duration: Average focus duration in minutes
+            distraction_rate: Tab switches per hour
+            tab_switches: Raw tab switch count
+            unique_domains: Distinct domains visited
+            duration_minutes: Session length in minutes
+            out: Optional preallocated (N, 12) float32 matrix to fill
+
+        Returns:
+            numpy array of shape (N, 12)
+        """
+        def col(values, missing=0.0):
+            values = np.asarray(values, dtype=np.float64)
+            return np.where(np.isnan(values), missing, values)
+
+        hour = col(hour)
+        day_of_week = col(day_of_week)
+        work_time = col(work_time)
+        n = hour.shape[0]
+
+        if out is None:
+            out = np.empty((n, 12), dtype=np.float32)
+
+        # Time features (cyclical encoding)
+        angle = 2 * math.pi * (hour / 24.0)
+        out[:, 0] = np.sin(angle)
+        out[:, 1] = np.cos(angle)
+        out[:, 2] = day_of_week / 7.0
+
+        # Work-life balance ratio
+        total_time = work_time + col(leisure_time) + col(social_time) + col(neutral_time)
+        work_ratio = np.divide(work_time, total_time, out=np.zeros(n), where=total_time > 0)
+        out[:, 3] = work_ratio
+
+        # Normalized behavioral metrics
+        tab_switches_norm = np.minimum(col(tab_switches) / self.MAX_TAB_SWITCHES, 1.0)
+        out[:, 4] = np.minimum(col(avg_focus_duration) / self.MAX_FOCUS_MINUTES, 1.0)
+        out[:, 5] = np.minimum(col(distraction_rate) / self.MAX_DISTRACTION_RATE, 1.0)
+        out[:, 6] = np.log(col(duration_minutes, missing=60.0) + 1) / math.log(self.MAX_SESSION_MINUTES)
+        out[:, 7] = tab_switches_norm
+        out[:, 8] = np.minimum(col(unique_domains) / self.MAX_UNIQUE_DOMAINS, 1.0)
+
+        # Context features
+        out[:, 9] = (day_of_week >= 0) & (day_of_week <= 4)
+        out[:, 10] = (hour >= 9) & (hour <= 17)
+        out[:, 11] = np.minimum((work_ratio * 0.6) + (tab_switches_norm * 0.4), 1.0)
+
+        return out
+
+    def timestamp_columns(self, timestamps) -> Tuple[np.ndarray, np.ndarray]:
+        """
+        Split timestamps into (hour, day_of_week) columns.
+
+        Args:
+            timestamps: datetime64 array (vectorized), or a sequence of
+                datetimes (their own timezone's wall clock, as encode_session uses)
+
+        Returns:
+            Tuple of int arrays (hour, day_of_week with Monday = 0)
+        """
+        if isinstance(timestamps, np.ndarray) and np.issubdtype(timestamps.dtype, np.datetime64):
+            days = timestamps.astype('datetime64[D]')
+            hour = (timestamps.astype('datetime64[h]') - days).astype(np.int64)
+            # 1970-01-01 was a Thursday (weekday 3)
+            day_of_week = (days.astype(np.int64) + 3) % 7
+            return hour, day_of_week
+
+        n = len(timestamps)
+        hour = np.fromiter((t.hour for t in timestamps), dtype=np.int64, count=n)
+        day_of_week = np.fromiter((t.weekday() for t in timestamps), dtype=np.int64, count=n)
+        return hour, day_of_week
+
+    def encode_session_rows(self, rows: Sequence[Tuple]) -> np.ndarray:
+        """
+        Encode rows of a column query over SESSION_COLUMNS.
+
+        Usage:
+            rows = db.query(*FeatureEncoder.session_columns()).filter(...).all()
+            features = feature_encoder.encode_session_rows(rows)
+
+        Args:
+            rows: (timestamp, work_time, ..., duration_minutes) tuples
+
+        Returns:
+            numpy array of shape (len(rows), 12)
+        """
+        if not rows:
+            return np.zeros((0, 12), dtype=np.float32)
+
+        columns = list(zip(*rows))
+        hour, day_of_week = self.timestamp_columns(columns[0])
+        numeric = [np.array(values, dtype=np.float64) for values in columns[1:]]  # NULL -> NaN
+        return self.encode_columns(hour, day_of_week, *numeric)
+
+    @classmethod
+    def session_columns(cls) -> List:
+        """BrowsingSession column attributes for a column query (SESSION_COLUMNS order)."""
+        from models.extension_metadata import BrowsingSession
+
+        return [getattr(BrowsingSession, name) for name in cls.SESSION_COLUMNS]
 
     def get_feature_names(self) -> List[str]:
         """
@@ -0,0 +1,163 @@
+"""
+Free Interval Index
+Sorted gap list for finding and allocating free time in a schedule.
+
+Used by the rule-based fallback scheduler and /schedule/available-slots.
+Gaps are kept twice: ordered by start (containment and first-fit queries)
+and ordered by (length, start) (best-fit queries).
+
+Costs, for n gaps: is_free() and best_fit() without not_before are binary
+searches, O(log n). first_fit() bisects to the gap holding its start time
+and then scans forward past gaps too short to hold the task; best_fit()
+with not_before bisects to the first long-enough gap and scans up in
+length past gaps that end too early. Both are O(log n + k) for k skipped
+gaps, O(n) at worst. allocate() bisects, then inserts into Python lists
+(a memmove, O(n) but cheap at schedule sizes).
+"""
+
+from bisect import bisect_left, bisect_right, insort
+from typing import Iterable, List, Optional, Tuple
+
+# Tolerance for float hour arithmetic (0.25 + 0.5 etc.)
+EPSILON = 1e-9
+
+
+class FreeIntervalIndex:
+    """
+    Free time within [start, end], as disjoint gaps.
+
+    Args:
+        start: Range start (hours; may exceed 24 for multi-day ranges)
+        end: Range end
+        busy: (start, end) intervals already taken; may overlap or extend
+            past the range
+    """
+
+    def __init__(self, start: float, end: float, busy: Iterable[Tuple[float, float]] = ()):
+        self.start = start
+        self.end = end
+        self._starts: List[float] = []               # Gap starts, ascending
+        self._ends: List[float] = []                 # Gap ends, parallel to _starts
+        self._by_length: List[Tuple[float, float]] = []  # (length, start), ascending
+
+        # Sweep the sorted busy intervals once to build the initial gaps
+        cursor = start
+        for busy_start, busy_end in sorted(busy):
+            if busy_start >= end:
+                break
+            if busy_start > cursor:
+                self._starts.append(cursor)
+                self._ends.append(busy_start)
+            cursor = max(cursor, busy_end)
+        if cursor < end:
+            self._starts.append(cursor)
+            self._ends.append(end)
+
+        self._by_length = sorted(
+            (gap_end - gap_start, gap_start)
+            for gap_start, gap_end in zip(self._starts, self._ends)
+        )
+
+    def __len__(self) -> int:
+        return len(self._starts)
+
+    @property
+    def total_free(self) -> float:
+        """Total free hours."""
+        return sum(e - s for s, e in zip(self._starts, self._ends))
+
+    def gaps(self, min_duration: float = 0.0) -> List[Tuple[float, float]]:
+        """Free (start, end) gaps of at least `min_duration`, in time order."""
+        return [
+            (s, e) for s, e in zip(self._starts, self._ends)
+            if e - s >= min_duration - EPSILON
+        ]
+
+    def _gap_index(self, t: float) -> int:
+        """Index of the gap containing time t, or -1."""
+        i = bisect_right(self._starts, t + EPSILON) - 1
+        if i >= 0 and self._ends[i] >= t - EPSILON:
+            return i
+        return -1
+
+    def is_free(self, start: float, duration: float) -> bool:
+        """Whether [start, start + duration] lies entirely in one gap."""
+        i = self._gap_index(start)
+        return i >= 0 and self._ends[i] >= start + duration - EPSILON
+
+    def first_fit(self, duration: float, not_before: Optional[float] = None) -> Optional[float]:
+        """
+        Earliest start time with `duration` free.
+
+        Bisects to the gap holding not_before, then scans forward; O(log n + k)
+        for k gaps skipped because they are too short.
+
+        Args:
+            duration: Hours needed
+            not_before: Earliest acceptable start (defaults to the range start)
+
+        Returns:
+            Start time, or None if nothing fits
+        """
+        t = self.start if not_before is None else not_before
+        i = max(bisect_right(self._starts, t) - 1, 0)
+        for j in range(i, len(self._starts)):
+            candidate = max(self._starts[j], t)
+            if self._ends[j] - candidate >= duration - EPSILON:
+                return candidate
+        return None
+
+    def best_fit(self, duration: float, not_before: Optional[float] = None) -> Optional[float]:
+        """
+        Start of the smallest gap that fits `duration` (earliest on ties).
+
+        Packing into the tightest gap keeps long gaps free for long tasks.
+        O(log n) without not_before; with it, gaps that fit by length but end
+        too soon after not_before are scanned past (O(log n + k)).
+
+        Args:
+            duration: Hours needed
+            not_before: Earliest acceptable start (defaults to the range start)
+
+        Returns:
+            Start time, or None if nothing fits
+        """
+        i = bisect_left(self._by_length, (duration - EPSILON, float("-inf")))
+        if not_before is None:
+            return self._by_length[i][1] if i < len(self._by_length) else None
+
+        # Smallest gap whose part after not_before still fits
+        for j in range(i, len(self._by_length)):
+            length, gap_start = self._by_length[j]
+            candidate = max(gap_start, not_before)
+            if gap_start + length - candidate >= duration - EPSILON:
+                return candidate
+        return None
+
+    def allocate(self, start: float, duration: float) -> None:
+        """
+        Mark [start, start + duration] as taken.
+
+        Raises:
+            ValueError: If the interval isn't entirely free
+        """
+        i = self._gap_index(start)
+        if i < 0 or self._ends[i] < start + duration - EPSILON:
+            raise ValueError(f"[{start}, {start + duration}] is not free")
+
+        gap_start, gap_end = self._starts[i], self._ends[i]
+        del self._starts[i]
+        del self._ends[i]
+        del self._by_length[bisect_left(self._by_length, (gap_end - gap_start, gap_start))]
+
+        end = start + duration
+        if start - gap_start > EPSILON:
+            self._insert_gap(gap_start, start)
+        if gap_end - end > EPSILON:
+            self._insert_gap(end, gap_end)
+
+    def _insert_gap(self, start: float, end: float) -> None:
+        i = bisect_left(self._starts, start)
+        self._starts.insert(i, start)
+        self._ends.insert(i, end)
+        insort(self._by_length, (end - start, start))
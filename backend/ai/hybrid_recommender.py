@@ -17,6 +17,8 @@ from .rule_engine import RuleEngine
 from .action_masker import ActionMasker
 from .task_selector import TaskSelector
 from .reward_calculator import RewardCalculator, Outcome
+from .user_context import UserContextSnapshot, UserContextCache, user_context_cache
+from core.metrics import span
 
 
 @dataclass
@@ -32,6 +34,7 @@ class RecommendationResult:
     task_id: Optional[int] = None
     task_title: Optional[str] = None
     phase: str = "bootstrap"
+    context: Optional[UserContextSnapshot] = None  # Snapshot the pipeline used
 
 
 class HybridRecommender:
@@ -44,6 +47,7 @@ class HybridRecommender:
     - RuleEngine for fallback/cold-start
     - ActionMasker for filtering invalid actions
     - TaskSelector for concrete task mapping
+    - UserContextCache so all stages share one data snapshot
     
     Phase-based strategy:
     - Bootstrap (<20 recs): Pure rules
@@ -51,7 +55,8 @@ class HybridRecommender:
     - Learned (>60 recs): RL primary with rules fallback
     """
     
-    def __init__(self):
+    def __init__(self, context_cache: Optional[UserContextCache] = None):
+        self.context_cache = context_cache or user_context_cache
         self.context_encoder = ContextEncoder()
         self.rule_engine = RuleEngine()
         self.action_masker = ActionMasker()
@@ -82,27 +87,36 @@ class HybridRecommender:
 
         user_id = AIConfig.get_user_id(user_id)
         
+        # Step 0: Load the user's data once for all stages
+        with span("recommender.load_context"):
+            context = self.context_cache.get(db, user_id, current_time)
+        
         # Step 1: Encode context to state
-        state = self.context_encoder.encode(db, current_time, user_id)
+        with span("recommender.encode_state"):
+            state = self.context_encoder.encode(db, current_time, user_id, context)
         state_key = StateSerializer.to_key(state)
         
         # Step 2: Get valid actions (action masking)
-        valid_actions = self.action_masker.get_valid_actions(state, db, user_id)
+        with span("recommender.mask_actions"):
+            valid_actions = self.action_masker.get_valid_actions(state, db, user_id, context)
         
         # Step 3: Determine phase and get agent
-        agent = ScheduleAgent.get_instance(user_id)
+        with span("recommender.get_agent"):
+            agent = ScheduleAgent.get_instance(user_id)
         phase = agent._get_phase()
         
         # Step 4: Choose strategy based on phase
-        action, confidence, strategy, explanation = self._select_action(
-            agent, state, valid_actions, phase
-        )
+        with span("recommender.select_action"):
+            action, confidence, strategy, explanation = self._select_action(
+                agent, state, valid_actions, phase
+            )
         
         # Step 5: Select concrete task if applicable
         task_id = None
         task_title = None
         if action in (ActionType.DEEP_FOCUS, ActionType.LIGHT_TASK):
-            task = self.task_selector.select_task(action, state, db, user_id)
+            with span("recommender.select_task"):
+                task = self.task_selector.select_task(action, state, db, user_id, context)
             if task:
                 task_id = task.id
                 task_title = task.title
@@ -121,6 +135,7 @@ class HybridRecommender:
             task_id=task_id,
             task_title=task_title,
             phase=phase,
+            context=context,
         )
     
     def _select_action(
@@ -236,7 +251,8 @@ class HybridRecommender:
         try:
             state = StateSerializer.from_key(state_key)
             agent = ScheduleAgent.get_instance(user_id)
-            agent.update(state, action, reward)
+            with span("recommender.update_agent"):
+                agent.update(state, action, reward)
         except ValueError:
             # Invalid state key - can't update
             pass
@@ -4,14 +4,16 @@ Infers recommendation outcomes from user behavior patterns.
 """
 
 from datetime import datetime, timedelta, timezone
-from typing import Optional, TYPE_CHECKING
-from sqlalchemy.orm import Session
+from typing import Dict, Iterator, List, Optional, Tuple, TYPE_CHECKING
+from sqlalchemy import and_, func, or_
+from sqlalchemy.orm import Session, aliased
 
 from .config import AIConfig
 from .reward_calculator import Outcome
 
 if TYPE_CHECKING:
     from models.recommendation_log import RecommendationLog
+    from models.task import Task
 
 
 class ImplicitFeedbackInferencer:
@@ -29,7 +31,8 @@ class ImplicitFeedbackInferencer:
         self,
         log: "RecommendationLog",
         db: Session,
-        current_time: Optional[datetime] = None
+        current_time: Optional[datetime] = None,
+        tasks: Optional[Dict[int, "Task"]] = None
     ) -> Outcome:
         """
         Infer outcome from a recommendation log entry.
@@ -38,6 +41,7 @@ class ImplicitFeedbackInferencer:
             log: The recommendation log entry
             db: Database session
             current_time: Current time (defaults to now)
+            tasks: Prefetched tasks by id (skips the per-log task query)
 
         Returns:
             Inferred Outcome enum value
@@ -54,7 +58,7 @@ class ImplicitFeedbackInferencer:
 
         # Check for task completion
         if log.suggested_task_id:
-            outcome = self._check_task_completion(log, db)
+            outcome = self._check_task_completion(log, db, tasks)
             if outcome:
                 return outcome
 
@@ -75,7 +79,8 @@ class ImplicitFeedbackInferencer:
     def _check_task_completion(
         self,
         log: "RecommendationLog",
-        db: Session
+        db: Session,
+        tasks: Optional[Dict[int, "Task"]] = None
     ) -> Optional[Outcome]:
         """
         Check if the suggested task was completed.
@@ -91,7 +96,10 @@ class ImplicitFeedbackInferencer:
         if not log.suggested_task_id:
             return None
 
-        task = db.query(Task).filter(Task.id == log.suggested_task_id).first()
+        if tasks is not None:
+            task = tasks.get(log.suggested_task_id)
+        else:
+            task = db.query(Task).filter(Task.id == log.suggested_task_id).first()
         if not task:
             return None
 
@@ -154,8 +162,11 @@ class ImplicitFeedbackInferencer:
             if log.activity_gap_seconds >= ignore_threshold_seconds:
                 return Outcome.IGNORED
 
-        # Fall back to time since recommendation
-        time_since_rec = current_time - log.timestamp
+        # Fall back to time since recommendation (SQLite returns naive UTC)
+        log_time = log.timestamp
+        if log_time.tzinfo is None and current_time.tzinfo is not None:
+            log_time = log_time.replace(tzinfo=timezone.utc)
+        time_since_rec = current_time - log_time
         ignore_threshold = timedelta(hours=AIConfig.IGNORE_DETECTION_HOURS)
 
         # Only mark as ignored if enough time has passed AND no completion
@@ -183,29 +194,170 @@ class ImplicitFeedbackInferencer:
         Returns:
             Number of logs processed
         """
-        from models.recommendation_log import RecommendationLog
+        return self.stream_infer_outcomes(
+            db,
+            min_age_hours=min_age_hours,
+            page_size=min(limit, AIConfig.FEEDBACK_INFER_PAGE_SIZE),
+            max_logs=limit,
+            user_id=user_id,
+        )
 
-        current_time = datetime.now(timezone.utc)
-        cutoff_time = current_time - timedelta(hours=min_age_hours)
+    def stream_infer_outcomes(
+        self,
+        db: Session,
+        min_age_hours: int = 2,
+        page_size: int = AIConfig.FEEDBACK_INFER_PAGE_SIZE,
+        max_logs: Optional[int] = None,
+        user_id: Optional[int] = None,
+        partition: Optional[Tuple[int, int]] = None
+    ) -> int:
+        """
+        Infer outcomes for every pending log, one keyset page at a time.
 
-        # Find logs without outcomes that are old enough
-        query = db.query(RecommendationLog).filter(
-            RecommendationLog.outcome == None,
-            RecommendationLog.timestamp <= cutoff_time
-        )
+        Each page costs three queries (logs, their suggested tasks, their
+        successor timestamps) and one commit, however many rows it holds,
+        so a large backlog is drained in bounded memory.
 
-        # Filter by user if provided
-        if user_id is not None:
-            query = query.filter(RecommendationLog.user_id == user_id)
+        Args:
+            db: Database session
+            min_age_hours: Only process logs older than this
+            page_size: Logs per page (and per commit)
+            max_logs: Stop after this many logs (None = drain the backlog)
+            user_id: If provided, only process this user's logs
+            partition: (index, count) to process only users with
+                user_id % count == index, so workers never share a user
 
-        logs = query.limit(limit).all()
+        Returns:
+            Number of logs processed
+        """
+        current_time = datetime.now(timezone.utc)
+        cutoff_time = current_time - timedelta(hours=min_age_hours)
 
         processed = 0
-        for log in logs:
-            outcome = self.infer_outcome(log, db, current_time)
-            log.outcome = outcome.value
-            log.outcome_recorded_at = current_time
-            processed += 1
+        for page in self._iter_pending_pages(db, cutoff_time, page_size, user_id, partition):
+            if max_logs is not None:
+                page = page[:max_logs - processed]
+
+            tasks = self._prefetch_tasks(db, page)
+            successors = self._prefetch_successor_times(db, page)
+
+            for log in page:
+                # Backfill skip-detection input the router normally records
+                # when the user's next recommendation arrives
+                successor_at = successors.get(log.id)
+                if log.next_recommendation_at is None and successor_at is not None:
+                    log.next_recommendation_at = successor_at
+                    log.activity_gap_seconds = int((successor_at - log.timestamp).total_seconds())
+
+                outcome = self.infer_outcome(log, db, current_time, tasks)
+                log.outcome = outcome.value
+                log.outcome_recorded_at = current_time
+
+            db.commit()
+            processed += len(page)
+            if max_logs is not None and processed >= max_logs:
+                break
 
-        db.commit()
         return processed
+
+    def _iter_pending_pages(
+        self,
+        db: Session,
+        cutoff_time: datetime,
+        page_size: int,
+        user_id: Optional[int] = None,
+        partition: Optional[Tuple[int, int]] = None
+    ) -> Iterator[List["RecommendationLog"]]:
+        """
+        Yield pages of outcome-less logs ordered by (timestamp, id).
+
+        Keyset pagination: each page starts strictly after the last row of
+        the previous one, so the scan never re-reads or skips rows even as
+        earlier pages get their outcomes filled in.
+        """
+        from models.recommendation_log import RecommendationLog
+
+        last_key: Optional[Tuple[datetime, int]] = None
+        while True:
+            # Find logs without outcomes that are old enough
+            query = db.query(RecommendationLog).filter(
+                RecommendationLog.outcome == None,
+                RecommendationLog.timestamp <= cutoff_time
+            )
+
+            # Filter by user (or user partition) if provided
+            if user_id is not None:
+                query = query.filter(RecommendationLog.user_id == user_id)
+            if partition is not None:
+                index, count = partition
+                query = query.filter(func.coalesce(RecommendationLog.user_id, 0) % count == index)
+
+            if last_key is not None:
+                last_timestamp, last_id = last_key
+                query = query.filter(or_(
+                    RecommendationLog.timestamp > last_timestamp,
+                    and_(
+                        RecommendationLog.timestamp == last_timestamp,
+                        RecommendationLog.id > last_id,
+                    ),
+                ))
+
+            page = query.order_by(
+                RecommendationLog.timestamp, RecommendationLog.id
+            ).limit(page_size).all()
+
+            if not page:
+                return
+
+            last_key = (page[-1].timestamp, page[-1].id)
+            yield page
+
+            if len(page) < page_size:
+                return
+
+    def _prefetch_tasks(
+        self,
+        db: Session,
+        logs: List["RecommendationLog"]
+    ) -> Dict[int, "Task"]:
+        """Load every suggested task of a page in one query."""
+        from models.task import Task
+
+        task_ids = {log.suggested_task_id for log in logs if log.suggested_task_id}
+        if not task_ids:
+            return {}
+        return {
+            task.id: task
+            for task in db.query(Task).filter(Task.id.in_(task_ids)).all()
+        }
+
+    def _prefetch_successor_times(
+        self,
+        db: Session,
+        logs: List["RecommendationLog"]
+    ) -> Dict[int, datetime]:
+        """
+        Find when each log's user got their next recommendation (one query).
+
+        Only logs whose next_recommendation_at is missing are looked up.
+        """
+        from models.recommendation_log import RecommendationLog
+
+        log_ids = [log.id for log in logs if log.next_recommendation_at is None]
+        if not log_ids:
+            return {}
+
+        # Correlated MIN per outer row: one seek on
+        # ix_recommendation_logs_user_timestamp each, instead of joining
+        # every log to all of its user's later logs
+        successor = aliased(RecommendationLog)
+        next_at = db.query(func.min(successor.timestamp)).filter(
+            successor.user_id == RecommendationLog.user_id,
+            successor.timestamp > RecommendationLog.timestamp,
+        ).correlate(RecommendationLog).scalar_subquery()
+
+        rows = db.query(RecommendationLog.id, next_at).filter(
+            RecommendationLog.id.in_(log_ids)
+        ).all()
+
+        return {log_id: next_at for log_id, next_at in rows if next_at is not None}
@@ -0,0 +1,103 @@
+"""
+Incremental JSON Array Parser
+Pulls complete objects out of a JSON array while the document is still
+arriving, so streamed LLM output can be acted on item by item.
+
+The LLM responds with one object such as {"schedule": [{...}, {...}], ...}.
+Feeding the text chunks to JSONArrayStreamParser("schedule") returns each
+array element as soon as its closing brace arrives.
+"""
+
+import json
+import re
+from typing import Any, Dict, List
+
+
+class JSONArrayStreamParser:
+    """
+    Extract the elements of one top-level array from a streamed JSON object.
+
+    Only string/escape state and bracket depth are tracked; each element is
+    handed to json.loads once it is complete, so malformed elements are
+    skipped without derailing the rest of the stream.
+    """
+
+    def __init__(self, key: str):
+        self._key_pattern = re.compile(r'"%s"\s*:\s*\[' % re.escape(key))
+        self._buffer = ""
+        self._pos = 0              # Next character to scan
+        self._in_array = False
+        self._depth = 0            # Nesting depth inside the array
+        self._item_start = None    # Buffer index of the current element's "{"
+        self._in_string = False
+        self._escape = False
+        self.done = False          # Closing "]" of the array has been seen
+
+    def feed(self, chunk: str) -> List[Dict[str, Any]]:
+        """
+        Add streamed text and return any elements completed by it.
+
+        Args:
+            chunk: Next piece of the response text
+
+        Returns:
+            Newly completed array elements (dicts), in order
+        """
+        self._buffer += chunk
+        if self.done or not chunk:
+            return []
+
+        if not self._in_array:
+            match = self._key_pattern.search(self._buffer)
+            if match is None:
+                return []
+            self._in_array = True
+            self._pos = match.end()
+
+        items = []
+        buffer = self._buffer
+        i = self._pos
+        while i < len(buffer):
+            char = buffer[i]
+            if self._in_string:
+                if self._escape:
+                    self._escape = False
+                elif char == "\\":
+                    self._escape = True
+                elif char == '"':
+                    self._in_string = False
+            elif char == '"':
+                self._in_string = True
+            elif char in "{[":
+                if self._depth == 0 and char == "{":
+                    self._item_start = i
+                self._depth += 1
+            elif char in "}]":
+                if self._depth == 0:
+                    # End of the array itself
+                    self.done = True
+                    i += 1
+                    break
+                self._depth -= 1
+                if self._depth == 0 and self._item_start is not None:
+                    item = self._decode(buffer[self._item_start:i + 1])
+                    if item is not None:
+                        items.append(item)
+                    self._item_start = None
+            i += 1
+
+        self._pos = i
+        return items
+
+    @property
+    def text(self) -> str:
+        """All text fed so far."""
+        return self._buffer
+
+    @staticmethod
+    def _decode(fragment: str):
+        try:
+            item = json.loads(fragment)
+        except ValueError:
+            return None
+        return item if isinstance(item, dict) else None
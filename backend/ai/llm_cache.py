@@ -0,0 +1,141 @@
+"""
+LLM Response Cache
+Keyed response cache and in-flight deduplication for LLMService.
+
+Dashboard refreshes tend to ask for the same generation several times in a
+row. Prompt inputs are normalized (sorted keys, time bucketed) and hashed so
+identical requests share one cached response, and identical requests that
+arrive while a generation is still running wait for it instead of starting
+their own.
+"""
+
+import hashlib
+import json
+import threading
+import time
+from collections import OrderedDict
+from concurrent.futures import Future
+from typing import Any, Callable, Dict, Optional
+
+from .config import AIConfig
+
+
+def make_cache_key(kind: str, payload: Dict[str, Any]) -> str:
+    """
+    Hash normalized prompt inputs into a cache key.
+
+    Args:
+        kind: Prompt type (schedule, breakdown, recommendation)
+        payload: JSON-serializable prompt inputs
+
+    Returns:
+        Hex digest prefixed with the prompt type
+    """
+    canonical = json.dumps(payload, sort_keys=True, separators=(",", ":"), default=str)
+    return f"{kind}:{hashlib.sha256(canonical.encode('utf-8')).hexdigest()}"
+
+
+def time_bucket(timestamp: Optional[float] = None) -> int:
+    """Index of the LLM_CACHE_TIME_BUCKET_MINUTES window containing `timestamp`."""
+    if timestamp is None:
+        timestamp = time.time()
+    return int(timestamp // (AIConfig.LLM_CACHE_TIME_BUCKET_MINUTES * 60))
+
+
+class LLMResponseCache:
+    """
+    Thread-safe TTL + LRU cache of raw LLM responses.
+
+    Only responses that parsed successfully are stored, so a malformed
+    generation is retried on the next request rather than replayed.
+    """
+
+    def __init__(
+        self,
+        ttl_seconds: float = AIConfig.LLM_CACHE_TTL_SECONDS,
+        max_entries: int = AIConfig.LLM_CACHE_MAX_ENTRIES
+    ):
+        self.ttl_seconds = ttl_seconds
+        self.max_entries = max_entries
+        self._entries: "OrderedDict[str, tuple]" = OrderedDict()  # key -> (expires_at, text)
+        self._lock = threading.Lock()
+        self.hits = 0
+        self.misses = 0
+
+    def get(self, key: str) -> Optional[str]:
+        """Get a cached response, or None if missing or expired."""
+        now = time.monotonic()
+        with self._lock:
+            entry = self._entries.get(key)
+            if entry is None or entry[0] <= now:
+                if entry is not None:
+                    del self._entries[key]
+                self.misses += 1
+                return None
+            self._entries.move_to_end(key)
+            self.hits += 1
+            return entry[1]
+
+    def set(self, key: str, text: str) -> None:
+        """Store a response, evicting the least recently used entries."""
+        if self.ttl_seconds <= 0 or self.max_entries <= 0:
+            return
+        with self._lock:
+            self._entries[key] = (time.monotonic() + self.ttl_seconds, text)
+            self._entries.move_to_end(key)
+            while len(self._entries) > self.max_entries:
+                self._entries.popitem(last=False)
+
+    def clear(self) -> None:
+        """Drop all cached responses."""
+        with self._lock:
+            self._entries.clear()
+
+    def get_stats(self) -> Dict:
+        """Get cache size and hit/miss counts."""
+        with self._lock:
+            return {
+                "size": len(self._entries),
+                "hits": self.hits,
+                "misses": self.misses,
+                "ttl_seconds": self.ttl_seconds,
+            }
+
+
+class SingleFlight:
+    """
+    Collapse concurrent identical calls into one (thread version).
+
+    The first caller for a key runs the function; callers arriving before it
+    finishes block on the same result.
+    """
+
+    def __init__(self):
+        self._inflight: Dict[str, Future] = {}
+        self._lock = threading.Lock()
+        self.shared = 0
+
+    def do(self, key: str, fn: Callable[[], Any]) -> Any:
+        """Run fn once per key among concurrent callers and return its result."""
+        with self._lock:
+            future = self._inflight.get(key)
+            leader = future is None
+            if leader:
+                future = Future()
+                self._inflight[key] = future
+            else:
+                self.shared += 1
+
+        if not leader:
+            return future.result()
+
+        try:
+            result = fn()
+            future.set_result(result)
+            return result
+        except BaseException as e:
+            future.set_exception(e)
+            raise
+        finally:
+            with self._lock:
+                self._inflight.pop(key, None)
@@ -6,30 +6,41 @@ Features:
 - Text-based schedule generation
 - Vision-based schedule extraction from images (class schedules, timetables)
 - Task breakdown and recommendations
+- Async calls with timeouts and concurrency limits, in-flight deduplication
+  and a response cache keyed on the normalized prompt inputs
+- Streaming schedule/breakdown generation with a mid-stream fallback
 """
 
 import os
 import json
 import base64
-from typing import Optional, List, Dict, Any
+import asyncio
+import importlib.util
+import threading
+import time
+from typing import Optional, List, Dict, Any, AsyncIterator, Callable, Tuple
 from datetime import datetime, timezone
 from dataclasses import dataclass
 
-# Try to import Gemini client
-try:
-    import google.generativeai as genai
-    from google.generativeai.types import HarmCategory, HarmBlockThreshold
-    GEMINI_AVAILABLE = True
-except ImportError:
-    GEMINI_AVAILABLE = False
+from .config import AIConfig
+from .free_intervals import FreeIntervalIndex
+from .json_stream import JSONArrayStreamParser
+from .llm_cache import LLMResponseCache, SingleFlight, make_cache_key, time_bucket
+from core.metrics import LLM_CALLS, STAGE_SECONDS, span
 
-# Try to import PIL for image processing
-try:
-    from PIL import Image
-    import io
-    PIL_AVAILABLE = True
-except ImportError:
-    PIL_AVAILABLE = False
+# The Gemini SDK is slow to import; check it is installed here and import it
+# only when a client is actually created (see LLMService._init_clients)
+def _installed(module: str) -> bool:
+    try:
+        return importlib.util.find_spec(module) is not None
+    except ImportError:  # Parent package missing
+        return False
+
+
+GEMINI_AVAILABLE = _installed("google.generativeai")
+
+# PIL is optional for image processing
+PIL_AVAILABLE = _installed("PIL")
 
 
 @dataclass
@@ -64,6 +75,14 @@ class TaskBreakdown:
     estimated_total_time: float
 
 
+@dataclass
+class StreamOutcome:
+    """How a streamed generation ended (filled in by _stream_items)."""
+    completed: bool = False  # The array (and response) arrived in full
+    cached: bool = False     # Replayed from the response cache
+    text: str = ""
+
+
 class LLMService:
     """
     Service for LLM-powered AI features.
@@ -77,6 +96,14 @@ class LLMService:
     def __init__(self):
         self.gemini_model = None
         self.gemini_vision_model = None
+        self._cache = LLMResponseCache()
+        self._flight = SingleFlight()
+        self._sync_slots = threading.BoundedSemaphore(AIConfig.LLM_MAX_CONCURRENCY)
+        # asyncio primitives belong to one event loop; rebuilt if the loop changes
+        self._async_loop = None
+        self._async_slots: Optional[asyncio.Semaphore] = None
+        self._async_inflight: Dict[str, asyncio.Task] = {}
+        self.shared_async = 0
         self._init_clients()
 
     def _init_clients(self):
@@ -84,6 +111,8 @@ class LLMService:
         gemini_key = os.getenv("GEMINI_API_KEY")
 
         if GEMINI_AVAILABLE and gemini_key:
+            import google.generativeai as genai
+
             genai.configure(api_key=gemini_key)
 
             # Text generation model (JSON output)
@@ -110,26 +139,345 @@ class LLMService:
         else:
             print("[LLM] No Gemini API key found - using intelligent fallback")
 
-    def _call_llm(self, system_prompt: str, user_prompt: str, json_mode: bool = True) -> str:
+    @staticmethod
+    def _full_prompt(system_prompt: str, user_prompt: str, json_mode: bool) -> str:
+        """Combine system and user prompts for Gemini."""
+        full_prompt = f"{system_prompt}\n\n{user_prompt}"
+        if json_mode:
+            full_prompt += "\n\nRespond with valid JSON only."
+        return full_prompt
+
+    def _call_llm(self, system_prompt: str, user_prompt: str, json_mode: bool = True) -> Optional[str]:
         """
         Call Gemini with the given prompts.
-        Falls back gracefully if no LLM is available.
+        Falls back gracefully if no LLM is available, the call fails or it
+        exceeds LLM_TIMEOUT_SECONDS.
         """
         if self.gemini_model:
             try:
-                # Combine system and user prompts for Gemini
-                full_prompt = f"{system_prompt}\n\n{user_prompt}"
-                if json_mode:
-                    full_prompt += "\n\nRespond with valid JSON only."
-
-                response = self.gemini_model.generate_content(full_prompt)
+                full_prompt = self._full_prompt(system_prompt, user_prompt, json_mode)
+                with self._sync_slots, span("llm.generate"):
+                    response = self.gemini_model.generate_content(
+                        full_prompt,
+                        request_options={"timeout": AIConfig.LLM_TIMEOUT_SECONDS}
+                    )
+                LLM_CALLS.inc(call="generate", result="ok")
                 return response.text
             except Exception as e:
+                LLM_CALLS.inc(call="generate", result="error")
                 print(f"[LLM] Gemini error: {e}")
 
         # No LLM available
         return None
 
+    async def _call_llm_async(self, system_prompt: str, user_prompt: str, json_mode: bool = True) -> Optional[str]:
+        """Async variant of _call_llm; waits on the event loop instead of a worker thread."""
+        if self.gemini_model:
+            try:
+                full_prompt = self._full_prompt(system_prompt, user_prompt, json_mode)
+                async with self._get_async_slots():
+                    with span("llm.generate_async"):
+                        response = await asyncio.wait_for(
+                            self.gemini_model.generate_content_async(full_prompt),
+                            timeout=AIConfig.LLM_TIMEOUT_SECONDS
+                        )
+                LLM_CALLS.inc(call="generate_async", result="ok")
+                return response.text
+            except asyncio.TimeoutError:
+                LLM_CALLS.inc(call="generate_async", result="timeout")
+                print(f"[LLM] Gemini call timed out after {AIConfig.LLM_TIMEOUT_SECONDS}s")
+            except Exception as e:
+                LLM_CALLS.inc(call="generate_async", result="error")
+                print(f"[LLM] Gemini error: {e}")
+
+        return None
+
+    def _get_async_slots(self) -> asyncio.Semaphore:
+        """Concurrency semaphore (and in-flight table) for the running event loop."""
+        loop = asyncio.get_running_loop()
+        if self._async_loop is not loop:
+            self._async_loop = loop
+            self._async_slots = asyncio.Semaphore(AIConfig.LLM_MAX_CONCURRENCY)
+            self._async_inflight = {}
+        return self._async_slots
+
+    def _generate(
+        self,
+        cache_key: str,
+        system_prompt: str,
+        user_prompt: str,
+        parse: Callable[[str], Any]
+    ) -> Optional[Any]:
+        """
+        Cached, deduplicated generation.
+
+        Args:
+            cache_key: Hash of the normalized prompt inputs
+            system_prompt: System prompt
+            user_prompt: User prompt
+            parse: Turns response text into a result (None if unusable)
+
+        Returns:
+            Parsed result, or None when the caller should fall back
+        """
+        if not self.gemini_model:
+            return None
+
+        cached = self._cache.get(cache_key)
+        if cached is not None:
+            LLM_CALLS.inc(call="generate", result="cached")
+            return parse(cached)
+
+        def run():
+            text = self._call_llm(system_prompt, user_prompt, json_mode=True)
+            result = parse(text) if text else None
+            if result is not None:
+                self._cache.set(cache_key, text)
+            return result
+
+        return self._flight.do(cache_key, run)
+
+    async def _generate_async(
+        self,
+        cache_key: str,
+        system_prompt: str,
+        user_prompt: str,
+        parse: Callable[[str], Any]
+    ) -> Optional[Any]:
+        """Async variant of _generate sharing the same response cache."""
+        if not self.gemini_model:
+            return None
+
+        cached = self._cache.get(cache_key)
+        if cached is not None:
+            LLM_CALLS.inc(call="generate_async", result="cached")
+            return parse(cached)
+
+        async def run():
+            text = await self._call_llm_async(system_prompt, user_prompt, json_mode=True)
+            result = parse(text) if text else None
+            if result is not None:
+                self._cache.set(cache_key, text)
+            return result
+
+        self._get_async_slots()
+        inflight = self._async_inflight
+        task = inflight.get(cache_key)
+        if task is None:
+            task = asyncio.ensure_future(run())
+            inflight[cache_key] = task
+            task.add_done_callback(lambda _t: inflight.pop(cache_key, None))
+        else:
+            self.shared_async += 1
+
+        # Shielded so one client disconnecting doesn't cancel everyone's call
+        return await asyncio.shield(task)
+
+    async def _stream_items(
+        self,
+        cache_key: str,
+        system_prompt: str,
+        user_prompt: str,
+        array_key: str,
+        outcome: StreamOutcome
+    ) -> AsyncIterator[Dict[str, Any]]:
+        """
+        Yield elements of `array_key` as the model streams them.
+
+        Stops early (outcome.completed stays False) if the model errors or no
+        chunk arrives within LLM_STREAM_STALL_SECONDS. A complete response is
+        cached like a non-streamed one, and a cached response is replayed.
+
+        The upstream stream is read by a separate task that holds the
+        concurrency slot only until generation finishes; items are queued, so
+        a slow consumer (DB flushes, a slow SSE client) never keeps the slot.
+
+        Args:
+            cache_key: Hash of the normalized prompt inputs
+            system_prompt: System prompt
+            user_prompt: User prompt
+            array_key: Top-level array to stream ("schedule", "subtasks")
+            outcome: Receives completion state and the full response text
+        """
+        if not self.gemini_model:
+            return
+
+        cached = self._cache.get(cache_key)
+        if cached is not None:
+            try:
+                items = json.loads(cached).get(array_key, [])
+            except (ValueError, AttributeError):
+                items = None
+            if isinstance(items, list):
+                LLM_CALLS.inc(call="stream", result="cached")
+                outcome.completed, outcome.cached, outcome.text = True, True, cached
+                for item in items:
+                    if isinstance(item, dict):
+                        yield item
+                return
+
+        parser = JSONArrayStreamParser(array_key)
+        full_prompt = self._full_prompt(system_prompt, user_prompt, json_mode=True)
+        stall = AIConfig.LLM_STREAM_STALL_SECONDS
+        # Unbounded: a response is a few KB, and the producer must never wait
+        # on the consumer or it would hold its slot through slow SSE clients
+        queue: asyncio.Queue = asyncio.Queue()
+        done = object()
+
+        async def produce():
+            """Read the upstream stream under a slot, handing items to the queue."""
+            started = time.perf_counter()  # Timed directly: a span can't stay current across tasks
+            try:
+                async with self._get_async_slots():
+                    response = await asyncio.wait_for(
+                        self.gemini_model.generate_content_async(full_prompt, stream=True),
+                        timeout=stall
+                    )
+                    chunks = response.__aiter__()
+                    while True:
+                        try:
+                            chunk = await asyncio.wait_for(chunks.__anext__(), timeout=stall)
+                        except StopAsyncIteration:
+                            break
+                        for item in parser.feed(chunk.text or ""):
+                            queue.put_nowait(item)
+            finally:
+                STAGE_SECONDS.observe(time.perf_counter() - started, stage="llm.stream")
+                queue.put_nowait(done)
+
+        producer = asyncio.ensure_future(produce())
+        try:
+            while True:
+                item = await queue.get()
+                if item is done:
+                    break
+                yield item
+            await producer  # Re-raises the producer's timeout or error
+        except asyncio.TimeoutError:
+            LLM_CALLS.inc(call="stream", result="timeout")
+            print(f"[LLM] Gemini stream stalled for {stall}s")
+            return
+        except Exception as e:
+            LLM_CALLS.inc(call="stream", result="error")
+            print(f"[LLM] Gemini stream error: {e}")
+            return
+        finally:
+            if not producer.done():
+                producer.cancel()  # Consumer went away: free the slot now
+
+        outcome.text = parser.text
+        LLM_CALLS.inc(call="stream", result="ok" if parser.done else "incomplete")
+        if parser.done:
+            outcome.completed = True
+            try:
+                json.loads(parser.text)
+                self._cache.set(cache_key, parser.text)
+            except ValueError:
+                pass  # Array arrived but the trailing fields didn't parse
+
+    async def stream_intelligent_schedule(
+        self,
+        tasks: List[Dict[str, Any]],
+        fixed_blocks: List[Dict[str, Any]],
+        user_context: Dict[str, Any],
+        working_hours: tuple = (9.0, 20.0)
+    ) -> AsyncIterator[Tuple[str, ScheduleBlock]]:
+        """
+        Stream an AI-optimized schedule block by block.
+
+        If the model is unavailable, stalls or fails mid-stream, the tasks it
+        hasn't placed yet are scheduled by _fallback_schedule around the
+        fixed blocks and the blocks already emitted.
+
+        Args:
+            tasks: List of pending tasks with priority, deadline, duration, etc.
+            fixed_blocks: Existing fixed commitments (meetings, classes)
+            user_context: User's current state (mood, energy, time of day)
+            working_hours: Start and end hours for scheduling
+
+        Yields:
+            (source, ScheduleBlock) where source is "llm" or "fallback"
+        """
+        if not tasks:
+            return
+
+        outcome = StreamOutcome()
+        emitted: List[ScheduleBlock] = []
+        async for item in self._stream_items(
+            *self._schedule_prompts(tasks, fixed_blocks, user_context, working_hours),
+            array_key="schedule",
+            outcome=outcome
+        ):
+            block = self._schedule_block_from_item(item)
+            if block is not None:
+                emitted.append(block)
+                yield "llm", block
+
+        if outcome.completed:
+            return
+
+        placed = {b.task_id for b in emitted if b.task_id is not None}
+        remaining = [t for t in tasks if t.get("id") not in placed]
+        occupied = list(fixed_blocks) + [
+            {"start": b.start_hour, "duration": b.duration_hours} for b in emitted
+        ]
+        for block in self._fallback_schedule(remaining, occupied, user_context, working_hours):
+            yield "fallback", block
+
+    async def stream_task_breakdown(
+        self,
+        task: Dict[str, Any],
+        user_context: Dict[str, Any]
+    ) -> AsyncIterator[Tuple[str, Any]]:
+        """
+        Stream a task breakdown subtask by subtask.
+
+        Falls back to the rule-based breakdown only if the model produced no
+        subtasks; a stream that stalls part-way keeps the steps it delivered.
+
+        Args:
+            task: The task to break down
+            user_context: User's context for personalization
+
+        Yields:
+            ("subtask", dict) for each subtask, then ("summary", TaskBreakdown)
+        """
+        outcome = StreamOutcome()
+        subtasks: List[Dict[str, Any]] = []
+        async for item in self._stream_items(
+            *self._breakdown_prompts(task, user_context),
+            array_key="subtasks",
+            outcome=outcome
+        ):
+            subtasks.append(item)
+            yield "subtask", item
+
+        if not subtasks:
+            breakdown = self._fallback_breakdown(task, user_context)
+            for item in breakdown.subtasks:
+                yield "subtask", item
+            yield "summary", breakdown
+            return
+
+        breakdown = self._parse_breakdown(outcome.text, task) if outcome.completed else None
+        if breakdown is None:
+            breakdown = TaskBreakdown(
+                subtasks=subtasks,
+                reasoning="Partial AI breakdown (the model stopped responding).",
+                estimated_total_time=round(sum(float(s.get("duration_hours", 0.5)) for s in subtasks), 2)
+            )
+        else:
+            breakdown.subtasks = subtasks
+        yield "summary", breakdown
+
+    def get_stats(self) -> Dict[str, Any]:
+        """Get cache and deduplication statistics."""
+        return {
+            "llm_available": self.gemini_model is not None,
+            "cache": self._cache.get_stats(),
+            "shared_calls": self._flight.shared + self.shared_async,
+        }
+
     def extract_schedule_from_image(
         self,
         image_bytes: bytes,
@@ -207,7 +555,9 @@ Respond with this JSON structure:
             }
 
             # Call Gemini Vision
-            response = self.gemini_vision_model.generate_content([prompt, image_part])
+            with span("llm.vision"):
+                response = self.gemini_vision_model.generate_content([prompt, image_part])
+            LLM_CALLS.inc(call="vision", result="ok")
             result_text = response.text
 
             # Parse the JSON response
@@ -330,6 +680,44 @@ Respond with this JSON structure:
         if not tasks:
             return []
 
+        blocks = self._generate(
+            *self._schedule_prompts(tasks, fixed_blocks, user_context, working_hours),
+            parse=self._parse_schedule
+        )
+        if blocks is not None:
+            return blocks
+
+        # Fallback to intelligent rule-based scheduling
+        return self._fallback_schedule(tasks, fixed_blocks, user_context, working_hours)
+
+    async def generate_intelligent_schedule_async(
+        self,
+        tasks: List[Dict[str, Any]],
+        fixed_blocks: List[Dict[str, Any]],
+        user_context: Dict[str, Any],
+        working_hours: tuple = (9.0, 20.0)
+    ) -> List[ScheduleBlock]:
+        """Async variant of generate_intelligent_schedule."""
+        if not tasks:
+            return []
+
+        blocks = await self._generate_async(
+            *self._schedule_prompts(tasks, fixed_blocks, user_context, working_hours),
+            parse=self._parse_schedule
+        )
+        if blocks is not None:
+            return blocks
+
+        return self._fallback_schedule(tasks, fixed_blocks, user_context, working_hours)
+
+    def _schedule_prompts(
+        self,
+        tasks: List[Dict[str, Any]],
+        fixed_blocks: List[Dict[str, Any]],
+        user_context: Dict[str, Any],
+        working_hours: tuple
+    ) -> Tuple[str, str, str]:
+        """Build (cache_key, system_prompt, user_prompt) for schedule generation."""
         system_prompt = """You are an expert productivity coach and schedule optimizer.
 Your job is to create an optimal daily schedule that maximizes productivity while respecting human cognitive limits.
 
@@ -410,29 +798,50 @@ Create an optimized schedule that:
 
 Return the schedule as JSON."""
 
-        response = self._call_llm(system_prompt, user_prompt, json_mode=True)
-
-        if response:
-            try:
-                data = json.loads(response)
-                blocks = []
-                for item in data.get("schedule", []):
-                    blocks.append(ScheduleBlock(
-                        task_id=item.get("task_id"),
-                        title=item.get("title", "Untitled"),
-                        start_hour=float(item.get("start_hour", 9.0)),
-                        duration_hours=float(item.get("duration_hours", 1.0)),
-                        block_type=item.get("block_type", "task"),
-                        reasoning=item.get("reasoning", ""),
-                        energy_required=item.get("energy_required", "medium"),
-                        cognitive_load=item.get("cognitive_load", "medium")
-                    ))
-                return blocks
-            except (json.JSONDecodeError, KeyError) as e:
-                print(f"[LLM] Failed to parse schedule response: {e}")
+        cache_key = make_cache_key("schedule", {
+            "tasks": tasks_info,
+            "fixed_blocks": fixed_info,
+            "context": {
+                key: user_context.get(key)
+                for key in ("current_hour", "energy_level", "mood", "day_of_week", "tasks_completed")
+            },
+            "working_hours": list(working_hours),
+            "bucket": time_bucket(),
+        })
+        return cache_key, system_prompt, user_prompt
+
+    @staticmethod
+    def _schedule_block_from_item(item: Dict[str, Any]) -> Optional[ScheduleBlock]:
+        """Build a ScheduleBlock from one element of the "schedule" array."""
+        try:
+            return ScheduleBlock(
+                task_id=item.get("task_id"),
+                title=item.get("title", "Untitled"),
+                start_hour=float(item.get("start_hour", 9.0)),
+                duration_hours=float(item.get("duration_hours", 1.0)),
+                block_type=item.get("block_type", "task"),
+                reasoning=item.get("reasoning", ""),
+                energy_required=item.get("energy_required", "medium"),
+                cognitive_load=item.get("cognitive_load", "medium")
+            )
+        except (ValueError, TypeError, AttributeError):
+            return None
 
-        # Fallback to intelligent rule-based scheduling
-        return self._fallback_schedule(tasks, fixed_blocks, user_context, working_hours)
+    @classmethod
+    def _parse_schedule(cls, response: str) -> Optional[List[ScheduleBlock]]:
+        """Parse a schedule response (None if malformed)."""
+        try:
+            data = json.loads(response)
+            blocks = []
+            for item in data.get("schedule", []):
+                block = cls._schedule_block_from_item(item)
+                if block is None:
+                    raise ValueError(f"invalid schedule item: {item!r}")
+                blocks.append(block)
+            return blocks
+        except (ValueError, KeyError, TypeError, AttributeError) as e:
+            print(f"[LLM] Failed to parse schedule response: {e}")
+            return None
 
     def _fallback_schedule(
         self,
@@ -486,35 +895,13 @@ Return the schedule as JSON."""
         high_load_tasks = [t for t in sorted_tasks if get_cognitive_load(t) == "high"]
         other_tasks = [t for t in sorted_tasks if get_cognitive_load(t) != "high"]
 
-        # Find available slots
-        available_slots = []
-        current_time = start_hour
-
-        for occ_start, occ_end in sorted(occupied):
-            if occ_start > current_time:
-                available_slots.append((current_time, occ_start))
-            current_time = max(current_time, occ_end)
-
-        if current_time < end_hour:
-            available_slots.append((current_time, end_hour))
-
-        # Schedule high-load tasks during peak hours first
-        slot_idx = 0
-        slot_time = available_slots[0][0] if available_slots else start_hour
+        # Free time index; every placement is allocated out of it, so earlier
+        # gaps stay available to later (smaller) tasks
+        free = FreeIntervalIndex(start_hour, end_hour, occupied)
+        pack_tightly = AIConfig.FALLBACK_SLOT_STRATEGY == "best_fit"
+        last_end = None
         work_since_break = 0.0
 
-        def find_slot(task_duration: float) -> Optional[float]:
-            nonlocal slot_idx, slot_time
-            while slot_idx < len(available_slots):
-                slot_start, slot_end = available_slots[slot_idx]
-                available_time = slot_end - max(slot_time, slot_start)
-                if available_time >= task_duration:
-                    return max(slot_time, slot_start)
-                slot_idx += 1
-                if slot_idx < len(available_slots):
-                    slot_time = available_slots[slot_idx][0]
-            return None
-
         # Schedule all tasks with breaks
         all_tasks = []
 
@@ -530,27 +917,31 @@ Return the schedule as JSON."""
             task_duration = task.get("duration", 1.0)
             cognitive_load = task.get("_cognitive_load", "medium")
 
-            # Need a break?
-            if work_since_break >= 1.5:  # 90-minute ultradian rhythm
-                break_start = find_slot(0.25)  # 15-minute break
-                if break_start is not None:
+            # Need a break? Take it right after the previous task
+            if work_since_break >= 1.5 and last_end is not None:  # 90-minute ultradian rhythm
+                if free.is_free(last_end, 0.25):  # 15-minute break
+                    free.allocate(last_end, 0.25)
                     blocks.append(ScheduleBlock(
                         task_id=None,
                         title="Break - Recharge",
-                        start_hour=break_start,
+                        start_hour=last_end,
                         duration_hours=0.25,
                         block_type="break",
                         reasoning="Strategic break after 90 minutes of focused work",
                         energy_required="low",
                         cognitive_load="low"
                     ))
-                    slot_time = break_start + 0.25
                     work_since_break = 0.0
 
-            # Find slot for task
-            task_start = find_slot(task_duration)
+            # Find slot for task; high-load tasks always take the earliest
+            # gap so they stay in the morning peak
+            if pack_tightly and cognitive_load != "high":
+                task_start = free.best_fit(task_duration)
+            else:
+                task_start = free.first_fit(task_duration)
             if task_start is None:
-                break  # No more available time
+                continue  # Doesn't fit anywhere; a shorter task still might
+            free.allocate(task_start, task_duration)
 
             # Determine reasoning based on context
             is_peak = is_peak_hour(task_start)
@@ -574,9 +965,10 @@ Return the schedule as JSON."""
                 cognitive_load=cognitive_load
             ))
 
-            slot_time = task_start + task_duration
+            last_end = task_start + task_duration
             work_since_break += task_duration
 
+        blocks.sort(key=lambda block: block.start_hour)
         return blocks
 
     def breakdown_task_intelligently(
@@ -594,6 +986,37 @@ Return the schedule as JSON."""
         Returns:
             TaskBreakdown with subtasks and reasoning
         """
+        breakdown = self._generate(
+            *self._breakdown_prompts(task, user_context),
+            parse=lambda text: self._parse_breakdown(text, task)
+        )
+        if breakdown is not None:
+            return breakdown
+
+        # Fallback to intelligent rule-based breakdown
+        return self._fallback_breakdown(task, user_context)
+
+    async def breakdown_task_intelligently_async(
+        self,
+        task: Dict[str, Any],
+        user_context: Dict[str, Any]
+    ) -> TaskBreakdown:
+        """Async variant of breakdown_task_intelligently."""
+        breakdown = await self._generate_async(
+            *self._breakdown_prompts(task, user_context),
+            parse=lambda text: self._parse_breakdown(text, task)
+        )
+        if breakdown is not None:
+            return breakdown
+
+        return self._fallback_breakdown(task, user_context)
+
+    def _breakdown_prompts(
+        self,
+        task: Dict[str, Any],
+        user_context: Dict[str, Any]
+    ) -> Tuple[str, str, str]:
+        """Build (cache_key, system_prompt, user_prompt) for task breakdown."""
         system_prompt = """You are an expert project manager and productivity coach.
 Your job is to break down complex tasks into actionable, manageable subtasks.
 
@@ -644,21 +1067,32 @@ Create a breakdown that:
 
 Return the breakdown as JSON."""
 
-        response = self._call_llm(system_prompt, user_prompt, json_mode=True)
-
-        if response:
-            try:
-                data = json.loads(response)
-                return TaskBreakdown(
-                    subtasks=data.get("subtasks", []),
-                    reasoning=data.get("reasoning", ""),
-                    estimated_total_time=data.get("estimated_total_time", task.get("duration", 2))
-                )
-            except (json.JSONDecodeError, KeyError) as e:
-                print(f"[LLM] Failed to parse breakdown response: {e}")
-
-        # Fallback to intelligent rule-based breakdown
-        return self._fallback_breakdown(task, user_context)
+        cache_key = make_cache_key("breakdown", {
+            "task": {
+                key: task.get(key)
+                for key in ("title", "description", "duration", "difficulty", "priority", "deadline")
+            },
+            "context": {
+                key: user_context.get(key)
+                for key in ("energy_level", "tasks_completed", "preferred_session_length")
+            },
+            "bucket": time_bucket(),
+        })
+        return cache_key, system_prompt, user_prompt
+
+    @staticmethod
+    def _parse_breakdown(response: str, task: Dict[str, Any]) -> Optional[TaskBreakdown]:
+        """Parse a breakdown response (None if malformed)."""
+        try:
+            data = json.loads(response)
+            return TaskBreakdown(
+                subtasks=data.get("subtasks", []),
+                reasoning=data.get("reasoning", ""),
+                estimated_total_time=data.get("estimated_total_time", task.get("duration", 2))
+            )
+        except (ValueError, KeyError, TypeError, AttributeError) as e:
+            print(f"[LLM] Failed to parse breakdown response: {e}")
+            return None
 
     def _fallback_breakdown(
         self,
@@ -775,12 +1209,53 @@ Return the breakdown as JSON."""
         - Personalized advice based on user history
         """
         if not available_tasks:
-            return {
-                "action": "break",
-                "reasoning": "No tasks available. Take this time to rest or plan ahead.",
-                "confidence": 1.0
-            }
+            return self._no_tasks_recommendation()
+
+        result = self._generate(
+            *self._recommendation_prompts(user_state, available_tasks, recent_activity),
+            parse=self._parse_recommendation
+        )
+        if result is not None:
+            return result
+
+        # Fallback to simple recommendation
+        return self._fallback_recommendation(user_state, available_tasks)
+
+    async def get_smart_recommendation_async(
+        self,
+        user_state: Dict[str, Any],
+        available_tasks: List[Dict[str, Any]],
+        recent_activity: List[Dict[str, Any]]
+    ) -> Dict[str, Any]:
+        """Async variant of get_smart_recommendation."""
+        if not available_tasks:
+            return self._no_tasks_recommendation()
+
+        result = await self._generate_async(
+            *self._recommendation_prompts(user_state, available_tasks, recent_activity),
+            parse=self._parse_recommendation
+        )
+        if result is not None:
+            return result
+
+        return self._fallback_recommendation(user_state, available_tasks)
+
+    @staticmethod
+    def _no_tasks_recommendation() -> Dict[str, Any]:
+        """Recommendation when the user has nothing pending."""
+        return {
+            "action": "break",
+            "reasoning": "No tasks available. Take this time to rest or plan ahead.",
+            "confidence": 1.0
+        }
 
+    def _recommendation_prompts(
+        self,
+        user_state: Dict[str, Any],
+        available_tasks: List[Dict[str, Any]],
+        recent_activity: List[Dict[str, Any]]
+    ) -> Tuple[str, str, str]:
+        """Build (cache_key, system_prompt, user_prompt) for a smart recommendation."""
         system_prompt = """You are a personal productivity AI assistant.
 Analyze the user's current state and recommend the best action right now.
 
@@ -828,16 +1303,30 @@ Respond with JSON:
 
 Recommend the best action considering their current state and workload."""
 
-        response = self._call_llm(system_prompt, user_prompt, json_mode=True)
-
-        if response:
-            try:
-                return json.loads(response)
-            except json.JSONDecodeError:
-                pass
+        # Activity timestamps change on every refresh; what was done (and how
+        # it went) is what shapes the answer
+        cache_key = make_cache_key("recommendation", {
+            "tasks": tasks_summary,
+            "state": {
+                key: user_state.get(key)
+                for key in ("time_block", "hour", "energy_level", "mood", "day_of_week")
+            },
+            "activity": [
+                [item.get("action_type"), item.get("outcome"), item.get("was_followed")]
+                for item in (recent_activity[-5:] if recent_activity else [])
+            ],
+            "bucket": time_bucket(),
+        })
+        return cache_key, system_prompt, user_prompt
 
-        # Fallback to simple recommendation
-        return self._fallback_recommendation(user_state, available_tasks)
+    @staticmethod
+    def _parse_recommendation(response: str) -> Optional[Dict[str, Any]]:
+        """Parse a recommendation response (None if malformed)."""
+        try:
+            data = json.loads(response)
+        except ValueError:
+            return None
+        return data if isinstance(data, dict) else None
 
     def _fallback_recommendation(
         self,
@@ -2,12 +2,16 @@
 Replay Buffer
 Experience replay buffer for DQN training.
 Stores transitions and samples mini-batches for training.
+
+Storage is a preallocated struct-of-arrays ring buffer: one contiguous
+array per field, so sampling is a single fancy-index per field instead of
+rebuilding arrays from Python tuples.
 """
 
-import numpy as np
-from collections import deque
 import random
-from typing import Tuple, List
+
+import numpy as np
+from typing import Tuple, List, Optional
 
 
 class ReplayBuffer:
@@ -16,18 +20,40 @@ class ReplayBuffer:
 
     Stores transitions (state, action, reward, next_state, done)
     and provides random sampling for breaking correlation in training data.
+
+    Layout (allocated on first push if state_dim is not given):
+    - states, next_states: float32 (capacity, state_dim)
+    - actions: int64 (capacity,)
+    - rewards, dones: float32 (capacity,)
     """
 
-    def __init__(self, capacity: int = 10000):
+    def __init__(self, capacity: int = 10000, state_dim: Optional[int] = None):
         """
         Initialize replay buffer.
 
         Args:
             capacity: Maximum number of transitions to store
+            state_dim: Feature dimension (inferred from the first push if None)
         """
         self.capacity = capacity
-        self.buffer = deque(maxlen=capacity)
-        self.position = 0
+        self.state_dim = state_dim
+        self.position = 0  # Next slot to write
+        self.size = 0
+
+        self.states: Optional[np.ndarray] = None
+        self.next_states: Optional[np.ndarray] = None
+        self.actions = np.zeros(capacity, dtype=np.int64)
+        self.rewards = np.zeros(capacity, dtype=np.float32)
+        self.dones = np.zeros(capacity, dtype=np.float32)
+
+        if state_dim is not None:
+            self._allocate(state_dim)
+
+    def _allocate(self, state_dim: int):
+        """Allocate the state matrices once the feature dimension is known."""
+        self.state_dim = state_dim
+        self.states = np.zeros((self.capacity, state_dim), dtype=np.float32)
+        self.next_states = np.zeros((self.capacity, state_dim), dtype=np.float32)
 
     def push(
         self,
@@ -36,7 +62,7 @@ class ReplayBuffer:
         reward: float,
         next_state: np.ndarray,
         done: bool
-    ):
+    ) -> int:
         """
         Add a transition to the buffer.
 
@@ -46,9 +72,83 @@ class ReplayBuffer:
             reward: Reward received
             next_state: Next state after action
             done: Whether episode ended
+
+        Returns:
+            Slot index the transition was written to
+        """
+        if self.states is None:
+            self._allocate(int(np.asarray(state).shape[-1]))
+
+        idx = self.position
+        self.states[idx] = state
+        self.actions[idx] = action
+        self.rewards[idx] = reward
+        self.next_states[idx] = next_state
+        self.dones[idx] = float(done)
+
+        self.position = (idx + 1) % self.capacity
+        self.size = min(self.size + 1, self.capacity)
+
+        return idx
+
+    def push_batch(
+        self,
+        states: np.ndarray,
+        actions: np.ndarray,
+        rewards: np.ndarray,
+        next_states: np.ndarray,
+        dones: np.ndarray
+    ) -> np.ndarray:
+        """
+        Add many transitions at once (vectorized, wraps around the ring).
+
+        Args:
+            states: (N, state_dim) state matrix
+            actions: (N,) actions
+            rewards: (N,) rewards
+            next_states: (N, state_dim) next-state matrix
+            dones: (N,) done flags
+
+        Returns:
+            Slot indices the transitions were written to
         """
-        transition = (state, action, reward, next_state, done)
-        self.buffer.append(transition)
+        states = np.asarray(states, dtype=np.float32)
+        n = states.shape[0]
+        if n == 0:
+            return np.zeros(0, dtype=np.int64)
+
+        if self.states is None:
+            self._allocate(states.shape[1])
+
+        # Only the last `capacity` rows survive a batch larger than the buffer
+        if n > self.capacity:
+            keep = slice(n - self.capacity, n)
+            states, actions, rewards = states[keep], np.asarray(actions)[keep], np.asarray(rewards)[keep]
+            next_states, dones = np.asarray(next_states)[keep], np.asarray(dones)[keep]
+            self.position = (self.position + n - self.capacity) % self.capacity
+            n = self.capacity
+
+        indices = (self.position + np.arange(n)) % self.capacity
+        self.states[indices] = states
+        self.actions[indices] = actions
+        self.rewards[indices] = rewards
+        self.next_states[indices] = next_states
+        self.dones[indices] = np.asarray(dones, dtype=np.float32)
+
+        self.position = int((self.position + n) % self.capacity)
+        self.size = min(self.size + n, self.capacity)
+
+        return indices
+
+    def _gather(self, indices: np.ndarray) -> Tuple[np.ndarray, ...]:
+        """Fancy-index every field for the given slots."""
+        return (
+            self.states[indices],
+            self.actions[indices],
+            self.rewards[indices],
+            self.next_states[indices],
+            self.dones[indices],
+        )
 
     def sample(self, batch_size: int) -> Tuple[np.ndarray, ...]:
         """
@@ -58,20 +158,27 @@ class ReplayBuffer:
             batch_size: Number of transitions to sample
 
         Returns:
-            Tuple of (states, actions, rewards, next_states, dones)
+            Tuple of (states, actions, rewards, next_states, dones); fewer
+            than batch_size rows if the buffer holds fewer
+
+        Raises:
+            ValueError: If batch_size isn't positive or the buffer is empty
         """
-        if len(self.buffer) < batch_size:
-            batch_size = len(self.buffer)
+        batch_size = self._check_sample_size(batch_size)
 
-        batch = random.sample(self.buffer, batch_size)
+        # random.sample draws k distinct indices in O(k); np.random.choice
+        # with replace=False permutes the whole buffer on every call
+        indices = np.fromiter(random.sample(range(self.size), batch_size), dtype=np.int64, count=batch_size)
 
-        states = np.array([t[0] for t in batch], dtype=np.float32)
-        actions = np.array([t[1] for t in batch], dtype=np.int64)
-        rewards = np.array([t[2] for t in batch], dtype=np.float32)
-        next_states = np.array([t[3] for t in batch], dtype=np.float32)
-        dones = np.array([t[4] for t in batch], dtype=np.float32)
+        return self._gather(indices)
 
-        return states, actions, rewards, next_states, dones
+    def _check_sample_size(self, batch_size: int) -> int:
+        """Validate a sample request and clamp it to the buffer size."""
+        if batch_size <= 0:
+            raise ValueError(f"batch_size must be positive, got {batch_size}")
+        if self.size == 0:
+            raise ValueError("Cannot sample from an empty replay buffer")
+        return min(batch_size, self.size)
 
     def __len__(self) -> int:
         """
@@ -80,14 +187,16 @@ class ReplayBuffer:
         Returns:
             Number of transitions in buffer
         """
-        return len(self.buffer)
+        return self.size
 
     def clear(self):
         """
         Clear all transitions from the buffer.
+
+        Storage stays allocated; slots are simply overwritten.
         """
-        self.buffer.clear()
         self.position = 0
+        self.size = 0
 
     def is_ready(self, min_size: int = 100) -> bool:
         """
@@ -99,7 +208,84 @@ class ReplayBuffer:
         Returns:
             True if buffer size >= min_size
         """
-        return len(self.buffer) >= min_size
+        return self.size >= min_size
+
+
+class SumTree:
+    """
+    Binary sum tree over leaf priorities.
+
+    Stored as a flat 1-indexed heap array: node i has children 2i and 2i+1,
+    leaves live at [leaf_count, 2 * leaf_count). Both prefix-sum lookup and
+    updates walk one root-to-leaf path, vectorized across the whole batch.
+    """
+
+    def __init__(self, capacity: int):
+        """
+        Initialize an all-zero tree.
+
+        Args:
+            capacity: Number of leaves that can hold a priority
+        """
+        self.capacity = capacity
+        self.leaf_count = 1
+        while self.leaf_count < capacity:
+            self.leaf_count *= 2
+        self.depth = self.leaf_count.bit_length() - 1
+        self.tree = np.zeros(2 * self.leaf_count, dtype=np.float64)
+
+    @property
+    def total(self) -> float:
+        """Sum of all leaf priorities."""
+        return float(self.tree[1])
+
+    def update(self, indices: np.ndarray, values: np.ndarray):
+        """
+        Set leaf values and refresh their ancestors.
+
+        Parents are recomputed from their children (not incremented), so
+        duplicate indices in one call are handled correctly.
+
+        Args:
+            indices: Leaf indices in [0, capacity)
+            values: New leaf values
+        """
+        nodes = np.asarray(indices, dtype=np.int64) + self.leaf_count
+        self.tree[nodes] = values
+
+        for _ in range(self.depth):
+            nodes = np.unique(nodes // 2)
+            self.tree[nodes] = self.tree[2 * nodes] + self.tree[2 * nodes + 1]
+
+    def get(self, indices: np.ndarray) -> np.ndarray:
+        """Read leaf values."""
+        return self.tree[np.asarray(indices, dtype=np.int64) + self.leaf_count]
+
+    def find(self, values: np.ndarray) -> np.ndarray:
+        """
+        Find the leaves whose prefix-sum interval contains each value.
+
+        Args:
+            values: Query points in [0, total)
+
+        Returns:
+            Leaf indices
+        """
+        values = np.array(values, dtype=np.float64)
+        nodes = np.ones(values.shape[0], dtype=np.int64)
+
+        for _ in range(self.depth):
+            left = 2 * nodes
+            left_sum = self.tree[left]
+            go_right = values >= left_sum
+            values = np.where(go_right, values - left_sum, values)
+            nodes = left + go_right
+
+        return nodes - self.leaf_count
+
+    def clear(self):
+        """Reset all priorities to zero."""
+        self.tree.fill(0.0)
 
 
 class PrioritizedReplayBuffer(ReplayBuffer):
@@ -108,19 +294,27 @@ class PrioritizedReplayBuffer(ReplayBuffer):
 
     Samples transitions based on their TD error, giving more importance
     to transitions with higher learning potential.
+
+    Priorities (raised to alpha) live in a SumTree, so sample() and
+    update_priorities() are O(batch * log capacity) rather than O(capacity).
+    Returned indices are ring-buffer slots and stay valid until overwritten.
     """
 
-    def __init__(self, capacity: int = 10000, alpha: float = 0.6):
+    # Keeps zero-TD-error transitions sampleable
+    PRIORITY_EPSILON = 1e-6
+
+    def __init__(self, capacity: int = 10000, alpha: float = 0.6, state_dim: Optional[int] = None):
         """
         Initialize prioritized replay buffer.
 
         Args:
             capacity: Maximum number of transitions
             alpha: Prioritization exponent (0 = uniform, 1 = full prioritization)
+            state_dim: Feature dimension (inferred from the first push if None)
         """
-        super().__init__(capacity)
+        super().__init__(capacity, state_dim)
         self.alpha = alpha
-        self.priorities = deque(maxlen=capacity)
+        self.tree = SumTree(capacity)
         self.max_priority = 1.0
 
     def push(
@@ -131,7 +325,7 @@ class PrioritizedReplayBuffer(ReplayBuffer):
         next_state: np.ndarray,
         done: bool,
         priority: float = None
-    ):
+    ) -> int:
         """
         Add a transition with priority.
 
@@ -142,13 +336,54 @@ class PrioritizedReplayBuffer(ReplayBuffer):
             next_state: Next state
             done: Whether episode ended
             priority: Priority value (defaults to max priority)
+
+        Returns:
+            Slot index the transition was written to
         """
-        super().push(state, action, reward, next_state, done)
+        idx = super().push(state, action, reward, next_state, done)
 
         if priority is None:
             priority = self.max_priority
 
-        self.priorities.append(priority)
+        self.tree.update(np.array([idx]), np.array([self._scaled(priority)]))
+
+        return idx
+
+    def push_batch(
+        self,
+        states: np.ndarray,
+        actions: np.ndarray,
+        rewards: np.ndarray,
+        next_states: np.ndarray,
+        dones: np.ndarray,
+        priorities: Optional[np.ndarray] = None
+    ) -> np.ndarray:
+        """
+        Add many transitions at once with optional per-row priorities.
+
+        Args:
+            states, actions, rewards, next_states, dones: Column arrays (see ReplayBuffer.push_batch)
+            priorities: Per-row priorities (defaults to max priority)
+
+        Returns:
+            Slot indices the transitions were written to
+        """
+        indices = super().push_batch(states, actions, rewards, next_states, dones)
+        if indices.size == 0:
+            return indices
+
+        if priorities is None:
+            priorities = np.full(indices.size, self.max_priority)
+        else:
+            priorities = np.asarray(priorities, dtype=np.float64)[-indices.size:]
+
+        self.tree.update(indices, self._scaled(priorities))
+
+        return indices
+
+    def _scaled(self, priorities):
+        """Convert raw priorities to stored sampling mass."""
+        return (np.abs(priorities) + self.PRIORITY_EPSILON) ** self.alpha
 
     def sample(
         self,
@@ -158,40 +393,36 @@ class PrioritizedReplayBuffer(ReplayBuffer):
         """
         Sample a mini-batch based on priorities.
 
+        Uses stratified sampling: the priority mass is split into batch_size
+        equal segments and one point is drawn from each.
+
         Args:
             batch_size: Number of transitions to sample
             beta: Importance sampling exponent (0 = no correction, 1 = full correction)
 
         Returns:
-            Tuple of (states, actions, rewards, next_states, dones, weights, indices)
-        """
-        if len(self.buffer) < batch_size:
-            batch_size = len(self.buffer)
-
-        # Calculate sampling probabilities
-        priorities = np.array(list(self.priorities), dtype=np.float32)
-        probabilities = priorities ** self.alpha
-        probabilities /= probabilities.sum()
-
-        # Sample indices based on probabilities
-        indices = np.random.choice(
-            len(self.buffer),
-            batch_size,
-            replace=False,
-            p=probabilities
-        )
+            Tuple of (states, actions, rewards, next_states, dones, weights, indices);
+            fewer than batch_size rows if the buffer holds fewer
+
+        Raises:
+            ValueError: If batch_size isn't positive or the buffer is empty
+        """
+        batch_size = self._check_sample_size(batch_size)
+
+        total = self.tree.total
+        segment = total / batch_size
+        points = (np.arange(batch_size) + np.random.random(batch_size)) * segment
+        points = np.minimum(points, np.nextafter(total, 0))
 
-        # Get transitions
-        batch = [self.buffer[idx] for idx in indices]
+        indices = self.tree.find(points)
+        # Float round-off can land past the filled region; clamp to valid slots
+        indices = np.minimum(indices, self.size - 1)
 
-        states = np.array([t[0] for t in batch], dtype=np.float32)
-        actions = np.array([t[1] for t in batch], dtype=np.int64)
-        rewards = np.array([t[2] for t in batch], dtype=np.float32)
-        next_states = np.array([t[3] for t in batch], dtype=np.float32)
-        dones = np.array([t[4] for t in batch], dtype=np.float32)
+        states, actions, rewards, next_states, dones = self._gather(indices)
 
         # Calculate importance sampling weights
-        weights = (len(self.buffer) * probabilities[indices]) ** (-beta)
+        probabilities = self.tree.get(indices) / total
+        weights = (self.size * probabilities) ** (-beta)
         weights /= weights.max()  # Normalize
         weights = weights.astype(np.float32)
 
@@ -205,14 +436,15 @@ class PrioritizedReplayBuffer(ReplayBuffer):
             indices: Indices of sampled transitions
             priorities: New priority values
         """
-        for idx, priority in zip(indices, priorities):
-            self.priorities[idx] = priority
-            self.max_priority = max(self.max_priority, priority)
+        priorities = np.asarray(priorities, dtype=np.float64)
+        self.tree.update(np.asarray(indices, dtype=np.int64), self._scaled(priorities))
+        if priorities.size:
+            self.max_priority = max(self.max_priority, float(np.abs(priorities).max()))
 
     def clear(self):
         """
         Clear all transitions and priorities.
         """
         super().clear()
-        self.priorities.clear()
+        self.tree.clear()
         self.max_priority = 1.0
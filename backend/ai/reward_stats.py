@@ -0,0 +1,76 @@
+"""
+Reward Statistics
+Streaming (Welford) mean/variance of observed rewards per state-action pair.
+
+Replaces per-pair reward lists: O(1) memory and O(1) update, with optional
+exponential forgetting so old behaviour fades out for long-lived users.
+"""
+
+from typing import Iterable, List
+
+
+class RewardStats:
+    """
+    Running count/mean/M2 accumulator (Welford's algorithm).
+
+    With decay < 1, count and M2 are scaled by decay before each update,
+    giving an exponentially weighted mean and variance whose effective
+    sample size converges to 1 / (1 - decay).
+    """
+
+    __slots__ = ("count", "mean", "m2")
+
+    def __init__(self, count: float = 0.0, mean: float = 0.0, m2: float = 0.0):
+        self.count = count
+        self.mean = mean
+        self.m2 = m2
+
+    def update(self, reward: float, decay: float = 1.0) -> None:
+        """
+        Add one observed reward.
+
+        Args:
+            reward: Observed reward
+            decay: Forgetting factor in (0, 1]; 1.0 = plain Welford
+        """
+        if decay < 1.0:
+            self.count *= decay
+            self.m2 *= decay
+
+        self.count += 1.0
+        delta = reward - self.mean
+        self.mean += delta / self.count
+        self.m2 += delta * (reward - self.mean)
+
+    @property
+    def variance(self) -> float:
+        """Population variance of observed rewards (0 with < 2 samples)."""
+        if self.count < 2:
+            return 0.0
+        return max(0.0, self.m2 / self.count)
+
+    def to_list(self) -> List[float]:
+        """Serialize as [count, mean, m2] (JSON-safe)."""
+        return [self.count, self.mean, self.m2]
+
+    @classmethod
+    def from_list(cls, values: List[float]) -> "RewardStats":
+        """Deserialize from [count, mean, m2]."""
+        count, mean, m2 = values
+        return cls(float(count), float(mean), float(m2))
+
+    @classmethod
+    def from_history(cls, rewards: Iterable[float], decay: float = 1.0) -> "RewardStats":
+        """Build statistics from a legacy reward list (oldest first)."""
+        stats = cls()
+        for reward in rewards:
+            stats.update(float(reward), decay)
+        return stats
+
+    def __eq__(self, other) -> bool:
+        if not isinstance(other, RewardStats):
+            return NotImplemented
+        return self.to_list() == other.to_list()
+
+    def __repr__(self) -> str:
+        return f"<RewardStats(count={self.count:.2f}, mean={self.mean:.4f}, var={self.variance:.4f})>"
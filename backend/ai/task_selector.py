@@ -3,6 +3,7 @@ Task Selector
 Maps action types to concrete tasks from the database.
 """
 
+import heapq
 from datetime import datetime, timedelta, timezone
 from typing import Optional, List
 from sqlalchemy.orm import Session
@@ -10,6 +11,7 @@ from sqlalchemy import desc, asc
 
 from .actions import ActionType, ACTION_TYPES
 from .state import UserState
+from .user_context import UserContextSnapshot, TaskInfo
 
 
 class TaskSelector:
@@ -22,6 +24,9 @@ class TaskSelector:
     - Other actions don't map to tasks
     """
 
+    # Rows fetched per round trip when streaming candidates
+    STREAM_BATCH_SIZE = 200
+
     # Action type to task filtering criteria
     TASK_CRITERIA = {
         ActionType.DEEP_FOCUS: {
@@ -41,7 +46,8 @@ class TaskSelector:
         action: ActionType,
         state: UserState,
         db: Session,
-        user_id: int
+        user_id: int,
+        context: Optional[UserContextSnapshot] = None
     ) -> Optional["Task"]:
         """
         Select the best task for the given action type.
@@ -51,59 +57,98 @@ class TaskSelector:
             state: Current user state
             db: Database session
             user_id: The user to select tasks for
+            context: Preloaded user snapshot (candidates come from it, no query)
+
+        Returns:
+            Best matching task (a TaskInfo projection) or None if no task fits
+        """
+        top = self.select_top_tasks(action, state, db, user_id, 1, context)
+        return top[0] if top else None
+
+    def select_top_tasks(
+        self,
+        action: ActionType,
+        state: UserState,
+        db: Session,
+        user_id: int,
+        k: int,
+        context: Optional[UserContextSnapshot] = None,
+        match_duration: bool = True
+    ) -> List[TaskInfo]:
+        """
+        Get the k best-scoring tasks for an action.
+
+        Filtering (user, status, priority range, duration cap) runs in SQL
+        against ix_tasks_user_active_priority; only a column projection is
+        streamed back, and heapq.nlargest keeps just k rows in memory instead
+        of materializing and sorting every candidate ORM object.
+
+        Args:
+            action: The recommended action type
+            state: Current user state
+            db: Database session
+            user_id: The user to select tasks for
+            k: Number of tasks to return
+            context: Preloaded user snapshot (candidates come from it, no query)
+            match_duration: Apply the action's max duration filter
 
         Returns:
-            Best matching Task or None if no task fits
+            Up to k TaskInfo records, best first
         """
         from models.task import Task
 
         # Actions that don't require tasks
         if action not in (ActionType.DEEP_FOCUS, ActionType.LIGHT_TASK):
-            return None
+            return []
 
         criteria = self.TASK_CRITERIA.get(action)
-        if not criteria:
-            return None
-
-        # Build base query (filter by user_id for multi-user support)
-        query = db.query(Task).filter(
-            Task.user_id == user_id,
-            Task.status == "pending",
-            Task.is_deleted == False,
-            Task.is_archived == False,
-        )
+        if not criteria or k <= 0:
+            return []
 
-        # Apply priority filter
-        if "min_priority" in criteria:
-            query = query.filter(Task.priority >= criteria["min_priority"])
-        if "max_priority" in criteria:
-            query = query.filter(Task.priority <= criteria["max_priority"])
-
-        # Apply duration filter if task has estimated_duration
-        if "max_duration_minutes" in criteria:
-            max_dur = criteria["max_duration_minutes"]
-            query = query.filter(
-                (Task.estimated_duration == None) |
-                (Task.estimated_duration <= max_dur)
+        if context is not None:
+            candidates = self._filter_snapshot(context, criteria, match_duration)
+        else:
+            # Build base query (filter by user_id for multi-user support)
+            query = db.query(*TaskInfo.columns()).filter(
+                Task.user_id == user_id,
+                Task.status == "pending",
+                Task.is_deleted == False,
+                Task.is_archived == False,
             )
 
-        # Get candidates
-        candidates = query.all()
-
-        if not candidates:
-            return None
-
-        # Score and rank candidates
-        scored = [(task, self._score_task(task, action, state)) for task in candidates]
-        scored.sort(key=lambda x: x[1], reverse=True)
+            # Apply priority filter
+            if "min_priority" in criteria:
+                query = query.filter(Task.priority >= criteria["min_priority"])
+            if "max_priority" in criteria:
+                query = query.filter(Task.priority <= criteria["max_priority"])
+
+            # Apply duration filter if task has estimated_duration
+            if match_duration and "max_duration_minutes" in criteria:
+                max_dur = criteria["max_duration_minutes"]
+                query = query.filter(
+                    (Task.estimated_duration == None) |
+                    (Task.estimated_duration <= max_dur)
+                )
+
+            candidates = (
+                TaskInfo.from_row(row)
+                for row in query.yield_per(self.STREAM_BATCH_SIZE)
+            )
 
-        return scored[0][0]
+        # Score and keep the top k; ties go to the older task (lower id) so
+        # the result doesn't depend on the row order the query plan produces
+        now = datetime.now(timezone.utc)
+        return heapq.nlargest(
+            k, candidates,
+            key=lambda task: (self._score_task(task, action, state, now), -task.id)
+        )
 
     def _score_task(
         self,
         task: "Task",
         action: ActionType,
-        state: UserState
+        state: UserState,
+        now: Optional[datetime] = None
     ) -> float:
         """
         Score a task's suitability for the current context.
@@ -114,11 +159,11 @@ class TaskSelector:
         - Duration match
         """
         score = 0.0
-        criteria = self.TASK_CRITERIA.get(action, {})
+        if now is None:
+            now = datetime.now(timezone.utc)
 
         # Deadline proximity (higher score for closer deadlines)
         if task.deadline:
-            now = datetime.now(timezone.utc)
             hours_until_deadline = (task.deadline - now).total_seconds() / 3600
 
             if hours_until_deadline <= 0:
@@ -146,7 +191,7 @@ class TaskSelector:
 
         # Slight preference for older tasks (avoid starvation)
         if task.created_at:
-            days_old = (datetime.now(timezone.utc) - task.created_at).days
+            days_old = (now - task.created_at).days
             score += min(days_old * 0.1, 1.0)  # Max 1 point for age
 
         return score
@@ -157,7 +202,8 @@ class TaskSelector:
         state: UserState,
         db: Session,
         user_id: int,
-        limit: int = 3
+        limit: int = 3,
+        context: Optional[UserContextSnapshot] = None
     ) -> List["Task"]:
         """
         Get multiple task suggestions ranked by suitability.
@@ -168,35 +214,36 @@ class TaskSelector:
             db: Database session
             user_id: The user to get suggestions for
             limit: Maximum number of suggestions
+            context: Preloaded user snapshot (candidates come from it, no query)
 
         Returns:
-            List of Task objects, ordered by suitability
+            List of tasks (TaskInfo projections), ordered by suitability
         """
-        from models.task import Task
-
-        if action not in (ActionType.DEEP_FOCUS, ActionType.LIGHT_TASK):
-            return []
-
-        criteria = self.TASK_CRITERIA.get(action, {})
-
-        # Build query (filter by user_id for multi-user support)
-        query = db.query(Task).filter(
-            Task.user_id == user_id,
-            Task.status == "pending",
-            Task.is_deleted == False,
-            Task.is_archived == False,
+        return self.select_top_tasks(
+            action, state, db, user_id, limit, context, match_duration=False
         )
 
-        # Apply filters
-        if "min_priority" in criteria:
-            query = query.filter(Task.priority >= criteria["min_priority"])
-        if "max_priority" in criteria:
-            query = query.filter(Task.priority <= criteria["max_priority"])
-
-        candidates = query.all()
-
-        # Score and sort
-        scored = [(task, self._score_task(task, action, state)) for task in candidates]
-        scored.sort(key=lambda x: x[1], reverse=True)
-
-        return [task for task, _ in scored[:limit]]
+    def _filter_snapshot(
+        self,
+        context: UserContextSnapshot,
+        criteria: dict,
+        match_duration: bool
+    ) -> List[TaskInfo]:
+        """Apply the same candidate filters as the SQL path to snapshot tasks."""
+        candidates = []
+        for task in context.pending_tasks:
+            if task.is_archived:
+                continue
+            if "min_priority" in criteria and task.priority < criteria["min_priority"]:
+                continue
+            if "max_priority" in criteria and task.priority > criteria["max_priority"]:
+                continue
+            if (
+                match_duration
+                and "max_duration_minutes" in criteria
+                and task.estimated_duration is not None
+                and task.estimated_duration > criteria["max_duration_minutes"]
+            ):
+                continue
+            candidates.append(task)
+        return candidates
@@ -0,0 +1,358 @@
+"""
+User Context Snapshot
+Per-request view of the user data the recommendation pipeline reads.
+
+ContextEncoder, ActionMasker and TaskSelector used to query tasks and moods
+independently (and the router queried mood again for logging). A snapshot
+loads pending tasks, the latest mood, today's completion count and the
+schedule blocks once, as lightweight column-only records, and every stage
+reads from it. Snapshots are cached for a few seconds and dropped whenever
+the user's tasks, moods or schedule blocks are written.
+"""
+
+import threading
+import time
+from dataclasses import dataclass, field
+from datetime import datetime, timezone
+from typing import Dict, List, Optional
+
+from sqlalchemy import event
+from sqlalchemy.orm import Session
+
+from .config import AIConfig
+
+
+def _as_utc(value: Optional[datetime]) -> Optional[datetime]:
+    """Treat naive datetimes (SQLite) as UTC so comparisons never mix kinds."""
+    if value is not None and value.tzinfo is None:
+        return value.replace(tzinfo=timezone.utc)
+    return value
+
+
+@dataclass(frozen=True)
+class TaskInfo:
+    """Column-only view of a pending Task (duck-types the fields AI code reads)."""
+    id: int
+    title: str
+    priority: int
+    estimated_duration: Optional[int]
+    duration: Optional[float]
+    deadline: Optional[datetime]
+    status: str
+    is_archived: bool
+    created_at: Optional[datetime]
+
+    @classmethod
+    def columns(cls) -> tuple:
+        """Task columns to select for a TaskInfo projection."""
+        from models.task import Task
+        return (
+            Task.id, Task.title, Task.priority, Task.estimated_duration,
+            Task.duration, Task.deadline, Task.status, Task.is_archived,
+            Task.created_at,
+        )
+
+    @classmethod
+    def from_row(cls, row) -> "TaskInfo":
+        """Build from a row selected with columns()."""
+        return cls(
+            id=row.id,
+            title=row.title,
+            priority=row.priority if row.priority is not None else 3,
+            estimated_duration=row.estimated_duration,
+            duration=row.duration,
+            deadline=_as_utc(row.deadline),
+            status=row.status,
+            is_archived=bool(row.is_archived),
+            created_at=_as_utc(row.created_at),
+        )
+
+
+@dataclass(frozen=True)
+class MoodInfo:
+    """Latest mood entry."""
+    mood: str
+    timestamp: Optional[datetime]
+
+
+@dataclass(frozen=True)
+class BlockInfo:
+    """Column-only view of a ScheduleBlock."""
+    id: int
+    task_id: Optional[int]
+    title: str
+    start: float
+    duration: float
+    block_type: str
+
+    @property
+    def end(self) -> float:
+        """Calculate end hour."""
+        return self.start + self.duration
+
+
+@dataclass
+class UserContextSnapshot:
+    """
+    Everything one recommendation needs to know about a user.
+
+    Loaded with a fixed number of queries regardless of how many pipeline
+    stages consume it.
+    """
+    user_id: int
+    day_start: datetime
+    pending_tasks: List[TaskInfo] = field(default_factory=list)
+    latest_mood: Optional[MoodInfo] = None
+    tasks_completed_today: int = 0
+    schedule_blocks: List[BlockInfo] = field(default_factory=list)
+
+    @classmethod
+    def load(
+        cls,
+        db: Session,
+        user_id: int,
+        current_time: Optional[datetime] = None
+    ) -> "UserContextSnapshot":
+        """
+        Load a snapshot from the database (four queries).
+
+        Args:
+            db: Database session
+            user_id: User to load
+            current_time: Reference time for "today" (defaults to now)
+
+        Returns:
+            UserContextSnapshot
+        """
+        from models.mood import MoodEntry
+        from models.schedule import ScheduleBlock
+        from models.task import Task
+
+        if current_time is None:
+            current_time = datetime.now(timezone.utc)
+        day_start = current_time.replace(hour=0, minute=0, second=0, microsecond=0)
+
+        task_rows = db.query(*TaskInfo.columns()).filter(
+            Task.user_id == user_id,
+            Task.status == "pending",
+            Task.is_deleted == False,
+        ).all()
+
+        mood_row = db.query(MoodEntry.mood, MoodEntry.timestamp).filter(
+            MoodEntry.user_id == user_id
+        ).order_by(MoodEntry.timestamp.desc()).first()
+
+        completed_today = db.query(Task.id).filter(
+            Task.user_id == user_id,
+            Task.status == "completed",
+            Task.completed_at >= day_start,
+            Task.is_deleted == False,
+        ).count()
+
+        block_rows = db.query(
+            ScheduleBlock.id, ScheduleBlock.task_id, ScheduleBlock.title,
+            ScheduleBlock.start, ScheduleBlock.duration, ScheduleBlock.block_type,
+        ).filter(
+            ScheduleBlock.user_id == user_id
+        ).order_by(ScheduleBlock.start).all()
+
+        return cls(
+            user_id=user_id,
+            day_start=day_start,
+            pending_tasks=[TaskInfo.from_row(row) for row in task_rows],
+            latest_mood=MoodInfo(mood_row.mood, _as_utc(mood_row.timestamp)) if mood_row else None,
+            tasks_completed_today=completed_today,
+            schedule_blocks=[
+                BlockInfo(
+                    id=row.id,
+                    task_id=row.task_id,
+                    title=row.title,
+                    start=row.start,
+                    duration=row.duration,
+                    block_type=row.block_type,
+                )
+                for row in block_rows
+            ],
+        )
+
+    def latest_mood_since(self, since: datetime) -> Optional[MoodInfo]:
+        """Get the latest mood if it was recorded at or after `since`."""
+        mood = self.latest_mood
+        if mood is None or mood.timestamp is None:
+            return None
+        return mood if mood.timestamp >= _as_utc(since) else None
+
+    @property
+    def pending_count(self) -> int:
+        """Number of pending, non-deleted tasks."""
+        return len(self.pending_tasks)
+
+    def count_pending_with_priority(self, min_priority: int) -> int:
+        """Number of pending tasks with priority >= min_priority."""
+        return sum(1 for task in self.pending_tasks if task.priority >= min_priority)
+
+    def has_deadline_before(self, threshold: datetime) -> bool:
+        """Whether any pending task is due at or before `threshold`."""
+        threshold = _as_utc(threshold)
+        return any(
+            task.deadline is not None and task.deadline <= threshold
+            for task in self.pending_tasks
+        )
+
+    def get_task(self, task_id: int) -> Optional[TaskInfo]:
+        """Look up a pending task by id."""
+        for task in self.pending_tasks:
+            if task.id == task_id:
+                return task
+        return None
+
+
+class UserContextCache:
+    """
+    Short-TTL, thread-safe cache of UserContextSnapshot per user.
+
+    Committed writes to a user's tasks, moods or schedule blocks invalidate
+    their entry (see the Session listeners below); the TTL bounds staleness for writes
+    that bypass the ORM unit of work (bulk Query.delete/update).
+    """
+
+    def __init__(self, ttl_seconds: float = AIConfig.CONTEXT_CACHE_TTL_SECONDS):
+        self.ttl_seconds = ttl_seconds
+        self._entries: Dict[int, tuple] = {}  # user_id -> (expires_at, snapshot)
+        self._generations: Dict[int, int] = {}  # Bumped on invalidate
+        self._lock = threading.Lock()
+        self.hits = 0
+        self.misses = 0
+
+    def get(
+        self,
+        db: Session,
+        user_id: int,
+        current_time: Optional[datetime] = None
+    ) -> UserContextSnapshot:
+        """
+        Get a fresh-enough snapshot, loading it on a miss.
+
+        Args:
+            db: Database session (used only on a miss)
+            user_id: User ID
+            current_time: Reference time; a snapshot from another day is reloaded
+
+        Returns:
+            UserContextSnapshot
+        """
+        if current_time is None:
+            current_time = datetime.now(timezone.utc)
+        day_start = current_time.replace(hour=0, minute=0, second=0, microsecond=0)
+        now = time.monotonic()
+
+        with self._lock:
+            entry = self._entries.get(user_id)
+            if entry is not None and entry[0] > now and entry[1].day_start == day_start:
+                self.hits += 1
+                return entry[1]
+            self.misses += 1
+            generation = self._generations.get(user_id, 0)
+
+        snapshot = UserContextSnapshot.load(db, user_id, current_time)
+
+        with self._lock:
+            # Don't cache a snapshot that raced with a write
+            if self._generations.get(user_id, 0) == generation and self.ttl_seconds > 0:
+                self._entries[user_id] = (now + self.ttl_seconds, snapshot)
+        return snapshot
+
+    def peek(
+        self,
+        user_id: int,
+        current_time: Optional[datetime] = None
+    ) -> Optional[UserContextSnapshot]:
+        """
+        Get a fresh-enough cached snapshot without loading one on a miss.
+
+        For callers that need only part of the snapshot and can fetch that
+        part in one query, rather than the four a full load costs.
+
+        Args:
+            user_id: User ID
+            current_time: Reference time; a snapshot from another day is a miss
+
+        Returns:
+            UserContextSnapshot, or None if none is cached
+        """
+        if current_time is None:
+            current_time = datetime.now(timezone.utc)
+        day_start = current_time.replace(hour=0, minute=0, second=0, microsecond=0)
+
+        with self._lock:
+            entry = self._entries.get(user_id)
+            if entry is not None and entry[0] > time.monotonic() and entry[1].day_start == day_start:
+                self.hits += 1
+                return entry[1]
+        return None
+
+    def invalidate(self, user_id: Optional[int]) -> None:
+        """Drop a user's cached snapshot."""
+        if user_id is None:
+            return
+        with self._lock:
+            self._entries.pop(user_id, None)
+            self._generations[user_id] = self._generations.get(user_id, 0) + 1
+
+    def clear(self) -> None:
+        """Drop all cached snapshots."""
+        with self._lock:
+            self._entries.clear()
+            self._generations.clear()
+
+    def get_stats(self) -> Dict:
+        """Get cache size and hit/miss counts."""
+        with self._lock:
+            return {
+                "size": len(self._entries),
+                "hits": self.hits,
+                "misses": self.misses,
+                "ttl_seconds": self.ttl_seconds,
+            }
+
+
+# Process-wide cache shared by the recommender and routers
+user_context_cache = UserContextCache()
+
+
+def invalidate_user_context(user_id: Optional[int]) -> None:
+    """Invalidate a user's cached context (call after bulk writes)."""
+    user_context_cache.invalidate(user_id)
+
+
+_CONTEXT_TABLES = frozenset({"tasks", "mood_entries", "schedule_blocks"})
+
+
+_PENDING_INVALIDATIONS = "user_context_invalidations"
+
+
+@event.listens_for(Session, "after_flush")
+def _collect_on_flush(session: Session, flush_context) -> None:
+    """Record users whose tasks, moods or blocks were flushed (invalidated on commit)."""
+    for instance in (*session.new, *session.dirty, *session.deleted):
+        if getattr(instance, "__tablename__", None) in _CONTEXT_TABLES:
+            user_id = getattr(instance, "user_id", None)
+            if user_id is not None:
+                session.info.setdefault(_PENDING_INVALIDATIONS, set()).add(user_id)
+
+
+@event.listens_for(Session, "after_commit")
+def _invalidate_on_commit(session: Session) -> None:
+    """
+    Invalidate after the commit, not at flush: a reader loading between the
+    flush and the commit still sees the old rows, and would otherwise cache
+    them for the full TTL.
+    """
+    for user_id in session.info.pop(_PENDING_INVALIDATIONS, ()):
+        user_context_cache.invalidate(user_id)
+
+
+@event.listens_for(Session, "after_rollback")
+def _discard_on_rollback(session: Session) -> None:
+    """Rolled-back writes never became visible; nothing to invalidate."""
+    session.info.pop(_PENDING_INVALIDATIONS, None)
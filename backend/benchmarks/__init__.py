@@ -0,0 +1,5 @@
+"""
+PULSE Benchmarks
+Standalone performance scripts. run_benchmarks.py drives micro.py and
+load.py and compares them with a recorded baseline.
+"""
@@ -0,0 +1,86 @@
+"""
+Shared Benchmark Helpers
+Scratch database setup, seeding and percentiles for the benchmark scripts.
+
+use_temp_database() must run before anything imports models.base, because
+the engines are created from DATABASE_URL at import time.
+"""
+
+import contextlib
+import io
+import os
+import random
+import tempfile
+from typing import List
+
+BENCH_PASSWORD = "benchpass123"
+
+
+def use_temp_database() -> str:
+    """
+    Point DATABASE_URL at a fresh SQLite file (keeps data/pulse.db untouched).
+
+    Returns:
+        Path of the scratch database
+    """
+    import sys
+    if "models.base" in sys.modules:
+        raise RuntimeError("use_temp_database() must run before models.base is imported")
+
+    directory = tempfile.mkdtemp(prefix="pulse-bench-")
+    path = os.path.join(directory, "bench.db")
+    os.environ["DATABASE_URL"] = f"sqlite:///{path}"
+    return path
+
+
+def seed_users(db, count: int, seed: int = 42, prefix: str = "bench") -> List[int]:
+    """
+    Create `count` users with seed_data.py's tasks, moods, schedule and
+    reflections, plus a few random extra tasks each so users differ.
+
+    Args:
+        db: Database session
+        count: Number of users
+        seed: RNG seed for the extra tasks
+        prefix: Username/email prefix (keeps separate seedings apart)
+
+    Returns:
+        User IDs
+    """
+    from core.auth import hash_password
+    from models.task import Task
+    from models.user import User
+    import seed_data
+
+    rng = random.Random(seed)
+    password_hash = hash_password(BENCH_PASSWORD)  # bcrypt once, not per user
+    user_ids = []
+    for i in range(count):
+        user = User(
+            email=f"{prefix}{i}@pulse.app", username=f"{prefix}{i}",
+            password_hash=password_hash, is_active=True,
+        )
+        db.add(user)
+        db.commit()
+        user_ids.append(user.id)
+
+        with contextlib.redirect_stdout(io.StringIO()):  # seed_data prints per call
+            seed_data.seed_tasks(db, user.id)
+            seed_data.seed_moods(db, user.id)
+            seed_data.seed_schedule(db, user.id)
+            seed_data.seed_reflections(db, user.id)
+
+        for j in range(rng.randint(0, 10)):
+            db.add(Task(
+                user_id=user.id, title=f"Extra task {j}", priority=rng.randint(1, 5),
+                status="pending", duration=rng.choice([0.5, 1.0, 2.0]),
+            ))
+        db.commit()
+    return user_ids
+
+
+def percentile(values: List[float], fraction: float) -> float:
+    if not values:
+        return float("nan")
+    ordered = sorted(values)
+    return ordered[min(len(ordered) - 1, int(fraction * len(ordered)))]
@@ -0,0 +1,273 @@
+"""
+Multi-User Load Generator
+Drives the recommendation, feedback and extension sync endpoints with many
+concurrent clients against a seeded scratch database.
+
+Usage (from backend/):
+    python benchmarks/load.py
+    python benchmarks/load.py --users 50 --clients 32 --rounds 20
+
+The app runs in-process behind httpx's ASGI transport (sync routes go
+through the same thread pool as under uvicorn, without socket overhead).
+Each virtual client repeatedly picks a random seeded user and runs:
+    GET  /ai/recommendation
+    POST /ai/feedback            (for that recommendation)
+    POST /api/v1/extension/sync  (a few hourly sessions)
+
+Reported per endpoint: p50/p99 latency and SQL statements per request,
+counted by an engine listener and attributed to the request through a
+context variable.
+"""
+
+import argparse
+import asyncio
+import contextvars
+import os
+import random
+import sys
+import time
+from datetime import datetime, timedelta, timezone
+from typing import Dict, List, Optional
+
+# Add parent directory to path for imports
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+from benchmarks.common import percentile
+
+OUTCOMES = ["completed", "partial", "skipped", "ignored"]
+SESSIONS_PER_SYNC = 6
+QUERY_HEADER = "x-bench-queries"
+
+_request_queries: contextvars.ContextVar[Optional[List[int]]] = contextvars.ContextVar(
+    "bench_request_queries", default=None
+)
+
+
+class QueryCountingApp:
+    """
+    ASGI wrapper that counts SQL statements per request.
+
+    The count is returned in the x-bench-queries response header. Sync
+    routes run in worker threads, which inherit the request's context, so
+    their statements land on the right counter.
+    """
+
+    def __init__(self, app, engines):
+        from sqlalchemy import event
+
+        self.app = app
+        for engine in set(engines):
+            event.listen(engine, "before_cursor_execute", self._count)
+
+    @staticmethod
+    def _count(*_args):
+        counter = _request_queries.get()
+        if counter is not None:
+            counter[0] += 1
+
+    async def __call__(self, scope, receive, send):
+        if scope["type"] != "http":
+            await self.app(scope, receive, send)
+            return
+
+        counter = [0]
+        token = _request_queries.set(counter)
+
+        async def send_with_count(message):
+            if message["type"] == "http.response.start":
+                message = dict(message)
+                message["headers"] = list(message.get("headers", [])) + [
+                    (QUERY_HEADER.encode(), str(counter[0]).encode())
+                ]
+            await send(message)
+
+        try:
+            await self.app(scope, receive, send_with_count)
+        finally:
+            _request_queries.reset(token)
+
+
+def _sync_payload(rng: random.Random, prefix: str) -> Dict:
+    start = datetime(2025, 1, 1, tzinfo=timezone.utc) + timedelta(hours=rng.randint(0, 24 * 365))
+    sessions = []
+    for hour in range(SESSIONS_PER_SYNC):
+        timestamp = start + timedelta(hours=hour)
+        work = rng.randint(0, 40)
+        sessions.append({
+            "session_id": f"{prefix}-{hour}",
+            "timestamp": timestamp.isoformat(),
+            "hour_key": timestamp.strftime("%Y-%m-%dT%H"),
+            "duration_minutes": 60,
+            "category_distribution": {"work": work, "leisure": 40 - work, "social": 10, "neutral": 10},
+            "metrics": {
+                "tab_switches": rng.randint(0, 60), "window_focus_changes": rng.randint(0, 10),
+                "avg_focus_duration_minutes": round(rng.uniform(0, 30), 2),
+                "distraction_rate_per_hour": round(rng.uniform(0, 60), 2),
+                "unique_domains": rng.randint(1, 20),
+            },
+            "event_count": rng.randint(10, 100),
+        })
+    return {"sessions": sessions, "timestamp": int(time.time() * 1000)}
+
+
+async def _client_loop(
+    client,
+    client_id: int,
+    tokens: Dict[int, str],
+    rounds: int,
+    seed: int,
+    samples: Optional[Dict[str, Dict[str, List]]]
+) -> None:
+    """One virtual client; samples=None runs unrecorded (warm-up)."""
+    rng = random.Random(seed * 1000 + client_id)
+    user_ids = sorted(tokens)
+
+    async def call(name: str, method: str, path: str, **kwargs):
+        started = time.perf_counter()
+        response = await client.request(method, path, **kwargs)
+        elapsed = time.perf_counter() - started
+        if samples is not None:
+            bucket = samples[name]
+            if response.status_code >= 400:
+                bucket["errors"].append(response.status_code)
+            else:
+                bucket["latencies"].append(elapsed)
+                bucket["queries"].append(int(response.headers.get(QUERY_HEADER, 0)))
+        return response
+
+    for n in range(rounds):
+        user_id = rng.choice(user_ids)
+        headers = {"Authorization": f"Bearer {tokens[user_id]}"}
+
+        response = await call("recommendation", "GET", "/ai/recommendation", headers=headers)
+        if response.status_code == 200:
+            await call("feedback", "POST", "/ai/feedback", headers=headers, json={
+                "recommendation_id": response.json()["recommendation_id"],
+                "outcome": rng.choice(OUTCOMES),
+                "rating": rng.randint(1, 5),
+            })
+
+        prefix = f"load-{'w' if samples is None else 'm'}-{client_id}-{n}"
+        await call("sync", "POST", "/api/v1/extension/sync", headers=headers,
+                   json=_sync_payload(rng, prefix))
+
+
+async def _drive(app, tokens: Dict[int, str], clients: int, rounds: int, warmup: int, seed: int):
+    import httpx
+
+    samples = {
+        name: {"latencies": [], "queries": [], "errors": []}
+        for name in ("recommendation", "feedback", "sync")
+    }
+    transport = httpx.ASGITransport(app=app)
+    async with httpx.AsyncClient(transport=transport, base_url="http://bench", timeout=60.0) as client:
+        if warmup:
+            await asyncio.gather(*(
+                _client_loop(client, i, tokens, warmup, seed, None) for i in range(clients)
+            ))
+        started = time.perf_counter()
+        await asyncio.gather(*(
+            _client_loop(client, i, tokens, rounds, seed, samples) for i in range(clients)
+        ))
+        elapsed = time.perf_counter() - started
+    return samples, elapsed
+
+
+def run_load(
+    users: int = 20,
+    clients: int = 16,
+    rounds: int = 10,
+    warmup: int = 1,
+    seed: int = 42
+) -> Dict[str, Dict]:
+    """
+    Seed a scratch database and run the mixed workload.
+
+    Requires benchmarks.common.use_temp_database() to have run first.
+
+    Args:
+        users: Seeded users
+        clients: Concurrent virtual clients
+        rounds: Recorded recommendation/feedback/sync rounds per client
+        warmup: Unrecorded rounds per client first (imports, caches)
+        seed: Seed for the data and the request mix
+
+    Returns:
+        {endpoint: {"requests", "errors", "p50_ms", "p99_ms", "queries_per_request"}}
+        plus "_total": {"requests", "seconds", "requests_per_second"}
+    """
+    from benchmarks.common import seed_users
+    from core.auth import create_user_token
+    from main import app
+    from models.base import SessionLocal, engine, init_db, read_engine
+    from models.user import User
+
+    random.seed(seed)  # Exploration in the agents
+    try:
+        import numpy as np
+        np.random.seed(seed)
+    except ImportError:
+        pass
+
+    init_db()
+    db = SessionLocal()
+    try:
+        user_ids = seed_users(db, users, seed)
+        tokens = {
+            user.id: create_user_token(user)
+            for user in db.query(User).filter(User.id.in_(user_ids))
+        }
+    finally:
+        db.close()
+
+    counted_app = QueryCountingApp(app, [engine, read_engine])
+    samples, elapsed = asyncio.run(_drive(counted_app, tokens, clients, rounds, warmup, seed))
+
+    results: Dict[str, Dict] = {}
+    total = 0
+    for name, bucket in samples.items():
+        latencies, queries = bucket["latencies"], bucket["queries"]
+        total += len(latencies) + len(bucket["errors"])
+        results[name] = {
+            "requests": len(latencies),
+            "errors": len(bucket["errors"]),
+            "p50_ms": round(percentile(latencies, 0.5) * 1000, 3),
+            "p99_ms": round(percentile(latencies, 0.99) * 1000, 3),
+            "queries_per_request": round(sum(queries) / len(queries), 2) if queries else float("nan"),
+        }
+    results["_total"] = {
+        "requests": total,
+        "seconds": round(elapsed, 3),
+        "requests_per_second": round(total / elapsed, 1) if elapsed else 0.0,
+    }
+    return results
+
+
+def print_load(results: Dict[str, Dict]) -> None:
+    print(f"{'endpoint':<16} {'requests':>9} {'errors':>7} {'p50 ms':>9} {'p99 ms':>9} {'queries':>8}")
+    for name, result in results.items():
+        if name.startswith("_"):
+            continue
+        print(
+            f"{name:<16} {result['requests']:>9} {result['errors']:>7} {result['p50_ms']:>9.2f} "
+            f"{result['p99_ms']:>9.2f} {result['queries_per_request']:>8.2f}"
+        )
+    total = results["_total"]
+    print(f"{total['requests']} requests in {total['seconds']:.1f}s ({total['requests_per_second']:.1f} req/s)")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Multi-user load generator")
+    parser.add_argument("--users", type=int, default=20, help="Seeded users")
+    parser.add_argument("--clients", type=int, default=16, help="Concurrent virtual clients")
+    parser.add_argument("--rounds", type=int, default=10, help="Recorded rounds per client")
+    parser.add_argument("--seed", type=int, default=42, help="Data and request-mix seed")
+    args = parser.parse_args()
+
+    from benchmarks.common import use_temp_database
+    use_temp_database()
+    print_load(run_load(args.users, args.clients, args.rounds, seed=args.seed))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,204 @@
+"""
+AI Microbenchmarks
+Per-call latency of the hot AI building blocks, measured in-process.
+
+Usage (from backend/):
+    python benchmarks/micro.py
+    python benchmarks/micro.py --scale 0.2    # Quicker, noisier
+
+Each benchmark runs `number` calls per sample and reports the p50/p99 of
+the per-call time over the samples. Benchmarks whose dependencies are
+missing (numpy, torch) are reported as skipped.
+"""
+
+import argparse
+import os
+import random
+import sys
+import time
+from datetime import datetime, timedelta, timezone
+from typing import Callable, Dict, List, Tuple
+
+# Add parent directory to path for imports
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+from benchmarks.common import percentile
+
+SAMPLES = 30
+
+# Fixed reference time so the encoded state is the same on every run
+NOW = datetime(2025, 1, 15, 10, 30, tzinfo=timezone.utc)
+
+
+def time_calls(func: Callable[[], object], number: int, samples: int = SAMPLES) -> Dict[str, float]:
+    """
+    Time `number` calls per sample after one warm-up call.
+
+    Returns:
+        {"p50_us", "p99_us", "calls"}
+    """
+    func()
+    per_call: List[float] = []
+    for _ in range(samples):
+        started = time.perf_counter()
+        for _ in range(number):
+            func()
+        per_call.append((time.perf_counter() - started) / number * 1e6)
+    return {
+        "p50_us": round(percentile(per_call, 0.5), 3),
+        "p99_us": round(percentile(per_call, 0.99), 3),
+        "calls": number * samples,
+    }
+
+
+def _state_benchmarks(db, user_id: int) -> List[Tuple[str, Callable, int]]:
+    """ContextEncoder, ActionMasker and ScheduleAgent (pure Python + DB reads)."""
+    from ai.action_masker import ActionMasker
+    from ai.agent import ScheduleAgent
+    from ai.context_encoder import ContextEncoder
+    from ai.user_context import UserContextSnapshot
+
+    encoder = ContextEncoder()
+    masker = ActionMasker()
+    context = UserContextSnapshot.load(db, user_id, NOW)
+    state = encoder.encode(db, NOW, user_id, context=context)
+    valid_actions = masker.get_valid_actions(state, db, user_id, context=context)
+
+    agent = ScheduleAgent(user_id)  # Fresh tables, never persisted
+    rng = random.Random(7)
+
+    def update():
+        agent.update(state, rng.choice(valid_actions), rng.uniform(-1.0, 1.0))
+
+    return [
+        ("UserContextSnapshot.load", lambda: UserContextSnapshot.load(db, user_id, NOW), 20),
+        ("ContextEncoder.encode[snapshot]", lambda: encoder.encode(db, NOW, user_id, context=context), 2000),
+        ("ContextEncoder.encode[db]", lambda: encoder.encode(db, NOW, user_id), 20),
+        ("ActionMasker.get_valid_actions", lambda: masker.get_valid_actions(state, db, user_id, context=context), 2000),
+        ("ScheduleAgent.recommend", lambda: agent.recommend(state, valid_actions), 5000),
+        ("ScheduleAgent.update", update, 5000),
+    ]
+
+
+def _replay_benchmarks() -> List[Tuple[str, Callable, int]]:
+    import numpy as np
+    from ai.replay_buffer import ReplayBuffer
+
+    rng = np.random.default_rng(7)
+    buffer = ReplayBuffer(capacity=10000, state_dim=12)
+    buffer.push_batch(
+        rng.random((10000, 12), dtype=np.float32), rng.integers(0, 10, 10000),
+        rng.random(10000, dtype=np.float32), rng.random((10000, 12), dtype=np.float32),
+        np.zeros(10000, dtype=np.float32),
+    )
+    return [("ReplayBuffer.sample[64]", lambda: buffer.sample(64), 2000)]
+
+
+def _feature_benchmarks() -> List[Tuple[str, Callable, int]]:
+    from ai.feature_encoder import FeatureEncoder
+
+    encoder = FeatureEncoder()
+    rng = random.Random(7)
+    start = NOW.replace(hour=0, minute=0)
+    sessions = []
+    for hour in range(24):
+        work = rng.randint(0, 40)
+        sessions.append({
+            "timestamp": start + timedelta(hours=hour),
+            "duration_minutes": 60,
+            "category_distribution": {"work": work, "leisure": 40 - work, "social": 10, "neutral": 10},
+            "metrics": {
+                "tab_switches": rng.randint(0, 60), "window_focus_changes": rng.randint(0, 10),
+                "avg_focus_duration_minutes": rng.uniform(0, 30),
+                "distraction_rate_per_hour": rng.uniform(0, 60), "unique_domains": rng.randint(1, 20),
+            },
+        })
+    return [("FeatureEncoder.encode_batch[24]", lambda: encoder.encode_batch(sessions), 500)]
+
+
+def _dqn_benchmarks() -> List[Tuple[str, Callable, int]]:
+    import numpy as np
+    from ai.dqn_agent import DQNAgent
+
+    rng = np.random.default_rng(7)
+    agent = DQNAgent(batch_size=32)
+    agent.replay_buffer.push_batch(
+        rng.random((1000, 12), dtype=np.float32), rng.integers(0, 10, 1000),
+        rng.random(1000, dtype=np.float32), rng.random((1000, 12), dtype=np.float32),
+        np.zeros(1000, dtype=np.float32),
+    )
+    return [("DQNAgent.train_step[32]", agent.train_step, 50)]
+
+
+def _metrics_benchmarks() -> List[Tuple[str, Callable, int]]:
+    """Instrumentation overhead paid per span on the hot paths."""
+    from core.metrics import span
+
+    def timed_stage():
+        with span("bench.noop"):
+            pass
+
+    return [("metrics.span", timed_stage, 20000)]
+
+
+def run_micro(db, user_id: int, scale: float = 1.0) -> Dict[str, Dict]:
+    """
+    Run every microbenchmark.
+
+    Args:
+        db: Session on a seeded database
+        user_id: Seeded user for the context-dependent benchmarks
+        scale: Multiplier on calls per sample
+
+    Returns:
+        {benchmark name: timings, or {"skipped": reason}}
+    """
+    random.seed(7)
+    results: Dict[str, Dict] = {}
+    groups = [
+        ("state", lambda: _state_benchmarks(db, user_id)),
+        ("replay buffer", _replay_benchmarks),
+        ("feature encoder", _feature_benchmarks),
+        ("dqn", _dqn_benchmarks),
+        ("metrics", _metrics_benchmarks),
+    ]
+    for group, build in groups:
+        try:
+            benchmarks = build()
+        except ImportError as e:
+            results[f"[{group}]"] = {"skipped": f"missing dependency: {e.name}"}
+            continue
+        for name, func, number in benchmarks:
+            results[name] = time_calls(func, max(1, int(number * scale)))
+    return results
+
+
+def print_micro(results: Dict[str, Dict]) -> None:
+    print(f"{'benchmark':<36} {'p50 us':>10} {'p99 us':>10} {'calls':>8}")
+    for name, result in results.items():
+        if "skipped" in result:
+            print(f"{name:<36} skipped ({result['skipped']})")
+        else:
+            print(f"{name:<36} {result['p50_us']:>10.2f} {result['p99_us']:>10.2f} {result['calls']:>8}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="AI microbenchmarks")
+    parser.add_argument("--scale", type=float, default=1.0, help="Multiplier on calls per sample")
+    args = parser.parse_args()
+
+    from benchmarks.common import seed_users, use_temp_database
+    use_temp_database()
+    from models.base import SessionLocal, init_db
+
+    init_db()
+    db = SessionLocal()
+    try:
+        (user_id,) = seed_users(db, 1)
+        print_micro(run_micro(db, user_id, args.scale))
+    finally:
+        db.close()
+
+
+if __name__ == "__main__":
+    main()
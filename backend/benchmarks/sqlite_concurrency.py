@@ -0,0 +1,186 @@
+"""
+SQLite Concurrency Benchmark
+Compares the legacy SQLite setup (one shared connection, rollback journal)
+with the tuned profile (WAL, one serialized writer, read-only pool) under
+concurrent extension syncs and recommendations.
+
+Usage (from backend/):
+    python benchmarks/sqlite_concurrency.py
+    python benchmarks/sqlite_concurrency.py --seconds 10 --sync-threads 4 --rec-threads 16
+
+Each profile runs against a fresh temporary database file:
+- sync: bulk-insert a day of BrowsingSession rows (the /extension/sync path)
+- recommendation: load a UserContextSnapshot through the read session, then
+  insert a RecommendationLog through the writer (the /ai/recommendation path)
+"""
+
+import argparse
+import os
+import random
+import shutil
+import sys
+import tempfile
+import threading
+import time
+from datetime import datetime, timedelta, timezone
+from typing import Dict, List
+
+# Add parent directory to path for imports
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+from sqlalchemy.orm import sessionmaker
+
+import models  # Registers every model on Base.metadata
+from models.base import Base, create_sqlite_engines
+from models.mood import MoodEntry
+from models.recommendation_log import RecommendationLog
+from models.schedule import ScheduleBlock
+from models.task import Task
+from ai.user_context import UserContextSnapshot
+from routers.extension_router import _bulk_insert_sessions
+
+USERS = 20
+
+
+def seed(session_factory) -> None:
+    """A few tasks, blocks and moods per user."""
+    db = session_factory()
+    try:
+        for user_id in range(1, USERS + 1):
+            for i in range(10):
+                db.add(Task(user_id=user_id, title=f"Task {i}", priority=1 + i % 5, status="pending"))
+            for hour in (9, 13, 16):
+                db.add(ScheduleBlock(user_id=user_id, title="Meeting", start=hour, duration=1.0))
+            db.add(MoodEntry(user_id=user_id, mood="focused"))
+        db.commit()
+    finally:
+        db.close()
+
+
+def sync_op(writer, counter: List[int], rng: random.Random) -> None:
+    """One extension sync: 24 hourly sessions for a random user."""
+    user_id = rng.randint(1, USERS)
+    start = datetime(2025, 1, 1, tzinfo=timezone.utc) + timedelta(days=rng.randint(0, 3650))
+    rows = []
+    for hour in range(24):
+        timestamp = start + timedelta(hours=hour)
+        counter[0] += 1
+        rows.append({
+            "session_id": f"bench-{threading.get_ident()}-{counter[0]}",
+            "user_id": user_id,
+            "timestamp": timestamp,
+            "hour_key": timestamp.strftime("%Y-%m-%dT%H"),
+            "duration_minutes": 60,
+            "work_time": 30, "leisure_time": 10, "social_time": 5, "neutral_time": 15,
+            "tab_switches": 12, "window_focus_changes": 4,
+            "avg_focus_duration_minutes": 6.5, "distraction_rate_per_hour": 12.0,
+            "unique_domains": 7, "event_count": 42,
+        })
+    db = writer()
+    try:
+        _bulk_insert_sessions(db, rows)
+        db.commit()
+    finally:
+        db.close()
+
+
+def recommendation_op(writer, reader, rng: random.Random) -> None:
+    """One recommendation: context reads, then a log write."""
+    user_id = rng.randint(1, USERS)
+    read_db = reader()
+    try:
+        context = UserContextSnapshot.load(read_db, user_id)
+    finally:
+        read_db.close()
+
+    db = writer()
+    try:
+        db.add(RecommendationLog(
+            user_id=user_id,
+            state_key="morning|monday|high|low",
+            state_snapshot={"pending": context.pending_count()},
+            action_type="DEEP_FOCUS",
+            confidence=0.8,
+            strategy_used="rule",
+        ))
+        db.commit()
+    finally:
+        db.close()
+
+
+def run_profile(tuned: bool, seconds: float, sync_threads: int, rec_threads: int) -> Dict[str, Dict]:
+    """Run both workloads concurrently against a fresh database."""
+    directory = tempfile.mkdtemp(prefix="pulse-bench-")
+    writer_engine, reader_engine = create_sqlite_engines(
+        f"sqlite:///{os.path.join(directory, 'bench.db')}", tuned=tuned
+    )
+    try:
+        Base.metadata.create_all(bind=writer_engine)
+        writer = sessionmaker(autocommit=False, autoflush=False, bind=writer_engine)
+        reader = sessionmaker(autocommit=False, autoflush=False, bind=reader_engine)
+        seed(writer)
+
+        results = {name: {"latencies": [], "errors": 0} for name in ("sync", "recommendation")}
+        lock = threading.Lock()
+        deadline = time.perf_counter() + seconds
+
+        def worker(name: str, seed_value: int) -> None:
+            rng = random.Random(seed_value)
+            counter = [0]
+            latencies, errors = [], 0
+            while time.perf_counter() < deadline:
+                started = time.perf_counter()
+                try:
+                    if name == "sync":
+                        sync_op(writer, counter, rng)
+                    else:
+                        recommendation_op(writer, reader, rng)
+                    latencies.append(time.perf_counter() - started)
+                except Exception:
+                    errors += 1  # The shared connection fails under concurrency
+            with lock:
+                results[name]["latencies"].extend(latencies)
+                results[name]["errors"] += errors
+
+        threads = [threading.Thread(target=worker, args=("sync", i)) for i in range(sync_threads)]
+        threads += [threading.Thread(target=worker, args=("recommendation", 1000 + i)) for i in range(rec_threads)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        return results
+    finally:
+        writer_engine.dispose()
+        reader_engine.dispose()
+        shutil.rmtree(directory, ignore_errors=True)
+
+
+def percentile(values: List[float], fraction: float) -> float:
+    if not values:
+        return float("nan")
+    ordered = sorted(values)
+    return ordered[min(len(ordered) - 1, int(fraction * len(ordered)))]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="SQLite legacy vs tuned concurrency benchmark")
+    parser.add_argument("--seconds", type=float, default=5.0, help="Duration per profile")
+    parser.add_argument("--sync-threads", type=int, default=2, help="Concurrent sync clients")
+    parser.add_argument("--rec-threads", type=int, default=8, help="Concurrent recommendation clients")
+    args = parser.parse_args()
+
+    print(f"{args.sync_threads} sync + {args.rec_threads} recommendation threads, {args.seconds:.0f}s per profile")
+    print(f"{'profile':<8} {'workload':<15} {'ops/s':>8} {'p50 ms':>8} {'p99 ms':>8} {'errors':>7}")
+    for tuned in (False, True):
+        results = run_profile(tuned, args.seconds, args.sync_threads, args.rec_threads)
+        for name, result in results.items():
+            latencies = result["latencies"]
+            print(
+                f"{'tuned' if tuned else 'legacy':<8} {name:<15} {len(latencies) / args.seconds:>8.1f} "
+                f"{percentile(latencies, 0.5) * 1000:>8.2f} {percentile(latencies, 0.99) * 1000:>8.2f} "
+                f"{result['errors']:>7}"
+            )
+
+
+if __name__ == "__main__":
+    main()
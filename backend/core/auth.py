@@ -13,8 +13,9 @@ from jose import JWTError, jwt
 from passlib.context import CryptContext
 from sqlalchemy.orm import Session
 
-from models.base import get_db
+from models.base import get_read_db
 from models.user import User
+from core.user_cache import AuthUser, user_cache
 
 
 # ============================================================================
@@ -26,6 +27,11 @@ SECRET_KEY = os.getenv("JWT_SECRET_KEY", "pulse-super-secret-key-change-in-produ
 ALGORITHM = os.getenv("JWT_ALGORITHM", "HS256")
 ACCESS_TOKEN_EXPIRE_HOURS = int(os.getenv("ACCESS_TOKEN_EXPIRE_HOURS", "24"))
 
+# Authorize from token claims alone (no cache or database read). Faster, but
+# a password change or deactivation only takes effect on the replica that
+# made it until the old tokens expire.
+AUTH_TRUST_TOKEN_CLAIMS = os.getenv("AUTH_TRUST_TOKEN_CLAIMS", "false").lower() == "true"
+
 # Password hashing context
 pwd_context = CryptContext(schemes=["pbkdf2_sha256"], deprecated="auto")
 
@@ -96,6 +102,27 @@ def create_access_token(data: dict, expires_delta: Optional[timedelta] = None) -
     return encoded_jwt
 
 
+def create_user_token(user: User) -> str:
+    """
+    Create an access token for a user.
+
+    Carries the token version (for revocation) and the identity fields
+    claims-only authorization needs.
+
+    Args:
+        user: Authenticated user
+
+    Returns:
+        Encoded JWT token string
+    """
+    return create_access_token(data={
+        "sub": user.id,
+        "ver": user.token_version or 0,
+        "email": user.email,
+        "username": user.username,
+    })
+
+
 def decode_access_token(token: str) -> Optional[dict]:
     """
     Decode and validate a JWT access token.
@@ -117,20 +144,86 @@ def decode_access_token(token: str) -> Optional[dict]:
 # FastAPI Dependencies
 # ============================================================================
 
+class _AuthError(Exception):
+    """Why a token was rejected (mapped to 401/403 by the dependencies)."""
+
+    def __init__(self, reason: str, inactive: bool = False):
+        super().__init__(reason)
+        self.inactive = inactive
+
+
+def _authenticate(token: str, db: Session) -> AuthUser:
+    """
+    Resolve a token to its user without touching the database when possible.
+
+    Order: token claims (if AUTH_TRUST_TOKEN_CLAIMS), then the user cache,
+    then a single query whose result is cached.
+
+    Raises:
+        _AuthError: If the token is invalid, revoked or the user is inactive
+    """
+    payload = decode_access_token(token)
+    if payload is None:
+        raise _AuthError("Token decode failed - invalid or expired token")
+
+    user_id_raw = payload.get("sub")
+    if user_id_raw is None:
+        raise _AuthError("No 'sub' claim in token payload")
+
+    # Convert sub from string to int (JWT sub claim is always a string)
+    try:
+        user_id = int(user_id_raw)
+        version = int(payload.get("ver", 0))
+    except (ValueError, TypeError):
+        raise _AuthError(f"Invalid 'sub' claim format: {user_id_raw}")
+
+    if version < user_cache.min_version(user_id):
+        raise _AuthError(f"Token version {version} for user {user_id} was revoked")
+
+    if AUTH_TRUST_TOKEN_CLAIMS and "email" in payload and "username" in payload:
+        return AuthUser(
+            id=user_id,
+            email=payload["email"],
+            username=payload["username"],
+            is_active=True,  # Inactive users can't obtain tokens
+            token_version=version,
+        )
+
+    user = user_cache.get(user_id)
+    if user is None:
+        row = db.query(User).filter(User.id == user_id).first()
+        if row is None:
+            raise _AuthError(f"User with id {user_id} not found in database")
+        user = AuthUser.from_model(row)
+        user_cache.put(user)
+
+    if user.token_version != version:
+        raise _AuthError(f"Token version {version} for user {user_id} is stale (current {user.token_version})")
+
+    if not user.is_active:
+        raise _AuthError(f"User {user_id} is inactive", inactive=True)
+
+    return user
+
+
 async def get_current_user(
     token: Optional[str] = Depends(oauth2_scheme),
-    db: Session = Depends(get_db)
-) -> User:
+    db: Session = Depends(get_read_db)
+) -> AuthUser:
     """
     FastAPI dependency to get the current authenticated user.
-    
+
+    Returns an immutable AuthUser (id, email, username, is_active) served
+    from the user cache or token claims; query User by id for ORM access.
+
     Usage:
         @router.get("/protected")
         def protected_route(current_user: User = Depends(get_current_user)):
             return {"user_id": current_user.id}
     
     Raises:
-        HTTPException 401 if not authenticated or token invalid
+        HTTPException 401 if not authenticated or token invalid/revoked
+        HTTPException 403 if the account is inactive
     """
     credentials_exception = HTTPException(
         status_code=status.HTTP_401_UNAUTHORIZED,
@@ -138,52 +231,26 @@ async def get_current_user(
         headers={"WWW-Authenticate": "Bearer"},
     )
     
-    # Debug logging
     if token is None:
         print("[AUTH DEBUG] No token received in request")
         raise credentials_exception
-    else:
-        print(f"[AUTH DEBUG] Token received: {token[:20]}...{token[-10:] if len(token) > 30 else ''}")
-    
-    payload = decode_access_token(token)
-    if payload is None:
-        print("[AUTH DEBUG] Token decode failed - invalid or expired token")
-        raise credentials_exception
-    else:
-        print(f"[AUTH DEBUG] Token decoded successfully, payload: {payload}")
-    
-    user_id_raw = payload.get("sub")
-    if user_id_raw is None:
-        print("[AUTH DEBUG] No 'sub' claim in token payload")
-        raise credentials_exception
-    
-    # Convert sub from string to int (JWT sub claim is always a string)
+
     try:
-        user_id = int(user_id_raw)
-    except (ValueError, TypeError):
-        print(f"[AUTH DEBUG] Invalid 'sub' claim format: {user_id_raw}")
-        raise credentials_exception
-    
-    user = db.query(User).filter(User.id == user_id).first()
-    if user is None:
-        print(f"[AUTH DEBUG] User with id {user_id} not found in database")
+        return _authenticate(token, db)
+    except _AuthError as e:
+        print(f"[AUTH DEBUG] {e}")
+        if e.inactive:
+            raise HTTPException(
+                status_code=status.HTTP_403_FORBIDDEN,
+                detail="User account is inactive"
+            )
         raise credentials_exception
-    
-    if not user.is_active:
-        print(f"[AUTH DEBUG] User {user_id} is inactive")
-        raise HTTPException(
-            status_code=status.HTTP_403_FORBIDDEN,
-            detail="User account is inactive"
-        )
-    
-    print(f"[AUTH DEBUG] Auth successful for user {user_id} ({user.email})")
-    return user
 
 
 async def get_optional_user(
     token: Optional[str] = Depends(oauth2_scheme),
-    db: Session = Depends(get_db)
-) -> Optional[User]:
+    db: Session = Depends(get_read_db)
+) -> Optional[AuthUser]:
     """
     FastAPI dependency to optionally get the current user.
     Returns None if not authenticated (no token or invalid token).
@@ -193,20 +260,8 @@ async def get_optional_user(
     """
     if token is None:
         return None
-    
-    payload = decode_access_token(token)
-    if payload is None:
-        return None
-    
-    user_id_raw = payload.get("sub")
-    if user_id_raw is None:
-        return None
-    
-    # Convert sub from string to int (JWT sub claim is always a string)
+
     try:
-        user_id = int(user_id_raw)
-    except (ValueError, TypeError):
+        return _authenticate(token, db)
+    except _AuthError:
         return None
-    
-    user = db.query(User).filter(User.id == user_id, User.is_active == True).first()
-    return user
@@ -0,0 +1,101 @@
+"""
+Conditional GET Responses
+ETags on JSON GET responses, answering 304 Not Modified when the client's
+If-None-Match still matches.
+
+The tag is a digest of the rendered body, so the route still runs its
+queries; what a 304 saves is the transfer, the client's JSON parse and
+the re-render of an unchanged list. ETAG_ENABLED=false turns it off.
+"""
+
+import hashlib
+import os
+
+ETAG_ENABLED = os.getenv("ETAG_ENABLED", "true").lower() == "true"
+
+
+def make_etag(body: bytes) -> str:
+    """Weak validator for a response body."""
+    return f'W/"{hashlib.blake2b(body, digest_size=12).hexdigest()}"'
+
+
+def etag_matches(if_none_match: str, etag: str) -> bool:
+    """Whether an If-None-Match header matches `etag` (weak comparison)."""
+    opaque = etag[2:] if etag.startswith("W/") else etag
+    for candidate in if_none_match.split(","):
+        candidate = candidate.strip()
+        if candidate == "*":
+            return True
+        if candidate.startswith("W/"):
+            candidate = candidate[2:]
+        if candidate == opaque:
+            return True
+    return False
+
+
+class ETagMiddleware:
+    """
+    ASGI middleware adding an ETag to 200 JSON responses of GET requests.
+
+    The body is buffered to hash it (JSON responses arrive in one message
+    anyway); streams and other content types pass straight through.
+    """
+
+    def __init__(self, app):
+        self.app = app
+
+    async def __call__(self, scope, receive, send):
+        if scope["type"] != "http" or scope["method"] != "GET" or not ETAG_ENABLED:
+            await self.app(scope, receive, send)
+            return
+
+        if_none_match = None
+        for name, value in scope["headers"]:
+            if name == b"if-none-match":
+                if_none_match = value.decode("latin-1")
+                break
+
+        start = None
+        chunks = []
+
+        async def send_with_etag(message):
+            nonlocal start
+            if message["type"] == "http.response.start":
+                headers = {name.lower(): value for name, value in message.get("headers", [])}
+                if (message["status"] == 200 and b"etag" not in headers
+                        and headers.get(b"content-type", b"").startswith(b"application/json")):
+                    start = message  # Held until the body is complete
+                    return
+                await send(message)
+                return
+
+            if start is None:
+                await send(message)
+                return
+
+            chunks.append(message.get("body", b""))
+            if message.get("more_body", False):
+                return
+
+            body = b"".join(chunks)
+            etag = make_etag(body)
+            headers = [
+                (name, value) for name, value in start.get("headers", [])
+                if name.lower() != b"content-length"
+            ]
+            headers.append((b"etag", etag.encode("latin-1")))
+            if not any(name.lower() == b"cache-control" for name, _ in headers):
+                headers.append((b"cache-control", b"private, no-cache"))
+
+            if if_none_match is not None and etag_matches(if_none_match, etag):
+                await send({"type": "http.response.start", "status": 304, "headers": [
+                    (name, value) for name, value in headers if name.lower() != b"content-type"
+                ]})
+                await send({"type": "http.response.body", "body": b""})
+                return
+
+            headers.append((b"content-length", str(len(body)).encode("latin-1")))
+            await send({**start, "headers": headers})
+            await send({"type": "http.response.body", "body": body})
+
+        await self.app(scope, receive, send_with_etag)
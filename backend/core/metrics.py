@@ -0,0 +1,410 @@
+"""
+Hot-Path Metrics
+In-process counters, gauges and latency histograms, exported in the
+Prometheus text format at /metrics, with optional OTLP traces.
+
+What is measured:
+- span(stage) timers around each recommender step, the recommendation
+  route's own DB work and every LLM call (pulse_stage_duration_seconds)
+- SQL statements and latency per HTTP request (MetricsMiddleware plus a
+  SQLAlchemy cursor listener that counts into the request's context)
+- ScheduleAgent registry hits/misses and save durations
+
+Recording is a perf_counter pair and one short lock per observation, so
+a recommendation carrying a dozen spans pays a few tens of microseconds.
+METRICS_ENABLED=false turns recording off.
+
+Traces: when OTEL_EXPORTER_OTLP_ENDPOINT is set and opentelemetry-sdk
+plus the OTLP HTTP exporter are installed, every span and request is also
+exported as an OpenTelemetry span. Without them nothing changes.
+"""
+
+import contextvars
+import os
+import threading
+from bisect import bisect_left
+from time import perf_counter
+from typing import Callable, Dict, List, Optional, Sequence, Tuple
+
+METRICS_ENABLED = os.getenv("METRICS_ENABLED", "true").lower() == "true"
+
+# When set, /metrics requires "Authorization: Bearer <METRICS_TOKEN>"
+METRICS_TOKEN = os.getenv("METRICS_TOKEN", "")
+
+# Seconds; spans range from sub-millisecond cache lookups to LLM calls
+LATENCY_BUCKETS = (
+    0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0, 30.0
+)
+QUERY_BUCKETS = (0, 1, 2, 3, 5, 8, 13, 21, 34, 55, 100)
+
+
+def _escape(value: str) -> str:
+    return value.replace("\\", "\\\\").replace("\n", "\\n").replace('"', '\\"')
+
+
+def _format_labels(names: Sequence[str], values: Sequence[str], extra: str = "") -> str:
+    parts = [f'{name}="{_escape(value)}"' for name, value in zip(names, values)]
+    if extra:
+        parts.append(extra)
+    return "{" + ",".join(parts) + "}" if parts else ""
+
+
+def _format_number(value: float) -> str:
+    if value == int(value) and abs(value) < 1e15:
+        return str(int(value))
+    return repr(float(value))
+
+
+class _Metric:
+    kind = "untyped"
+
+    def __init__(self, name: str, documentation: str, labelnames: Sequence[str] = ()):
+        self.name = name
+        self.documentation = documentation
+        self.labelnames = tuple(labelnames)
+        self._lock = threading.Lock()
+
+    def _key(self, labels: Dict[str, object]) -> Tuple[str, ...]:
+        return tuple(str(labels[name]) for name in self.labelnames)
+
+    def render(self) -> List[str]:
+        return [f"# HELP {self.name} {self.documentation}", f"# TYPE {self.name} {self.kind}"]
+
+    def reset(self) -> None:
+        pass
+
+
+class Counter(_Metric):
+    """Monotonic count per label set."""
+    kind = "counter"
+
+    def __init__(self, name: str, documentation: str, labelnames: Sequence[str] = ()):
+        super().__init__(name, documentation, labelnames)
+        self._values: Dict[Tuple[str, ...], float] = {}
+
+    def inc(self, amount: float = 1.0, **labels) -> None:
+        if not METRICS_ENABLED:
+            return
+        key = self._key(labels)
+        with self._lock:
+            self._values[key] = self._values.get(key, 0.0) + amount
+
+    def value(self, **labels) -> float:
+        return self._values.get(self._key(labels), 0.0)
+
+    def render(self) -> List[str]:
+        lines = super().render()
+        with self._lock:
+            items = sorted(self._values.items())
+        for key, value in items:
+            lines.append(f"{self.name}{_format_labels(self.labelnames, key)} {_format_number(value)}")
+        return lines
+
+    def reset(self) -> None:
+        with self._lock:
+            self._values.clear()
+
+
+class Gauge(_Metric):
+    """Value read from a callback at scrape time."""
+    kind = "gauge"
+
+    def __init__(self, name: str, documentation: str, read: Callable[[], float]):
+        super().__init__(name, documentation)
+        self.read = read
+
+    def render(self) -> List[str]:
+        lines = super().render()
+        try:
+            lines.append(f"{self.name} {_format_number(float(self.read()))}")
+        except Exception:
+            pass  # A failing source (e.g. DB down) must not break the scrape
+        return lines
+
+
+class Histogram(_Metric):
+    """Bucketed distribution per label set (cumulative buckets on export)."""
+    kind = "histogram"
+
+    def __init__(
+        self,
+        name: str,
+        documentation: str,
+        labelnames: Sequence[str] = (),
+        buckets: Sequence[float] = LATENCY_BUCKETS
+    ):
+        super().__init__(name, documentation, labelnames)
+        self.buckets = tuple(sorted(buckets))
+        # key -> [per-bucket counts (+Inf last), sum, count]
+        self._series: Dict[Tuple[str, ...], list] = {}
+
+    def observe(self, value: float, **labels) -> None:
+        if not METRICS_ENABLED:
+            return
+        key = self._key(labels)
+        index = bisect_left(self.buckets, value)
+        with self._lock:
+            series = self._series.get(key)
+            if series is None:
+                series = self._series[key] = [[0] * (len(self.buckets) + 1), 0.0, 0]
+            series[0][index] += 1
+            series[1] += value
+            series[2] += 1
+
+    def count(self, **labels) -> int:
+        series = self._series.get(self._key(labels))
+        return series[2] if series else 0
+
+    def snapshot(self, **labels) -> Dict:
+        """
+        One label set's per-bucket counts (not cumulative) and summary, as JSON
+        for stats endpoints. Bucket keys are the bounds as rendered, plus "+Inf".
+        """
+        with self._lock:
+            series = self._series.get(self._key(labels))
+            counts, total, count = (list(series[0]), series[1], series[2]) if series else (
+                [0] * (len(self.buckets) + 1), 0.0, 0
+            )
+        bounds = [_format_number(bound) for bound in self.buckets] + ["+Inf"]
+        return {
+            "buckets": dict(zip(bounds, counts)),
+            "count": count,
+            "sum": round(total, 6),
+            "mean": round(total / count, 6) if count else 0.0,
+        }
+
+    def render(self) -> List[str]:
+        lines = super().render()
+        with self._lock:
+            items = sorted((key, (list(s[0]), s[1], s[2])) for key, s in self._series.items())
+        for key, (counts, total, count) in items:
+            cumulative = 0
+            for bound, bucket_count in zip(self.buckets + (float("inf"),), counts):
+                cumulative += bucket_count
+                le = "+Inf" if bound == float("inf") else _format_number(bound)
+                labels = _format_labels(self.labelnames, key, f'le="{le}"')
+                lines.append(f"{self.name}_bucket{labels} {cumulative}")
+            labels = _format_labels(self.labelnames, key)
+            lines.append(f"{self.name}_sum{labels} {repr(float(total))}")
+            lines.append(f"{self.name}_count{labels} {count}")
+        return lines
+
+    def reset(self) -> None:
+        with self._lock:
+            self._series.clear()
+
+
+class MetricsRegistry:
+    """Named metrics, rendered together for /metrics."""
+
+    def __init__(self):
+        self._metrics: Dict[str, _Metric] = {}
+        self._lock = threading.Lock()
+
+    def register(self, metric: _Metric) -> _Metric:
+        """Add a metric (re-registering a name returns the existing one)."""
+        with self._lock:
+            existing = self._metrics.get(metric.name)
+            if existing is not None:
+                if type(existing) is not type(metric):
+                    raise ValueError(f"Metric {metric.name} already registered as {existing.kind}")
+                return existing
+            self._metrics[metric.name] = metric
+            return metric
+
+    def counter(self, name: str, documentation: str, labelnames: Sequence[str] = ()) -> Counter:
+        return self.register(Counter(name, documentation, labelnames))
+
+    def histogram(
+        self,
+        name: str,
+        documentation: str,
+        labelnames: Sequence[str] = (),
+        buckets: Sequence[float] = LATENCY_BUCKETS
+    ) -> Histogram:
+        return self.register(Histogram(name, documentation, labelnames, buckets))
+
+    def gauge(self, name: str, documentation: str, read: Callable[[], float]) -> Gauge:
+        return self.register(Gauge(name, documentation, read))
+
+    def render(self) -> str:
+        """Prometheus text exposition format (version 0.0.4)."""
+        with self._lock:
+            metrics = sorted(self._metrics.values(), key=lambda metric: metric.name)
+        lines: List[str] = []
+        for metric in metrics:
+            lines.extend(metric.render())
+        return "\n".join(lines) + "\n"
+
+    def reset(self) -> None:
+        """Clear every recorded value (for testing)."""
+        with self._lock:
+            metrics = list(self._metrics.values())
+        for metric in metrics:
+            metric.reset()
+
+
+registry = MetricsRegistry()
+
+STAGE_SECONDS = registry.histogram(
+    "pulse_stage_duration_seconds", "Duration of instrumented hot-path stages", ("stage",)
+)
+REQUEST_SECONDS = registry.histogram(
+    "pulse_http_request_duration_seconds", "HTTP request latency", ("method", "route", "status")
+)
+REQUEST_QUERIES = registry.histogram(
+    "pulse_http_request_db_queries", "SQL statements executed per HTTP request", ("route",),
+    buckets=QUERY_BUCKETS,
+)
+AGENT_CACHE = registry.counter(
+    "pulse_agent_cache_total", "ScheduleAgent registry lookups", ("result",)
+)
+AGENT_SAVE_SECONDS = registry.histogram(
+    "pulse_agent_save_duration_seconds", "ScheduleAgent snapshot save duration"
+)
+LLM_CALLS = registry.counter(
+    "pulse_llm_calls_total", "LLM calls by kind and result", ("call", "result")
+)
+
+
+# =============================================================================
+# Spans
+# =============================================================================
+
+_tracer = None  # Set by configure_tracing() when OTLP export is enabled
+
+
+class span:
+    """
+    Time a stage into pulse_stage_duration_seconds (and an OTel span).
+
+    Usage:
+        with span("recommender.encode_state"):
+            state = encoder.encode(...)
+    """
+
+    __slots__ = ("stage", "_started", "_otel")
+
+    def __init__(self, stage: str):
+        self.stage = stage
+
+    def __enter__(self) -> "span":
+        if _tracer is not None:
+            self._otel = _tracer.start_as_current_span(self.stage)
+            self._otel.__enter__()
+        else:
+            self._otel = None
+        self._started = perf_counter()
+        return self
+
+    def __exit__(self, exc_type, exc, tb) -> bool:
+        STAGE_SECONDS.observe(perf_counter() - self._started, stage=self.stage)
+        if self._otel is not None:
+            self._otel.__exit__(exc_type, exc, tb)
+        return False
+
+
+def configure_tracing() -> bool:
+    """
+    Enable OTLP trace export if configured (OTEL_EXPORTER_OTLP_ENDPOINT).
+
+    Returns:
+        True if spans are now exported
+    """
+    global _tracer
+    if _tracer is not None:
+        return True
+    if not os.getenv("OTEL_EXPORTER_OTLP_ENDPOINT"):
+        return False
+    try:
+        from opentelemetry import trace
+        from opentelemetry.exporter.otlp.proto.http.trace_exporter import OTLPSpanExporter
+        from opentelemetry.sdk.resources import Resource
+        from opentelemetry.sdk.trace import TracerProvider
+        from opentelemetry.sdk.trace.export import BatchSpanProcessor
+    except ImportError:
+        print("[Metrics] OTEL_EXPORTER_OTLP_ENDPOINT is set but opentelemetry-sdk is not installed; traces disabled")
+        return False
+
+    provider = TracerProvider(resource=Resource.create({
+        "service.name": os.getenv("OTEL_SERVICE_NAME", "pulse-api"),
+    }))
+    provider.add_span_processor(BatchSpanProcessor(OTLPSpanExporter()))
+    trace.set_tracer_provider(provider)
+    _tracer = trace.get_tracer("pulse")
+    print(f"[Metrics] Exporting traces to {os.getenv('OTEL_EXPORTER_OTLP_ENDPOINT')}")
+    return True
+
+
+# =============================================================================
+# Per-request accounting
+# =============================================================================
+
+# Statement counter of the request being served (None outside requests).
+# Sync routes run in worker threads that copy the request's context, so
+# their statements land on the same list.
+_request_queries: contextvars.ContextVar[Optional[List[int]]] = contextvars.ContextVar(
+    "pulse_request_queries", default=None
+)
+
+_query_counter_installed = False
+
+
+def _count_query(*_args) -> None:
+    counter = _request_queries.get()
+    if counter is not None:
+        counter[0] += 1
+
+
+def install_query_counter() -> None:
+    """Count statements of every engine (including test engines) per request."""
+    global _query_counter_installed
+    if _query_counter_installed or not METRICS_ENABLED:
+        return
+    from sqlalchemy import event
+    from sqlalchemy.engine import Engine
+
+    event.listen(Engine, "before_cursor_execute", _count_query)
+    _query_counter_installed = True
+
+
+class MetricsMiddleware:
+    """
+    ASGI middleware recording latency and SQL statements per request.
+
+    Requests are labelled by route template (/tasks/{task_id}), never by
+    raw path, so label cardinality stays bounded.
+    """
+
+    def __init__(self, app):
+        self.app = app
+
+    async def __call__(self, scope, receive, send):
+        if scope["type"] != "http" or not METRICS_ENABLED:
+            await self.app(scope, receive, send)
+            return
+
+        counter = [0]
+        token = _request_queries.set(counter)
+        status = [500]
+
+        async def send_with_status(message):
+            if message["type"] == "http.response.start":
+                status[0] = message["status"]
+            await send(message)
+
+        otel = None
+        if _tracer is not None:
+            otel = _tracer.start_as_current_span(f"{scope['method']} {scope['path']}")
+            otel.__enter__()
+        started = perf_counter()
+        try:
+            await self.app(scope, receive, send_with_status)
+        finally:
+            elapsed = perf_counter() - started
+            _request_queries.reset(token)
+            route = getattr(scope.get("route"), "path", "unmatched")
+            REQUEST_SECONDS.observe(elapsed, method=scope["method"], route=route, status=status[0])
+            REQUEST_QUERIES.observe(counter[0], route=route)
+            if otel is not None:
+                otel.__exit__(None, None, None)
@@ -0,0 +1,181 @@
+"""
+Authenticated User Cache
+In-process cache of the user fields authentication needs.
+
+get_current_user used to load the User row on every request. Active users
+are now cached briefly as immutable AuthUser records, which removes that
+query (and the pool checkout) from most authenticated requests.
+
+Every access token carries the user's token_version. Changing a user's
+password or deactivating the account bumps the version (see the Session
+hooks below). That drops the cache entry, and tokens issued before the
+change are rejected from then on.
+"""
+
+import os
+import threading
+import time
+from collections import OrderedDict
+from dataclasses import dataclass
+from typing import Dict, Optional
+
+from sqlalchemy import event, inspect
+from sqlalchemy.orm import Session
+
+from models.user import User
+
+
+# Seconds a cached user is trusted before re-reading it (0 disables caching)
+USER_CACHE_TTL_SECONDS = float(os.getenv("USER_CACHE_TTL_SECONDS", "60"))
+USER_CACHE_MAX_ENTRIES = int(os.getenv("USER_CACHE_MAX_ENTRIES", "10000"))
+
+# Changes to these columns revoke the user's existing tokens
+_REVOKING_COLUMNS = ("password_hash", "is_active")
+
+
+@dataclass(frozen=True)
+class AuthUser:
+    """Column-only view of a User (duck-types the fields routes read)."""
+    id: int
+    email: str
+    username: str
+    is_active: bool
+    token_version: int
+
+    @classmethod
+    def from_model(cls, user: User) -> "AuthUser":
+        """Build from a User row."""
+        return cls(
+            id=user.id,
+            email=user.email,
+            username=user.username,
+            is_active=bool(user.is_active),
+            token_version=user.token_version or 0,
+        )
+
+
+class UserCache:
+    """
+    Thread-safe TTL + LRU cache of AuthUser by user ID.
+
+    Keeps the latest token version seen for each invalidated user, so a
+    stale in-flight load can't put a revoked record back in the cache.
+    """
+
+    def __init__(
+        self,
+        ttl_seconds: float = USER_CACHE_TTL_SECONDS,
+        max_entries: int = USER_CACHE_MAX_ENTRIES
+    ):
+        self.ttl_seconds = ttl_seconds
+        self.max_entries = max_entries
+        self._entries: "OrderedDict[int, tuple]" = OrderedDict()  # user_id -> (expires_at, AuthUser)
+        self._min_versions: Dict[int, int] = {}  # Lowest valid token version after revocation
+        self._lock = threading.Lock()
+        self.hits = 0
+        self.misses = 0
+
+    def get(self, user_id: int) -> Optional[AuthUser]:
+        """Get a cached user, or None if missing or expired."""
+        now = time.monotonic()
+        with self._lock:
+            entry = self._entries.get(user_id)
+            if entry is None or entry[0] <= now:
+                if entry is not None:
+                    del self._entries[user_id]
+                self.misses += 1
+                return None
+            self._entries.move_to_end(user_id)
+            self.hits += 1
+            return entry[1]
+
+    def put(self, user: AuthUser) -> None:
+        """Cache a user loaded from the database."""
+        if self.ttl_seconds <= 0 or self.max_entries <= 0:
+            return
+        with self._lock:
+            if user.token_version < self._min_versions.get(user.id, 0):
+                return  # Loaded before a revocation committed
+            self._entries[user.id] = (time.monotonic() + self.ttl_seconds, user)
+            self._entries.move_to_end(user.id)
+            while len(self._entries) > self.max_entries:
+                self._entries.popitem(last=False)
+
+    def min_version(self, user_id: int) -> int:
+        """Lowest token version this process still accepts for the user."""
+        with self._lock:
+            return self._min_versions.get(user_id, 0)
+
+    def invalidate(self, user_id: Optional[int], min_version: Optional[int] = None) -> None:
+        """Drop a user's entry (and optionally reject token versions below min_version)."""
+        if user_id is None:
+            return
+        with self._lock:
+            self._entries.pop(user_id, None)
+            if min_version is not None:
+                self._min_versions[user_id] = max(self._min_versions.get(user_id, 0), min_version)
+
+    def clear(self) -> None:
+        """Drop all entries."""
+        with self._lock:
+            self._entries.clear()
+            self._min_versions.clear()
+
+    def get_stats(self) -> Dict:
+        """Get cache size and hit/miss counts."""
+        with self._lock:
+            return {
+                "size": len(self._entries),
+                "hits": self.hits,
+                "misses": self.misses,
+                "ttl_seconds": self.ttl_seconds,
+            }
+
+
+# Process-wide cache used by core.auth
+user_cache = UserCache()
+
+
+@event.listens_for(Session, "before_flush")
+def _bump_token_version(session: Session, flush_context, instances) -> None:
+    """Revoke outstanding tokens when a user's password or active flag changes."""
+    for instance in session.dirty:
+        if not isinstance(instance, User):
+            continue
+        state = inspect(instance)
+        if any(state.attrs[name].history.has_changes() for name in _REVOKING_COLUMNS):
+            instance.token_version = (instance.token_version or 0) + 1
+
+
+# session.info key: user_id -> min token version, applied on commit
+_PENDING_INVALIDATIONS = "user_cache_invalidations"
+
+
+@event.listens_for(Session, "after_flush")
+def _collect_on_flush(session: Session, flush_context) -> None:
+    """Record users that were updated or deleted (invalidated on commit)."""
+    for instance in (*session.dirty, *session.deleted):
+        if isinstance(instance, User):
+            min_version = instance.token_version or 0
+            if instance in session.deleted:
+                min_version += 1  # No token of a deleted user stays valid
+            pending = session.info.setdefault(_PENDING_INVALIDATIONS, {})
+            pending[instance.id] = max(pending.get(instance.id, 0), min_version)
+
+
+@event.listens_for(Session, "after_commit")
+def _invalidate_on_commit(session: Session) -> None:
+    """
+    Apply the version bumps once they are committed. At flush time a
+    rollback could still undo them, and raising min_version then would
+    reject tokens that stay valid; a request reading between the flush and
+    the commit would also re-cache the old row.
+    """
+    for user_id, min_version in session.info.pop(_PENDING_INVALIDATIONS, {}).items():
+        user_cache.invalidate(user_id, min_version)
+
+
+@event.listens_for(Session, "after_rollback")
+def _discard_on_rollback(session: Session) -> None:
+    """Rolled-back changes never revoked anything."""
+    session.info.pop(_PENDING_INVALIDATIONS, None)
@@ -3,11 +3,12 @@ Mood CRUD Operations
 Handles mood tracking with JSON file persistence.
 """
 
-import json
 import os
 from typing import List, Optional
 from datetime import datetime
 
+from .record_log import RecordLog
+
 # Data file path
 DATA_DIR = os.path.join(os.path.dirname(__file__), "..", "data")
 DATA_FILE = os.path.join(DATA_DIR, "mood.json")
@@ -15,31 +16,7 @@ DATA_FILE = os.path.join(DATA_DIR, "mood.json")
 # Valid mood states (matching frontend)
 VALID_MOODS = {"calm", "energized", "focused", "tired"}
 
-
-def _ensure_data_file() -> None:
-    """Ensure the data directory and file exist."""
-    os.makedirs(DATA_DIR, exist_ok=True)
-    if not os.path.exists(DATA_FILE):
-        with open(DATA_FILE, "w") as f:
-            json.dump({
-                "current": "calm",
-                "history": [],
-                "next_id": 1
-            }, f)
-
-
-def _read_data() -> dict:
-    """Read data from JSON file."""
-    _ensure_data_file()
-    with open(DATA_FILE, "r") as f:
-        return json.load(f)
-
-
-def _write_data(data: dict) -> None:
-    """Write data to JSON file."""
-    _ensure_data_file()
-    with open(DATA_FILE, "w") as f:
-        json.dump(data, f, indent=2)
+_store = RecordLog(DATA_FILE, collections=["history"], meta={"current": "calm", "next_id": 1})
 
 
 # ============ CRUD Operations ============
@@ -60,20 +37,11 @@ def set_mood(mood: str) -> dict:
     if mood not in VALID_MOODS:
         raise ValueError(f"Invalid mood: {mood}. Must be one of {VALID_MOODS}")
     
-    data = _read_data()
-    
-    entry = {
-        "id": data["next_id"],
-        "mood": mood,
-        "timestamp": datetime.now().isoformat()
-    }
-    
-    data["current"] = mood
-    data["history"].append(entry)
-    data["next_id"] += 1
-    _write_data(data)
-    
-    return entry
+    return _store.insert(
+        "history",
+        {"mood": mood, "timestamp": datetime.now().isoformat()},
+        meta={"current": mood}
+    )
 
 
 def get_current_mood() -> str:
@@ -83,8 +51,7 @@ def get_current_mood() -> str:
     Returns:
         Current mood string
     """
-    data = _read_data()
-    return data["current"]
+    return _store.get_meta("current")
 
 
 def get_mood_history(limit: Optional[int] = None) -> List[dict]:
@@ -97,9 +64,8 @@ def get_mood_history(limit: Optional[int] = None) -> List[dict]:
     Returns:
         List of mood entry dicts
     """
-    data = _read_data()
     history = sorted(
-        data["history"],
+        _store.records("history"),
         key=lambda h: h["timestamp"],
         reverse=True
     )
@@ -120,11 +86,7 @@ def get_mood_by_id(entry_id: int) -> Optional[dict]:
     Returns:
         Mood entry dict or None if not found
     """
-    data = _read_data()
-    for entry in data["history"]:
-        if entry["id"] == entry_id:
-            return entry
-    return None
+    return _store.get("history", entry_id)
 
 
 def delete_mood_entry(entry_id: int) -> bool:
@@ -137,16 +99,7 @@ def delete_mood_entry(entry_id: int) -> bool:
     Returns:
         True if deleted, False if not found
     """
-    data = _read_data()
-    original_len = len(data["history"])
-    
-    data["history"] = [h for h in data["history"] if h["id"] != entry_id]
-    
-    if len(data["history"]) < original_len:
-        _write_data(data)
-        return True
-    
-    return False
+    return _store.delete("history", entry_id)
 
 
 def get_mood_counts(limit: int = 100) -> dict:
@@ -195,11 +148,4 @@ def clear_history() -> int:
     Returns:
         Number of entries deleted
     """
-    data = _read_data()
-    count = len(data["history"])
-    
-    data["history"] = []
-    data["next_id"] = 1
-    _write_data(data)
-    
-    return count
+    return _store.clear("history", meta={"next_id": 1})
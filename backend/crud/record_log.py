@@ -0,0 +1,369 @@
+"""
+Record Log
+Append-only JSON-lines storage with an in-memory index, shared by the
+JSON-file CRUD modules (local/offline mode).
+
+File format (one JSON object per line):
+
+    {"v": 1, "snapshot": {"tasks": [...], "next_id": 4}}    <- always line 1
+    {"c": "tasks", "put": {...}, "meta": {"next_id": 5}}     <- insert/replace
+    {"c": "tasks", "id": 3, "set": {"completed": true}}      <- field update
+    {"c": "tasks", "del": 3}                                 <- delete
+    {"c": "tasks", "clear": true}                            <- delete all
+    {"meta": {"current": "calm"}}                            <- metadata only
+
+Each mutation is one appended line, so it costs O(1) I/O no matter how many
+records exist. A torn last line (crash mid-write) is dropped on load.
+Appends are flushed to the OS immediately and fsynced in batches. When the
+log grows past its snapshot, it is compacted into a fresh snapshot written
+to a temp file and swapped in with os.replace.
+
+Files written by earlier versions (one JSON document) are converted on load.
+"""
+
+import json
+import os
+import threading
+from typing import Any, Dict, Iterable, List, Optional
+
+FORMAT_VERSION = 1
+
+# Longest time an acknowledged write may sit un-fsynced
+FSYNC_INTERVAL_SECONDS = 0.5
+
+# Compact once the log has this many lines and twice as many as live records
+COMPACT_MIN_OPS = 1000
+COMPACT_RATIO = 2
+
+
+class RecordLog:
+    """
+    Collections of id-keyed records plus metadata values, persisted as an
+    append-only log.
+
+    Reads are served from memory. Each call first stats the file, so a
+    file deleted, replaced or appended to by someone else is reloaded.
+    """
+
+    def __init__(
+        self,
+        path: str,
+        collections: Iterable[str],
+        meta: Dict[str, Any],
+        fsync_interval: float = FSYNC_INTERVAL_SECONDS
+    ):
+        """
+        Args:
+            path: Log file path
+            collections: Names of the record collections
+            meta: Metadata keys and their initial values (e.g. next_id)
+            fsync_interval: Batch window for fsync, in seconds
+        """
+        self.path = path
+        self.collection_names = tuple(collections)
+        self.default_meta = dict(meta)
+        self.fsync_interval = fsync_interval
+
+        self._lock = threading.RLock()
+        self._file = None            # Append handle, opened on first write
+        self._file_id = None         # (st_dev, st_ino, size) when last in sync with disk
+        self._ops_since_snapshot = 0
+        self._fsync_timer: Optional[threading.Timer] = None
+        self._reset()
+
+    # =========================================================================
+    # Reads
+    # =========================================================================
+
+    def records(self, collection: str) -> List[dict]:
+        """All records of a collection, in insertion order (copies)."""
+        with self._lock:
+            self._refresh()
+            return [dict(record) for record in self._collections[collection].values()]
+
+    def get(self, collection: str, record_id: Any) -> Optional[dict]:
+        """One record by id (a copy), or None."""
+        with self._lock:
+            self._refresh()
+            record = self._collections[collection].get(record_id)
+            return dict(record) if record is not None else None
+
+    def count(self, collection: str) -> int:
+        """Number of records in a collection."""
+        with self._lock:
+            self._refresh()
+            return len(self._collections[collection])
+
+    def get_meta(self, key: str) -> Any:
+        """A metadata value."""
+        with self._lock:
+            self._refresh()
+            return self._meta[key]
+
+    # =========================================================================
+    # Writes (one appended line each)
+    # =========================================================================
+
+    def insert(self, collection: str, fields: dict, meta: Optional[Dict[str, Any]] = None) -> dict:
+        """
+        Add a record under the next id (from the next_id metadata value).
+
+        Args:
+            collection: Collection name
+            fields: Record fields other than id
+            meta: Other metadata to set in the same write
+
+        Returns:
+            The stored record (a copy)
+        """
+        with self._lock:
+            self._refresh()
+            record_id = self._meta["next_id"]
+            record = {"id": record_id, **fields}
+            self._append({"c": collection, "put": record, "meta": {**(meta or {}), "next_id": record_id + 1}})
+            return dict(record)
+
+    def update(self, collection: str, record_id: Any, changes: Dict[str, Any]) -> Optional[dict]:
+        """
+        Set fields on a record.
+
+        Returns:
+            The updated record (a copy), or None if not found
+        """
+        with self._lock:
+            self._refresh()
+            if record_id not in self._collections[collection]:
+                return None
+            if changes:
+                self._append({"c": collection, "id": record_id, "set": changes})
+            return dict(self._collections[collection][record_id])
+
+    def delete(self, collection: str, record_id: Any) -> bool:
+        """Delete a record. Returns False if it didn't exist."""
+        with self._lock:
+            self._refresh()
+            if record_id not in self._collections[collection]:
+                return False
+            self._append({"c": collection, "del": record_id})
+            return True
+
+    def clear(self, collection: str, meta: Optional[Dict[str, Any]] = None) -> int:
+        """Delete every record of a collection. Returns how many there were."""
+        with self._lock:
+            self._refresh()
+            count = len(self._collections[collection])
+            op = {"c": collection, "clear": True}
+            if meta:
+                op["meta"] = meta
+            self._append(op)
+            return count
+
+    def set_meta(self, **values: Any) -> None:
+        """Set metadata values."""
+        with self._lock:
+            self._refresh()
+            self._append({"meta": values})
+
+    # =========================================================================
+    # Durability
+    # =========================================================================
+
+    def sync(self) -> None:
+        """fsync every write so far."""
+        with self._lock:
+            if self._fsync_timer is not None:
+                self._fsync_timer.cancel()
+                self._fsync_timer = None
+            if self._file is not None:
+                self._file.flush()
+                os.fsync(self._file.fileno())
+
+    def compact(self) -> None:
+        """Rewrite the file as a single snapshot line (atomic via os.replace)."""
+        with self._lock:
+            self._refresh()
+            self._write_snapshot()
+
+    def close(self) -> None:
+        """Sync and release the file handle."""
+        with self._lock:
+            self.sync()
+            self._close_file()
+
+    # =========================================================================
+    # Internals
+    # =========================================================================
+
+    def _reset(self) -> None:
+        """Empty in-memory state (no file yet)."""
+        self._collections: Dict[str, Dict[Any, dict]] = {name: {} for name in self.collection_names}
+        self._meta: Dict[str, Any] = dict(self.default_meta)
+        self._ops_since_snapshot = 0
+
+    def _close_file(self) -> None:
+        if self._fsync_timer is not None:
+            self._fsync_timer.cancel()
+            self._fsync_timer = None
+        if self._file is not None:
+            try:
+                self._file.close()
+            except OSError:
+                pass
+            self._file = None
+        self._file_id = None
+
+    def _refresh(self) -> None:
+        """Reload if the file changed behind our back (O(1) when it didn't)."""
+        try:
+            st = os.stat(self.path)
+        except FileNotFoundError:
+            # Deleted (or never written): start empty
+            self._close_file()
+            self._reset()
+            return
+
+        if self._file_id != (st.st_dev, st.st_ino, st.st_size):
+            self._close_file()
+            self._load()
+
+    def _load(self) -> None:
+        """Rebuild state from the file: snapshot, then replay the log."""
+        self._reset()
+        with open(self.path, "rb") as f:
+            lines = f.read().split(b"\n")
+
+        try:
+            header = json.loads(lines[0]) if lines[0].strip() else None
+        except ValueError:
+            header = None
+        if not isinstance(header, dict) or header.get("v") is None:
+            self._load_legacy()
+            return
+        if header["v"] > FORMAT_VERSION:
+            raise ValueError(f"{self.path}: format version {header['v']} is newer than {FORMAT_VERSION}")
+
+        self._apply_snapshot(header["snapshot"])
+
+        valid_bytes = len(lines[0]) + 1
+        for line in lines[1:]:
+            if not line.strip():
+                valid_bytes += len(line) + 1
+                continue
+            try:
+                op = json.loads(line)
+            except ValueError:
+                break  # Torn write: everything after it is discarded
+            self._apply(op)
+            self._ops_since_snapshot += 1
+            valid_bytes += len(line) + 1
+
+        # Drop a torn tail so later appends start on a clean line
+        size = os.path.getsize(self.path)
+        if valid_bytes < size:
+            with open(self.path, "r+b") as f:
+                f.truncate(valid_bytes)
+                os.fsync(f.fileno())
+        self._open_file()
+
+    def _load_legacy(self) -> None:
+        """Convert a whole-file JSON document (earlier format) to a snapshot."""
+        with open(self.path, "r") as f:
+            data = json.load(f)
+        self._apply_snapshot(data)
+        self._write_snapshot()
+
+    def _apply_snapshot(self, snapshot: Dict[str, Any]) -> None:
+        for key, value in snapshot.items():
+            if key in self._collections:
+                self._collections[key] = {record["id"]: record for record in value}
+            else:
+                self._meta[key] = value
+
+    def _apply(self, op: Dict[str, Any]) -> None:
+        """Apply one log line to memory."""
+        collection = op.get("c")
+        if collection is not None:
+            records = self._collections[collection]
+            if "put" in op:
+                record = op["put"]
+                records[record["id"]] = record
+            elif "set" in op:
+                records[op["id"]].update(op["set"])
+            elif "del" in op:
+                records.pop(op["del"], None)
+            elif op.get("clear"):
+                records.clear()
+        if "meta" in op:
+            self._meta.update(op["meta"])
+
+    def _append(self, op: Dict[str, Any]) -> None:
+        """Persist one mutation, then apply it."""
+        line = (json.dumps(op, separators=(",", ":")) + "\n").encode()
+        if self._file is None and not os.path.exists(self.path):
+            self._write_snapshot()
+
+        self._file.write(line)
+        self._file.flush()  # Visible to other readers now; durable at the next fsync
+        self._file_id = self._file_id[:2] + (self._file_id[2] + len(line),)
+
+        # A put copies the record so callers can't mutate the index
+        if "put" in op:
+            op = {**op, "put": dict(op["put"])}
+        elif "set" in op:
+            op = {**op, "set": dict(op["set"])}
+        self._apply(op)
+        self._ops_since_snapshot += 1
+
+        live = sum(len(records) for records in self._collections.values())
+        if self._ops_since_snapshot >= max(COMPACT_MIN_OPS, COMPACT_RATIO * live):
+            self._write_snapshot()
+        else:
+            self._schedule_fsync()
+
+    def _schedule_fsync(self) -> None:
+        """Group fsyncs: the first unsynced write starts the batch window."""
+        if self.fsync_interval <= 0:
+            self.sync()
+        elif self._fsync_timer is None:
+            self._fsync_timer = threading.Timer(self.fsync_interval, self.sync)
+            self._fsync_timer.daemon = True
+            self._fsync_timer.start()
+
+    def _write_snapshot(self) -> None:
+        """Write state as one snapshot line to a temp file and swap it in."""
+        self._close_file()
+        os.makedirs(os.path.dirname(os.path.abspath(self.path)), exist_ok=True)
+
+        snapshot = dict(self._meta)
+        for name, records in self._collections.items():
+            snapshot[name] = list(records.values())
+
+        tmp_path = f"{self.path}.tmp"
+        with open(tmp_path, "wb") as f:
+            f.write((json.dumps({"v": FORMAT_VERSION, "snapshot": snapshot}, separators=(",", ":")) + "\n").encode())
+            f.flush()
+            os.fsync(f.fileno())
+        os.replace(tmp_path, self.path)
+        fsync_directory(os.path.dirname(os.path.abspath(self.path)))
+
+        self._ops_since_snapshot = 0
+        self._open_file()
+
+    def _open_file(self) -> None:
+        self._file = open(self.path, "ab")
+        st = os.fstat(self._file.fileno())
+        self._file_id = (st.st_dev, st.st_ino, st.st_size)
+
+
+def fsync_directory(directory: str) -> None:
+    """Make a rename durable (not supported on every platform)."""
+    try:
+        fd = os.open(directory, os.O_RDONLY)
+    except OSError:
+        return
+    try:
+        os.fsync(fd)
+    except OSError:
+        pass
+    finally:
+        os.close(fd)
@@ -3,36 +3,17 @@ Reflections CRUD Operations
 Handles end-of-day reflection entries with JSON file persistence.
 """
 
-import json
 import os
 from typing import List, Optional
 from datetime import datetime, date
 
+from .record_log import RecordLog
+
 # Data file path
 DATA_DIR = os.path.join(os.path.dirname(__file__), "..", "data")
 DATA_FILE = os.path.join(DATA_DIR, "reflections.json")
 
-
-def _ensure_data_file() -> None:
-    """Ensure the data directory and file exist."""
-    os.makedirs(DATA_DIR, exist_ok=True)
-    if not os.path.exists(DATA_FILE):
-        with open(DATA_FILE, "w") as f:
-            json.dump({"reflections": [], "next_id": 1}, f)
-
-
-def _read_data() -> dict:
-    """Read data from JSON file."""
-    _ensure_data_file()
-    with open(DATA_FILE, "r") as f:
-        return json.load(f)
-
-
-def _write_data(data: dict) -> None:
-    """Write data to JSON file."""
-    _ensure_data_file()
-    with open(DATA_FILE, "w") as f:
-        json.dump(data, f, indent=2)
+_store = RecordLog(DATA_FILE, collections=["reflections"], meta={"next_id": 1})
 
 
 # ============ CRUD Operations ============
@@ -57,10 +38,7 @@ def save_reflection(
     Returns:
         The created reflection dict
     """
-    data = _read_data()
-    
-    reflection = {
-        "id": data["next_id"],
+    return _store.insert("reflections", {
         "date": date.today().isoformat(),
         "moodScore": mood_score,
         "distractions": distractions,
@@ -68,13 +46,7 @@ def save_reflection(
         "completedTasks": completed_tasks,
         "totalTasks": total_tasks,
         "createdAt": datetime.now().isoformat()
-    }
-    
-    data["reflections"].append(reflection)
-    data["next_id"] += 1
-    _write_data(data)
-    
-    return reflection
+    })
 
 
 def get_reflections(limit: Optional[int] = None) -> List[dict]:
@@ -87,9 +59,8 @@ def get_reflections(limit: Optional[int] = None) -> List[dict]:
     Returns:
         List of reflection dicts
     """
-    data = _read_data()
     reflections = sorted(
-        data["reflections"],
+        _store.records("reflections"),
         key=lambda r: r["date"],
         reverse=True
     )
@@ -110,11 +81,7 @@ def get_reflection_by_id(reflection_id: int) -> Optional[dict]:
     Returns:
         Reflection dict or None if not found
     """
-    data = _read_data()
-    for reflection in data["reflections"]:
-        if reflection["id"] == reflection_id:
-            return reflection
-    return None
+    return _store.get("reflections", reflection_id)
 
 
 def get_reflection_by_date(target_date: str) -> Optional[dict]:
@@ -127,8 +94,7 @@ def get_reflection_by_date(target_date: str) -> Optional[dict]:
     Returns:
         Reflection dict or None if not found
     """
-    data = _read_data()
-    for reflection in data["reflections"]:
+    for reflection in _store.records("reflections"):
         if reflection["date"] == target_date:
             return reflection
     return None
@@ -145,19 +111,9 @@ def update_reflection(reflection_id: int, **updates) -> Optional[dict]:
     Returns:
         Updated reflection dict or None if not found
     """
-    data = _read_data()
-    
-    for i, reflection in enumerate(data["reflections"]):
-        if reflection["id"] == reflection_id:
-            allowed = {"moodScore", "distractions", "note"}
-            for key, value in updates.items():
-                if key in allowed:
-                    data["reflections"][i][key] = value
-            
-            _write_data(data)
-            return data["reflections"][i]
-    
-    return None
+    allowed = {"moodScore", "distractions", "note"}
+    changes = {key: value for key, value in updates.items() if key in allowed}
+    return _store.update("reflections", reflection_id, changes)
 
 
 def delete_reflection(reflection_id: int) -> bool:
@@ -170,19 +126,7 @@ def delete_reflection(reflection_id: int) -> bool:
     Returns:
         True if deleted, False if not found
     """
-    data = _read_data()
-    original_len = len(data["reflections"])
-    
-    data["reflections"] = [
-        r for r in data["reflections"] 
-        if r["id"] != reflection_id
-    ]
-    
-    if len(data["reflections"]) < original_len:
-        _write_data(data)
-        return True
-    
-    return False
+    return _store.delete("reflections", reflection_id)
 
 
 def get_mood_average(days: int = 7) -> Optional[float]:
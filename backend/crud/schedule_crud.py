@@ -3,36 +3,17 @@ Schedule CRUD Operations
 Handles all schedule block operations with JSON file persistence.
 """
 
-import json
 import os
 from typing import List, Optional
 from datetime import datetime
 
+from .record_log import RecordLog
+
 # Data file path
 DATA_DIR = os.path.join(os.path.dirname(__file__), "..", "data")
 DATA_FILE = os.path.join(DATA_DIR, "schedule.json")
 
-
-def _ensure_data_file() -> None:
-    """Ensure the data directory and file exist."""
-    os.makedirs(DATA_DIR, exist_ok=True)
-    if not os.path.exists(DATA_FILE):
-        with open(DATA_FILE, "w") as f:
-            json.dump({"blocks": [], "next_id": 1}, f)
-
-
-def _read_data() -> dict:
-    """Read data from JSON file."""
-    _ensure_data_file()
-    with open(DATA_FILE, "r") as f:
-        return json.load(f)
-
-
-def _write_data(data: dict) -> None:
-    """Write data to JSON file."""
-    _ensure_data_file()
-    with open(DATA_FILE, "w") as f:
-        json.dump(data, f, indent=2)
+_store = RecordLog(DATA_FILE, collections=["blocks"], meta={"next_id": 1})
 
 
 # ============ CRUD Operations ============
@@ -55,22 +36,13 @@ def create_block(
     Returns:
         The created block dict
     """
-    data = _read_data()
-    
-    block = {
-        "id": data["next_id"],
+    return _store.insert("blocks", {
         "title": title,
         "start": start,
         "duration": duration,
         "type": block_type,
         "createdAt": datetime.now().isoformat()
-    }
-    
-    data["blocks"].append(block)
-    data["next_id"] += 1
-    _write_data(data)
-    
-    return block
+    })
 
 
 def get_blocks(block_type: Optional[str] = None) -> List[dict]:
@@ -83,8 +55,7 @@ def get_blocks(block_type: Optional[str] = None) -> List[dict]:
     Returns:
         List of block dicts
     """
-    data = _read_data()
-    blocks = data["blocks"]
+    blocks = _store.records("blocks")
     
     if block_type is not None:
         blocks = [b for b in blocks if b["type"] == block_type]
@@ -102,11 +73,7 @@ def get_block_by_id(block_id: int) -> Optional[dict]:
     Returns:
         Block dict or None if not found
     """
-    data = _read_data()
-    for block in data["blocks"]:
-        if block["id"] == block_id:
-            return block
-    return None
+    return _store.get("blocks", block_id)
 
 
 def update_block(block_id: int, **updates) -> Optional[dict]:
@@ -120,19 +87,9 @@ def update_block(block_id: int, **updates) -> Optional[dict]:
     Returns:
         Updated block dict or None if not found
     """
-    data = _read_data()
-    
-    for i, block in enumerate(data["blocks"]):
-        if block["id"] == block_id:
-            allowed = {"title", "start", "duration", "type"}
-            for key, value in updates.items():
-                if key in allowed:
-                    data["blocks"][i][key] = value
-            
-            _write_data(data)
-            return data["blocks"][i]
-    
-    return None
+    allowed = {"title", "start", "duration", "type"}
+    changes = {key: value for key, value in updates.items() if key in allowed}
+    return _store.update("blocks", block_id, changes)
 
 
 def delete_block(block_id: int) -> bool:
@@ -145,16 +102,7 @@ def delete_block(block_id: int) -> bool:
     Returns:
         True if deleted, False if not found
     """
-    data = _read_data()
-    original_len = len(data["blocks"])
-    
-    data["blocks"] = [b for b in data["blocks"] if b["id"] != block_id]
-    
-    if len(data["blocks"]) < original_len:
-        _write_data(data)
-        return True
-    
-    return False
+    return _store.delete("blocks", block_id)
 
 
 def get_blocks_in_range(start_hour: float, end_hour: float) -> List[dict]:
@@ -168,10 +116,9 @@ def get_blocks_in_range(start_hour: float, end_hour: float) -> List[dict]:
     Returns:
         List of overlapping blocks
     """
-    data = _read_data()
     result = []
     
-    for block in data["blocks"]:
+    for block in _store.records("blocks"):
         block_end = block["start"] + block["duration"]
         # Check for overlap
         if block["start"] < end_hour and block_end > start_hour:
@@ -187,10 +134,4 @@ def clear_all_blocks() -> int:
     Returns:
         Number of blocks deleted
     """
-    data = _read_data()
-    count = len(data["blocks"])
-    
-    data["blocks"] = []
-    _write_data(data)
-    
-    return count
+    return _store.clear("blocks")
@@ -3,36 +3,17 @@ Tasks CRUD Operations
 Handles all task-related data operations with JSON file persistence.
 """
 
-import json
 import os
 from typing import List, Optional
 from datetime import datetime
 
+from .record_log import RecordLog
+
 # Data file path (relative to crud directory)
 DATA_DIR = os.path.join(os.path.dirname(__file__), "..", "data")
 DATA_FILE = os.path.join(DATA_DIR, "tasks.json")
 
-
-def _ensure_data_file() -> None:
-    """Ensure the data directory and file exist."""
-    os.makedirs(DATA_DIR, exist_ok=True)
-    if not os.path.exists(DATA_FILE):
-        with open(DATA_FILE, "w") as f:
-            json.dump({"tasks": [], "next_id": 1}, f)
-
-
-def _read_data() -> dict:
-    """Read data from JSON file."""
-    _ensure_data_file()
-    with open(DATA_FILE, "r") as f:
-        return json.load(f)
-
-
-def _write_data(data: dict) -> None:
-    """Write data to JSON file."""
-    _ensure_data_file()
-    with open(DATA_FILE, "w") as f:
-        json.dump(data, f, indent=2)
+_store = RecordLog(DATA_FILE, collections=["tasks"], meta={"next_id": 1})
 
 
 # ============ CRUD Operations ============
@@ -53,23 +34,14 @@ def create_task(
     Returns:
         The created task dict
     """
-    data = _read_data()
-    
-    task = {
-        "id": data["next_id"],
+    return _store.insert("tasks", {
         "title": title,
         "duration": duration,
         "difficulty": difficulty,
         "completed": False,
         "scheduledAt": None,
         "createdAt": datetime.now().isoformat()
-    }
-    
-    data["tasks"].append(task)
-    data["next_id"] += 1
-    _write_data(data)
-    
-    return task
+    })
 
 
 def get_tasks(completed: Optional[bool] = None) -> List[dict]:
@@ -82,8 +54,7 @@ def get_tasks(completed: Optional[bool] = None) -> List[dict]:
     Returns:
         List of task dicts
     """
-    data = _read_data()
-    tasks = data["tasks"]
+    tasks = _store.records("tasks")
     
     if completed is not None:
         tasks = [t for t in tasks if t["completed"] == completed]
@@ -101,11 +72,7 @@ def get_task_by_id(task_id: int) -> Optional[dict]:
     Returns:
         Task dict or None if not found
     """
-    data = _read_data()
-    for task in data["tasks"]:
-        if task["id"] == task_id:
-            return task
-    return None
+    return _store.get("tasks", task_id)
 
 
 def update_task(task_id: int, **updates) -> Optional[dict]:
@@ -119,20 +86,10 @@ def update_task(task_id: int, **updates) -> Optional[dict]:
     Returns:
         Updated task dict or None if not found
     """
-    data = _read_data()
-    
-    for i, task in enumerate(data["tasks"]):
-        if task["id"] == task_id:
-            # Only update allowed fields
-            allowed = {"title", "duration", "difficulty", "completed", "scheduledAt"}
-            for key, value in updates.items():
-                if key in allowed:
-                    data["tasks"][i][key] = value
-            
-            _write_data(data)
-            return data["tasks"][i]
-    
-    return None
+    # Only update allowed fields
+    allowed = {"title", "duration", "difficulty", "completed", "scheduledAt"}
+    changes = {key: value for key, value in updates.items() if key in allowed}
+    return _store.update("tasks", task_id, changes)
 
 
 def delete_task(task_id: int) -> bool:
@@ -145,16 +102,7 @@ def delete_task(task_id: int) -> bool:
     Returns:
         True if deleted, False if not found
     """
-    data = _read_data()
-    original_len = len(data["tasks"])
-    
-    data["tasks"] = [t for t in data["tasks"] if t["id"] != task_id]
-    
-    if len(data["tasks"]) < original_len:
-        _write_data(data)
-        return True
-    
-    return False
+    return _store.delete("tasks", task_id)
 
 
 def toggle_task(task_id: int) -> Optional[dict]:
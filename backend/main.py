@@ -8,15 +8,15 @@ from dotenv import load_dotenv
 load_dotenv()
 
 import os
-import asyncio
 from contextlib import asynccontextmanager
-from fastapi import FastAPI
+from typing import Optional
+from fastapi import FastAPI, Header, HTTPException, Response
 from fastapi.middleware.cors import CORSMiddleware
 
 # Import from models package (NOT models.base) to ensure all models are loaded
 # before init_db() is called - otherwise Base.metadata won't know about any tables!
 from models import init_db, test_connection
-from routers import tasks_router, schedule_router, reflections_router, mood_router, ai_router, extension_router, auth_router
+from routers import tasks_router, schedule_router, reflections_router, mood_router, ai_router, extension_router, auth_router, insights_router
 
 # Background tasks
 from tasks.background import (
@@ -25,23 +25,25 @@ from tasks.background import (
     background_runner,
 )
 
+# Hot-path metrics (/metrics) and optional OTLP traces
+from core import metrics
+from core.etag import ETagMiddleware
+from ai.agent import ScheduleAgent
+
 # Track database status
 db_initialized = False
 db_error = None
 
-# Track background task
-_background_task = None
-
-
 @asynccontextmanager
 async def lifespan(app: FastAPI):
     """
     Lifespan context manager for startup/shutdown events.
     Database initialization happens here so the app can start even if DB fails.
     """
-    global db_initialized, db_error, _background_task
+    global db_initialized, db_error
     
     print("[STARTUP] Initializing PULSE API...")
+    metrics.configure_tracing()
     
     # Try to initialize database (non-blocking - app starts even if this fails)
     try:
@@ -72,12 +74,13 @@ async def lifespan(app: FastAPI):
                 print(f"[STARTUP] WARNING: Seeding failed: {e}")
     
     # Start background task runner for periodic tasks
-    # (model persistence every 5 min, outcome inference every 30 min)
+    # (model persistence every 5 min, outcome inference every 30 min,
+    # rollup refresh every minute, archival every 6 hours, executed in a
+    # thread pool so the event loop never blocks on them). A one-off job
+    # preloads recently active users' agents once traffic is flowing.
     if db_initialized:
         try:
-            background_runner._running = True
-            _background_task = asyncio.create_task(background_runner._run_periodic_tasks())
-            print("[STARTUP] Background task runner started")
+            await background_runner.start()
         except Exception as e:
             print(f"[STARTUP] WARNING: Background runner failed to start: {e}")
     
@@ -88,15 +91,8 @@ async def lifespan(app: FastAPI):
     # Shutdown
     print("[SHUTDOWN] PULSE API shutting down...")
     
-    # Stop background task runner
-    if _background_task:
-        background_runner._running = False
-        _background_task.cancel()
-        try:
-            await _background_task
-        except asyncio.CancelledError:
-            pass
-        print("[SHUTDOWN] Background task runner stopped")
+    # Stop background task runner (waits for in-flight jobs)
+    await background_runner.stop()
     
     # Run shutdown tasks (persist all agent models)
     if db_initialized:
@@ -126,6 +122,10 @@ allowed_origins = [o.strip() for o in env_origins]
 # CORS wildcards like "chrome-extension://*" don't work, need regex instead
 extension_regex = r"^(chrome-extension|moz-extension)://.*$"
 
+# ETags on JSON GETs (answers 304 for unchanged lists); inside CORS so the
+# 304 still carries the CORS headers
+app.add_middleware(ETagMiddleware)
+
 app.add_middleware(
     CORSMiddleware,
     allow_origins=allowed_origins,
@@ -133,6 +133,17 @@ app.add_middleware(
     allow_credentials=True,
     allow_methods=["*"],
     allow_headers=["*"],
+    expose_headers=["ETag"],  # Read by the frontend cache for If-None-Match
+)
+
+# Outermost, so request latency includes CORS handling
+app.add_middleware(metrics.MetricsMiddleware)
+metrics.install_query_counter()
+metrics.registry.gauge(
+    "pulse_agents_cached", "ScheduleAgents held in memory", lambda: len(ScheduleAgent._instances)
+)
+metrics.registry.gauge(
+    "pulse_agents_dirty", "Cached ScheduleAgents with unsaved updates", ScheduleAgent.count_dirty
 )
 
 # Include routers
@@ -143,6 +154,7 @@ app.include_router(mood_router)
 app.include_router(ai_router)
 app.include_router(extension_router)
 app.include_router(auth_router)
+app.include_router(insights_router)
 
 
 @app.get("/")
@@ -169,11 +181,23 @@ def health_check():
         "status": "healthy" if db_connected else "degraded",
         "api": "ok",
         "database": "connected" if db_connected else "disconnected",
-        "background_tasks": "running" if _background_task and not _background_task.done() else "stopped",
+        "background_tasks": "running" if background_runner.is_running else "stopped",
+        "background": background_runner.get_stats(),
         "error": db_error if db_error else None
     }
 
 
+@app.get("/metrics", include_in_schema=False)
+def metrics_endpoint(authorization: Optional[str] = Header(None)):
+    """
+    Prometheus scrape endpoint (text exposition format).
+    Requires "Authorization: Bearer <METRICS_TOKEN>" when METRICS_TOKEN is set.
+    """
+    if metrics.METRICS_TOKEN and authorization != f"Bearer {metrics.METRICS_TOKEN}":
+        raise HTTPException(status_code=401, detail="Invalid metrics token")
+    return Response(metrics.registry.render(), media_type="text/plain; version=0.0.4; charset=utf-8")
+
+
 @app.post("/dev/seed")
 def seed_database():
     """
@@ -0,0 +1,16 @@
+-- ============================================================================
+-- PULSE Database Migration: Add Task Selection Index
+-- Version: 2.1.0
+-- Date: 2026-10-14
+--
+-- Backs TaskSelector's candidate scan (user, pending, not deleted, not
+-- archived, priority range). New databases get it from the model via
+-- create_all(); run this for existing databases.
+-- Works in PostgreSQL (Supabase SQL Editor / psql) and SQLite.
+-- ============================================================================
+
+CREATE INDEX IF NOT EXISTS ix_tasks_user_active_priority
+    ON tasks (user_id, status, is_deleted, is_archived, priority);
+
+-- Verify the index exists (PostgreSQL)
+-- SELECT indexname, indexdef FROM pg_indexes WHERE tablename = 'tasks';
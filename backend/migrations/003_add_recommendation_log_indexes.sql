@@ -0,0 +1,16 @@
+-- ============================================================================
+-- PULSE Database Migration: Add Recommendation Log Indexes
+-- Version: 2.2.0
+-- Date: 2026-10-14
+--
+-- Backs streaming outcome inference: the keyset scan over pending logs
+-- ordered by (timestamp, id) and the per-user successor lookup.
+-- New databases get these from the model via create_all().
+-- Works in PostgreSQL (Supabase SQL Editor / psql) and SQLite.
+-- ============================================================================
+
+CREATE INDEX IF NOT EXISTS ix_recommendation_logs_outcome_timestamp_id
+    ON recommendation_logs (outcome, timestamp, id);
+
+CREATE INDEX IF NOT EXISTS ix_recommendation_logs_user_timestamp
+    ON recommendation_logs (user_id, timestamp);
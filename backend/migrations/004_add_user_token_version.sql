@@ -0,0 +1,12 @@
+-- ============================================================================
+-- PULSE Database Migration: Add User Token Version
+-- Version: 2.3.0
+-- Date: 2026-10-14
+--
+-- Access tokens carry the user's token_version; bumping it (password change,
+-- deactivation) revokes tokens issued before the change.
+-- init_db() adds this column automatically on PostgreSQL.
+-- Works in PostgreSQL (Supabase SQL Editor / psql) and SQLite.
+-- ============================================================================
+
+ALTER TABLE users ADD COLUMN token_version INTEGER NOT NULL DEFAULT 0;
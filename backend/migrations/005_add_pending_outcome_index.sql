@@ -0,0 +1,18 @@
+-- ============================================================================
+-- PULSE Database Migration: Partial Index on Pending Outcomes
+-- Version: 2.3.0
+-- Date: 2026-10-14
+--
+-- Outcome inference scans `outcome IS NULL AND timestamp <= cutoff` ordered
+-- by (timestamp, id). A partial index holds only the pending logs, so the
+-- scan stays small however many resolved logs accumulate. It replaces the
+-- full (outcome, timestamp, id) index from 003.
+-- New databases get this from the model via create_all().
+-- Works in PostgreSQL (Supabase SQL Editor / psql) and SQLite.
+-- ============================================================================
+
+CREATE INDEX IF NOT EXISTS ix_recommendation_logs_pending_timestamp_id
+    ON recommendation_logs (timestamp, id)
+    WHERE outcome IS NULL;
+
+DROP INDEX IF EXISTS ix_recommendation_logs_outcome_timestamp_id;
@@ -1,13 +1,14 @@
 # Models Module
 # SQLAlchemy ORM models for PULSE backend
 
-from .base import Base, engine, SessionLocal, get_db, init_db, drop_db, test_connection
+from .base import Base, engine, SessionLocal, get_db, get_read_db, init_db, drop_db, test_connection
 from .task import Task
 from .schedule import ScheduleBlock
 from .reflection import Reflection
 from .mood import MoodEntry
 from .user import User
 from .recommendation_log import RecommendationLog
+from .daily_rollup import DailyUserRollup, RollupDirtyDay
 from .extension_metadata import (
     BrowsingSession,
     UserExtensionConsent,
@@ -20,6 +21,7 @@ __all__ = [
     "engine",
     "SessionLocal",
     "get_db",
+    "get_read_db",
     "init_db",
     "drop_db",
     "test_connection",
@@ -29,6 +31,8 @@ __all__ = [
     "MoodEntry",
     "User",
     "RecommendationLog",
+    "DailyUserRollup",
+    "RollupDirtyDay",
     "BrowsingSession",
     "UserExtensionConsent",
     "ConsentVersion",
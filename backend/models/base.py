@@ -4,13 +4,17 @@ SQLAlchemy engine, session, and base model setup.
 Supports SQLite (local dev), Railway PostgreSQL, and Supabase PostgreSQL.
 """
 
-from typing import Generator
-from sqlalchemy import create_engine, text
+from typing import Generator, Tuple
+from sqlalchemy import column, create_engine, event, table, text
+from sqlalchemy.engine import Engine, make_url
 from sqlalchemy.orm import declarative_base
 from sqlalchemy.orm import sessionmaker, Session
 from sqlalchemy.pool import StaticPool, QueuePool
 from urllib.parse import urlparse, urlunparse, parse_qs, urlencode
+from urllib.request import pathname2url
+import hashlib
 import os
+import sqlite3
 
 # Get DATABASE_URL from environment
 DATABASE_URL = os.getenv("DATABASE_URL")
@@ -75,15 +79,99 @@ else:
     DATABASE_URL = f"sqlite:///{os.path.join(DATABASE_DIR, 'pulse.db')}"
     print(f"[DB] Using SQLite (local dev): {DATABASE_URL}")
 
+# SQLite tuning for file databases: WAL journal, one serialized writer
+# connection and a pool of read-only connections (see get_read_db).
+# SQLITE_TUNED=false restores the single shared connection.
+SQLITE_TUNED = os.getenv("SQLITE_TUNED", "true").lower() == "true"
+SQLITE_READ_POOL_SIZE = int(os.getenv("SQLITE_READ_POOL_SIZE", "4"))
+SQLITE_BUSY_TIMEOUT_MS = 5000
+
+# Set on every tuned connection. WAL lets readers run alongside the writer;
+# synchronous=NORMAL is durable across crashes in WAL mode (a power loss can
+# drop the last commits, never corrupt the file).
+SQLITE_PRAGMAS = (
+    f"busy_timeout={SQLITE_BUSY_TIMEOUT_MS}",
+    "mmap_size=268435456",   # 256 MiB memory-mapped reads
+    "cache_size=-65536",     # 64 MiB page cache per connection
+    "temp_store=MEMORY",
+)
+SQLITE_WRITER_PRAGMAS = ("journal_mode=WAL", "synchronous=NORMAL")
+SQLITE_READER_PRAGMAS = ("query_only=ON",)
+
+
+def _sqlite_pragma_listener(pragmas: Tuple[str, ...]):
+    """Connect-event listener that applies PRAGMA statements."""
+    def set_pragmas(dbapi_connection, connection_record):
+        cursor = dbapi_connection.cursor()
+        try:
+            for pragma in pragmas:
+                cursor.execute(f"PRAGMA {pragma}")
+        finally:
+            cursor.close()
+    return set_pragmas
+
+
+def create_sqlite_engines(url: str, tuned: bool = SQLITE_TUNED) -> Tuple[Engine, Engine]:
+    """
+    Create the (writer, reader) engines for a SQLite URL.
+
+    Tuned mode: the writer is a pool of exactly one connection, so writes
+    queue in the pool instead of failing with "database is locked". Readers
+    have their own pool of read-only connections that see every committed
+    write (WAL) without waiting for the writer. In-memory databases and
+    untuned mode use one shared connection for both.
+
+    Args:
+        url: sqlite:/// URL
+        tuned: Use WAL, pragmas and separate reader connections
+
+    Returns:
+        (writer engine, reader engine); the same engine twice when untuned
+    """
+    database = make_url(url).database
+    if not tuned or not database or database == ":memory:" or database.startswith("file:"):
+        engine = create_engine(
+            url,
+            connect_args={"check_same_thread": False},
+            poolclass=StaticPool,
+            echo=False
+        )
+        return engine, engine
+
+    writer = create_engine(
+        url,
+        connect_args={"check_same_thread": False, "timeout": SQLITE_BUSY_TIMEOUT_MS / 1000},
+        poolclass=QueuePool,
+        pool_size=1,
+        max_overflow=0,
+        pool_timeout=30,
+        echo=False
+    )
+    event.listen(writer, "connect", _sqlite_pragma_listener(SQLITE_WRITER_PRAGMAS + SQLITE_PRAGMAS))
+
+    read_uri = f"file:{pathname2url(os.path.abspath(database))}?mode=ro"
+    reader = create_engine(
+        "sqlite://",
+        creator=lambda: sqlite3.connect(
+            read_uri, uri=True, check_same_thread=False, timeout=SQLITE_BUSY_TIMEOUT_MS / 1000
+        ),
+        poolclass=QueuePool,
+        pool_size=SQLITE_READ_POOL_SIZE,
+        max_overflow=SQLITE_READ_POOL_SIZE,
+        pool_timeout=30,
+        echo=False
+    )
+    event.listen(reader, "connect", _sqlite_pragma_listener(SQLITE_PRAGMAS + SQLITE_READER_PRAGMAS))
+
+    return writer, reader
+
+
 # Create engine with appropriate settings
 if DATABASE_URL.startswith("sqlite"):
     # SQLite-specific settings (local development)
-    engine = create_engine(
-        DATABASE_URL,
-        connect_args={"check_same_thread": False},
-        poolclass=StaticPool,
-        echo=False
-    )
+    engine, read_engine = create_sqlite_engines(DATABASE_URL)
+    if read_engine is not engine:
+        print(f"[DB] SQLite tuned: WAL, 1 writer, {SQLITE_READ_POOL_SIZE} read-only connections")
 else:
     # PostgreSQL settings (Railway or Supabase)
     # Supabase uses connection pooling via PgBouncer, so we adjust settings
@@ -104,12 +192,14 @@ else:
             "options": "-c statement_timeout=30000"  # 30 second query timeout
         } if is_supabase else {}
     )
+    read_engine = engine  # PostgreSQL readers don't block writers
 
     if is_supabase:
         print("[DB] Supabase detected - using optimized connection settings")
 
-# Create session factory
+# Create session factories
 SessionLocal = sessionmaker(autocommit=False, autoflush=False, bind=engine)
+ReadSessionLocal = sessionmaker(autocommit=False, autoflush=False, bind=read_engine)
 
 # Create base class for models
 Base = declarative_base()
@@ -127,10 +217,99 @@ def get_db() -> Generator[Session, None, None]:
         db.close()
 
 
+def get_read_db() -> Generator[Session, None, None]:
+    """
+    Dependency that provides a read-only database session, for GET routes.
+    On tuned SQLite it comes from the read-only pool and never waits for
+    the writer; elsewhere it is an ordinary session.
+    """
+    db = ReadSessionLocal()
+    try:
+        yield db
+    finally:
+        db.close()
+
+
+# Bump when _run_migrations() or a migrations/*.sql file changes the schema
+# outside the models. Model changes are covered by schema_fingerprint().
+SCHEMA_VERSION = 5
+
+# FORCE_SCHEMA_CHECK=true runs create_all and the migrations even when the
+# stored schema version is current (e.g. after editing the schema by hand).
+FORCE_SCHEMA_CHECK = os.getenv("FORCE_SCHEMA_CHECK", "false").lower() == "true"
+
+
+def schema_fingerprint() -> str:
+    """
+    Version string for the current code's schema.
+
+    SCHEMA_VERSION plus a digest of every registered table, column and
+    index, so adding a model or column invalidates the stored version
+    without anyone remembering to bump it.
+    """
+    parts = []
+    for table in sorted(Base.metadata.tables.values(), key=lambda t: t.name):
+        parts.append(table.name)
+        parts.extend(f"{column.name}:{type(column.type).__name__}" for column in table.columns)
+        parts.extend(sorted(index.name or "" for index in table.indexes))
+    digest = hashlib.sha256("\n".join(parts).encode()).hexdigest()[:16]
+    return f"{SCHEMA_VERSION}:{digest}"
+
+
+def read_schema_version(bind: Engine) -> str:
+    """Stored schema version, or "" if the database was never stamped."""
+    try:
+        with bind.connect() as conn:
+            version = conn.execute(text("SELECT version FROM schema_version WHERE id = 1")).scalar()
+    except Exception:
+        return ""  # Table missing (new or pre-versioning database)
+    return version or ""
+
+
+# Kept out of Base.metadata so it doesn't change schema_fingerprint()
+_schema_version_table = table("schema_version", column("id"), column("version"))
+
+
+def stamp_schema_version(bind: Engine, version: str) -> None:
+    """
+    Record `version` as the database's schema version.
+
+    A single upsert on PostgreSQL and SQLite, so a concurrent starter never
+    sees the row missing; other dialects update, then insert if absent.
+    """
+    with bind.begin() as conn:
+        conn.execute(text(
+            "CREATE TABLE IF NOT EXISTS schema_version (id INTEGER PRIMARY KEY, version VARCHAR(64) NOT NULL)"
+        ))
+        dialect = conn.dialect.name
+        if dialect in ("postgresql", "sqlite"):
+            if dialect == "postgresql":
+                from sqlalchemy.dialects.postgresql import insert as dialect_insert
+            else:
+                from sqlalchemy.dialects.sqlite import insert as dialect_insert
+
+            stmt = dialect_insert(_schema_version_table).values(id=1, version=version)
+            conn.execute(stmt.on_conflict_do_update(
+                index_elements=["id"],
+                set_={"version": stmt.excluded.version},
+            ))
+        else:
+            updated = conn.execute(
+                _schema_version_table.update()
+                .where(_schema_version_table.c.id == 1)
+                .values(version=version)
+            ).rowcount
+            if not updated:
+                conn.execute(_schema_version_table.insert().values(id=1, version=version))
+
+
 def init_db() -> None:
     """
     Create all tables in the database.
     Call this on application startup.
+
+    Skips create_all, the migrations and the default-user check when the
+    database is already stamped with the current schema_fingerprint().
     """
     # Log which tables will be created
     table_names = list(Base.metadata.tables.keys())
@@ -146,25 +325,39 @@ def init_db() -> None:
             conn.execute(text("SELECT 1"))
             print("[DB] Database connection successful")
 
+        version = schema_fingerprint()
+        if not FORCE_SCHEMA_CHECK and read_schema_version(engine) == version:
+            print(f"[DB] Schema version {version} is current - skipping create_all and migrations")
+            return
+
         # Create all tables
         Base.metadata.create_all(bind=engine)
         print(f"[DB] init_db() complete - {len(table_names)} tables created/verified")
 
         # Run migrations to add missing columns
-        _run_migrations()
+        migrated = _run_migrations()
 
         # Create default user if it doesn't exist (required for AI features)
         _ensure_default_user()
 
+        # A failed migration must run again next start. The information_schema
+        # checks only apply to PostgreSQL, so they always "fail" on SQLite.
+        if migrated or engine.dialect.name != "postgresql":
+            stamp_schema_version(engine, version)
+            print(f"[DB] Schema version stamped: {version}")
+
     except Exception as e:
         print(f"[DB] ERROR during init_db(): {e}")
         raise
 
 
-def _run_migrations() -> None:
+def _run_migrations() -> bool:
     """
     Run database migrations to add missing columns.
     This ensures the schema is up-to-date with the latest model definitions.
+
+    Returns:
+        False if the migration check failed
     """
     db = SessionLocal()
     try:
@@ -179,7 +372,7 @@ def _run_migrations() -> None:
 
         if not table_exists:
             print("[DB] Users table does not exist yet - will be created by create_all()")
-            return
+            return True
 
         # Check if users table has the new auth columns
         result = db.execute(text("""
@@ -187,7 +380,7 @@ def _run_migrations() -> None:
             FROM information_schema.columns
             WHERE table_schema = 'public'
             AND table_name = 'users'
-            AND column_name IN ('email', 'password_hash', 'is_active', 'username')
+            AND column_name IN ('email', 'password_hash', 'is_active', 'username', 'token_version')
         """))
         existing_columns = {row[0] for row in result.fetchall()}
 
@@ -215,6 +408,11 @@ def _run_migrations() -> None:
             db.execute(text("ALTER TABLE users ADD COLUMN is_active BOOLEAN DEFAULT TRUE"))
             migrations_run.append("is_active")
 
+        # Add token_version column if missing (access token revocation)
+        if 'token_version' not in existing_columns:
+            db.execute(text("ALTER TABLE users ADD COLUMN token_version INTEGER NOT NULL DEFAULT 0"))
+            migrations_run.append("token_version")
+
         if migrations_run:
             db.commit()
             # Update existing users with default values (separate transaction)
@@ -231,11 +429,13 @@ def _run_migrations() -> None:
             print(f"[DB] Migrations applied: {', '.join(migrations_run)}")
         else:
             print("[DB] Schema is up-to-date, no migrations needed")
+        return True
 
     except Exception as e:
         db.rollback()
         print(f"[DB] Warning: Migration check failed: {e}")
         # Don't raise - let app continue, create_all will handle new tables
+        return False
     finally:
         db.close()
 
@@ -283,6 +483,8 @@ def drop_db() -> None:
     Use with caution - this deletes all data!
     """
     Base.metadata.drop_all(bind=engine)
+    with engine.begin() as conn:
+        conn.execute(text("DROP TABLE IF EXISTS schema_version"))
 
 
 def test_connection() -> bool:
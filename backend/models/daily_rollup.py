@@ -0,0 +1,120 @@
+"""
+Daily Rollup Models
+SQLAlchemy ORM models for per-user daily aggregates behind the insights endpoints.
+"""
+
+from typing import Any
+from sqlalchemy import Column, Integer, Float, Boolean, Date, DateTime, JSON, ForeignKey, UniqueConstraint
+from .base import Base
+
+
+class DailyUserRollup(Base):
+    """
+    One user's activity for one UTC day, aggregated from the raw tables.
+
+    Rows are rebuilt from scratch for a (user, day) whenever that day is
+    marked dirty (see tasks/rollups.py), so they never drift from the
+    source rows. Days without any activity have no row.
+
+    Attributes:
+        recommendations_by_action: {action_type: count}
+        recommendations_by_outcome: {outcome: count}, "pending" for no outcome yet
+        recommendations_by_strategy: {strategy_used: count}
+        reward_sum / reward_count: Average reward is reward_sum / reward_count
+        mood_counts: {mood: count} from mood entries
+        reflection_mood_score: That day's reflection score (1-5), if any
+        reflection_distractions: Distraction tags from that day's reflection
+        tasks_completed / completed_task_hours: Tasks completed that day
+        focus_minutes / tracked_minutes: Work and total time from browsing sessions
+        recommendations_archived / sessions_archived: The day's source rows
+            were moved to cold storage; those figures are final
+    """
+    __tablename__ = "daily_user_rollups"
+    __table_args__ = (
+        UniqueConstraint('user_id', 'day', name='uq_daily_user_rollups_user_day'),
+    )
+
+    id = Column(Integer, primary_key=True, index=True)
+    user_id = Column(Integer, ForeignKey('users.id'), nullable=False)
+    day = Column(Date, nullable=False)
+
+    # Recommendations
+    recommendation_count = Column(Integer, nullable=False, default=0)
+    followed_count = Column(Integer, nullable=False, default=0)
+    recommendations_by_action = Column(JSON, nullable=False, default=dict)
+    recommendations_by_outcome = Column(JSON, nullable=False, default=dict)
+    recommendations_by_strategy = Column(JSON, nullable=False, default=dict)
+    reward_sum = Column(Float, nullable=False, default=0.0)
+    reward_count = Column(Integer, nullable=False, default=0)
+
+    # Mood and reflections
+    mood_count = Column(Integer, nullable=False, default=0)
+    mood_counts = Column(JSON, nullable=False, default=dict)
+    reflection_mood_score = Column(Integer, nullable=True)
+    reflection_completed_tasks = Column(Integer, nullable=True)
+    reflection_total_tasks = Column(Integer, nullable=True)
+    reflection_distractions = Column(JSON, nullable=False, default=list)
+
+    # Tasks
+    tasks_completed = Column(Integer, nullable=False, default=0)
+    completed_task_hours = Column(Float, nullable=False, default=0.0)
+
+    # Browsing sessions (minutes)
+    focus_minutes = Column(Integer, nullable=False, default=0)
+    tracked_minutes = Column(Integer, nullable=False, default=0)
+
+    # Set by the archive job once it removes the day's source rows
+    recommendations_archived = Column(Boolean, nullable=False, default=False)
+    sessions_archived = Column(Boolean, nullable=False, default=False)
+
+    refreshed_at = Column(DateTime(timezone=True), nullable=True)
+
+    def __repr__(self) -> str:
+        return f"<DailyUserRollup(user_id={self.user_id}, day={self.day})>"
+
+    @property
+    def average_reward(self) -> float | None:
+        """Mean reward of the day's recommendations that have one."""
+        if not self.reward_count:
+            return None
+        return self.reward_sum / self.reward_count
+
+    def to_dict(self) -> dict[str, Any]:
+        """Convert model to dictionary (for API responses)."""
+        return {
+            "date": self.day.isoformat(),
+            "recommendations": self.recommendation_count,
+            "followed": self.followed_count,
+            "byAction": self.recommendations_by_action or {},
+            "byOutcome": self.recommendations_by_outcome or {},
+            "byStrategy": self.recommendations_by_strategy or {},
+            "averageReward": self.average_reward,
+            "moodCount": self.mood_count,
+            "moodCounts": self.mood_counts or {},
+            "reflectionMoodScore": self.reflection_mood_score,
+            "reflectionCompletedTasks": self.reflection_completed_tasks,
+            "reflectionTotalTasks": self.reflection_total_tasks,
+            "reflectionDistractions": self.reflection_distractions or [],
+            "tasksCompleted": self.tasks_completed,
+            "completedTaskHours": self.completed_task_hours,
+            "focusMinutes": self.focus_minutes,
+            "trackedMinutes": self.tracked_minutes,
+        }
+
+
+class RollupDirtyDay(Base):
+    """
+    A (user, day) whose rollup is out of date.
+
+    Written in the same transaction as the source change; the background
+    refresh rebuilds the rollup and deletes the mark. marked_at is bumped on
+    every new change, so a mark set while a refresh is running survives it.
+    """
+    __tablename__ = "rollup_dirty_days"
+
+    user_id = Column(Integer, primary_key=True)
+    day = Column(Date, primary_key=True)
+    marked_at = Column(DateTime(timezone=True), nullable=False)
+
+    def __repr__(self) -> str:
+        return f"<RollupDirtyDay(user_id={self.user_id}, day={self.day})>"
@@ -4,7 +4,7 @@ SQLAlchemy ORM model for tracking AI recommendations.
 """
 
 from typing import Any, Optional
-from sqlalchemy import Column, Integer, String, Float, Boolean, DateTime, Text, ForeignKey, JSON
+from sqlalchemy import Column, Integer, String, Float, Boolean, DateTime, Text, ForeignKey, JSON, Index
 from sqlalchemy.sql import func
 from .base import Base
 
@@ -60,6 +60,19 @@ class RecommendationLog(Base):
     task_completed_at = Column(DateTime(timezone=True), nullable=True)
     activity_gap_seconds = Column(Integer, nullable=True)
 
+    # Composite indexes for outcome inference
+    __table_args__ = (
+        # Keyset scan of pending logs ordered by (timestamp, id). Partial, so
+        # it holds only the small pending set, not every resolved log
+        Index(
+            'ix_recommendation_logs_pending_timestamp_id', 'timestamp', 'id',
+            postgresql_where=outcome.is_(None),
+            sqlite_where=outcome.is_(None),
+        ),
+        # Successor lookup (next recommendation for the same user)
+        Index('ix_recommendation_logs_user_timestamp', 'user_id', 'timestamp'),
+    )
+
     def __repr__(self) -> str:
         return f"<RecommendationLog(id={self.id}, action={self.action_type}, outcome={self.outcome})>"
 
@@ -53,9 +53,11 @@ class Task(Base):
     created_at = Column(DateTime(timezone=True), server_default=func.now())
     updated_at = Column(DateTime(timezone=True), onupdate=func.now())
 
-    # Composite index for AI queries
+    # Composite indexes for AI queries
     __table_args__ = (
         Index('ix_tasks_user_status_deleted', 'user_id', 'status', 'is_deleted'),
+        # TaskSelector candidate scan: equality prefix + priority range
+        Index('ix_tasks_user_active_priority', 'user_id', 'status', 'is_deleted', 'is_archived', 'priority'),
     )
 
     def __repr__(self) -> str:
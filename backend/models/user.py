@@ -19,6 +19,7 @@ class User(Base):
         username: Display name
         password_hash: Hashed password (not exposed in API)
         is_active: Whether account is active
+        token_version: Embedded in access tokens; bumped to revoke them
         created_at: When the user was created
     """
     __tablename__ = "users"
@@ -28,6 +29,7 @@ class User(Base):
     username = Column(String(50), unique=True, nullable=False)
     password_hash = Column(String(255), nullable=False)
     is_active = Column(Boolean, default=True)
+    token_version = Column(Integer, nullable=False, default=0, server_default="0")
     created_at = Column(DateTime(timezone=True), server_default=func.now())
 
     def __repr__(self) -> str:
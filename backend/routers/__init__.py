@@ -8,6 +8,7 @@ from .mood_router import router as mood_router
 from .ai_router import router as ai_router
 from .extension_router import router as extension_router
 from .auth_router import router as auth_router
+from .insights_router import router as insights_router
 
 __all__ = [
     "tasks_router",
@@ -17,5 +18,6 @@ __all__ = [
     "ai_router",
     "extension_router",
     "auth_router",
+    "insights_router",
 ]
 
@@ -9,18 +9,22 @@ This module provides TRUE AI functionality:
 - Context-aware optimization based on user energy, mood, and cognitive load
 """
 
+import json
 from datetime import datetime, timezone
 from typing import Optional, List
 from fastapi import APIRouter, Depends, HTTPException, Query
+from fastapi.concurrency import run_in_threadpool
+from fastapi.responses import StreamingResponse
 from sqlalchemy.orm import Session
 
-from models.base import get_db
+from models.base import get_db, get_read_db, SessionLocal
 from models.recommendation_log import RecommendationLog
 from models.mood import MoodEntry
 from models.user import User
 from models.task import Task
 from models.schedule import ScheduleBlock
 from core.auth import get_current_user
+from core.metrics import span
 from schema.recommendation import (
     RecommendationResponse,
     RecommendationFeedback,
@@ -39,6 +43,7 @@ from ai.agent import ScheduleAgent
 from ai.llm_service import get_llm_service
 from ai.context_encoder import ContextEncoder
 from ai.mood_mapper import MoodMapper
+from ai.user_context import invalidate_user_context
 
 
 router = APIRouter(prefix="/ai", tags=["AI"])
@@ -71,10 +76,13 @@ def get_recommendation(
         user_id = current_user.id
 
         # Update previous recommendation's next_recommendation_at for implicit feedback
-        _update_previous_recommendation(db, user_id)
+        with span("recommendation.update_previous"):
+            _update_previous_recommendation(db, user_id)
 
-        # Get recommendation
-        result = _recommender.get_recommendation(db, user_id)
+        # Get recommendation (result.context is the snapshot every stage used)
+        with span("recommendation.recommender"):
+            result = _recommender.get_recommendation(db, user_id)
+        context = result.context
 
         # Get alternative tasks if applicable
         alternative_tasks = None
@@ -82,9 +90,11 @@ def get_recommendation(
             from ai.state import StateSerializer
             from ai.actions import ActionType
             state = StateSerializer.from_key(result.state_key)
-            alternatives = _task_selector.get_task_suggestions(
-                ActionType(result.action.value), state, db, user_id=user_id, limit=3
-            )
+            with span("recommendation.alternatives"):
+                alternatives = _task_selector.get_task_suggestions(
+                    ActionType(result.action.value), state, db, user_id=user_id, limit=3,
+                    context=context
+                )
             alternative_tasks = [
                 TaskSuggestion(
                     id=t.id,
@@ -96,10 +106,8 @@ def get_recommendation(
                 for t in alternatives if t.id != result.task_id
             ]
 
-        # Get current mood for logging (user's mood only)
-        mood_entry = db.query(MoodEntry).filter(
-            MoodEntry.user_id == user_id
-        ).order_by(MoodEntry.timestamp.desc()).first()
+        # Current mood for logging comes from the same snapshot
+        mood_entry = context.latest_mood if context else None
 
         # Create log entry
         log = RecommendationLog(
@@ -117,17 +125,20 @@ def get_recommendation(
             explanation=result.explanation,
             mood_before=mood_entry.mood if mood_entry else None,
         )
-        db.add(log)
-        db.commit()
-        db.refresh(log)
+        with span("recommendation.log_insert"):
+            db.add(log)
+            db.commit()
+            db.refresh(log)
 
         # Build response
         suggested_task = None
         if result.task_id:
-            task = db.query(Task).filter(
-                Task.id == result.task_id,
-                Task.user_id == user_id
-            ).first()
+            task = context.get_task(result.task_id) if context else None
+            if task is None:
+                task = db.query(Task).filter(
+                    Task.id == result.task_id,
+                    Task.user_id == user_id
+                ).first()
             if task:
                 suggested_task = TaskSuggestion(
                     id=task.id,
@@ -208,21 +219,23 @@ def submit_feedback(
 
     # Calculate reward and update agent
     from ai.actions import ActionType
-    reward = _recommender.record_feedback(
-        db=db,
-        state_key=log.state_key,
-        action=ActionType(log.action_type),
-        outcome=outcome,
-        user_id=log.user_id,
-        mood_before=log.mood_before,
-        mood_after=feedback.mood_after,
-        user_rating=feedback.rating,
-        suggested_duration=log.suggested_duration_minutes,
-        actual_duration=feedback.actual_duration_minutes,
-    )
+    with span("feedback.record"):
+        reward = _recommender.record_feedback(
+            db=db,
+            state_key=log.state_key,
+            action=ActionType(log.action_type),
+            outcome=outcome,
+            user_id=log.user_id,
+            mood_before=log.mood_before,
+            mood_after=feedback.mood_after,
+            user_rating=feedback.rating,
+            suggested_duration=log.suggested_duration_minutes,
+            actual_duration=feedback.actual_duration_minutes,
+        )
 
     log.reward = reward
-    db.commit()
+    with span("feedback.commit"):
+        db.commit()
 
     # Determine message based on outcome
     if outcome == Outcome.COMPLETED:
@@ -243,7 +256,7 @@ def submit_feedback(
 
 @router.get("/stats", response_model=AgentStatsResponse)
 def get_stats(
-    db: Session = Depends(get_db),
+    db: Session = Depends(get_read_db),
     current_user: User = Depends(get_current_user)
 ):
     """
@@ -270,7 +283,7 @@ def get_stats(
 
 @router.get("/phase", response_model=UserPhaseInfo)
 def get_phase(
-    db: Session = Depends(get_db),
+    db: Session = Depends(get_read_db),
     current_user: User = Depends(get_current_user)
 ):
     """
@@ -338,8 +351,9 @@ def persist_agent_models(
 
 
 @router.post("/breakdown-task/{task_id}")
-def breakdown_task(
+async def breakdown_task(
     task_id: int,
+    read_db: Session = Depends(get_read_db),
     db: Session = Depends(get_db),
     current_user: User = Depends(get_current_user)
 ):
@@ -355,10 +369,54 @@ def breakdown_task(
 
     Falls back to intelligent rule-based breakdown when no LLM is available.
     """
+    # Database work runs in the threadpool; the LLM call is awaited on the loop.
+    # Inputs come from a read session released before the await, and the
+    # writer session is first used after it, so no connection (in particular
+    # the single SQLite writer) is held while the model runs.
+    inputs = await run_in_threadpool(_load_breakdown_inputs, read_db, current_user.id, task_id)
+    read_db.close()
+    if "response" in inputs:
+        return inputs["response"]
+
+    llm_service = get_llm_service()
+    breakdown = await llm_service.breakdown_task_intelligently_async(
+        inputs["task"], inputs["user_context"]
+    )
+
+    created_subtasks = await run_in_threadpool(
+        _save_subtasks, db, current_user.id, inputs["task"], breakdown.subtasks
+    )
+
+    return {
+        "message": f"Task intelligently broken down into {len(created_subtasks)} subtasks",
+        "subtasks": [
+            {
+                "id": t.id,
+                "title": t.title,
+                "description": t.description,
+                "duration": t.duration,
+                "difficulty": t.difficulty
+            }
+            for t in created_subtasks
+        ],
+        "reasoning": breakdown.reasoning,
+        "estimated_total_time": breakdown.estimated_total_time,
+        "ai_powered": True
+    }
+
+
+def _load_breakdown_inputs(db: Session, user_id: int, task_id: int) -> dict:
+    """
+    Load the task to break down and the user's context.
+
+    Returns:
+        {"response": ...} if the task was already broken down, otherwise
+        {"task": task_data, "user_context": user_context}
+    """
     # Get the task (must belong to current user)
     task = db.query(Task).filter(
         Task.id == task_id,
-        Task.user_id == current_user.id,
+        Task.user_id == user_id,
         Task.is_deleted == False
     ).first()
     if not task:
@@ -367,18 +425,17 @@ def breakdown_task(
     # Check if already broken down
     existing_subtasks = db.query(Task).filter(
         Task.parent_id == task_id,
-        Task.user_id == current_user.id,
+        Task.user_id == user_id,
         Task.is_deleted == False
     ).all()
     if existing_subtasks:
-        return {
+        return {"response": {
             "message": "Task already broken down",
             "subtasks": [{"id": t.id, "title": t.title, "duration": t.duration} for t in existing_subtasks],
             "ai_powered": False
-        }
+        }}
 
     # Get user context for personalization
-    user_id = current_user.id
     mood_entry = db.query(MoodEntry).filter(
         MoodEntry.user_id == user_id
     ).order_by(MoodEntry.timestamp.desc()).first()
@@ -395,8 +452,6 @@ def breakdown_task(
         "preferred_session_length": 45  # Default 45-minute sessions
     }
 
-    # Use LLM service for intelligent breakdown
-    llm_service = get_llm_service()
     task_data = {
         "id": task.id,
         "title": task.title,
@@ -407,19 +462,21 @@ def breakdown_task(
         "deadline": str(task.deadline) if task.deadline else None
     }
 
-    breakdown = llm_service.breakdown_task_intelligently(task_data, user_context)
+    return {"task": task_data, "user_context": user_context}
 
-    # Create subtasks from breakdown
+
+def _save_subtasks(db: Session, user_id: int, task_data: dict, subtasks: List[dict]) -> List[Task]:
+    """Create subtasks from a breakdown under the parent task."""
     created_subtasks = []
-    for sub in breakdown.subtasks:
+    for sub in subtasks:
         subtask = Task(
-            user_id=current_user.id,
-            title=sub.get("title", f"{task.title} - Step"),
+            user_id=user_id,
+            title=sub.get("title", f"{task_data['title']} - Step"),
             description=sub.get("description", ""),
             duration=sub.get("duration_hours", 0.5),
-            difficulty=sub.get("difficulty", task.difficulty),
-            parent_id=task_id,
-            priority=task.priority,
+            difficulty=sub.get("difficulty", task_data["difficulty"]),
+            parent_id=task_data["id"],
+            priority=task_data["priority"],
             estimated_duration=int(sub.get("duration_hours", 0.5) * 60)  # Convert to minutes
         )
         db.add(subtask)
@@ -431,26 +488,120 @@ def breakdown_task(
     for subtask in created_subtasks:
         db.refresh(subtask)
 
-    return {
-        "message": f"Task intelligently broken down into {len(created_subtasks)} subtasks",
-        "subtasks": [
-            {
-                "id": t.id,
-                "title": t.title,
-                "description": t.description,
-                "duration": t.duration,
-                "difficulty": t.difficulty
-            }
-            for t in created_subtasks
-        ],
-        "reasoning": breakdown.reasoning,
-        "estimated_total_time": breakdown.estimated_total_time,
-        "ai_powered": True
-    }
+    return created_subtasks
+
+
+@router.post("/breakdown-task/{task_id}/stream")
+async def breakdown_task_stream(
+    task_id: int,
+    db: Session = Depends(get_read_db),
+    current_user: User = Depends(get_current_user)
+):
+    """
+    Stream a task breakdown as Server-Sent Events.
+
+    Same analysis as /breakdown-task, but each subtask is sent as soon as the
+    model produces it and saved in small batches.
+
+    **Events:**
+    - `subtask`: {index, title, description, duration, difficulty}
+    - `saved`: {ids: {index: subtask_id}} after each committed batch
+    - `done`: {message, reasoning, estimated_total_time, ai_powered}
+    - `error`: {detail} if persistence fails
+
+    If the task was already broken down, responds with plain JSON as
+    /breakdown-task does.
+    """
+    inputs = await run_in_threadpool(_load_breakdown_inputs, db, current_user.id, task_id)
+    # Dependency teardown only runs after the stream ends: release the
+    # connection now rather than holding it for the whole response
+    db.close()
+    if "response" in inputs:
+        return inputs["response"]
+
+    return StreamingResponse(
+        _breakdown_events(current_user.id, inputs["task"], inputs["user_context"]),
+        media_type="text/event-stream",
+        headers=_SSE_HEADERS
+    )
+
+
+async def _breakdown_events(user_id: int, task_data: dict, user_context: dict):
+    """SSE generator for breakdown_task_stream (a fresh session per batch)."""
+    batch_size = AIConfig.LLM_STREAM_PERSIST_BATCH_SIZE
+    pending = []  # (index, subtask dict) not yet committed
+    count = 0
+    try:
+        async for kind, payload in get_llm_service().stream_task_breakdown(task_data, user_context):
+            if kind == "summary":
+                breakdown = payload
+                continue
+
+            yield _sse("subtask", {
+                "index": count,
+                "title": payload.get("title", f"{task_data['title']} - Step"),
+                "description": payload.get("description", ""),
+                "duration": payload.get("duration_hours", 0.5),
+                "difficulty": payload.get("difficulty", task_data["difficulty"]),
+            })
+            pending.append((count, payload))
+            count += 1
+
+            if len(pending) >= batch_size:
+                yield await _flush_subtasks(user_id, task_data, pending)
+                pending = []
+
+        if pending:
+            yield await _flush_subtasks(user_id, task_data, pending)
+
+        yield _sse("done", {
+            "message": f"Task intelligently broken down into {count} subtasks",
+            "reasoning": breakdown.reasoning,
+            "estimated_total_time": breakdown.estimated_total_time,
+            "ai_powered": True
+        })
+    except Exception as e:
+        print(f"[AI] Streaming breakdown error: {type(e).__name__}: {e}")
+        yield _sse("error", {"detail": f"{type(e).__name__}: {e}"})
+
+
+def _in_write_session(func, *args):
+    """
+    Run a write helper on its own short-lived session.
+
+    Streaming generators call this per batch, so the writer connection
+    (a pool of one on tuned SQLite) is never held between batches or
+    while waiting on the model.
+    """
+    db = SessionLocal()
+    try:
+        return func(db, *args)
+    finally:
+        db.close()
+
+
+async def _flush_subtasks(user_id: int, task_data: dict, pending: list) -> str:
+    """Commit a batch of streamed subtasks and return the `saved` event."""
+    created = await run_in_threadpool(
+        _in_write_session, _save_subtasks, user_id, task_data, [sub for _, sub in pending]
+    )
+    return _sse("saved", {"ids": {index: t.id for (index, _), t in zip(pending, created)}})
+
+
+_SSE_HEADERS = {
+    "Cache-Control": "no-cache",
+    "X-Accel-Buffering": "no",  # Don't let nginx buffer the stream
+}
+
+
+def _sse(event: str, data: dict) -> str:
+    """Format one Server-Sent Event."""
+    return f"event: {event}\ndata: {json.dumps(data, default=str)}\n\n"
 
 
 @router.post("/generate-schedule")
-def generate_ai_schedule(
+async def generate_ai_schedule(
+    read_db: Session = Depends(get_read_db),
     db: Session = Depends(get_db),
     current_user: User = Depends(get_current_user)
 ):
@@ -482,144 +633,35 @@ def generate_ai_schedule(
     try:
         user_id = current_user.id
         now = datetime.now(timezone.utc)
-        current_hour = now.hour
 
-        # Get pending tasks for this user
-        pending_tasks = db.query(Task).filter(
-            Task.user_id == user_id,
-            Task.is_deleted == False,
-            Task.completed == False
-        ).order_by(Task.priority.desc(), Task.deadline.asc().nullslast()).all()
-
-        if not pending_tasks:
+        # Read session released before the LLM await; the writer is only
+        # touched afterwards (see breakdown_task)
+        inputs = await run_in_threadpool(_load_schedule_inputs, read_db, user_id, now)
+        read_db.close()
+        if inputs is None:
             return {
                 "message": "No pending tasks to schedule",
                 "blocks": [],
                 "ai_powered": True,
                 "optimization_notes": "Add some tasks to get started with AI scheduling!"
             }
-
-        # Get existing fixed blocks for this user
-        fixed_blocks = db.query(ScheduleBlock).filter(
-            ScheduleBlock.user_id == user_id,
-            ScheduleBlock.block_type == "fixed"
-        ).order_by(ScheduleBlock.start).all()
-
-        # Get user context for AI optimization
-        mood_entry = db.query(MoodEntry).filter(
-            MoodEntry.user_id == user_id
-        ).order_by(MoodEntry.timestamp.desc()).first()
-
-        tasks_completed_today = db.query(Task).filter(
-            Task.user_id == user_id,
-            Task.completed == True,
-            Task.updated_at >= now.replace(hour=0, minute=0, second=0)
-        ).count()
-
-        # Determine energy level from mood
-        energy_level = "medium"
-        mood_str = "neutral"
-        if mood_entry:
-            mood_str = mood_entry.mood
-            energy_level = _mood_mapper.mood_to_energy(mood_str)
-
-        # Get day of week
-        days = ["monday", "tuesday", "wednesday", "thursday", "friday", "saturday", "sunday"]
-        day_of_week = days[now.weekday()]
-
-        user_context = {
-            "current_hour": current_hour,
-            "energy_level": energy_level,
-            "mood": mood_str,
-            "day_of_week": day_of_week,
-            "tasks_completed": tasks_completed_today
-        }
-
-        # Format tasks for LLM
-        tasks_data = []
-        for task in pending_tasks:
-            tasks_data.append({
-                "id": task.id,
-                "title": task.title,
-                "description": task.description or "",
-                "priority": task.priority or 3,
-                "duration": task.duration or 1.0,
-                "difficulty": task.difficulty or "medium",
-                "deadline": str(task.deadline) if task.deadline else None
-            })
-
-        # Format fixed blocks for LLM
-        fixed_data = []
-        for block in fixed_blocks:
-            fixed_data.append({
-                "title": block.title,
-                "start": block.start,
-                "duration": block.duration,
-                "block_type": block.block_type
-            })
-
-        # Clear existing task blocks (regenerate schedule)
-        db.query(ScheduleBlock).filter(
-            ScheduleBlock.user_id == user_id,
-            ScheduleBlock.block_type.in_(["task", "break"])
-        ).delete(synchronize_session=False)
+        tasks_data, fixed_data, user_context = inputs
 
         # Use LLM service for intelligent scheduling
         llm_service = get_llm_service()
-        schedule_blocks = llm_service.generate_intelligent_schedule(
+        schedule_blocks = await llm_service.generate_intelligent_schedule_async(
             tasks=tasks_data,
             fixed_blocks=fixed_data,
             user_context=user_context,
             working_hours=(9.0, 20.0)
         )
 
-        # Create schedule blocks in database
-        created_blocks = []
-        scheduled_task_ids = set()
-
-        for ai_block in schedule_blocks:
-            block = ScheduleBlock(
-                user_id=user_id,
-                task_id=ai_block.task_id,
-                title=ai_block.title,
-                start=ai_block.start_hour,
-                duration=ai_block.duration_hours,
-                block_type=ai_block.block_type
-            )
-            db.add(block)
-            created_blocks.append({
-                "block": block,
-                "reasoning": ai_block.reasoning,
-                "energy_required": ai_block.energy_required,
-                "cognitive_load": ai_block.cognitive_load
-            })
-            if ai_block.task_id:
-                scheduled_task_ids.add(ai_block.task_id)
-
-        db.commit()
-
-        # Refresh blocks to get IDs
-        for item in created_blocks:
-            db.refresh(item["block"])
-
-        # Build response with AI insights
-        response_blocks = []
-        for item in created_blocks:
-            b = item["block"]
-            response_blocks.append({
-                "id": b.id,
-                "taskId": b.task_id,
-                "title": b.title,
-                "start": b.start,
-                "duration": b.duration,
-                "type": b.block_type,
-                "reasoning": item["reasoning"],
-                "energyRequired": item["energy_required"],
-                "cognitiveLoad": item["cognitive_load"]
-            })
+        response_blocks, scheduled_task_ids = await run_in_threadpool(
+            _replace_schedule_blocks, db, user_id, schedule_blocks
+        )
 
         # Count unscheduled tasks
-        unscheduled_count = len(pending_tasks) - len(scheduled_task_ids)
+        unscheduled_count = len(tasks_data) - len(scheduled_task_ids)
 
         # Generate optimization notes
         optimization_notes = _generate_optimization_notes(user_context, len(scheduled_task_ids), unscheduled_count)
@@ -630,10 +672,10 @@ def generate_ai_schedule(
             "unscheduled_tasks": unscheduled_count,
             "ai_powered": True,
             "user_context": {
-                "energy_level": energy_level,
-                "mood": mood_str,
-                "time_of_day": _get_time_block(current_hour),
-                "tasks_completed_today": tasks_completed_today
+                "energy_level": user_context["energy_level"],
+                "mood": user_context["mood"],
+                "time_of_day": _get_time_block(user_context["current_hour"]),
+                "tasks_completed_today": user_context["tasks_completed"]
             },
             "optimization_notes": optimization_notes
         }
@@ -645,6 +687,285 @@ def generate_ai_schedule(
         raise HTTPException(status_code=500, detail=error_detail)
 
 
+def _load_schedule_inputs(db: Session, user_id: int, now: datetime):
+    """
+    Gather pending tasks, fixed blocks and user context for schedule generation.
+
+    Returns:
+        (tasks_data, fixed_data, user_context), or None if nothing is pending
+    """
+    current_hour = now.hour
+
+    # Get pending tasks for this user
+    pending_tasks = db.query(Task).filter(
+        Task.user_id == user_id,
+        Task.is_deleted == False,
+        Task.completed == False
+    ).order_by(Task.priority.desc(), Task.deadline.asc().nullslast()).all()
+
+    if not pending_tasks:
+        return None
+
+    # Get existing fixed blocks for this user
+    fixed_blocks = db.query(ScheduleBlock).filter(
+        ScheduleBlock.user_id == user_id,
+        ScheduleBlock.block_type == "fixed"
+    ).order_by(ScheduleBlock.start).all()
+
+    # Get user context for AI optimization
+    mood_entry = db.query(MoodEntry).filter(
+        MoodEntry.user_id == user_id
+    ).order_by(MoodEntry.timestamp.desc()).first()
+
+    tasks_completed_today = db.query(Task).filter(
+        Task.user_id == user_id,
+        Task.completed == True,
+        Task.updated_at >= now.replace(hour=0, minute=0, second=0)
+    ).count()
+
+    # Determine energy level from mood
+    energy_level = "medium"
+    mood_str = "neutral"
+    if mood_entry:
+        mood_str = mood_entry.mood
+        energy_level = _mood_mapper.mood_to_energy(mood_str)
+
+    # Get day of week
+    days = ["monday", "tuesday", "wednesday", "thursday", "friday", "saturday", "sunday"]
+    day_of_week = days[now.weekday()]
+
+    user_context = {
+        "current_hour": current_hour,
+        "energy_level": energy_level,
+        "mood": mood_str,
+        "day_of_week": day_of_week,
+        "tasks_completed": tasks_completed_today
+    }
+
+    # Format tasks for LLM
+    tasks_data = []
+    for task in pending_tasks:
+        tasks_data.append({
+            "id": task.id,
+            "title": task.title,
+            "description": task.description or "",
+            "priority": task.priority or 3,
+            "duration": task.duration or 1.0,
+            "difficulty": task.difficulty or "medium",
+            "deadline": str(task.deadline) if task.deadline else None
+        })
+
+    # Format fixed blocks for LLM
+    fixed_data = []
+    for block in fixed_blocks:
+        fixed_data.append({
+            "title": block.title,
+            "start": block.start,
+            "duration": block.duration,
+            "block_type": block.block_type
+        })
+
+    return tasks_data, fixed_data, user_context
+
+
+def _replace_schedule_blocks(db: Session, user_id: int, schedule_blocks) -> tuple:
+    """
+    Replace the user's task and break blocks with a generated schedule.
+
+    The old blocks are cleared in the same transaction as the insert, so a
+    failed generation leaves the previous schedule in place.
+
+    Returns:
+        (response_blocks, scheduled_task_ids)
+    """
+    created = _insert_schedule_blocks(db, user_id, schedule_blocks, replace_existing=True)
+
+    # Build response with AI insights
+    response_blocks = [
+        _schedule_block_response(block, ai_block)
+        for block, ai_block in zip(created, schedule_blocks)
+    ]
+    scheduled_task_ids = {ai_block.task_id for ai_block in schedule_blocks if ai_block.task_id}
+
+    return response_blocks, scheduled_task_ids
+
+
+def _insert_schedule_blocks(
+    db: Session,
+    user_id: int,
+    schedule_blocks,
+    replace_existing: bool = False
+) -> List[ScheduleBlock]:
+    """
+    Insert generated blocks in one transaction.
+
+    Args:
+        db: Database session
+        user_id: Owner of the blocks
+        schedule_blocks: llm_service.ScheduleBlock items to insert
+        replace_existing: Clear the user's task/break blocks first
+
+    Returns:
+        The created ScheduleBlock rows (with IDs)
+    """
+    if replace_existing:
+        # Clear existing task blocks (regenerate schedule)
+        db.query(ScheduleBlock).filter(
+            ScheduleBlock.user_id == user_id,
+            ScheduleBlock.block_type.in_(["task", "break"])
+        ).delete(synchronize_session=False)
+
+    # Create schedule blocks in database
+    created_blocks = []
+    for ai_block in schedule_blocks:
+        block = ScheduleBlock(
+            user_id=user_id,
+            task_id=ai_block.task_id,
+            title=ai_block.title,
+            start=ai_block.start_hour,
+            duration=ai_block.duration_hours,
+            block_type=ai_block.block_type
+        )
+        db.add(block)
+        created_blocks.append(block)
+
+    db.commit()
+    if replace_existing:
+        invalidate_user_context(user_id)  # Bulk delete bypasses flush events
+
+    # Refresh blocks to get IDs
+    for block in created_blocks:
+        db.refresh(block)
+
+    return created_blocks
+
+
+def _schedule_block_response(block: Optional[ScheduleBlock], ai_block) -> dict:
+    """Response/event payload for a generated block (block may be unsaved)."""
+    return {
+        "id": block.id if block is not None else None,
+        "taskId": ai_block.task_id,
+        "title": ai_block.title,
+        "start": ai_block.start_hour,
+        "duration": ai_block.duration_hours,
+        "type": ai_block.block_type,
+        "reasoning": ai_block.reasoning,
+        "energyRequired": ai_block.energy_required,
+        "cognitiveLoad": ai_block.cognitive_load
+    }
+
+
+@router.post("/generate-schedule/stream")
+async def generate_ai_schedule_stream(
+    db: Session = Depends(get_read_db),
+    current_user: User = Depends(get_current_user)
+):
+    """
+    Stream an AI-optimized schedule as Server-Sent Events.
+
+    Same scheduling as /generate-schedule, but each block is sent as soon as
+    the model produces it (the response JSON is parsed incrementally) and
+    blocks are committed in small batches. If the model stalls or fails
+    mid-stream, the remaining tasks are placed by the rule-based scheduler
+    and the stream carries on.
+
+    **Events:**
+    - `start`: {task_count, user_context}
+    - `block`: {index, source ("llm"|"fallback"), ...block fields}
+    - `saved`: {ids: {index: block_id}} after each committed batch
+    - `done`: {message, blocks, unscheduled_tasks, fallback_used, optimization_notes, ...}
+    - `error`: {detail} if persistence fails
+
+    With no pending tasks, responds with plain JSON as /generate-schedule does.
+    """
+    user_id = current_user.id
+    now = datetime.now(timezone.utc)
+
+    inputs = await run_in_threadpool(_load_schedule_inputs, db, user_id, now)
+    db.close()  # Teardown would only run after the stream (see breakdown_task_stream)
+    if inputs is None:
+        return {
+            "message": "No pending tasks to schedule",
+            "blocks": [],
+            "ai_powered": True,
+            "optimization_notes": "Add some tasks to get started with AI scheduling!"
+        }
+
+    return StreamingResponse(
+        _schedule_events(user_id, *inputs),
+        media_type="text/event-stream",
+        headers=_SSE_HEADERS
+    )
+
+
+async def _schedule_events(user_id: int, tasks_data: list, fixed_data: list, user_context: dict):
+    """SSE generator for generate_ai_schedule_stream (a fresh session per batch)."""
+    batch_size = AIConfig.LLM_STREAM_PERSIST_BATCH_SIZE
+    pending = []  # (index, ai_block) not yet committed
+    replaced = False  # Old task/break blocks are cleared with the first batch
+    count = 0
+    fallback_used = False
+    scheduled_task_ids = set()
+
+    async def flush():
+        nonlocal pending, replaced
+        batch = pending
+        pending = []
+        created = await run_in_threadpool(
+            _in_write_session, _insert_schedule_blocks, user_id, [b for _, b in batch], not replaced
+        )
+        replaced = True
+        return _sse("saved", {"ids": {index: block.id for (index, _), block in zip(batch, created)}})
+
+    try:
+        yield _sse("start", {"task_count": len(tasks_data), "user_context": user_context})
+
+        stream = get_llm_service().stream_intelligent_schedule(
+            tasks=tasks_data,
+            fixed_blocks=fixed_data,
+            user_context=user_context,
+            working_hours=(9.0, 20.0)
+        )
+        async for source, ai_block in stream:
+            fallback_used = fallback_used or source == "fallback"
+            yield _sse("block", {
+                "index": count,
+                "source": source,
+                **_schedule_block_response(None, ai_block)
+            })
+            pending.append((count, ai_block))
+            count += 1
+            if ai_block.task_id:
+                scheduled_task_ids.add(ai_block.task_id)
+
+            if len(pending) >= batch_size:
+                yield await flush()
+
+        if pending or not replaced:
+            yield await flush()
+
+        unscheduled_count = len(tasks_data) - len(scheduled_task_ids)
+        yield _sse("done", {
+            "message": f"AI-optimized schedule generated with {count} blocks",
+            "blocks": count,
+            "unscheduled_tasks": unscheduled_count,
+            "ai_powered": True,
+            "fallback_used": fallback_used,
+            "user_context": {
+                "energy_level": user_context["energy_level"],
+                "mood": user_context["mood"],
+                "time_of_day": _get_time_block(user_context["current_hour"]),
+                "tasks_completed_today": user_context["tasks_completed"]
+            },
+            "optimization_notes": _generate_optimization_notes(
+                user_context, len(scheduled_task_ids), unscheduled_count
+            )
+        })
+    except Exception as e:
+        print(f"[AI] Streaming schedule error: {type(e).__name__}: {e}")
+        yield _sse("error", {"detail": f"{type(e).__name__}: {e}"})
+
+
 def _get_time_block(hour: int) -> str:
     """Convert hour to human-readable time block."""
     if 6 <= hour < 12:
@@ -686,7 +1007,7 @@ def _generate_optimization_notes(user_context: dict, scheduled: int, unscheduled
 
 
 @router.get("/smart-recommendation")
-def get_smart_recommendation(
+async def get_smart_recommendation(
     db: Session = Depends(get_db),
     current_user: User = Depends(get_current_user)
 ):
@@ -704,62 +1025,14 @@ def get_smart_recommendation(
     try:
         user_id = current_user.id
         now = datetime.now(timezone.utc)
-        current_hour = now.hour
-
-        # Get user's current mood
-        mood_entry = db.query(MoodEntry).filter(
-            MoodEntry.user_id == user_id
-        ).order_by(MoodEntry.timestamp.desc()).first()
-
-        # Get pending tasks
-        pending_tasks = db.query(Task).filter(
-            Task.user_id == user_id,
-            Task.is_deleted == False,
-            Task.completed == False
-        ).order_by(Task.priority.desc(), Task.deadline.asc().nullslast()).all()
-
-        # Get recent activity (last 3 recommendations)
-        recent_logs = db.query(RecommendationLog).filter(
-            RecommendationLog.user_id == user_id
-        ).order_by(RecommendationLog.timestamp.desc()).limit(5).all()
-
-        recent_activity = []
-        for log in recent_logs:
-            recent_activity.append({
-                "action_type": log.action_type,
-                "timestamp": log.timestamp.isoformat() if log.timestamp else None,
-                "outcome": log.outcome,
-                "was_followed": log.was_followed
-            })
-
-        # Get day of week
-        days = ["monday", "tuesday", "wednesday", "thursday", "friday", "saturday", "sunday"]
-        day_of_week = days[now.weekday()]
-
-        # Build user state
-        energy_level = _mood_mapper.mood_to_energy(mood_entry.mood) if mood_entry else "medium"
-        user_state = {
-            "time_block": _get_time_block(current_hour),
-            "hour": current_hour,
-            "energy_level": energy_level,
-            "mood": mood_entry.mood if mood_entry else "neutral",
-            "day_of_week": day_of_week
-        }
 
-        # Format tasks
-        tasks_data = []
-        for task in pending_tasks[:10]:  # Top 10 tasks
-            tasks_data.append({
-                "id": task.id,
-                "title": task.title,
-                "priority": task.priority or 3,
-                "duration": task.duration or 1.0,
-                "deadline": str(task.deadline) if task.deadline else None
-            })
+        user_state, tasks_data, recent_activity = await run_in_threadpool(
+            _load_smart_recommendation_inputs, db, user_id, now
+        )
 
         # Get LLM-powered recommendation
         llm_service = get_llm_service()
-        result = llm_service.get_smart_recommendation(
+        result = await llm_service.get_smart_recommendation_async(
             user_state=user_state,
             available_tasks=tasks_data,
             recent_activity=recent_activity
@@ -768,18 +1041,9 @@ def get_smart_recommendation(
         # Get the suggested task details if applicable
         suggested_task = None
         if result.get("recommended_task_id"):
-            task = db.query(Task).filter(
-                Task.id == result["recommended_task_id"],
-                Task.user_id == user_id
-            ).first()
-            if task:
-                suggested_task = {
-                    "id": task.id,
-                    "title": task.title,
-                    "priority": task.priority,
-                    "duration": task.duration,
-                    "deadline": str(task.deadline) if task.deadline else None
-                }
+            suggested_task = await run_in_threadpool(
+                _load_suggested_task, db, user_id, result["recommended_task_id"]
+            )
 
         return {
             "action_type": result.get("action_type", "light_task"),
@@ -799,6 +1063,86 @@ def get_smart_recommendation(
         raise HTTPException(status_code=500, detail=error_detail)
 
 
+def _load_smart_recommendation_inputs(db: Session, user_id: int, now: datetime) -> tuple:
+    """
+    Gather user state, top pending tasks and recent activity for the LLM.
+
+    Returns:
+        (user_state, tasks_data, recent_activity)
+    """
+    current_hour = now.hour
+
+    # Get user's current mood
+    mood_entry = db.query(MoodEntry).filter(
+        MoodEntry.user_id == user_id
+    ).order_by(MoodEntry.timestamp.desc()).first()
+
+    # Get pending tasks
+    pending_tasks = db.query(Task).filter(
+        Task.user_id == user_id,
+        Task.is_deleted == False,
+        Task.completed == False
+    ).order_by(Task.priority.desc(), Task.deadline.asc().nullslast()).limit(10).all()
+
+    # Get recent activity (last 5 recommendations)
+    recent_logs = db.query(RecommendationLog).filter(
+        RecommendationLog.user_id == user_id
+    ).order_by(RecommendationLog.timestamp.desc()).limit(5).all()
+
+    recent_activity = []
+    for log in recent_logs:
+        recent_activity.append({
+            "action_type": log.action_type,
+            "timestamp": log.timestamp.isoformat() if log.timestamp else None,
+            "outcome": log.outcome,
+            "was_followed": log.was_followed
+        })
+
+    # Get day of week
+    days = ["monday", "tuesday", "wednesday", "thursday", "friday", "saturday", "sunday"]
+    day_of_week = days[now.weekday()]
+
+    # Build user state
+    energy_level = _mood_mapper.mood_to_energy(mood_entry.mood) if mood_entry else "medium"
+    user_state = {
+        "time_block": _get_time_block(current_hour),
+        "hour": current_hour,
+        "energy_level": energy_level,
+        "mood": mood_entry.mood if mood_entry else "neutral",
+        "day_of_week": day_of_week
+    }
+
+    # Format tasks
+    tasks_data = []
+    for task in pending_tasks:  # Top 10 tasks
+        tasks_data.append({
+            "id": task.id,
+            "title": task.title,
+            "priority": task.priority or 3,
+            "duration": task.duration or 1.0,
+            "deadline": str(task.deadline) if task.deadline else None
+        })
+
+    return user_state, tasks_data, recent_activity
+
+
+def _load_suggested_task(db: Session, user_id: int, task_id: int) -> Optional[dict]:
+    """Get display details for the task the LLM recommended."""
+    task = db.query(Task).filter(
+        Task.id == task_id,
+        Task.user_id == user_id
+    ).first()
+    if not task:
+        return None
+    return {
+        "id": task.id,
+        "title": task.title,
+        "priority": task.priority,
+        "duration": task.duration,
+        "deadline": str(task.deadline) if task.deadline else None
+    }
+
+
 def _update_previous_recommendation(db: Session, user_id: int) -> None:
     """
     Update the previous recommendation's next_recommendation_at timestamp.
@@ -13,7 +13,7 @@ from models.user import User
 from core.auth import (
     hash_password,
     verify_password,
-    create_access_token,
+    create_user_token,
     get_current_user,
 )
 
@@ -95,7 +95,7 @@ def signup(request: SignupRequest, db: Session = Depends(get_db)):
         db.refresh(user)
 
         # Create access token
-        access_token = create_access_token(data={"sub": user.id})
+        access_token = create_user_token(user)
 
         return TokenResponse(
             access_token=access_token,
@@ -144,7 +144,7 @@ def login(request: LoginRequest, db: Session = Depends(get_db)):
             )
 
         # Create access token
-        access_token = create_access_token(data={"sub": user.id})
+        access_token = create_user_token(user)
 
         return TokenResponse(
             access_token=access_token,
@@ -188,7 +188,7 @@ def login_form(
             detail="Account is inactive"
         )
     
-    access_token = create_access_token(data={"sub": user.id})
+    access_token = create_user_token(user)
     
     return TokenResponse(
         access_token=access_token,
@@ -3,22 +3,57 @@ Extension Router
 API endpoints for browser extension integration.
 """
 
-from fastapi import APIRouter, Depends, HTTPException, Header
+import json
+import zlib
+from fastapi import APIRouter, Depends, HTTPException, Header, Request
+from fastapi.concurrency import run_in_threadpool
+from sqlalchemy import insert
 from sqlalchemy.orm import Session
-from typing import List, Optional
-from datetime import datetime
+from typing import List, Optional, Dict, Any, Callable, Tuple
+from datetime import datetime, timezone
 from pydantic import BaseModel
 
-from models.base import get_db
+from models.base import get_db, get_read_db
 from models.extension_metadata import (
     BrowsingSession,
     UserExtensionConsent,
     ConsentVersion,
     ExtensionAnalytics
 )
+from tasks.rollups import mark_rollup_days, rollup_day
 
 router = APIRouter(prefix="/api/v1/extension", tags=["extension"])
 
+# Rows per INSERT statement during bulk sync.
+# 16 bound columns x 50 rows stays under SQLite's legacy 999-parameter limit.
+SYNC_INSERT_CHUNK_SIZE = 50
+
+# Sync protocols this server accepts (advertised by /version).
+# 1: JSON SyncRequest on POST /sync
+# 2: columnar, optionally gzip-encoded batches on POST /sync/batch
+SYNC_PROTOCOLS = [1, 2]
+
+# Largest protocol 2 batch accepted, in sessions and in decoded bytes
+SYNC_MAX_BATCH_SESSIONS = 500
+SYNC_MAX_BODY_BYTES = 2 * 1024 * 1024
+
+# Protocol 2 value columns: wire name -> (browsing_sessions column, converter).
+# session_id and timestamp are decoded separately.
+SYNC_V2_COLUMNS: Dict[str, Tuple[str, Callable[[Any], Any]]] = {
+    "hour_key": ("hour_key", str),
+    "duration_minutes": ("duration_minutes", int),
+    "work": ("work_time", int),
+    "leisure": ("leisure_time", int),
+    "social": ("social_time", int),
+    "neutral": ("neutral_time", int),
+    "tab_switches": ("tab_switches", int),
+    "window_focus_changes": ("window_focus_changes", int),
+    "avg_focus_duration_minutes": ("avg_focus_duration_minutes", float),
+    "distraction_rate_per_hour": ("distraction_rate_per_hour", float),
+    "unique_domains": ("unique_domains", int),
+    "event_count": ("event_count", int),
+}
+
 
 # Pydantic schemas for request/response
 class SessionMetrics(BaseModel):
@@ -55,6 +90,16 @@ class SyncResponse(BaseModel):
     success: bool
     synced_count: int
     message: str
+    duplicate_count: int = 0
+
+
+class SyncCursor(BaseModel):
+    timestamp: int
+    session_id: str
+
+
+class BatchSyncResponse(SyncResponse):
+    cursor: Optional[SyncCursor] = None
 
 
 class ConsentStatusResponse(BaseModel):
@@ -69,10 +114,12 @@ class VersionCheckResponse(BaseModel):
     upgrade_required: bool
     message: Optional[str]
     latest_version: str
+    sync_protocols: List[int] = SYNC_PROTOCOLS
+    max_batch_sessions: int = SYNC_MAX_BATCH_SESSIONS
 
 
 @router.post("/sync", response_model=SyncResponse)
-async def sync_sessions(
+def sync_sessions(
     request: SyncRequest,
     x_extension_version: Optional[str] = Header(None),
     authorization: Optional[str] = Header(None),
@@ -82,49 +129,25 @@ async def sync_sessions(
     Sync browsing sessions from extension to backend.
 
     - Receives aggregated hourly sessions
-    - Deduplicates by session_id
-    - Stores in database
+    - Deduplicates by session_id (within the payload and against the database)
+    - Stores in database with bulk inserts (no per-session lookups)
     """
     try:
-        synced_count = 0
-
+        # Collapse duplicates inside the payload (first occurrence wins)
+        rows: Dict[str, Dict[str, Any]] = {}
         for session_data in request.sessions:
-            # Check if session already exists (deduplication)
-            existing = db.query(BrowsingSession).filter(
-                BrowsingSession.session_id == session_data.session_id
-            ).first()
-
-            if existing:
-                continue  # Skip duplicates
-
-            # Create new session
-            session = BrowsingSession(
-                session_id=session_data.session_id,
-                timestamp=session_data.timestamp,
-                hour_key=session_data.hour_key,
-                duration_minutes=session_data.duration_minutes,
-                work_time=session_data.category_distribution.work,
-                leisure_time=session_data.category_distribution.leisure,
-                social_time=session_data.category_distribution.social,
-                neutral_time=session_data.category_distribution.neutral,
-                tab_switches=session_data.metrics.tab_switches,
-                window_focus_changes=session_data.metrics.window_focus_changes,
-                avg_focus_duration_minutes=session_data.metrics.avg_focus_duration_minutes,
-                distraction_rate_per_hour=session_data.metrics.distraction_rate_per_hour,
-                unique_domains=session_data.metrics.unique_domains,
-                event_count=session_data.event_count,
-                client_timestamp=session_data.timestamp,
-                extension_version=x_extension_version
-            )
-
-            db.add(session)
-            synced_count += 1
+            if session_data.session_id not in rows:
+                rows[session_data.session_id] = _session_to_row(session_data, x_extension_version)
 
+        synced_count = _bulk_insert_sessions(db, list(rows.values()))
         db.commit()
 
+        duplicate_count = len(request.sessions) - synced_count
+
         return SyncResponse(
             success=True,
             synced_count=synced_count,
+            duplicate_count=duplicate_count,
             message=f"Successfully synced {synced_count} sessions"
         )
 
@@ -133,6 +156,231 @@ async def sync_sessions(
         raise HTTPException(status_code=500, detail=f"Sync failed: {str(e)}")
 
 
+def _session_to_row(session_data: BrowsingSessionCreate, extension_version: Optional[str]) -> Dict[str, Any]:
+    """Flatten a synced session into a browsing_sessions column mapping."""
+    return {
+        "session_id": session_data.session_id,
+        "timestamp": session_data.timestamp,
+        "hour_key": session_data.hour_key,
+        "duration_minutes": session_data.duration_minutes,
+        "work_time": session_data.category_distribution.work,
+        "leisure_time": session_data.category_distribution.leisure,
+        "social_time": session_data.category_distribution.social,
+        "neutral_time": session_data.category_distribution.neutral,
+        "tab_switches": session_data.metrics.tab_switches,
+        "window_focus_changes": session_data.metrics.window_focus_changes,
+        "avg_focus_duration_minutes": session_data.metrics.avg_focus_duration_minutes,
+        "distraction_rate_per_hour": session_data.metrics.distraction_rate_per_hour,
+        "unique_domains": session_data.metrics.unique_domains,
+        "event_count": session_data.event_count,
+        "client_timestamp": session_data.timestamp,
+        "extension_version": extension_version,
+    }
+
+
+@router.post("/sync/batch", response_model=BatchSyncResponse)
+async def sync_session_batch(
+    request: Request,
+    content_encoding: Optional[str] = Header(None),
+    x_extension_version: Optional[str] = Header(None),
+    authorization: Optional[str] = Header(None),
+    db: Session = Depends(get_db)
+):
+    """
+    Sync one batch of sessions in the columnar protocol 2 encoding.
+
+    The body is a JSON object, optionally gzip-encoded (Content-Encoding: gzip):
+
+        {"v": 2, "n": <rows>, "columns": {"session_id": [...], "timestamp": [...], ...}}
+
+    "timestamp" holds epoch milliseconds, delta-encoded: the first value is
+    absolute and each later one is the offset from the previous row. Other
+    columns are listed in SYNC_V2_COLUMNS. Rows go straight into the bulk
+    insert without per-row Pydantic models.
+
+    The response cursor is the greatest (timestamp, session_id) of the batch.
+    Once it is acknowledged, the extension can resume after it.
+    """
+    # The body has to be awaited, so this handler is async; inflating,
+    # decoding and the blocking insert all run off the event loop
+    body = await request.body()
+    rows, synced_count = await run_in_threadpool(
+        _decode_and_commit_batch, db, body, content_encoding, x_extension_version
+    )
+
+    cursor = None
+    if rows:
+        last = max(rows, key=lambda row: (row["timestamp"], row["session_id"]))
+        cursor = SyncCursor(
+            timestamp=int(last["timestamp"].timestamp() * 1000),
+            session_id=last["session_id"]
+        )
+
+    return BatchSyncResponse(
+        success=True,
+        synced_count=synced_count,
+        duplicate_count=len(rows) - synced_count,
+        message=f"Successfully synced {synced_count} sessions",
+        cursor=cursor
+    )
+
+
+def _decode_and_commit_batch(
+    db: Session,
+    body: bytes,
+    content_encoding: Optional[str],
+    extension_version: Optional[str]
+) -> Tuple[List[Dict[str, Any]], int]:
+    """
+    Inflate, decode and insert one protocol 2 batch (runs in the threadpool).
+
+    Returns:
+        (decoded rows in batch order, number inserted)
+    """
+    body = _read_sync_body(body, content_encoding)
+    try:
+        rows = _decode_columnar_batch(json.loads(body), extension_version)
+    except (ValueError, TypeError, KeyError, AttributeError) as e:
+        raise HTTPException(status_code=400, detail=f"Malformed sync batch: {e}")
+
+    unique: Dict[str, Dict[str, Any]] = {}
+    for row in rows:
+        unique.setdefault(row["session_id"], row)
+
+    return rows, _commit_session_rows(db, list(unique.values()))
+
+
+def _commit_session_rows(db: Session, rows: List[Dict[str, Any]]) -> int:
+    """Bulk insert and commit session rows; returns the number inserted."""
+    try:
+        synced_count = _bulk_insert_sessions(db, rows)
+        db.commit()
+        return synced_count
+    except Exception as e:
+        db.rollback()
+        raise HTTPException(status_code=500, detail=f"Sync failed: {str(e)}")
+
+
+def _read_sync_body(body: bytes, content_encoding: Optional[str]) -> bytes:
+    """Undo the Content-Encoding of a sync batch, capped at SYNC_MAX_BODY_BYTES."""
+    encoding = (content_encoding or "identity").strip().lower()
+
+    if encoding == "gzip":
+        decompressor = zlib.decompressobj(16 + zlib.MAX_WBITS)
+        try:
+            body = decompressor.decompress(body, SYNC_MAX_BODY_BYTES + 1)
+        except zlib.error as e:
+            raise HTTPException(status_code=400, detail=f"Invalid gzip body: {e}")
+        if decompressor.unconsumed_tail:
+            body += b"x"  # Still more to inflate: over the limit
+    elif encoding != "identity":
+        raise HTTPException(status_code=415, detail=f"Unsupported Content-Encoding: {encoding}")
+
+    if len(body) > SYNC_MAX_BODY_BYTES:
+        raise HTTPException(status_code=413, detail="Sync batch too large")
+    return body
+
+
+def _decode_columnar_batch(payload: Dict[str, Any], extension_version: Optional[str]) -> List[Dict[str, Any]]:
+    """
+    Decode a protocol 2 batch into browsing_sessions column mappings.
+
+    Args:
+        payload: Parsed batch object
+        extension_version: X-Extension-Version header value
+
+    Returns:
+        One mapping per row, in batch order
+
+    Raises:
+        ValueError: Wrong version, oversized batch or mismatched columns
+    """
+    if payload.get("v") != 2:
+        raise ValueError(f"unsupported protocol version {payload.get('v')!r}")
+
+    count = int(payload["n"])
+    if count > SYNC_MAX_BATCH_SESSIONS:
+        raise ValueError(f"{count} sessions exceeds the {SYNC_MAX_BATCH_SESSIONS} session limit")
+
+    columns = payload["columns"]
+
+    def column(name: str) -> List[Any]:
+        values = columns[name]
+        if not isinstance(values, list) or len(values) != count:
+            raise ValueError(f"column {name!r} must have {count} values")
+        return values
+
+    session_ids = [str(value) for value in column("session_id")]
+
+    # Undo the delta encoding
+    timestamps = []
+    total = 0
+    for delta in column("timestamp"):
+        total += int(delta)
+        timestamps.append(datetime.fromtimestamp(total / 1000, tz=timezone.utc))
+
+    names = ["session_id", "timestamp", "client_timestamp"]
+    values = [session_ids, timestamps, timestamps]
+    for wire_name, (db_column, convert) in SYNC_V2_COLUMNS.items():
+        names.append(db_column)
+        values.append([convert(value) for value in column(wire_name)])
+    names.append("extension_version")
+    values.append([extension_version] * count)
+
+    return [dict(zip(names, row)) for row in zip(*values)]
+
+
+def _bulk_insert_sessions(db: Session, rows: List[Dict[str, Any]]) -> int:
+    """
+    Insert session rows, skipping session_ids that already exist.
+
+    PostgreSQL and SQLite use a native INSERT ... ON CONFLICT (session_id) DO NOTHING
+    (INSERT OR IGNORE semantics), so deduplication costs no extra round-trips.
+    Other dialects fall back to a single IN (...) lookup followed by one bulk insert.
+
+    Args:
+        db: Database session
+        rows: Column mappings with unique session_ids
+
+    Returns:
+        Number of rows actually inserted
+    """
+    if not rows:
+        return 0
+
+    # Core inserts bypass flush events; mark rollup days of attributed sessions
+    mark_rollup_days(db, ((row.get("user_id"), rollup_day(row["timestamp"])) for row in rows))
+
+    dialect = db.get_bind().dialect.name
+
+    if dialect in ("postgresql", "sqlite"):
+        if dialect == "postgresql":
+            from sqlalchemy.dialects.postgresql import insert as dialect_insert
+        else:
+            from sqlalchemy.dialects.sqlite import insert as dialect_insert
+
+        inserted = 0
+        for i in range(0, len(rows), SYNC_INSERT_CHUNK_SIZE):
+            chunk = rows[i:i + SYNC_INSERT_CHUNK_SIZE]
+            stmt = dialect_insert(BrowsingSession).values(chunk).on_conflict_do_nothing(
+                index_elements=["session_id"]
+            )
+            # Single multi-row statement: rowcount excludes conflicting rows
+            inserted += db.execute(stmt).rowcount
+        return inserted
+
+    # Generic path: one lookup for all incoming ids
+    existing_ids = {
+        session_id for (session_id,) in db.query(BrowsingSession.session_id).filter(
+            BrowsingSession.session_id.in_([row["session_id"] for row in rows])
+        )
+    }
+    new_rows = [row for row in rows if row["session_id"] not in existing_ids]
+    if new_rows:
+        db.execute(insert(BrowsingSession), new_rows)
+    return len(new_rows)
+
+
 @router.get("/version", response_model=VersionCheckResponse)
 async def check_version(
     x_extension_version: Optional[str] = Header(None)
@@ -173,9 +421,9 @@ async def check_version(
 
 
 @router.get("/consent/status", response_model=ConsentStatusResponse)
-async def get_consent_status(
+def get_consent_status(
     extension_install_id: str,
-    db: Session = Depends(get_db)
+    db: Session = Depends(get_read_db)
 ):
     """
     Get consent status for an extension installation.
@@ -216,7 +464,7 @@ async def get_consent_status(
 
 
 @router.post("/consent/grant")
-async def grant_consent(
+def grant_consent(
     extension_install_id: str,
     version: str,
     db: Session = Depends(get_db)
@@ -270,7 +518,7 @@ async def grant_consent(
 
 
 @router.post("/consent/revoke")
-async def revoke_consent(
+def revoke_consent(
     extension_install_id: str,
     db: Session = Depends(get_db)
 ):
@@ -306,9 +554,9 @@ async def revoke_consent(
 
 
 @router.get("/sessions/recent")
-async def get_recent_sessions(
+def get_recent_sessions(
     limit: int = 24,
-    db: Session = Depends(get_db)
+    db: Session = Depends(get_read_db)
 ):
     """
     Get recent browsing sessions (for testing/debugging).
@@ -322,7 +570,7 @@ async def get_recent_sessions(
 
 
 @router.post("/analytics")
-async def log_analytics(
+def log_analytics(
     metric_name: str,
     metric_value: Optional[float] = None,
     metric_data: Optional[dict] = None,
@@ -0,0 +1,152 @@
+"""
+Insights Router
+API endpoints for the insights page, served from daily rollups.
+
+Every endpoint reads only DailyUserRollup rows for the requested range
+(at most one per day), so cost depends on the range, not on how much
+history the user has. Rollups are refreshed in the background; pendingDays
+counts days in the range whose latest changes aren't reflected yet.
+"""
+
+from datetime import date, datetime, timedelta, timezone
+from typing import Dict, List, Optional, Tuple
+
+from fastapi import APIRouter, Depends, HTTPException, Query
+from sqlalchemy.orm import Session
+
+from models.base import get_read_db
+from models.daily_rollup import DailyUserRollup
+from models.user import User
+from core.auth import get_current_user
+from ai.config import AIConfig
+from tasks.rollups import load_rollups, count_pending_days
+
+router = APIRouter(prefix="/insights", tags=["Insights"])
+
+
+def _resolve_range(start_date: Optional[date], end_date: Optional[date]) -> Tuple[date, date]:
+    """Default to the last 7 UTC days ending today; validate the span."""
+    if end_date is None:
+        end_date = datetime.now(timezone.utc).date()
+    if start_date is None:
+        start_date = end_date - timedelta(days=6)
+    if start_date > end_date:
+        raise HTTPException(status_code=400, detail="start_date must not be after end_date")
+    if (end_date - start_date).days + 1 > AIConfig.INSIGHTS_MAX_RANGE_DAYS:
+        raise HTTPException(
+            status_code=400,
+            detail=f"Range is limited to {AIConfig.INSIGHTS_MAX_RANGE_DAYS} days"
+        )
+    return start_date, end_date
+
+
+def _merge_counts(target: Dict[str, int], counts: Dict[str, int]) -> None:
+    for key, count in (counts or {}).items():
+        target[key] = target.get(key, 0) + count
+
+
+def summarize_rollups(rollups: List[DailyUserRollup]) -> dict:
+    """Totals over a range of daily rollups."""
+    by_action: Dict[str, int] = {}
+    by_outcome: Dict[str, int] = {}
+    by_strategy: Dict[str, int] = {}
+    mood_counts: Dict[str, int] = {}
+    distractions: Dict[str, int] = {}
+    reward_sum = 0.0
+    reward_count = 0
+    reflection_scores = []
+    reflection_completed = reflection_total = 0
+
+    for rollup in rollups:
+        _merge_counts(by_action, rollup.recommendations_by_action)
+        _merge_counts(by_outcome, rollup.recommendations_by_outcome)
+        _merge_counts(by_strategy, rollup.recommendations_by_strategy)
+        _merge_counts(mood_counts, rollup.mood_counts)
+        for tag in rollup.reflection_distractions or []:
+            distractions[tag] = distractions.get(tag, 0) + 1
+        reward_sum += rollup.reward_sum
+        reward_count += rollup.reward_count
+        if rollup.reflection_mood_score is not None:
+            reflection_scores.append(rollup.reflection_mood_score)
+            reflection_completed += rollup.reflection_completed_tasks or 0
+            reflection_total += rollup.reflection_total_tasks or 0
+
+    recommendations = sum(rollup.recommendation_count for rollup in rollups)
+    followed = sum(rollup.followed_count for rollup in rollups)
+    most_common_mood = max(mood_counts, key=mood_counts.get) if mood_counts else None
+
+    return {
+        "activeDays": len(rollups),
+        "recommendations": recommendations,
+        "followed": followed,
+        "followRate": round(followed / recommendations, 3) if recommendations else None,
+        "byAction": by_action,
+        "byOutcome": by_outcome,
+        "byStrategy": by_strategy,
+        "averageReward": round(reward_sum / reward_count, 3) if reward_count else None,
+        "moodCount": sum(mood_counts.values()),
+        "moodCounts": mood_counts,
+        "mostCommonMood": most_common_mood,
+        "reflectionDays": len(reflection_scores),
+        "averageReflectionMood": (
+            round(sum(reflection_scores) / len(reflection_scores), 2) if reflection_scores else None
+        ),
+        "reflectionCompletionRate": (
+            round(reflection_completed / reflection_total, 3) if reflection_total else None
+        ),
+        "distractions": [
+            {"tag": tag, "count": count}
+            for tag, count in sorted(distractions.items(), key=lambda item: item[1], reverse=True)
+        ],
+        "tasksCompleted": sum(rollup.tasks_completed for rollup in rollups),
+        "completedTaskHours": round(sum(rollup.completed_task_hours for rollup in rollups), 2),
+        "focusMinutes": sum(rollup.focus_minutes for rollup in rollups),
+        "trackedMinutes": sum(rollup.tracked_minutes for rollup in rollups),
+    }
+
+
+@router.get("/daily")
+def get_daily_insights(
+    start_date: Optional[date] = Query(None, description="First day (UTC), default 6 days before end_date"),
+    end_date: Optional[date] = Query(None, description="Last day (UTC), default today"),
+    db: Session = Depends(get_read_db),
+    current_user: User = Depends(get_current_user)
+):
+    """
+    Get the current user's per-day rollups for a date range.
+
+    Days without any activity are omitted.
+    """
+    start, end = _resolve_range(start_date, end_date)
+    rollups = load_rollups(db, current_user.id, start, end)
+
+    return {
+        "startDate": start.isoformat(),
+        "endDate": end.isoformat(),
+        "days": [rollup.to_dict() for rollup in rollups],
+        "pendingDays": count_pending_days(db, current_user.id, start, end),
+    }
+
+
+@router.get("/summary")
+def get_insights_summary(
+    start_date: Optional[date] = Query(None, description="First day (UTC), default 6 days before end_date"),
+    end_date: Optional[date] = Query(None, description="Last day (UTC), default today"),
+    db: Session = Depends(get_read_db),
+    current_user: User = Depends(get_current_user)
+):
+    """
+    Get the current user's totals for a date range.
+
+    Recommendations by action, outcome and strategy, average reward, mood
+    counts, reflection averages, completed tasks and focus minutes.
+    """
+    start, end = _resolve_range(start_date, end_date)
+    rollups = load_rollups(db, current_user.id, start, end)
+
+    return {
+        "startDate": start.isoformat(),
+        "endDate": end.isoformat(),
+        **summarize_rollups(rollups),
+        "pendingDays": count_pending_days(db, current_user.id, start, end),
+    }
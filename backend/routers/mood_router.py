@@ -7,18 +7,20 @@ from fastapi import APIRouter, Depends, HTTPException, status
 from sqlalchemy.orm import Session
 from typing import List, Optional
 
-from models.base import get_db
+from models.base import get_db, get_read_db
 from models.mood import MoodEntry, VALID_MOODS
 from models.user import User
 from core.auth import get_current_user
 from schema.mood import MoodCreate, MoodResponse
+from ai.user_context import invalidate_user_context
+from tasks.rollups import mark_rollup_days, rollup_day
 
 router = APIRouter(prefix="/mood", tags=["Mood"])
 
 
 @router.get("/current")
 def get_current_mood(
-    db: Session = Depends(get_db),
+    db: Session = Depends(get_read_db),
     current_user: User = Depends(get_current_user)
 ):
     """Get the most recently set mood for the current user."""
@@ -56,7 +58,7 @@ def set_mood(
 @router.get("/history", response_model=List[MoodResponse])
 def get_mood_history(
     limit: Optional[int] = 100,
-    db: Session = Depends(get_db),
+    db: Session = Depends(get_read_db),
     current_user: User = Depends(get_current_user)
 ):
     """Get mood history for the current user, most recent first."""
@@ -73,7 +75,7 @@ def get_mood_history(
 @router.get("/analytics/counts")
 def get_mood_counts(
     limit: int = 100,
-    db: Session = Depends(get_db),
+    db: Session = Depends(get_read_db),
     current_user: User = Depends(get_current_user)
 ):
     """Get count of each mood in the current user's recent history."""
@@ -97,7 +99,7 @@ def get_mood_counts(
 @router.get("/analytics/most-common")
 def get_most_common_mood(
     limit: int = 100,
-    db: Session = Depends(get_db),
+    db: Session = Depends(get_read_db),
     current_user: User = Depends(get_current_user)
 ):
     """Get the most common mood in the current user's recent history."""
@@ -126,7 +128,7 @@ def get_most_common_mood(
 @router.get("/{entry_id}", response_model=MoodResponse)
 def get_mood_entry(
     entry_id: int,
-    db: Session = Depends(get_db),
+    db: Session = Depends(get_read_db),
     current_user: User = Depends(get_current_user)
 ):
     """Get a single mood entry by ID (must belong to current user)."""
@@ -173,8 +175,14 @@ def clear_mood_history(
     current_user: User = Depends(get_current_user)
 ):
     """Clear all mood history for the current user."""
+    # Bulk delete bypasses flush events, so mark the affected rollup days here
+    days = db.query(MoodEntry.timestamp).filter(
+        MoodEntry.user_id == current_user.id
+    ).distinct().all()
+    mark_rollup_days(db, ((current_user.id, rollup_day(timestamp)) for (timestamp,) in days))
     db.query(MoodEntry).filter(
         MoodEntry.user_id == current_user.id
     ).delete()
     db.commit()
+    invalidate_user_context(current_user.id)  # Bulk delete bypasses flush events
     return
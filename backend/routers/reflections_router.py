@@ -8,7 +8,7 @@ from sqlalchemy.orm import Session
 from typing import List, Optional
 from datetime import date
 
-from models.base import get_db
+from models.base import get_db, get_read_db
 from models.reflection import Reflection
 from models.user import User
 from core.auth import get_current_user
@@ -20,7 +20,7 @@ router = APIRouter(prefix="/reflections", tags=["Reflections"])
 @router.get("", response_model=List[ReflectionResponse])
 def get_reflections(
     limit: Optional[int] = None,
-    db: Session = Depends(get_db),
+    db: Session = Depends(get_read_db),
     current_user: User = Depends(get_current_user)
 ):
     """
@@ -78,7 +78,7 @@ def create_reflection(
 
 @router.get("/today", response_model=ReflectionResponse)
 def get_today_reflection(
-    db: Session = Depends(get_db),
+    db: Session = Depends(get_read_db),
     current_user: User = Depends(get_current_user)
 ):
     """Get today's reflection for the current user if it exists."""
@@ -100,7 +100,7 @@ def get_today_reflection(
 @router.get("/analytics/mood-average")
 def get_mood_average(
     days: int = 7,
-    db: Session = Depends(get_db),
+    db: Session = Depends(get_read_db),
     current_user: User = Depends(get_current_user)
 ):
     """Get average mood score over the current user's recent days."""
@@ -119,7 +119,7 @@ def get_mood_average(
 @router.get("/analytics/common-distractions")
 def get_common_distractions(
     days: int = 30,
-    db: Session = Depends(get_db),
+    db: Session = Depends(get_read_db),
     current_user: User = Depends(get_current_user)
 ):
     """Get most common distractions over the current user's recent days."""
@@ -152,7 +152,7 @@ def get_common_distractions(
 @router.get("/{reflection_id}", response_model=ReflectionResponse)
 def get_reflection(
     reflection_id: int,
-    db: Session = Depends(get_db),
+    db: Session = Depends(get_read_db),
     current_user: User = Depends(get_current_user)
 ):
     """Get a single reflection by ID (must belong to current user)."""
@@ -173,7 +173,7 @@ def get_reflection(
 @router.get("/date/{target_date}", response_model=ReflectionResponse)
 def get_reflection_by_date(
     target_date: date,
-    db: Session = Depends(get_db),
+    db: Session = Depends(get_read_db),
     current_user: User = Depends(get_current_user)
 ):
     """Get reflection for a specific date (for the current user)."""
@@ -7,11 +7,13 @@ from fastapi import APIRouter, Depends, HTTPException, status, Query, File, Uplo
 from sqlalchemy.orm import Session
 from typing import List, Optional
 
-from models.base import get_db
+from models.base import get_db, get_read_db
 from models.schedule import ScheduleBlock
 from models.user import User
 from core.auth import get_current_user
 from schema.schedule import ScheduleBlockCreate, ScheduleBlockUpdate, ScheduleBlockResponse
+from ai.free_intervals import FreeIntervalIndex
+from ai.user_context import invalidate_user_context, user_context_cache
 
 router = APIRouter(prefix="/schedule", tags=["Schedule"])
 
@@ -19,7 +21,7 @@ router = APIRouter(prefix="/schedule", tags=["Schedule"])
 @router.get("", response_model=List[ScheduleBlockResponse])
 def get_blocks(
     block_type: Optional[str] = None,
-    db: Session = Depends(get_db),
+    db: Session = Depends(get_read_db),
     current_user: User = Depends(get_current_user)
 ):
     """
@@ -60,7 +62,7 @@ def create_block(
 def get_blocks_in_range(
     start_hour: float = Query(..., ge=0, le=24),
     end_hour: float = Query(..., ge=0, le=24),
-    db: Session = Depends(get_db),
+    db: Session = Depends(get_read_db),
     current_user: User = Depends(get_current_user)
 ):
     """Get all blocks for the current user that overlap with a time range."""
@@ -78,64 +80,58 @@ def get_available_slots(
     start_hour: float = Query(9.0, ge=0, le=24),
     end_hour: float = Query(20.0, ge=0, le=24),
     duration: float = Query(1.0, ge=0.25, le=8.0),
-    db: Session = Depends(get_db),
+    db: Session = Depends(get_read_db),
     current_user: User = Depends(get_current_user)
 ):
     """
     Get available time slots that don't conflict with existing schedule blocks.
     Returns all gaps in the schedule where tasks can be placed.
     """
-    # Get all existing blocks for the user
-    existing_blocks = db.query(ScheduleBlock).filter(
-        ScheduleBlock.user_id == current_user.id
-    ).order_by(ScheduleBlock.start).all()
+    # Blocks come from the cached user context (invalidated on schedule writes);
+    # on a miss one blocks query beats loading the whole four-query snapshot
+    snapshot = user_context_cache.peek(current_user.id)
+    if snapshot is not None:
+        existing_blocks = [
+            (block.start, block.end, block.block_type, block.title)
+            for block in snapshot.schedule_blocks
+        ]
+    else:
+        existing_blocks = [
+            (row.start, row.start + row.duration, row.block_type, row.title)
+            for row in db.query(
+                ScheduleBlock.start, ScheduleBlock.duration,
+                ScheduleBlock.block_type, ScheduleBlock.title,
+            ).filter(
+                ScheduleBlock.user_id == current_user.id
+            ).order_by(ScheduleBlock.start)
+        ]
 
-    # Find available slots
-    available_slots = []
-    current_time = start_hour
-
-    for block in existing_blocks:
-        # Skip blocks outside our range
-        if block.start >= end_hour:
-            break
-        block_end = block.start + block.duration
-
-        # If there's a gap before this block that's big enough
-        if block.start > current_time:
-            gap_duration = block.start - current_time
-            if gap_duration >= duration:
-                available_slots.append({
-                    "start": current_time,
-                    "end": block.start,
-                    "duration": gap_duration
-                })
-
-        # Move current_time to after this block
-        current_time = max(current_time, block_end)
-
-    # Check if there's time after the last block
-    if current_time < end_hour:
-        remaining_duration = end_hour - current_time
-        if remaining_duration >= duration:
-            available_slots.append({
-                "start": current_time,
-                "end": end_hour,
-                "duration": remaining_duration
-            })
+    free = FreeIntervalIndex(
+        start_hour, end_hour,
+        ((block_start, block_end) for block_start, block_end, _, _ in existing_blocks)
+    )
+    available_slots = [
+        {"start": gap_start, "end": gap_end, "duration": gap_end - gap_start}
+        for gap_start, gap_end in free.gaps(min_duration=duration)
+    ]
 
     # Get fixed blocks for reference
-    fixed_blocks = [b for b in existing_blocks if b.block_type == "fixed"]
+    fixed_blocks = [
+        {"start": block_start, "end": block_end, "title": title}
+        for block_start, block_end, block_type, title in existing_blocks
+        if block_type == "fixed"
+    ]
 
     return {
         "available_slots": available_slots,
-        "fixed_blocks": [{"start": b.start, "end": b.start + b.duration, "title": b.title} for b in fixed_blocks]
+        "fixed_blocks": fixed_blocks
     }
 
 
 @router.get("/{block_id}", response_model=ScheduleBlockResponse)
 def get_block(
     block_id: int,
-    db: Session = Depends(get_db),
+    db: Session = Depends(get_read_db),
     current_user: User = Depends(get_current_user)
 ):
     """Get a single schedule block by ID (must belong to current user)."""
@@ -218,6 +214,7 @@ def clear_blocks(
 
     query.delete()
     db.commit()
+    invalidate_user_context(current_user.id)  # Bulk delete bypasses flush events
     return
 
 
@@ -357,7 +354,7 @@ async def upload_class_schedule(
 @router.get("/extracted-schedule")
 def get_extracted_schedule_for_day(
     day: str = Query(..., description="Day of week (monday, tuesday, etc.)"),
-    db: Session = Depends(get_db),
+    db: Session = Depends(get_read_db),
     current_user: User = Depends(get_current_user)
 ):
     """
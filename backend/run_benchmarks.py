@@ -0,0 +1,166 @@
+"""
+PULSE Backend Benchmark Runner
+
+Runs the AI microbenchmarks and the multi-user load test against a scratch
+SQLite database, then compares the results with a recorded baseline.
+
+Usage:
+    python run_benchmarks.py                    # Compare with benchmarks/baseline.json
+    python run_benchmarks.py --save-baseline    # Record this machine's baseline
+    python run_benchmarks.py --micro-only --scale 0.2
+
+Latency is hardware-dependent, so record the baseline on the machine that
+runs the comparison. Exit code 1 means a regression (or request errors).
+"""
+
+import argparse
+import json
+import os
+import platform
+import sys
+from datetime import datetime, timezone
+
+# Must run before anything imports models.base (engines are built at import)
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from benchmarks.common import use_temp_database
+
+DEFAULT_BASELINE = os.path.join("benchmarks", "baseline.json")
+
+# Statement counts are deterministic; anything above this is a regression
+QUERY_SLACK = 0.05
+
+
+def compare(results: dict, baseline: dict, tolerance: float) -> list:
+    """
+    Regressions of results against baseline.
+
+    p50 may grow by `tolerance` (fraction), p99 by twice that, queries per
+    request only by QUERY_SLACK.
+
+    Returns:
+        Human-readable regression lines
+    """
+    regressions = []
+    for section in ("micro", "load"):
+        for name, current in results.get(section, {}).items():
+            previous = baseline.get(section, {}).get(name)
+            if not previous or "skipped" in current or "skipped" in previous:
+                continue
+            for metric, allowed in (
+                ("p50_us", tolerance), ("p99_us", 2 * tolerance),
+                ("p50_ms", tolerance), ("p99_ms", 2 * tolerance),
+            ):
+                if metric in current and metric in previous and previous[metric] > 0:
+                    ratio = current[metric] / previous[metric]
+                    if ratio > 1 + allowed:
+                        regressions.append(
+                            f"{section}/{name} {metric}: {previous[metric]:.2f} -> {current[metric]:.2f} "
+                            f"(+{(ratio - 1) * 100:.0f}%, allowed +{allowed * 100:.0f}%)"
+                        )
+            if "queries_per_request" in current and "queries_per_request" in previous:
+                if current["queries_per_request"] > previous["queries_per_request"] + QUERY_SLACK:
+                    regressions.append(
+                        f"{section}/{name} queries_per_request: "
+                        f"{previous['queries_per_request']:.2f} -> {current['queries_per_request']:.2f}"
+                    )
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description="PULSE benchmark runner")
+    parser.add_argument("--micro-only", action="store_true", help="Skip the load test")
+    parser.add_argument("--load-only", action="store_true", help="Skip the microbenchmarks")
+    parser.add_argument("--scale", type=float, default=1.0, help="Microbenchmark calls multiplier")
+    parser.add_argument("--users", type=int, default=20, help="Seeded users for the load test")
+    parser.add_argument("--clients", type=int, default=16, help="Concurrent virtual clients")
+    parser.add_argument("--rounds", type=int, default=10, help="Recorded rounds per client")
+    parser.add_argument("--seed", type=int, default=42, help="Data and request-mix seed")
+    parser.add_argument("--baseline", default=DEFAULT_BASELINE, help="Baseline JSON file")
+    parser.add_argument("--save-baseline", action="store_true", help="Write results as the new baseline")
+    parser.add_argument("--tolerance", type=float, default=0.25, help="Allowed p50 slowdown (fraction)")
+    args = parser.parse_args()
+
+    os.chdir(os.path.dirname(os.path.abspath(__file__)))
+    database_path = use_temp_database()
+
+    print("=" * 70)
+    print("PULSE Backend - Benchmarks")
+    print(f"Started at: {datetime.now().strftime('%Y-%m-%d %H:%M:%S')}")
+    print(f"Scratch database: {database_path}")
+    print("=" * 70)
+    print()
+
+    results = {
+        "meta": {
+            "recorded_at": datetime.now(timezone.utc).isoformat(),
+            "python": platform.python_version(),
+            "machine": f"{platform.system()} {platform.machine()}",
+            "config": {
+                "scale": args.scale, "users": args.users, "clients": args.clients,
+                "rounds": args.rounds, "seed": args.seed,
+            },
+        },
+    }
+
+    from benchmarks.load import print_load, run_load
+    from benchmarks.micro import print_micro, run_micro
+
+    if not args.micro_only:
+        print("Load test")
+        print("-" * 70)
+        results["load"] = run_load(args.users, args.clients, args.rounds, seed=args.seed)
+        print_load(results["load"])
+        print()
+
+    if not args.load_only:
+        from benchmarks.common import seed_users
+        from models.base import SessionLocal, init_db
+
+        init_db()
+        db = SessionLocal()
+        try:
+            (user_id,) = seed_users(db, 1, args.seed, prefix="micro")
+            print("Microbenchmarks")
+            print("-" * 70)
+            results["micro"] = run_micro(db, user_id, args.scale)
+            print_micro(results["micro"])
+            print()
+        finally:
+            db.close()
+
+    print("=" * 70)
+    errors = sum(result.get("errors", 0) for name, result in results.get("load", {}).items()
+                 if not name.startswith("_"))
+    exit_code = 0
+    if errors:
+        print(f"❌ {errors} load-test requests failed")
+        exit_code = 1
+
+    if args.save_baseline:
+        with open(args.baseline, "w") as f:
+            json.dump(results, f, indent=2, sort_keys=True)
+            f.write("\n")
+        print(f"Baseline written to {args.baseline}")
+    elif os.path.exists(args.baseline):
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+        if baseline.get("meta", {}).get("config") != results["meta"]["config"]:
+            print(f"⚠️  Baseline was recorded with {baseline.get('meta', {}).get('config')}; comparing anyway")
+        regressions = compare(results, baseline, args.tolerance)
+        if regressions:
+            print(f"❌ {len(regressions)} regressions against {args.baseline}:")
+            for line in regressions:
+                print(f"  • {line}")
+            exit_code = 1
+        else:
+            print(f"✅ No regressions against {args.baseline} "
+                  f"(recorded {baseline.get('meta', {}).get('recorded_at', '?')})")
+    else:
+        print(f"No baseline at {args.baseline}; record one with --save-baseline")
+
+    print("=" * 70)
+    return exit_code
+
+
+if __name__ == "__main__":
+    sys.exit(main())
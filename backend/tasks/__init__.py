@@ -2,17 +2,31 @@
 # Background tasks for PULSE backend
 
 from .background import (
+    persist_agent_models,
     persist_agent_models_task,
+    infer_pending_outcomes,
     infer_pending_outcomes_task,
     run_startup_tasks,
     run_shutdown_tasks,
+    BackgroundTaskRunner,
+    PeriodicJob,
     background_runner,
 )
+from .rollups import refresh_rollups, mark_rollup_days
+from .archive import archive_old_rows, ColdArchive
 
 __all__ = [
+    "persist_agent_models",
     "persist_agent_models_task",
+    "infer_pending_outcomes",
     "infer_pending_outcomes_task",
     "run_startup_tasks",
     "run_shutdown_tasks",
+    "BackgroundTaskRunner",
+    "PeriodicJob",
     "background_runner",
+    "refresh_rollups",
+    "mark_rollup_days",
+    "archive_old_rows",
+    "ColdArchive",
 ]
@@ -0,0 +1,329 @@
+"""
+Cold Storage Archive
+Moves old rows out of the hot recommendation_logs and browsing_sessions
+tables into compressed monthly files the offline DQN trainer can read.
+
+Layout (one directory per table and month of the row timestamp):
+
+    <ARCHIVE_DIRECTORY>/recommendation_logs/2025-01/part-20250415T030000Z-000123.jsonl.gz
+
+Each part is gzip-compressed JSON lines. Line 1 is a header
+{"v": 1, "table": ..., "columns": [...]}, and every other line is one row
+as a list of values in that column order. Datetimes are ISO 8601 UTC
+strings.
+
+The archive job only takes recommendation logs that have an outcome, and
+browsing sessions, once they are older than the retention window. Before
+deleting a day's rows it rebuilds that day's rollup and marks those figures
+as final, so the insights endpoints keep the full history.
+
+Archiving is off unless a retention window is set and ARCHIVE_DIRECTORY
+names an absolute path (see archive_config_error): deleted rows only
+survive as long as that directory does, so it must be durable storage,
+not the container's own filesystem.
+
+A part is fsynced before the rows are deleted. A crash between the two
+leaves the rows in both places, and the next run archives them again.
+Readers drop duplicate keys, so nothing is lost or counted twice.
+"""
+
+import gzip
+import json
+import os
+from collections import defaultdict
+from datetime import date, datetime, timedelta, timezone
+from typing import Any, Dict, Iterator, List, Optional, Sequence
+
+from sqlalchemy import Date, DateTime, func, select
+from sqlalchemy.orm import Session
+
+from ai.config import AIConfig
+from crud.record_log import fsync_directory
+from models.base import ReadSessionLocal, SessionLocal
+from tasks.rollups import rebuild_rollup_day, rollup_day
+
+ARCHIVE_FORMAT_VERSION = 1
+
+# Rows per DELETE ... WHERE key IN (...) statement
+_DELETE_CHUNK_SIZE = 500
+
+
+def _archived_models() -> Dict[str, tuple]:
+    """table name -> (model, dedup key column, rollup flag)"""
+    from models.recommendation_log import RecommendationLog
+    from models.extension_metadata import BrowsingSession
+
+    return {
+        "recommendation_logs": (RecommendationLog, "id", "recommendations_archived"),
+        "browsing_sessions": (BrowsingSession, "session_id", "sessions_archived"),
+    }
+
+
+def _utc(value: datetime) -> datetime:
+    """Aware UTC datetime (naive values from SQLite are UTC)."""
+    if value.tzinfo is None:
+        return value.replace(tzinfo=timezone.utc)
+    return value.astimezone(timezone.utc)
+
+
+def _encode(value: Any) -> Any:
+    if isinstance(value, datetime):
+        return _utc(value).isoformat()
+    if isinstance(value, date):
+        return value.isoformat()
+    return value
+
+
+class ColdArchive:
+    """
+    Reader and writer for archive parts under one directory.
+
+    Usage:
+        archive = ColdArchive()
+        for row in archive.iter_rows("browsing_sessions", start=since):
+            ...
+    """
+
+    def __init__(self, directory: Optional[str] = None):
+        """
+        Args:
+            directory: Archive root (defaults to AIConfig.ARCHIVE_DIRECTORY)
+
+        Raises:
+            ValueError: If no directory is given or configured
+        """
+        directory = AIConfig.ARCHIVE_DIRECTORY if directory is None else directory
+        if not directory:
+            raise ValueError("No archive directory: set ARCHIVE_DIRECTORY")
+        self.directory = directory
+
+    def months(self, table: str) -> List[str]:
+        """Months ("YYYY-MM") with archived rows for a table, oldest first."""
+        table_dir = os.path.join(self.directory, table)
+        if not os.path.isdir(table_dir):
+            return []
+        return sorted(name for name in os.listdir(table_dir) if len(name) == 7)
+
+    def write_part(self, table: str, month: str, columns: Sequence[str], rows: Sequence[Sequence[Any]]) -> str:
+        """
+        Write one durable part file (temp file, fsync, rename).
+
+        Returns:
+            Path of the part
+        """
+        month_dir = os.path.join(self.directory, table, month)
+        os.makedirs(month_dir, exist_ok=True)
+        stamp = datetime.now(timezone.utc).strftime("%Y%m%dT%H%M%SZ")
+        path = os.path.join(month_dir, f"part-{stamp}-{os.getpid()}-{len(os.listdir(month_dir)):06d}.jsonl.gz")
+
+        tmp_path = f"{path}.tmp"
+        with open(tmp_path, "wb") as raw:
+            with gzip.GzipFile(fileobj=raw, mode="wb") as f:
+                header = {"v": ARCHIVE_FORMAT_VERSION, "table": table, "columns": list(columns)}
+                f.write((json.dumps(header) + "\n").encode())
+                for row in rows:
+                    f.write((json.dumps([_encode(value) for value in row], separators=(",", ":")) + "\n").encode())
+            raw.flush()
+            os.fsync(raw.fileno())
+        os.replace(tmp_path, path)
+        fsync_directory(month_dir)
+        return path
+
+    def iter_rows(
+        self,
+        table: str,
+        start: Optional[datetime] = None,
+        end: Optional[datetime] = None
+    ) -> Iterator[Dict[str, Any]]:
+        """
+        Archived rows as column dicts, in month order, deduplicated.
+
+        Args:
+            table: recommendation_logs or browsing_sessions
+            start: Only rows with timestamp >= start
+            end: Only rows with timestamp < end
+
+        Yields:
+            {column: value} with datetimes as aware UTC datetimes
+        """
+        model, key, _ = _archived_models()[table]
+        converters = {}
+        for column in model.__table__.columns:
+            if isinstance(column.type, DateTime):
+                converters[column.name] = datetime.fromisoformat
+            elif isinstance(column.type, Date):
+                converters[column.name] = date.fromisoformat
+
+        start = _utc(start) if start is not None else None
+        end = _utc(end) if end is not None else None
+        first_month = start.strftime("%Y-%m") if start else None
+        last_month = end.strftime("%Y-%m") if end else None
+
+        seen = set()
+        for month in self.months(table):
+            if (first_month and month < first_month) or (last_month and month > last_month):
+                continue
+            month_dir = os.path.join(self.directory, table, month)
+            for name in sorted(os.listdir(month_dir)):
+                if not name.endswith(".jsonl.gz"):
+                    continue
+                with gzip.open(os.path.join(month_dir, name), "rt") as f:
+                    header = json.loads(f.readline())
+                    if header.get("v", 0) > ARCHIVE_FORMAT_VERSION:
+                        raise ValueError(f"{name}: archive format {header['v']} is newer than {ARCHIVE_FORMAT_VERSION}")
+                    columns = header["columns"]
+                    for line in f:
+                        row = dict(zip(columns, json.loads(line)))
+                        for column, convert in converters.items():
+                            if row.get(column) is not None:
+                                row[column] = convert(row[column])
+                        timestamp = row["timestamp"]
+                        if (start and timestamp < start) or (end and timestamp >= end):
+                            continue
+                        if row[key] in seen:
+                            continue
+                        seen.add(row[key])
+                        yield row
+
+
+# =============================================================================
+# Archive job
+# =============================================================================
+
+def _archivable(model, cutoff: datetime) -> list:
+    """WHERE clauses selecting a table's rows eligible for archival."""
+    conditions = [model.timestamp < cutoff]
+    if model.__tablename__ == "recommendation_logs":
+        conditions.append(model.outcome != None)  # Pending logs stay hot for inference
+    return conditions
+
+
+def archive_table(
+    db: Session,
+    archive: ColdArchive,
+    table: str,
+    cutoff: datetime,
+    batch_size: Optional[int] = None
+) -> int:
+    """
+    Move a table's eligible rows older than cutoff to the archive.
+
+    Each batch is written to one part per month, then its rollup days are
+    finalized and its rows deleted in one commit.
+
+    Returns:
+        Number of rows archived
+    """
+    if batch_size is None:
+        batch_size = AIConfig.ARCHIVE_BATCH_SIZE
+    model, key, rollup_flag = _archived_models()[table]
+    columns = [column.name for column in model.__table__.columns]
+    key_column = getattr(model, key)
+
+    archived = 0
+    while True:
+        rows = db.execute(
+            select(*model.__table__.columns)
+            .where(*_archivable(model, cutoff))
+            .order_by(model.timestamp, model.id)
+            .limit(batch_size)
+        ).all()
+        if not rows:
+            break
+
+        by_month: Dict[str, List] = defaultdict(list)
+        for row in rows:
+            by_month[_utc(row.timestamp).strftime("%Y-%m")].append(row)
+        for month, month_rows in sorted(by_month.items()):
+            archive.write_part(table, month, columns, month_rows)
+
+        # Rollups were built from the rows about to go; freeze those figures
+        days = {(row.user_id, rollup_day(row.timestamp)) for row in rows if row.user_id is not None}
+        for user_id, day in sorted(days):
+            rollup = rebuild_rollup_day(db, user_id, day)
+            if rollup is not None:
+                setattr(rollup, rollup_flag, True)
+        db.flush()
+
+        keys = [getattr(row, key) for row in rows]
+        for i in range(0, len(keys), _DELETE_CHUNK_SIZE):
+            db.execute(model.__table__.delete().where(key_column.in_(keys[i:i + _DELETE_CHUNK_SIZE])))
+        db.commit()
+
+        archived += len(rows)
+        if len(rows) < batch_size:
+            break
+    return archived
+
+
+def _cutoffs(now: datetime) -> Dict[str, datetime]:
+    """Archive cutoff per table (retention of 0 or less disables a table)."""
+    retention = {
+        "recommendation_logs": AIConfig.RECOMMENDATION_LOG_RETENTION_DAYS,
+        "browsing_sessions": AIConfig.BROWSING_SESSION_RETENTION_DAYS,
+    }
+    return {table: now - timedelta(days=days) for table, days in retention.items() if days > 0}
+
+
+def archive_config_error(directory: Optional[str] = None) -> Optional[str]:
+    """
+    Why the archive job must not delete rows, or None if it may.
+
+    Args:
+        directory: Archive root to check (defaults to AIConfig.ARCHIVE_DIRECTORY)
+    """
+    directory = AIConfig.ARCHIVE_DIRECTORY if directory is None else directory
+    if not directory:
+        return "ARCHIVE_DIRECTORY is not set"
+    if not os.path.isabs(directory):
+        return f"ARCHIVE_DIRECTORY {directory!r} must be an absolute path on durable storage"
+    return None
+
+
+def archive_old_rows(archive: Optional[ColdArchive] = None) -> int:
+    """
+    Background job: archive every table's rows past its retention window.
+
+    Does nothing unless a retention window is set and the archive
+    directory passes archive_config_error().
+
+    Returns:
+        Number of rows archived
+    """
+    cutoffs = _cutoffs(datetime.now(timezone.utc))
+    if not cutoffs:
+        return 0
+    problem = archive_config_error(archive.directory if archive else None)
+    if problem:
+        print(f"[Background] Archiving skipped, no rows deleted: {problem}")
+        return 0
+
+    archive = archive or ColdArchive()
+    total = 0
+    db = SessionLocal()
+    try:
+        for table, cutoff in cutoffs.items():
+            count = archive_table(db, archive, table, cutoff)
+            if count:
+                print(f"[Background] Archived {count} {table} rows older than {cutoff.date()}")
+            total += count
+    finally:
+        db.close()
+    return total
+
+
+def count_archivable_rows() -> int:
+    """Rows currently past their retention window (backlog for /health)."""
+    if archive_config_error():
+        return 0  # Nothing will be archived
+    models = _archived_models()
+    db = ReadSessionLocal()  # Read-only: don't hold the single writer
+    try:
+        return sum(
+            db.query(func.count()).select_from(models[table][0]).filter(
+                *_archivable(models[table][0], cutoff)
+            ).scalar()
+            for table, cutoff in _cutoffs(datetime.now(timezone.utc)).items()
+        )
+    finally:
+        db.close()
@@ -1,23 +1,35 @@
 """
 Background Tasks
 Periodic tasks for AI model maintenance.
+
+Jobs are plain synchronous functions (they touch the database and disk);
+BackgroundTaskRunner schedules them on the event loop and executes them in
+a thread pool so requests are never blocked behind a persist or an
+inference sweep.
 """
 
 import asyncio
-from datetime import datetime
-from typing import Optional
+import random
+import time
+from concurrent.futures import Future, ThreadPoolExecutor
+from datetime import datetime, timezone
+from typing import Any, Callable, Dict, List, Optional, Tuple
 
 from sqlalchemy.orm import Session
-from models.base import SessionLocal
+from models.base import SessionLocal, ReadSessionLocal
 from ai.agent import ScheduleAgent
+from ai.config import AIConfig
 from ai.implicit_feedback import ImplicitFeedbackInferencer
+from tasks.rollups import refresh_rollups, count_dirty_days, backfill_rollups_if_empty
+from tasks.archive import archive_old_rows, count_archivable_rows
 
 
-async def persist_agent_models_task():
+def persist_agent_models() -> int:
     """
-    Periodic task to persist all cached agent models.
-    
-    Should be scheduled to run every 5 minutes.
+    Persist all cached agent models that changed since their last save.
+
+    Returns:
+        Number of agents saved
     """
     saved_count = ScheduleAgent.persist_all()
     if saved_count > 0:
@@ -25,29 +37,153 @@ async def persist_agent_models_task():
     return saved_count
 
 
-async def infer_pending_outcomes_task(min_age_hours: int = 2, limit: int = 100):
+def infer_pending_outcomes(
+    min_age_hours: int = 2,
+    limit: Optional[int] = None,
+    workers: Optional[int] = None
+) -> int:
     """
-    Periodic task to infer outcomes for old recommendations.
-    
-    Should be scheduled to run every 30 minutes.
+    Infer outcomes for old recommendations.
+
+    Drains the whole backlog with keyset pagination (or up to `limit` logs
+    per worker), optionally split across `workers` threads that each own a
+    disjoint set of users.
+
+    Returns:
+        Number of logs processed
     """
+    if workers is None:
+        workers = AIConfig.FEEDBACK_INFER_WORKERS
+    workers = max(1, workers)
+
+    if workers == 1:
+        processed_count = _infer_partition(min_age_hours, limit, None)
+    else:
+        with ThreadPoolExecutor(max_workers=workers, thread_name_prefix="infer") as pool:
+            processed_count = sum(pool.map(
+                lambda index: _infer_partition(min_age_hours, limit, (index, workers)),
+                range(workers),
+            ))
+
+    if processed_count > 0:
+        print(f"[Background] Inferred outcomes for {processed_count} recommendations")
+    return processed_count
+
+
+def _infer_partition(
+    min_age_hours: int,
+    limit: Optional[int],
+    partition: Optional[Tuple[int, int]]
+) -> int:
+    """Run streaming inference for one user partition on its own session."""
     db = SessionLocal()
     try:
         inferencer = ImplicitFeedbackInferencer()
-        processed_count = inferencer.batch_infer_outcomes(db, min_age_hours, limit)
-        if processed_count > 0:
-            print(f"[Background] Inferred outcomes for {processed_count} recommendations")
-        return processed_count
+        return inferencer.stream_infer_outcomes(
+            db, min_age_hours, max_logs=limit, partition=partition
+        )
     finally:
         db.close()
 
 
+def count_pending_outcomes(min_age_hours: int = 2) -> int:
+    """Count recommendation logs old enough for inference but still without an outcome."""
+    from datetime import timedelta
+    from models.recommendation_log import RecommendationLog
+
+    cutoff_time = datetime.now(timezone.utc) - timedelta(hours=min_age_hours)
+    db = ReadSessionLocal()  # Read-only: keep the single writer free for the jobs
+    try:
+        return db.query(RecommendationLog.id).filter(
+            RecommendationLog.outcome == None,
+            RecommendationLog.timestamp <= cutoff_time
+        ).count()
+    finally:
+        db.close()
+
+
+def warm_recent_agents(
+    recent_days: Optional[int] = None,
+    max_users: Optional[int] = None
+) -> int:
+    """
+    Load the agents of recently active users into the registry.
+
+    Users are ranked by their latest recommendation, most recent first.
+    Agents that are already cached are left alone.
+
+    Args:
+        recent_days: Activity window (default AGENT_WARMUP_RECENT_DAYS)
+        max_users: Most agents to load (default AGENT_WARMUP_MAX_USERS)
+
+    Returns:
+        Number of agents loaded
+    """
+    from datetime import timedelta
+    from sqlalchemy import func
+    from models.recommendation_log import RecommendationLog
+
+    if recent_days is None:
+        recent_days = AIConfig.AGENT_WARMUP_RECENT_DAYS
+    if max_users is None:
+        max_users = AIConfig.AGENT_WARMUP_MAX_USERS
+
+    cutoff_time = datetime.now(timezone.utc) - timedelta(days=recent_days)
+    db = ReadSessionLocal()
+    try:
+        latest = func.max(RecommendationLog.timestamp)
+        user_ids = [row[0] for row in (
+            db.query(RecommendationLog.user_id)
+            .filter(RecommendationLog.timestamp >= cutoff_time)
+            .group_by(RecommendationLog.user_id)
+            .order_by(latest.desc())
+            .limit(max_users)
+            .all()
+        )]
+    finally:
+        db.close()
+
+    loaded_count = 0
+    for user_id in user_ids:
+        if ScheduleAgent.is_cached(user_id):
+            continue
+        ScheduleAgent.get_instance(user_id)
+        loaded_count += 1
+
+    if loaded_count > 0:
+        print(f"[Background] Warmed {loaded_count} agent models")
+    return loaded_count
+
+
+async def persist_agent_models_task():
+    """
+    Periodic task to persist all cached agent models.
+    
+    Should be scheduled to run every 5 minutes.
+    """
+    return await asyncio.to_thread(persist_agent_models)
+
+
+async def infer_pending_outcomes_task(
+    min_age_hours: int = 2,
+    limit: Optional[int] = None,
+    workers: Optional[int] = None
+):
+    """
+    Periodic task to infer outcomes for old recommendations.
+    
+    Should be scheduled to run every 30 minutes.
+    """
+    return await asyncio.to_thread(infer_pending_outcomes, min_age_hours, limit, workers)
+
+
 def run_startup_tasks():
     """
     Tasks to run on application startup.
     
     - Create default user if needed
     - Load cached agents
+    - Queue rollup backfill on first start
     """
     db = SessionLocal()
     try:
@@ -67,6 +203,12 @@ def run_startup_tasks():
     finally:
         db.close()
 
+    # First start with rollups: queue existing history for the refresh job
+    try:
+        backfill_rollups_if_empty()
+    except Exception as e:
+        print(f"[Startup] Warning during rollup backfill: {e}")
+
 
 def run_shutdown_tasks():
     """
@@ -78,57 +220,240 @@ def run_shutdown_tasks():
     print(f"[Shutdown] Saved {saved_count} agent models")
 
 
-# Simple background task runner for development
-# In production, use APScheduler or Celery
-class SimpleBackgroundRunner:
+class PeriodicJob:
     """
-    Simple background task runner for development.
-    
-    For production, replace with APScheduler, Celery, or similar.
+    A synchronous job run every `interval_seconds` (+/- jitter).
+
+    Tracks run statistics for /health. `backlog` is an optional callable
+    measured after each run (e.g. dirty agents, pending logs) so the health
+    check never has to query for it. A `run_once` job fires a single time,
+    `interval_seconds` after start (e.g. startup warm-up).
     """
-    
-    def __init__(self):
+
+    def __init__(
+        self,
+        name: str,
+        func: Callable[[], Any],
+        interval_seconds: float,
+        jitter_fraction: float = AIConfig.BACKGROUND_JITTER_FRACTION,
+        backlog: Optional[Callable[[], int]] = None,
+        run_once: bool = False
+    ):
+        self.name = name
+        self.func = func
+        self.interval_seconds = interval_seconds
+        self.jitter_fraction = jitter_fraction
+        self.backlog = backlog
+        self.run_once = run_once
+
+        self.run_count = 0
+        self.skipped_count = 0
+        self.error_count = 0
+        self.last_started_at: Optional[datetime] = None
+        self.last_duration_seconds: Optional[float] = None
+        self.last_result: Any = None
+        self.last_error: Optional[str] = None
+        self.backlog_size: Optional[int] = None
+        self._future: Optional[Future] = None
+
+    @property
+    def is_running(self) -> bool:
+        """Whether a run is in progress."""
+        return self._future is not None and not self._future.done()
+
+    def next_delay(self) -> float:
+        """Seconds until the next tick, with jitter."""
+        jitter = self.interval_seconds * self.jitter_fraction
+        return max(0.0, self.interval_seconds + random.uniform(-jitter, jitter))
+
+    def execute(self) -> Any:
+        """Run the job once and record its statistics (called in a worker thread)."""
+        self.last_started_at = datetime.now(timezone.utc)
+        started = time.perf_counter()
+        try:
+            self.last_result = self.func()
+            self.last_error = None
+        except Exception as e:
+            self.error_count += 1
+            self.last_error = f"{type(e).__name__}: {e}"
+            print(f"[Background] Job {self.name} failed: {self.last_error}")
+        finally:
+            self.last_duration_seconds = round(time.perf_counter() - started, 3)
+            self.run_count += 1
+
+        if self.backlog is not None:
+            try:
+                self.backlog_size = self.backlog()
+            except Exception as e:
+                print(f"[Background] Backlog check for {self.name} failed: {e}")
+        return self.last_result
+
+    def get_stats(self) -> Dict[str, Any]:
+        """Get run statistics."""
+        return {
+            "interval_seconds": self.interval_seconds,
+            "run_once": self.run_once,
+            "running": self.is_running,
+            "runs": self.run_count,
+            "skipped": self.skipped_count,
+            "errors": self.error_count,
+            "last_started_at": self.last_started_at.isoformat() if self.last_started_at else None,
+            "last_duration_seconds": self.last_duration_seconds,
+            "last_result": self.last_result if isinstance(self.last_result, (int, float, str)) else None,
+            "last_error": self.last_error,
+            "backlog": self.backlog_size,
+        }
+
+
+class BackgroundTaskRunner:
+    """
+    Asyncio scheduler for periodic maintenance jobs.
+
+    Each job gets its own ticker coroutine on the event loop; the job body
+    runs in a shared thread pool. If a tick arrives while the previous run
+    of that job is still going, the tick is skipped (backpressure) rather
+    than queueing another run behind it.
+
+    Usage (inside a running event loop):
+        await background_runner.start()
+        ...
+        await background_runner.stop()
+    """
+
+    def __init__(self, max_workers: int = AIConfig.BACKGROUND_MAX_WORKERS):
+        self.max_workers = max_workers
+        self.jobs: Dict[str, PeriodicJob] = {}
+        self._executor: Optional[ThreadPoolExecutor] = None
+        self._tickers: List[asyncio.Task] = []
         self._running = False
-        self._task: Optional[asyncio.Task] = None
-    
-    async def _run_periodic_tasks(self):
-        """Run periodic tasks in a loop."""
-        persist_interval = 300  # 5 minutes
-        infer_interval = 1800   # 30 minutes
-        
-        last_persist = datetime.now()
-        last_infer = datetime.now()
-        
-        while self._running:
-            now = datetime.now()
-            
-            # Check if persist is due
-            if (now - last_persist).total_seconds() >= persist_interval:
-                await persist_agent_models_task()
-                last_persist = now
-            
-            # Check if infer is due
-            if (now - last_infer).total_seconds() >= infer_interval:
-                await infer_pending_outcomes_task()
-                last_infer = now
-            
-            # Sleep for a minute
-            await asyncio.sleep(60)
-    
-    def start(self):
-        """Start the background task runner."""
+
+    def add_job(
+        self,
+        name: str,
+        func: Callable[[], Any],
+        interval_seconds: float,
+        backlog: Optional[Callable[[], int]] = None,
+        jitter_fraction: float = AIConfig.BACKGROUND_JITTER_FRACTION,
+        run_once: bool = False
+    ) -> PeriodicJob:
+        """Register a periodic job (takes effect on the next start())."""
+        job = PeriodicJob(name, func, interval_seconds, jitter_fraction, backlog, run_once)
+        self.jobs[name] = job
+        return job
+
+    @property
+    def is_running(self) -> bool:
+        """Whether the scheduler is running."""
+        return self._running and any(not ticker.done() for ticker in self._tickers)
+
+    async def start(self):
+        """Start one ticker per job on the current event loop."""
+        if self._running:
+            return
         self._running = True
-        # Note: This needs to be called from an async context
-        # self._task = asyncio.create_task(self._run_periodic_tasks())
+        self._executor = ThreadPoolExecutor(
+            max_workers=self.max_workers, thread_name_prefix="background"
+        )
+        self._tickers = [
+            asyncio.create_task(self._tick(job), name=f"background-{job.name}")
+            for job in self.jobs.values()
+        ]
         print("[Background] Task runner started")
-    
-    def stop(self):
-        """Stop the background task runner."""
+
+    async def stop(self, timeout: float = 30.0):
+        """Cancel tickers and wait (up to timeout) for in-flight runs."""
+        if not self._running:
+            return
         self._running = False
-        if self._task:
-            self._task.cancel()
+
+        for ticker in self._tickers:
+            ticker.cancel()
+        await asyncio.gather(*self._tickers, return_exceptions=True)
+        self._tickers = []
+
+        in_flight = [
+            asyncio.wrap_future(job._future)
+            for job in self.jobs.values() if job.is_running
+        ]
+        if in_flight:
+            await asyncio.wait(in_flight, timeout=timeout)
+
+        self._executor.shutdown(wait=False)
+        self._executor = None
         print("[Background] Task runner stopped")
 
+    async def run_now(self, name: str) -> Any:
+        """Run a job immediately in the pool (skipped if already running)."""
+        job = self.jobs[name]
+        future = self._submit(job)
+        if future is None:
+            return None
+        return await asyncio.wrap_future(future)
+
+    async def _tick(self, job: PeriodicJob):
+        """Fire a job on its interval, skipping ticks while a run is in progress."""
+        while self._running:
+            await asyncio.sleep(job.next_delay())
+            if self._submit(job) is None:
+                print(f"[Background] Skipping {job.name}: previous run still in progress")
+            if job.run_once:
+                return
+
+    def _submit(self, job: PeriodicJob) -> Optional[Future]:
+        """Hand a job to the pool unless it's already running."""
+        if job.is_running:
+            job.skipped_count += 1
+            return None
+        if self._executor is None:
+            raise RuntimeError("Background task runner is not started")
+        job._future = self._executor.submit(job.execute)
+        return job._future
+
+    def get_stats(self) -> Dict[str, Any]:
+        """Get scheduler and per-job statistics (for /health)."""
+        return {
+            "running": self.is_running,
+            "jobs": {name: job.get_stats() for name, job in self.jobs.items()},
+        }
+
+
+def _create_default_runner() -> BackgroundTaskRunner:
+    """Runner with the standard persistence, inference, rollup and archive jobs
+    (plus the one-off agent warm-up when enabled)."""
+    runner = BackgroundTaskRunner()
+    runner.add_job(
+        "persist_agents",
+        persist_agent_models,
+        AIConfig.PERSIST_INTERVAL_SECONDS,
+        backlog=ScheduleAgent.count_dirty,
+    )
+    runner.add_job(
+        "infer_outcomes",
+        infer_pending_outcomes,
+        AIConfig.FEEDBACK_INFER_INTERVAL_SECONDS,
+        backlog=count_pending_outcomes,
+    )
+    runner.add_job(
+        "refresh_rollups",
+        refresh_rollups,
+        AIConfig.ROLLUP_REFRESH_INTERVAL_SECONDS,
+        backlog=count_dirty_days,
+    )
+    runner.add_job(
+        "archive_rows",
+        archive_old_rows,
+        AIConfig.ARCHIVE_INTERVAL_SECONDS,
+        backlog=count_archivable_rows,
+    )
+    if AIConfig.AGENT_WARMUP_ENABLED:
+        runner.add_job(
+            "warm_agents",
+            warm_recent_agents,
+            AIConfig.AGENT_WARMUP_DELAY_SECONDS,
+            run_once=True,
+        )
+    return runner
+
 
 # Global instance
-background_runner = SimpleBackgroundRunner()
+background_runner = _create_default_runner()
@@ -0,0 +1,421 @@
+"""
+Daily Rollups
+Keeps DailyUserRollup rows in step with the raw tables.
+
+Maintenance is split in two:
+- On write: a flush listener marks the (user, UTC day) of every changed
+  recommendation log, mood entry, reflection, task or browsing session as
+  dirty, in the same transaction as the change. Bulk writes that bypass
+  flush events (Core inserts, query.delete()) call mark_rollup_days().
+- In the background: refresh_rollups() rebuilds each dirty day from its
+  source rows with a handful of grouped queries and clears the mark.
+
+Rebuilding a whole day (instead of applying deltas) keeps rollups exact
+through updates, deletes and late outcomes, and the insights endpoints
+only ever read the rollup table.
+"""
+
+from datetime import date, datetime, time as dt_time, timedelta, timezone
+from typing import Dict, Iterable, List, Optional, Set, Tuple
+
+from sqlalchemy import case, event, func, inspect
+from sqlalchemy.orm import Session
+
+from ai.config import AIConfig
+from models.base import ReadSessionLocal, SessionLocal
+from models.daily_rollup import DailyUserRollup, RollupDirtyDay
+
+# Source tables -> the column that decides which day a row counts towards
+_ROLLUP_DAY_COLUMNS = {
+    "recommendation_logs": "timestamp",
+    "mood_entries": "timestamp",
+    "reflections": "date",
+    "tasks": "completed_at",
+    "browsing_sessions": "timestamp",
+}
+
+# Sources whose day column is filled by a server default (NULL before insert)
+_SERVER_TIMESTAMPED = frozenset({"recommendation_logs", "mood_entries"})
+
+# Rows per upsert statement (3 bound columns each)
+_MARK_CHUNK_SIZE = 200
+
+
+def rollup_day(value) -> Optional[date]:
+    """UTC calendar day of a datetime (naive values are UTC) or date."""
+    if value is None:
+        return None
+    if isinstance(value, datetime):
+        if value.tzinfo is not None:
+            value = value.astimezone(timezone.utc)
+        return value.date()
+    return value
+
+
+def day_bounds(day: date) -> Tuple[datetime, datetime]:
+    """[start, end) of a UTC day as aware datetimes."""
+    start = datetime.combine(day, dt_time.min, tzinfo=timezone.utc)
+    return start, start + timedelta(days=1)
+
+
+# =============================================================================
+# Marking dirty days
+# =============================================================================
+
+def mark_rollup_days(
+    db: Session,
+    days: Iterable[Tuple[Optional[int], Optional[date]]],
+    marked_at: Optional[datetime] = None
+) -> int:
+    """
+    Mark (user_id, day) pairs for a rollup rebuild, in the session's transaction.
+
+    Pairs with a missing user or day are ignored. An existing mark gets the
+    new marked_at, which keeps it alive through a refresh already underway.
+
+    Returns:
+        Number of distinct pairs marked
+    """
+    pairs = sorted({(user_id, day) for user_id, day in days if user_id is not None and day is not None})
+    if not pairs:
+        return 0
+    if marked_at is None:
+        marked_at = datetime.now(timezone.utc)
+
+    rows = [{"user_id": user_id, "day": day, "marked_at": marked_at} for user_id, day in pairs]
+    connection = db.connection()
+    dialect = connection.dialect.name
+
+    if dialect in ("postgresql", "sqlite"):
+        if dialect == "postgresql":
+            from sqlalchemy.dialects.postgresql import insert as dialect_insert
+        else:
+            from sqlalchemy.dialects.sqlite import insert as dialect_insert
+
+        for i in range(0, len(rows), _MARK_CHUNK_SIZE):
+            stmt = dialect_insert(RollupDirtyDay).values(rows[i:i + _MARK_CHUNK_SIZE])
+            stmt = stmt.on_conflict_do_update(
+                index_elements=["user_id", "day"],
+                set_={"marked_at": stmt.excluded.marked_at},
+            )
+            connection.execute(stmt)
+    else:
+        table = RollupDirtyDay.__table__
+        for row in rows:
+            updated = connection.execute(
+                table.update()
+                .where(table.c.user_id == row["user_id"], table.c.day == row["day"])
+                .values(marked_at=marked_at)
+            ).rowcount
+            if not updated:
+                connection.execute(table.insert().values(row))
+    return len(pairs)
+
+
+def mark_all_rollup_days(db: Session, user_id: Optional[int] = None) -> int:
+    """
+    Mark every day that has source rows (backfill for existing history).
+
+    Only the user and day columns are read.
+
+    Returns:
+        Number of pairs marked
+    """
+    from models.recommendation_log import RecommendationLog
+    from models.mood import MoodEntry
+    from models.reflection import Reflection
+    from models.task import Task
+    from models.extension_metadata import BrowsingSession
+
+    pairs: Set[Tuple[int, date]] = set()
+    for model in (RecommendationLog, MoodEntry, Reflection, Task, BrowsingSession):
+        column = getattr(model, _ROLLUP_DAY_COLUMNS[model.__tablename__])
+        query = db.query(model.user_id, column).filter(model.user_id != None, column != None)
+        if user_id is not None:
+            query = query.filter(model.user_id == user_id)
+        for row_user, value in query.yield_per(1000):
+            pairs.add((row_user, rollup_day(value)))
+    return mark_rollup_days(db, pairs)
+
+
+def _instance_days(instance, table: str) -> Set[date]:
+    """Days a pending instance counts towards, before and after the change."""
+    column = _ROLLUP_DAY_COLUMNS[table]
+    state = inspect(instance)
+    history = state.attrs[column].history
+    values = [*history.added, *history.deleted]
+    if state.persistent:
+        values.append(getattr(instance, column))  # Loads it if expired (the row still exists)
+
+    days = {rollup_day(value) for value in values if value is not None}
+    if not days and state.pending and table in _SERVER_TIMESTAMPED:
+        days.add(datetime.now(timezone.utc).date())  # Server default: now
+    return days
+
+
+@event.listens_for(Session, "before_flush")
+def _mark_rollups_on_flush(session: Session, flush_context, instances) -> None:
+    """Mark the days touched by pending source changes (same transaction)."""
+    pairs = set()
+    for instance in (*session.new, *session.dirty, *session.deleted):
+        table = getattr(instance, "__tablename__", None)
+        if table not in _ROLLUP_DAY_COLUMNS:
+            continue
+        user_id = getattr(instance, "user_id", None)
+        if user_id is None:
+            continue
+        for day in _instance_days(instance, table):
+            pairs.add((user_id, day))
+    if pairs:
+        mark_rollup_days(session, pairs)
+
+
+# =============================================================================
+# Rebuilding
+# =============================================================================
+
+def rebuild_rollup_day(db: Session, user_id: int, day: date, now: Optional[datetime] = None) -> Optional[DailyUserRollup]:
+    """
+    Recompute one user's rollup for one day from the source tables.
+
+    Recommendation and session figures of a day whose rows were moved to
+    cold storage (tasks/archive.py) are kept as they are: the archive job
+    rebuilt them just before removing the rows.
+
+    Returns:
+        The rollup row, or None if the day has no activity (row removed)
+    """
+    from models.recommendation_log import RecommendationLog
+    from models.mood import MoodEntry
+    from models.reflection import Reflection
+    from models.task import Task
+    from models.extension_metadata import BrowsingSession
+
+    start, end = day_bounds(day)
+    if now is None:
+        now = datetime.now(timezone.utc)
+
+    rollup = db.query(DailyUserRollup).filter(
+        DailyUserRollup.user_id == user_id,
+        DailyUserRollup.day == day,
+    ).first()
+    recommendations_frozen = rollup is not None and rollup.recommendations_archived
+    sessions_frozen = rollup is not None and rollup.sessions_archived
+
+    stats = {}
+    if not recommendations_frozen:
+        # Recommendations, grouped by every dimension at once
+        by_action: Dict[str, int] = {}
+        by_outcome: Dict[str, int] = {}
+        by_strategy: Dict[str, int] = {}
+        recommendation_count = followed_count = reward_count = 0
+        reward_sum = 0.0
+        rows = db.query(
+            RecommendationLog.action_type,
+            RecommendationLog.outcome,
+            RecommendationLog.strategy_used,
+            func.count(RecommendationLog.id),
+            func.sum(case((RecommendationLog.was_followed == True, 1), else_=0)),
+            func.sum(RecommendationLog.reward),
+            func.count(RecommendationLog.reward),
+        ).filter(
+            RecommendationLog.user_id == user_id,
+            RecommendationLog.timestamp >= start,
+            RecommendationLog.timestamp < end,
+        ).group_by(
+            RecommendationLog.action_type,
+            RecommendationLog.outcome,
+            RecommendationLog.strategy_used,
+        ).all()
+        for action_type, outcome, strategy, count, followed, rewards, rewarded in rows:
+            outcome = outcome or "pending"
+            by_action[action_type] = by_action.get(action_type, 0) + count
+            by_outcome[outcome] = by_outcome.get(outcome, 0) + count
+            by_strategy[strategy] = by_strategy.get(strategy, 0) + count
+            recommendation_count += count
+            followed_count += followed or 0
+            reward_sum += rewards or 0.0
+            reward_count += rewarded
+        stats.update(
+            recommendation_count=recommendation_count,
+            followed_count=followed_count,
+            recommendations_by_action=by_action,
+            recommendations_by_outcome=by_outcome,
+            recommendations_by_strategy=by_strategy,
+            reward_sum=reward_sum,
+            reward_count=reward_count,
+        )
+
+    mood_counts = dict(db.query(MoodEntry.mood, func.count(MoodEntry.id)).filter(
+        MoodEntry.user_id == user_id,
+        MoodEntry.timestamp >= start,
+        MoodEntry.timestamp < end,
+    ).group_by(MoodEntry.mood).all())
+
+    reflection = db.query(
+        Reflection.mood_score,
+        Reflection.completed_tasks,
+        Reflection.total_tasks,
+        Reflection.distractions,
+    ).filter(
+        Reflection.user_id == user_id,
+        Reflection.date == day,
+    ).first()
+
+    tasks_completed, task_hours = db.query(
+        func.count(Task.id),
+        func.sum(Task.duration),
+    ).filter(
+        Task.user_id == user_id,
+        Task.completed == True,
+        Task.is_deleted == False,
+        Task.completed_at >= start,
+        Task.completed_at < end,
+    ).one()
+
+    stats.update(
+        mood_count=sum(mood_counts.values()),
+        mood_counts=mood_counts,
+        reflection_mood_score=reflection.mood_score if reflection else None,
+        reflection_completed_tasks=reflection.completed_tasks if reflection else None,
+        reflection_total_tasks=reflection.total_tasks if reflection else None,
+        reflection_distractions=list(reflection.distractions or []) if reflection else [],
+        tasks_completed=tasks_completed or 0,
+        completed_task_hours=float(task_hours or 0.0),
+    )
+
+    if not sessions_frozen:
+        focus_minutes, tracked_minutes = db.query(
+            func.sum(BrowsingSession.work_time),
+            func.sum(BrowsingSession.duration_minutes),
+        ).filter(
+            BrowsingSession.user_id == user_id,
+            BrowsingSession.timestamp >= start,
+            BrowsingSession.timestamp < end,
+        ).one()
+        stats.update(focus_minutes=int(focus_minutes or 0), tracked_minutes=int(tracked_minutes or 0))
+
+    if not (recommendations_frozen or sessions_frozen) and not (
+        stats["recommendation_count"] or mood_counts or reflection
+        or stats["tasks_completed"] or stats["tracked_minutes"]
+    ):
+        if rollup is not None:
+            db.delete(rollup)
+        return None
+
+    if rollup is None:
+        rollup = DailyUserRollup(user_id=user_id, day=day)
+        db.add(rollup)
+    for name, value in stats.items():
+        setattr(rollup, name, value)
+    rollup.refreshed_at = now
+    return rollup
+
+
+def refresh_dirty_days(db: Session, limit: Optional[int] = None) -> int:
+    """
+    Rebuild the oldest-marked dirty days and clear their marks, in one commit.
+
+    A mark is only cleared if it still holds the marked_at read here, so a
+    change that lands during the rebuild leaves its day dirty for next time.
+
+    Returns:
+        Number of days rebuilt
+    """
+    if limit is None:
+        limit = AIConfig.ROLLUP_REFRESH_BATCH_SIZE
+
+    marks = db.query(
+        RollupDirtyDay.user_id, RollupDirtyDay.day, RollupDirtyDay.marked_at
+    ).order_by(RollupDirtyDay.marked_at).limit(limit).all()
+    if not marks:
+        return 0
+
+    now = datetime.now(timezone.utc)
+    for user_id, day, marked_at in marks:
+        rebuild_rollup_day(db, user_id, day, now)
+        db.flush()
+        db.query(RollupDirtyDay).filter(
+            RollupDirtyDay.user_id == user_id,
+            RollupDirtyDay.day == day,
+            RollupDirtyDay.marked_at == marked_at,
+        ).delete(synchronize_session=False)
+    db.commit()
+    return len(marks)
+
+
+def count_dirty_days() -> int:
+    """Number of rollup days waiting for a rebuild."""
+    db = ReadSessionLocal()  # Read-only: don't hold the single writer
+    try:
+        return db.query(func.count()).select_from(RollupDirtyDay).scalar()
+    finally:
+        db.close()
+
+
+def refresh_rollups(limit: Optional[int] = None) -> int:
+    """
+    Background job: rebuild dirty rollup days until none are left.
+
+    Works in batches of ROLLUP_REFRESH_BATCH_SIZE days (one commit each),
+    stopping after `limit` days if given.
+
+    Returns:
+        Number of days rebuilt
+    """
+    refreshed = 0
+    db = SessionLocal()
+    try:
+        while limit is None or refreshed < limit:
+            batch = AIConfig.ROLLUP_REFRESH_BATCH_SIZE
+            if limit is not None:
+                batch = min(batch, limit - refreshed)
+            count = refresh_dirty_days(db, batch)
+            refreshed += count
+            if count < batch:
+                break
+    finally:
+        db.close()
+
+    if refreshed > 0:
+        print(f"[Background] Refreshed {refreshed} daily rollups")
+    return refreshed
+
+
+def backfill_rollups_if_empty() -> int:
+    """
+    Mark all history dirty when the rollup tables are empty (first start
+    after upgrading). The background job builds the rollups afterwards.
+
+    Returns:
+        Number of days marked
+    """
+    db = SessionLocal()
+    try:
+        if db.query(DailyUserRollup.id).first() is not None or db.query(RollupDirtyDay.user_id).first() is not None:
+            return 0
+        marked = mark_all_rollup_days(db)
+        db.commit()
+        if marked:
+            print(f"[Startup] Marked {marked} days for rollup backfill")
+        return marked
+    finally:
+        db.close()
+
+
+def load_rollups(db: Session, user_id: int, start: date, end: date) -> List[DailyUserRollup]:
+    """A user's rollup rows for start..end (inclusive), by day."""
+    return db.query(DailyUserRollup).filter(
+        DailyUserRollup.user_id == user_id,
+        DailyUserRollup.day >= start,
+        DailyUserRollup.day <= end,
+    ).order_by(DailyUserRollup.day).all()
+
+
+def count_pending_days(db: Session, user_id: int, start: date, end: date) -> int:
+    """Dirty days in start..end not rebuilt yet (the rollups may lag these)."""
+    return db.query(func.count()).select_from(RollupDirtyDay).filter(
+        RollupDirtyDay.user_id == user_id,
+        RollupDirtyDay.day >= start,
+        RollupDirtyDay.day <= end,
+    ).scalar()
@@ -15,7 +15,7 @@ from sqlalchemy.orm import sessionmaker
 # Add parent directory to path for imports
 sys.path.insert(0, os.path.dirname(os.path.dirname(__file__)))
 
-from models.base import Base, get_db
+from models.base import Base, get_db, get_read_db
 from main import app
 
 # Test database configuration (SQLite for isolation)
@@ -42,13 +42,18 @@ def override_get_db():
         db.close()
 
 
-# Apply dependency override
+# Apply dependency overrides (reads and writes share the test database)
 app.dependency_overrides[get_db] = override_get_db
+app.dependency_overrides[get_read_db] = override_get_db
 
 
 @pytest.fixture(scope="function")
 def db_session():
     """Create a fresh database for each test."""
+    from ai.user_context import user_context_cache
+    from core.user_cache import user_cache
+    user_context_cache.clear()
+    user_cache.clear()
     Base.metadata.create_all(bind=engine)
     db = TestingSessionLocal()
     try:
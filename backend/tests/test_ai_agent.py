@@ -15,6 +15,7 @@ from ai.agent import ScheduleAgent
 from ai.state import UserState
 from ai.actions import ActionType
 from ai.config import AIConfig
+from ai.reward_stats import RewardStats
 
 
 @pytest.fixture
@@ -162,12 +163,12 @@ class TestAgentPersistence:
     """Tests for save/load functionality."""
     
     def test_save_creates_file(self, test_agent, temp_model_dir, test_state):
-        """Test save creates agent file."""
+        """Test save creates agent file (binary by default)."""
         with patch.object(AIConfig, 'MODEL_DIRECTORY', str(temp_model_dir)):
             test_agent.recommend(test_state)
             test_agent.save()
             
-            filepath = temp_model_dir / f"agent_{test_agent.user_id}.json"
+            filepath = temp_model_dir / f"agent_{test_agent.user_id}.bin"
             assert filepath.exists()
     
     def test_save_creates_directory(self, test_agent, tmp_path, test_state):
@@ -204,7 +205,8 @@ class TestAgentPersistence:
     
     def test_save_json_keys_are_strings(self, test_agent, temp_model_dir, test_state):
         """Test saved JSON uses string keys (CRITICAL)."""
-        with patch.object(AIConfig, 'MODEL_DIRECTORY', str(temp_model_dir)):
+        with patch.object(AIConfig, 'MODEL_DIRECTORY', str(temp_model_dir)), \
+             patch.object(AIConfig, 'AGENT_STORAGE_FORMAT', 'json'):
             test_agent.update(test_state, ActionType.BREAK, 0.5)
             test_agent.save()
             
@@ -218,6 +220,144 @@ class TestAgentPersistence:
                 assert "|" in key  # Pipe-separated
 
 
+    def test_binary_round_trip(self, temp_model_dir, test_state):
+        """Test binary save/load restores tables and reward statistics exactly."""
+        with patch.object(AIConfig, 'MODEL_DIRECTORY', str(temp_model_dir)):
+            agent1 = ScheduleAgent(user_id=112)
+            agent1.update(test_state, ActionType.DEEP_FOCUS, 1.0)
+            agent1.update(test_state, ActionType.DEEP_FOCUS, 0.25)
+            agent1.save()
+            
+            agent2 = ScheduleAgent(user_id=112)
+            assert agent2.load() is True
+            assert agent2.q_table == agent1.q_table
+            assert agent2.visit_counts == agent1.visit_counts
+            state_key = next(iter(agent1.q_table))
+            action_key = ActionType.DEEP_FOCUS.value
+            assert agent2.reward_stats[state_key][action_key] == agent1.reward_stats[state_key][action_key]
+            assert agent2.total_recommendations == 2
+    
+    def test_truncated_binary_starts_fresh(self, temp_model_dir, test_state):
+        """Test a .bin cut short at any byte loads as a fresh agent instead of raising."""
+        with patch.object(AIConfig, 'MODEL_DIRECTORY', str(temp_model_dir)):
+            agent1 = ScheduleAgent(user_id=114)
+            agent1.update(test_state, ActionType.DEEP_FOCUS, 1.0)
+            agent1.save()
+            path = temp_model_dir / "agent_114.bin"
+            blob = path.read_bytes()
+
+            for length in range(len(blob)):
+                path.write_bytes(blob[:length])
+                agent2 = ScheduleAgent(user_id=114)
+                assert agent2.load() is False
+                assert agent2.q_table == {}
+
+    def test_load_legacy_json(self, temp_model_dir):
+        """Test agents saved as indented JSON by older versions still load."""
+        legacy = {
+            "user_id": 113,
+            "q_table": {"morning|monday|high|low": {"break": 0.9}},
+            "visit_counts": {"morning|monday|high|low": {"break": 4}},
+            "reward_history": {"morning|monday|high|low": {"break": [1.0, 0.8]}},
+            "epsilon": 0.2,
+            "total_recommendations": 4,
+        }
+        (temp_model_dir / "agent_113.json").write_text(json.dumps(legacy, indent=2))
+        
+        with patch.object(AIConfig, 'MODEL_DIRECTORY', str(temp_model_dir)), \
+             patch.object(AIConfig, 'REWARD_STATS_DECAY', 1.0):  # Plain mean/variance below
+            agent = ScheduleAgent(user_id=113)
+            assert agent.load() is True
+            assert agent.q_table["morning|monday|high|low"]["break"] == 0.9
+            assert agent.epsilon == 0.2
+            
+            # Raw reward lists are migrated into streaming statistics
+            stats = agent.reward_stats["morning|monday|high|low"]["break"]
+            assert stats.count == 2
+            assert stats.mean == pytest.approx(0.9)
+            assert stats.variance == pytest.approx(0.01)
+    
+    def test_persist_all_skips_clean_agents(self, temp_model_dir, test_state):
+        """Test persist_all only writes agents updated since their last save."""
+        ScheduleAgent.clear_cache()
+        
+        with patch.object(AIConfig, 'MODEL_DIRECTORY', str(temp_model_dir)):
+            changed = ScheduleAgent.get_instance(120)
+            ScheduleAgent.get_instance(121)  # Never updated
+            
+            changed.update(test_state, ActionType.BREAK, 0.5)
+            assert changed.is_dirty
+            assert ScheduleAgent.persist_all() == 1
+            assert not changed.is_dirty
+            assert not (temp_model_dir / "agent_121.bin").exists()
+            
+            # Nothing changed since the last persist
+            assert ScheduleAgent.persist_all() == 0
+        ScheduleAgent.clear_cache()
+
+
+class TestRewardStats:
+    """Tests for streaming reward statistics."""
+    
+    def test_matches_direct_computation(self):
+        """Test Welford updates match mean/variance over the full list."""
+        rewards = [1.0, -0.5, 0.25, 0.8, 0.0, 1.0]
+        stats = RewardStats.from_history(rewards)
+        
+        mean = sum(rewards) / len(rewards)
+        variance = sum((r - mean) ** 2 for r in rewards) / len(rewards)
+        assert stats.count == len(rewards)
+        assert stats.mean == pytest.approx(mean)
+        assert stats.variance == pytest.approx(variance)
+    
+    def test_single_sample_has_zero_variance(self):
+        """Test variance is 0 until two rewards are seen."""
+        stats = RewardStats()
+        stats.update(0.7)
+        assert stats.variance == 0.0
+    
+    def test_decay_forgets_old_rewards(self):
+        """Test decayed statistics follow recent rewards."""
+        stats = RewardStats()
+        for _ in range(50):
+            stats.update(-1.0, decay=0.8)
+        for _ in range(50):
+            stats.update(1.0, decay=0.8)
+        
+        assert stats.mean == pytest.approx(1.0, abs=1e-3)
+        assert stats.count == pytest.approx(5.0, abs=1e-3)  # 1 / (1 - 0.8)
+    
+    def test_default_decay_tracks_recent_rewards(self, test_agent, test_state):
+        """Test a long good run followed by noise lowers confidence (window-like forgetting)."""
+        from ai.state import StateSerializer
+        state_key = StateSerializer.to_key(test_state)
+        action = ActionType.DEEP_FOCUS
+
+        for _ in range(200):
+            test_agent.update(test_state, action, 1.0)
+        stats = test_agent.reward_stats[state_key][action.value]
+        assert stats.count == pytest.approx(1 / (1 - AIConfig.REWARD_STATS_DECAY), rel=1e-3)
+
+        steady = test_agent._calculate_confidence(state_key, action.value)
+        for reward in (1.0, -1.0) * 5:
+            test_agent.update(test_state, action, reward)
+        assert test_agent._calculate_confidence(state_key, action.value) < steady
+
+    def test_confidence_uses_running_variance(self, test_agent, test_state):
+        """Test inconsistent rewards lower confidence versus consistent ones."""
+        from ai.state import StateSerializer
+        state_key = StateSerializer.to_key(test_state)
+        
+        for reward in (1.0, 1.0, 1.0, 1.0):
+            test_agent.update(test_state, ActionType.DEEP_FOCUS, reward)
+        for reward in (1.0, -1.0, 1.0, -1.0):
+            test_agent.update(test_state, ActionType.BREAK, reward)
+        
+        steady = test_agent._calculate_confidence(state_key, ActionType.DEEP_FOCUS.value)
+        noisy = test_agent._calculate_confidence(state_key, ActionType.BREAK.value)
+        assert steady > noisy
+
+
 class TestAgentPhases:
     """Tests for learning phase detection."""
     
@@ -252,3 +392,110 @@ class TestAgentStats:
         assert "total_recommendations" in stats
         assert "current_epsilon" in stats
         assert "phase" in stats
+        assert "avg_reward" in stats
+
+
+class TestAgentConcurrency:
+    """Tests for the per-user registry and snapshot safety."""
+    
+    def test_concurrent_first_touch_loads_once(self, temp_model_dir):
+        """Test concurrent get_instance calls for one user coalesce into one load."""
+        ScheduleAgent.clear_cache()
+        load_calls = []
+        original_load = ScheduleAgent.load
+        
+        def slow_load(agent):
+            load_calls.append(agent.user_id)
+            threading.Event().wait(0.05)
+            return original_load(agent)
+        
+        with patch.object(AIConfig, 'MODEL_DIRECTORY', str(temp_model_dir)), \
+             patch.object(ScheduleAgent, 'load', slow_load):
+            results = []
+            threads = [
+                threading.Thread(target=lambda: results.append(ScheduleAgent.get_instance(444)))
+                for _ in range(8)
+            ]
+            for t in threads:
+                t.start()
+            for t in threads:
+                t.join()
+            
+            assert load_calls == [444]
+            assert len(results) == 8
+            assert all(agent is results[0] for agent in results)
+        ScheduleAgent.clear_cache()
+    
+    def test_slow_load_does_not_block_other_users(self, temp_model_dir):
+        """Test a user stuck in load() doesn't block lookups for another user."""
+        ScheduleAgent.clear_cache()
+        release = threading.Event()
+        original_load = ScheduleAgent.load
+        
+        def blocking_load(agent):
+            if agent.user_id == 333:
+                release.wait(5)
+            return original_load(agent)
+        
+        with patch.object(AIConfig, 'MODEL_DIRECTORY', str(temp_model_dir)), \
+             patch.object(ScheduleAgent, 'load', blocking_load):
+            slow = threading.Thread(target=ScheduleAgent.get_instance, args=(333,))
+            slow.start()
+            
+            other = ScheduleAgent.get_instance(334)
+            assert other.user_id == 334
+            assert slow.is_alive()
+            
+            release.set()
+            slow.join()
+        ScheduleAgent.clear_cache()
+    
+    def test_persist_during_updates(self, temp_model_dir, test_state):
+        """Test snapshots taken while updating always produce valid files."""
+        ScheduleAgent.clear_cache()
+        
+        with patch.object(AIConfig, 'MODEL_DIRECTORY', str(temp_model_dir)), \
+             patch.object(AIConfig, 'PERSIST_INTERVAL_SECONDS', 0):
+            agent = ScheduleAgent.get_instance(222)
+            
+            def train():
+                for _ in range(200):
+                    agent.update(test_state, ActionType.BREAK, 0.5)
+            
+            trainer = threading.Thread(target=train)
+            trainer.start()
+            for _ in range(20):
+                ScheduleAgent.persist_all()
+            trainer.join()
+            ScheduleAgent.persist_all()
+            
+            restored = ScheduleAgent(user_id=222)
+            assert restored.load() is True
+            assert restored.total_recommendations == 200
+        ScheduleAgent.clear_cache()
+
+    def test_concurrent_saves_do_not_collide(self, temp_model_dir, test_state):
+        """Test saves racing on one agent each use their own temp file."""
+        with patch.object(AIConfig, 'MODEL_DIRECTORY', str(temp_model_dir)):
+            agent = ScheduleAgent(user_id=223)
+            agent.update(test_state, ActionType.BREAK, 0.5)
+            errors = []
+
+            def save():
+                try:
+                    for _ in range(25):
+                        agent.save()
+                except Exception as e:
+                    errors.append(e)
+
+            savers = [threading.Thread(target=save) for _ in range(4)]
+            for saver in savers:
+                saver.start()
+            for saver in savers:
+                saver.join()
+
+            assert errors == []
+            assert sorted(os.listdir(temp_model_dir)) == ["agent_223.bin"]
+            restored = ScheduleAgent(user_id=223)
+            assert restored.load() is True
+            assert restored.total_recommendations == 1
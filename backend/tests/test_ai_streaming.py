@@ -0,0 +1,120 @@
+"""
+Streaming AI Route Tests
+Tests the SSE schedule and breakdown routes against the tuned SQLite
+engines (one writer connection plus a read-only pool), as in production.
+"""
+
+import json
+
+import pytest
+from fastapi.testclient import TestClient
+
+from main import app
+from models import base
+from models.base import Base, get_db, get_read_db
+from models.schedule import ScheduleBlock
+from models.task import Task
+from routers import ai_router
+
+
+def _events(response):
+    """Parse an SSE body into [(event, data)]."""
+    events = []
+    for raw in response.text.strip().split("\n\n"):
+        lines = dict(line.split(": ", 1) for line in raw.splitlines())
+        events.append((lines["event"], json.loads(lines["data"])))
+    return events
+
+
+@pytest.fixture
+def tuned_client(tmp_path, monkeypatch):
+    """TestClient whose sessions use tuned writer/reader engines on a temp file."""
+    from ai.user_context import user_context_cache
+    from core.user_cache import user_cache
+
+    writer, reader = base.create_sqlite_engines(f"sqlite:///{tmp_path / 'tuned.db'}", tuned=True)
+    assert writer is not reader
+    Base.metadata.create_all(bind=writer)
+    WriterSession = base.sessionmaker(autocommit=False, autoflush=False, bind=writer)
+    ReaderSession = base.sessionmaker(autocommit=False, autoflush=False, bind=reader)
+
+    def tuned_db():
+        db = WriterSession()
+        try:
+            yield db
+        finally:
+            db.close()
+
+    def tuned_read_db():
+        db = ReaderSession()
+        try:
+            yield db
+        finally:
+            db.close()
+
+    user_context_cache.clear()
+    user_cache.clear()
+    monkeypatch.setitem(app.dependency_overrides, get_db, tuned_db)
+    monkeypatch.setitem(app.dependency_overrides, get_read_db, tuned_read_db)
+    monkeypatch.setattr(ai_router, "SessionLocal", WriterSession)
+
+    with TestClient(app) as client:
+        response = client.post("/auth/signup", json={
+            "email": "stream@example.com", "username": "stream", "password": "secret123"
+        })
+        client.headers["Authorization"] = f"Bearer {response.json()['access_token']}"
+        yield client, WriterSession
+
+    writer.dispose()
+    reader.dispose()
+
+
+class TestStreamingWithTunedEngines:
+    """The request session must not hold the writer while the stream saves."""
+
+    def test_schedule_stream_saves_blocks(self, tuned_client):
+        """Test streamed blocks are committed (no pool timeout on the writer)."""
+        client, WriterSession = tuned_client
+        for title in ("Write report", "Review notes"):
+            assert client.post("/tasks", json={"title": title, "duration": 1.0}).status_code == 201
+
+        events = _events(client.post("/ai/generate-schedule/stream"))
+
+        kinds = [kind for kind, _ in events]
+        assert "error" not in kinds
+        assert kinds[0] == "start" and kinds[-1] == "done"
+        saved_ids = [i for kind, data in events if kind == "saved" for i in data["ids"].values()]
+        assert saved_ids
+
+        db = WriterSession()
+        try:
+            assert db.query(ScheduleBlock).filter(ScheduleBlock.id.in_(saved_ids)).count() == len(saved_ids)
+        finally:
+            db.close()
+
+    def test_breakdown_stream_saves_subtasks(self, tuned_client):
+        """Test streamed subtasks are committed under the parent task."""
+        client, WriterSession = tuned_client
+        task_id = client.post("/tasks", json={"title": "Plan launch", "duration": 3.0}).json()["id"]
+
+        events = _events(client.post(f"/ai/breakdown-task/{task_id}/stream"))
+
+        kinds = [kind for kind, _ in events]
+        assert "error" not in kinds
+        assert "saved" in kinds and kinds[-1] == "done"
+
+        db = WriterSession()
+        try:
+            assert db.query(Task).filter(Task.parent_id == task_id).count() == kinds.count("subtask")
+        finally:
+            db.close()
+
+    def test_writes_proceed_during_non_streaming_generation(self, tuned_client):
+        """Test the non-streaming routes save through the writer after the LLM call."""
+        client, _ = tuned_client
+        client.post("/tasks", json={"title": "Write report", "duration": 1.0})
+
+        response = client.post("/ai/generate-schedule")
+
+        assert response.status_code == 200
+        assert all(block["id"] is not None for block in response.json()["blocks"])
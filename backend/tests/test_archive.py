@@ -0,0 +1,143 @@
+"""
+Cold Storage Archive Tests
+Tests for moving old rows out of the hot tables and reading them back.
+"""
+
+from datetime import date, datetime, timezone
+
+import pytest
+
+from models.daily_rollup import DailyUserRollup
+from models.extension_metadata import BrowsingSession
+from models.mood import MoodEntry
+from models.recommendation_log import RecommendationLog
+from ai.config import AIConfig
+from tasks import archive as archive_module
+from tasks.archive import ColdArchive, archive_config_error, archive_old_rows, archive_table
+from tasks.rollups import refresh_dirty_days
+
+CUTOFF = datetime(2025, 2, 1, tzinfo=timezone.utc)
+
+
+def _log(hour, day=10, month=1, outcome="completed", reward=1.0):
+    return RecommendationLog(
+        user_id=1, timestamp=datetime(2025, month, day, hour), state_key="morning|monday|high|low",
+        state_snapshot={"state_key": "morning|monday|high|low"}, action_type="DEEP_FOCUS",
+        strategy_used="rule", confidence=0.8, outcome=outcome, reward=reward,
+        outcome_recorded_at=datetime(2025, month, day, hour + 1) if outcome else None,
+    )
+
+
+def _session(session_id, day=10, month=1, work_time=40):
+    return BrowsingSession(
+        session_id=session_id, user_id=1, timestamp=datetime(2025, month, day, 9),
+        hour_key=f"2025-{month:02d}-{day:02d}T09", duration_minutes=60, work_time=work_time,
+    )
+
+
+@pytest.fixture
+def archive(tmp_path):
+    return ColdArchive(str(tmp_path / "archive"))
+
+
+class TestArchiveTable:
+    """Tests for archiving recommendation logs and browsing sessions."""
+
+    def test_moves_only_resolved_old_logs(self, db_session, archive):
+        """Test pending and recent logs stay in the hot table."""
+        db_session.add_all([
+            _log(9), _log(10, outcome=None, reward=None), _log(9, day=5, month=2),
+        ])
+        db_session.commit()
+
+        assert archive_table(db_session, archive, "recommendation_logs", CUTOFF) == 1
+
+        remaining = db_session.query(RecommendationLog).order_by(RecommendationLog.timestamp).all()
+        assert [(log.outcome, log.timestamp.month) for log in remaining] == [(None, 1), ("completed", 2)]
+        assert archive.months("recommendation_logs") == ["2025-01"]
+
+        (row,) = archive.iter_rows("recommendation_logs")
+        assert row["timestamp"] == datetime(2025, 1, 10, 9, tzinfo=timezone.utc)
+        assert row["state_snapshot"] == {"state_key": "morning|monday|high|low"}
+        assert row["reward"] == 1.0
+
+    def test_reads_filter_by_range_and_drop_duplicates(self, db_session, archive):
+        """Test a batch archived twice (crash before delete) is read once."""
+        db_session.add_all([_session("a", day=10), _session("b", day=20)])
+        db_session.commit()
+        rows = db_session.execute(BrowsingSession.__table__.select()).all()
+        columns = [column.name for column in BrowsingSession.__table__.columns]
+        archive.write_part("browsing_sessions", "2025-01", columns, rows)
+
+        archive_table(db_session, archive, "browsing_sessions", CUTOFF)
+
+        assert [row["session_id"] for row in archive.iter_rows("browsing_sessions")] == ["a", "b"]
+        later = archive.iter_rows("browsing_sessions", start=datetime(2025, 1, 15, tzinfo=timezone.utc))
+        assert [row["session_id"] for row in later] == ["b"]
+        assert db_session.query(BrowsingSession).count() == 0
+
+    def test_rollups_keep_archived_figures(self, db_session, archive):
+        """Test a day rebuilt after archival still reports its archived rows."""
+        from models.user import User
+
+        db_session.add(User(id=1, username="archived"))
+        db_session.add_all([_log(9), _session("a")])
+        db_session.commit()
+        refresh_dirty_days(db_session)
+
+        archive_table(db_session, archive, "recommendation_logs", CUTOFF)
+        archive_table(db_session, archive, "browsing_sessions", CUTOFF)
+
+        # A later write on the same day triggers a rebuild
+        db_session.add(MoodEntry(user_id=1, mood="calm", timestamp=datetime(2025, 1, 10, 12)))
+        db_session.commit()
+        refresh_dirty_days(db_session)
+
+        rollup = db_session.query(DailyUserRollup).filter(DailyUserRollup.day == date(2025, 1, 10)).one()
+        assert rollup.recommendation_count == 1
+        assert rollup.focus_minutes == 40
+        assert rollup.mood_counts == {"calm": 1}
+        assert rollup.recommendations_archived and rollup.sessions_archived
+
+
+class TestArchiveConfig:
+    """Tests that the job never deletes rows without a durable archive."""
+
+    def test_disabled_by_default(self, monkeypatch):
+        """Test the default retention archives nothing."""
+        monkeypatch.setattr(AIConfig, "RECOMMENDATION_LOG_RETENTION_DAYS", 0)
+        monkeypatch.setattr(AIConfig, "BROWSING_SESSION_RETENTION_DAYS", 0)
+        assert archive_old_rows() == 0
+
+    def test_refuses_unset_or_relative_directory(self, db_session, monkeypatch):
+        """Test retention alone doesn't delete rows into an ephemeral directory."""
+        db_session.add(_log(9))
+        db_session.commit()
+        monkeypatch.setattr(AIConfig, "RECOMMENDATION_LOG_RETENTION_DAYS", 1)
+
+        monkeypatch.setattr(AIConfig, "ARCHIVE_DIRECTORY", "")
+        assert archive_config_error() is not None
+        with pytest.raises(ValueError):
+            ColdArchive()
+        assert archive_old_rows() == 0
+
+        assert "absolute" in archive_config_error("data/archive")
+        assert archive_old_rows(ColdArchive("data/archive")) == 0
+        assert db_session.query(RecommendationLog).count() == 1
+
+    def test_backlog_count_uses_read_session(self, db_session, tmp_path, monkeypatch):
+        """Test count_archivable_rows doesn't take the writer connection."""
+        from tests.conftest import TestingSessionLocal
+
+        def no_writer():
+            raise AssertionError("count_archivable_rows opened a writer session")
+
+        monkeypatch.setattr(archive_module, "SessionLocal", no_writer)
+        monkeypatch.setattr(archive_module, "ReadSessionLocal", TestingSessionLocal)
+        monkeypatch.setattr(AIConfig, "ARCHIVE_DIRECTORY", str(tmp_path / "archive"))
+        monkeypatch.setattr(AIConfig, "RECOMMENDATION_LOG_RETENTION_DAYS", 1)
+        monkeypatch.setattr(AIConfig, "BROWSING_SESSION_RETENTION_DAYS", 0)
+        db_session.add(_log(9))
+        db_session.commit()
+
+        assert archive_module.count_archivable_rows() == 1
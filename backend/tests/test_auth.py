@@ -0,0 +1,128 @@
+"""
+Authentication Tests
+Tests for the cached get_current_user path and token version revocation.
+"""
+
+import pytest
+from unittest.mock import patch
+
+from sqlalchemy import event
+
+from core.user_cache import user_cache
+
+
+def _signup(client, email="ada@example.com", username="ada"):
+    response = client.post("/auth/signup", json={
+        "email": email, "username": username, "password": "secret123"
+    })
+    assert response.status_code == 201
+    return response.json()["access_token"]
+
+
+def _me(client, token):
+    return client.get("/auth/me", headers={"Authorization": f"Bearer {token}"})
+
+
+@pytest.fixture
+def user_queries(db_session):
+    """Count SELECTs against the users table."""
+    statements = []
+
+    def _count(conn, cursor, statement, *args):
+        if statement.lstrip().upper().startswith("SELECT") and "FROM users" in statement:
+            statements.append(statement)
+
+    engine = db_session.get_bind()
+    event.listen(engine, "before_cursor_execute", _count)
+    yield statements
+    event.remove(engine, "before_cursor_execute", _count)
+
+
+class TestUserCache:
+    """Tests for serving authentication from the cache."""
+
+    def test_repeat_requests_skip_user_query(self, client, user_queries):
+        """Test only the first authenticated request loads the user."""
+        token = _signup(client)
+        user_queries.clear()
+
+        for _ in range(3):
+            assert _me(client, token).status_code == 200
+        assert len(user_queries) == 1
+        assert user_cache.get_stats()["hits"] >= 2
+
+    def test_claims_only_mode_skips_database(self, client, user_queries):
+        """Test trusting claims authenticates without any user query."""
+        token = _signup(client)
+        user_cache.clear()
+        user_queries.clear()
+
+        with patch("core.auth.AUTH_TRUST_TOKEN_CLAIMS", True):
+            response = _me(client, token)
+
+        assert response.status_code == 200
+        assert response.json()["username"] == "ada"
+        assert user_queries == []
+
+
+class TestTokenRevocation:
+    """Tests for token version invalidation."""
+
+    def test_password_change_revokes_tokens(self, client, db_session):
+        """Test a password change rejects tokens issued before it."""
+        from models.user import User
+
+        token = _signup(client)
+        assert _me(client, token).status_code == 200
+
+        user = db_session.query(User).filter(User.username == "ada").first()
+        user.password_hash = "changed"
+        db_session.commit()
+
+        assert user.token_version == 1
+        assert _me(client, token).status_code == 401
+        with patch("core.auth.AUTH_TRUST_TOKEN_CLAIMS", True):
+            assert _me(client, token).status_code == 401
+
+    def test_deactivation_revokes_tokens(self, client, db_session):
+        """Test deactivating an account rejects its tokens."""
+        from models.user import User
+
+        token = _signup(client)
+        user = db_session.query(User).filter(User.username == "ada").first()
+        user.is_active = False
+        db_session.commit()
+
+        assert _me(client, token).status_code == 401
+
+    def test_rolled_back_password_change_keeps_tokens(self, client, db_session):
+        """Test a flushed but rolled-back change neither revokes nor evicts."""
+        from models.user import User
+
+        token = _signup(client)
+        assert _me(client, token).status_code == 200
+        user = db_session.query(User).filter(User.username == "ada").first()
+        user_id = user.id
+
+        user.password_hash = "changed"
+        db_session.flush()
+        assert user_cache.min_version(user_id) == 0
+        assert user_cache.get(user_id) is not None  # Still cached until commit
+        db_session.rollback()
+
+        assert user_cache.min_version(user_id) == 0
+        assert _me(client, token).status_code == 200
+
+    def test_other_updates_keep_tokens(self, client, db_session):
+        """Test unrelated profile changes don't revoke tokens."""
+        from models.user import User
+
+        token = _signup(client)
+        user = db_session.query(User).filter(User.username == "ada").first()
+        user.username = "ada_l"
+        db_session.commit()
+
+        assert user.token_version == 0
+        response = _me(client, token)
+        assert response.status_code == 200
+        assert response.json()["username"] == "ada_l"
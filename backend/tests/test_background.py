@@ -0,0 +1,179 @@
+"""
+Background Task Tests
+Tests for the asyncio scheduler that runs periodic jobs in a thread pool.
+"""
+
+import asyncio
+import threading
+import time
+from datetime import datetime, timedelta, timezone
+import pytest
+
+from tasks.background import BackgroundTaskRunner
+
+
+class TestBackgroundTaskRunner:
+    """Tests for scheduling, backpressure and statistics."""
+
+    def test_job_runs_off_event_loop(self):
+        """Test jobs execute in a worker thread and record their result."""
+        loop_thread = []
+        job_thread = []
+
+        async def scenario():
+            loop_thread.append(threading.get_ident())
+            runner = BackgroundTaskRunner()
+            runner.add_job(
+                "work", lambda: job_thread.append(threading.get_ident()) or 7,
+                interval_seconds=0.01, jitter_fraction=0.0, backlog=lambda: 3,
+            )
+            await runner.start()
+            await asyncio.sleep(0.1)
+            await runner.stop()
+            return runner.get_stats()["jobs"]["work"]
+
+        stats = asyncio.run(scenario())
+        assert stats["runs"] >= 1
+        assert stats["last_result"] == 7
+        assert stats["backlog"] == 3
+        assert stats["last_duration_seconds"] is not None
+        assert job_thread and loop_thread[0] not in job_thread
+
+    def test_overlapping_ticks_are_skipped(self):
+        """Test a slow job is never run concurrently with itself."""
+        active = []
+        max_active = []
+
+        def slow_job():
+            active.append(1)
+            max_active.append(len(active))
+            time.sleep(0.15)
+            active.pop()
+
+        async def scenario():
+            runner = BackgroundTaskRunner()
+            runner.add_job("slow", slow_job, interval_seconds=0.02, jitter_fraction=0.0)
+            await runner.start()
+            await asyncio.sleep(0.2)
+            await runner.stop()
+            return runner.get_stats()["jobs"]["slow"]
+
+        stats = asyncio.run(scenario())
+        assert max(max_active) == 1
+        assert stats["skipped"] >= 1
+
+    def test_job_errors_are_recorded(self):
+        """Test a failing job doesn't stop the scheduler."""
+        def broken():
+            raise RuntimeError("boom")
+
+        async def scenario():
+            runner = BackgroundTaskRunner()
+            runner.add_job("broken", broken, interval_seconds=0.01, jitter_fraction=0.0)
+            await runner.start()
+            await asyncio.sleep(0.1)
+            running = runner.is_running
+            await runner.stop()
+            return running, runner.get_stats()["jobs"]["broken"]
+
+        running, stats = asyncio.run(scenario())
+        assert running
+        assert stats["errors"] >= 1
+        assert "boom" in stats["last_error"]
+
+    def test_run_now(self):
+        """Test a job can be triggered on demand."""
+        async def scenario():
+            runner = BackgroundTaskRunner()
+            runner.add_job("once", lambda: 42, interval_seconds=3600)
+            await runner.start()
+            result = await runner.run_now("once")
+            await runner.stop()
+            return result
+
+        assert asyncio.run(scenario()) == 42
+
+    def test_run_once_job_fires_once(self):
+        """Test a run_once job runs a single time after its delay."""
+        async def scenario():
+            runner = BackgroundTaskRunner()
+            runner.add_job("warm", lambda: 1, interval_seconds=0.01, jitter_fraction=0.0, run_once=True)
+            runner.add_job("periodic", lambda: 2, interval_seconds=0.01, jitter_fraction=0.0)
+            await runner.start()
+            await asyncio.sleep(0.1)
+            running = runner.is_running
+            await runner.stop()
+            return running, runner.get_stats()["jobs"]
+
+        running, jobs = asyncio.run(scenario())
+        assert running  # Periodic jobs keep going after the one-off finishes
+        assert jobs["warm"]["runs"] == 1
+        assert jobs["warm"]["run_once"] is True
+        assert jobs["periodic"]["runs"] > 1
+
+
+class TestAgentWarmup:
+    """Tests for preloading recently active users' agents."""
+
+    def _log(self, user_id, timestamp):
+        from models.recommendation_log import RecommendationLog
+        return RecommendationLog(
+            user_id=user_id, timestamp=timestamp, state_key="morning|monday|high|low",
+            state_snapshot={"state_key": "morning|monday|high|low"}, action_type="DEEP_FOCUS",
+            strategy_used="rule", confidence=0.8,
+        )
+
+    def test_loads_recent_users_most_recent_first(self, db_session, tmp_path, monkeypatch):
+        """Test only users active in the window are loaded, newest first, up to the cap."""
+        from ai.agent import ScheduleAgent
+        from ai.config import AIConfig
+        from tasks import background
+        from tests.conftest import TestingSessionLocal
+
+        monkeypatch.setattr(AIConfig, "MODEL_DIRECTORY", str(tmp_path))
+        monkeypatch.setattr(background, "ReadSessionLocal", TestingSessionLocal)
+        now = datetime.now(timezone.utc).replace(tzinfo=None)
+        db_session.add_all([
+            self._log(1, now - timedelta(hours=5)),
+            self._log(2, now - timedelta(hours=1)),
+            self._log(2, now - timedelta(days=2)),
+            self._log(3, now - timedelta(days=10)),  # Outside the window
+            self._log(4, now - timedelta(hours=3)),
+        ])
+        db_session.commit()
+        ScheduleAgent.clear_cache()
+
+        assert background.warm_recent_agents(recent_days=3, max_users=2) == 2
+        assert ScheduleAgent.is_cached(2) and ScheduleAgent.is_cached(4)
+        assert not ScheduleAgent.is_cached(1)
+        assert not ScheduleAgent.is_cached(3)
+
+        # Already-cached agents aren't counted again
+        assert background.warm_recent_agents(recent_days=3, max_users=10) == 1
+        assert ScheduleAgent.is_cached(1)
+        ScheduleAgent.clear_cache()
+
+
+def _no_writer():
+    raise AssertionError("read-only backlog count opened a writer session")
+
+
+class TestBacklogCounts:
+    """Tests that /health backlog counts stay off the writer connection."""
+
+    def test_pending_outcomes_use_read_session(self, db_session, monkeypatch):
+        """Test count_pending_outcomes reads through ReadSessionLocal."""
+        from models.recommendation_log import RecommendationLog
+        from tasks import background
+        from tests.conftest import TestingSessionLocal
+
+        monkeypatch.setattr(background, "SessionLocal", _no_writer)
+        monkeypatch.setattr(background, "ReadSessionLocal", TestingSessionLocal)
+        db_session.add(RecommendationLog(
+            user_id=1, timestamp=datetime.now(timezone.utc) - timedelta(hours=5),
+            state_key="morning|monday|high|low", action_type="DEEP_FOCUS",
+            strategy_used="rule", confidence=0.8,
+        ))
+        db_session.commit()
+
+        assert background.count_pending_outcomes() == 1
@@ -0,0 +1,187 @@
+"""
+DQN Inference Server Tests
+Tests for micro-batching, per-row masking, failure paths and histograms.
+"""
+
+import threading
+import time
+from concurrent.futures import TimeoutError as FutureTimeoutError
+
+import pytest
+
+np = pytest.importorskip("numpy")
+
+from ai.dqn_inference import DQNInferenceServer
+from tests.test_dqn_weights import make_weights
+
+
+class CountingAgent:
+    """DQNWeights wrapper recording each batched forward pass."""
+
+    def __init__(self, delay: float = 0.0):
+        self.weights = make_weights()
+        self.action_dim = self.weights.action_dim
+        self.epsilon = 0.0
+        self.delay = delay
+        self.calls = []  # One (states, masks) pair per forward pass
+        self.release = threading.Event()
+
+    def select_actions_batch(self, states, masks, epsilons):
+        self.calls.append((states.copy(), masks.copy()))
+        if self.delay:
+            self.release.wait(self.delay)
+        return self.weights.select_actions_batch(states, masks, epsilons)
+
+
+def _states(n, seed=0):
+    return np.random.default_rng(seed).random((n, 12), dtype=np.float32)
+
+
+@pytest.fixture
+def agent():
+    return CountingAgent()
+
+
+@pytest.fixture
+def make_server():
+    servers = []
+
+    def factory(agent, **kwargs):
+        server = DQNInferenceServer(lambda user_id: agent, **kwargs)
+        servers.append(server)
+        return server
+
+    yield factory
+    for server in servers:
+        server.stop()
+
+
+class TestBatching:
+    """Tests that queued requests share one forward pass."""
+
+    def test_window_coalesces_requests(self, agent, make_server):
+        """Test N requests submitted within the window run as one batch."""
+        server = make_server(agent, window_ms=200, max_batch_size=64)
+        futures = [server.submit(user_id, state) for user_id, state in enumerate(_states(5))]
+
+        results = [future.result(timeout=2) for future in futures]
+
+        assert len(agent.calls) == 1
+        assert agent.calls[0][0].shape == (5, 12)
+        assert [r.batch_size for r in results] == [5] * 5
+
+    def test_full_batch_flushes_before_window(self, agent, make_server):
+        """Test max_batch_size requests are served without waiting out the window."""
+        server = make_server(agent, window_ms=10_000, max_batch_size=4)
+        started = time.perf_counter()
+        futures = [server.submit(0, state) for state in _states(4)]
+
+        for future in futures:
+            assert future.result(timeout=2).batch_size == 4
+        assert time.perf_counter() - started < 5
+        assert len(agent.calls) == 1
+
+    def test_results_match_direct_selection(self, agent, make_server):
+        """Test each caller gets its own row of the batched answer."""
+        server = make_server(agent, window_ms=200)
+        states = _states(3, seed=1)
+        futures = [server.submit(0, state, epsilon=0.0) for state in states]
+
+        expected = agent.weights.get_q_values_batch(states)
+        for row, future in enumerate(futures):
+            result = future.result(timeout=2)
+            np.testing.assert_allclose(result.q_values, expected[row], rtol=1e-5)
+            assert result.action == int(np.argmax(expected[row]))
+
+
+class TestMasking:
+    """Tests that each row keeps its own available actions."""
+
+    def test_per_row_masks(self, agent, make_server):
+        """Test rows with different available_actions get different masks."""
+        server = make_server(agent, window_ms=200)
+        allowed = [[2], [5, 7], None]
+        futures = [
+            server.submit(0, state, available_actions=actions, epsilon=0.0)
+            for state, actions in zip(_states(3), allowed)
+        ]
+
+        results = [future.result(timeout=2) for future in futures]
+
+        masks = agent.calls[0][1]
+        assert list(np.flatnonzero(masks[0])) == [2]
+        assert list(np.flatnonzero(masks[1])) == [5, 7]
+        assert masks[2].all()
+        assert results[0].action == 2
+        assert results[1].action in (5, 7)
+
+
+class TestFailures:
+    """Tests that callers aren't left waiting forever."""
+
+    def test_select_action_times_out(self, make_server):
+        """Test a slow forward pass raises TimeoutError to the caller."""
+        slow = CountingAgent(delay=5.0)
+        server = make_server(slow, window_ms=0)
+
+        with pytest.raises((TimeoutError, FutureTimeoutError)):
+            server.select_action(0, _states(1)[0], timeout=0.05)
+        slow.release.set()
+
+    def test_stop_fails_queued_requests(self, make_server):
+        """Test requests still queued at stop() fail with RuntimeError."""
+        slow = CountingAgent(delay=5.0)
+        server = make_server(slow, window_ms=0, max_batch_size=1)
+        in_flight = server.submit(0, _states(1)[0])
+        while not slow.calls:
+            time.sleep(0.001)  # Worker is now busy with the first request
+        queued = [server.submit(0, state) for state in _states(3)]
+
+        stopper = threading.Thread(target=server.stop, kwargs={"timeout": 2})
+        stopper.start()
+        while server.get_stats()["running"]:
+            time.sleep(0.001)
+        slow.release.set()  # Worker finishes its batch, then sees the stop
+        stopper.join()
+
+        assert in_flight.result(timeout=2).batch_size == 1
+        for future in queued:
+            with pytest.raises(RuntimeError, match="stopped"):
+                future.result(timeout=2)
+        assert len(slow.calls) == 1
+
+    def test_resolver_error_reaches_caller(self, make_server):
+        """Test a user without weights fails only their own request."""
+        agent = CountingAgent()
+
+        def resolver(user_id):
+            if user_id == 99:
+                raise KeyError("no weights for user 99")
+            return agent
+
+        server = DQNInferenceServer(resolver, window_ms=200)
+        try:
+            good = server.submit(1, _states(1)[0])
+            bad = server.submit(99, _states(1)[0])
+            assert good.result(timeout=2).batch_size == 1
+            with pytest.raises(KeyError):
+                bad.result(timeout=2)
+        finally:
+            server.stop()
+
+
+class TestHistograms:
+    """Tests for the tuning metrics."""
+
+    def test_server_records_batches_and_latency(self, agent, make_server):
+        """Test one batch is recorded once, and each request's latency once."""
+        server = make_server(agent, window_ms=200)
+        for future in [server.submit(0, state) for state in _states(3)]:
+            future.result(timeout=2)
+
+        stats = server.get_stats()
+        assert stats["batch_size"]["count"] == 1
+        assert stats["batch_size"]["buckets"]["4"] == 1  # 3 requests -> <= 4 bucket
+        assert stats["forward_latency_ms"]["count"] == 1
+        assert stats["queue_latency_ms"]["count"] == 3
+        assert stats["pending"] == 0
@@ -0,0 +1,240 @@
+"""
+DQN Trainer Tests
+Tests for tailing labelled recommendations and stacked multi-user training.
+"""
+
+from datetime import datetime, timedelta
+
+import pytest
+
+np = pytest.importorskip("numpy")
+
+from ai.dqn_trainer import DQNTrainer, ACTION_INDEX
+from ai.dqn_weights import DQNWeightRegistry
+
+
+USER_ID = 3
+
+
+@pytest.fixture
+def now():
+    """Naive UTC reference time (matches what SQLite hands back)."""
+    return datetime.utcnow().replace(minute=0, second=0, microsecond=0)
+
+
+@pytest.fixture
+def trainer(tmp_path):
+    """Trainer writing into a temp directory."""
+    registry = DQNWeightRegistry(directory=str(tmp_path / "serving"))
+    return DQNTrainer(registry=registry, checkpoint_directory=str(tmp_path / "models"))
+
+
+def add_session(db, user_id, timestamp, work_time=40):
+    from models.extension_metadata import BrowsingSession
+
+    db.add(BrowsingSession(
+        session_id=f"s-{user_id}-{timestamp.isoformat()}",
+        user_id=user_id,
+        timestamp=timestamp,
+        hour_key=timestamp.strftime("%Y-%m-%dT%H"),
+        work_time=work_time,
+        leisure_time=60 - work_time,
+        tab_switches=10,
+    ))
+
+
+def add_log(db, user_id, timestamp, outcome_at, action="DEEP_FOCUS", outcome="completed", reward=1.0):
+    from models.recommendation_log import RecommendationLog
+
+    log = RecommendationLog(
+        user_id=user_id,
+        timestamp=timestamp,
+        state_key="morning|monday|high|low",
+        action_type=action,
+        strategy_used="rule",
+        outcome=outcome,
+        reward=reward,
+        outcome_recorded_at=outcome_at,
+    )
+    db.add(log)
+    return log
+
+
+class TestIngest:
+    """Tests for turning RecommendationLog rows into transitions."""
+
+    def test_builds_transitions_from_sessions(self, db_session, trainer, now):
+        """Test state/next-state come from the sessions around the log."""
+        add_session(db_session, USER_ID, now - timedelta(hours=2), work_time=50)
+        add_session(db_session, USER_ID, now - timedelta(hours=1), work_time=10)
+        add_log(db_session, USER_ID, now - timedelta(hours=2) + timedelta(minutes=5),
+                now - timedelta(minutes=50), action="BREAK", reward=0.5)
+        db_session.commit()
+
+        assert trainer.ingest(db_session) == 1
+        buffer = trainer.buffers[USER_ID]
+        assert len(buffer) == 1
+        assert buffer.actions[0] == ACTION_INDEX["BREAK"]
+        assert buffer.rewards[0] == pytest.approx(0.5)
+        assert buffer.dones[0] == 0.0
+        assert not np.allclose(buffer.states[0], buffer.next_states[0])
+
+    def test_skips_logs_without_browsing_context(self, db_session, trainer, now):
+        """Test recommendations far from any session are dropped."""
+        add_session(db_session, USER_ID, now - timedelta(days=1))
+        add_log(db_session, USER_ID, now - timedelta(hours=1), now)
+        db_session.commit()
+
+        assert trainer.ingest(db_session) == 0
+        assert USER_ID not in trainer.buffers
+
+    def test_tailing_reads_each_log_once(self, db_session, trainer, now):
+        """Test a second ingest only picks up newly labelled logs."""
+        add_session(db_session, USER_ID, now - timedelta(hours=3))
+        add_log(db_session, USER_ID, now - timedelta(hours=3), now - timedelta(hours=2))
+        db_session.commit()
+        assert trainer.ingest(db_session) == 1
+        assert trainer.ingest(db_session) == 0
+
+        add_log(db_session, USER_ID, now - timedelta(hours=3), now - timedelta(hours=1),
+                outcome="skipped", reward=None)
+        db_session.commit()
+        assert trainer.ingest(db_session) == 1
+        # Implicit outcomes get a reward from RewardCalculator
+        assert trainer.buffers[USER_ID].rewards[1] < 0
+
+    def test_ingests_cold_storage(self, db_session, trainer, now, tmp_path):
+        """Test archived logs and sessions build the same transitions."""
+        from datetime import timezone
+        from tasks.archive import ColdArchive, archive_table
+
+        add_session(db_session, USER_ID, now - timedelta(hours=2), work_time=50)
+        add_session(db_session, USER_ID, now - timedelta(hours=1), work_time=10)
+        add_log(db_session, USER_ID, now - timedelta(hours=2) + timedelta(minutes=5),
+                now - timedelta(minutes=50), action="BREAK", reward=0.5)
+        db_session.commit()
+
+        archive = ColdArchive(str(tmp_path / "archive"))
+        cutoff = (now + timedelta(hours=1)).replace(tzinfo=timezone.utc)
+        archive_table(db_session, archive, "recommendation_logs", cutoff)
+        archive_table(db_session, archive, "browsing_sessions", cutoff)
+        assert trainer.ingest(db_session) == 0  # Nothing left in the hot tables
+
+        assert trainer.ingest_archive(archive) == 1
+        buffer = trainer.buffers[USER_ID]
+        assert buffer.actions[0] == ACTION_INDEX["BREAK"]
+        assert buffer.dones[0] == 0.0
+
+
+class TestStackedTraining:
+    """Tests for batched multi-user training (requires PyTorch)."""
+
+    def test_stacked_forward_matches_networks(self):
+        """Test the stacked model reproduces each user's network."""
+        torch = pytest.importorskip("torch")
+        from ai.dqn_agent import DQNNetwork, StackedDQN
+
+        networks = [DQNNetwork() for _ in range(3)]
+        stacked = StackedDQN(networks)
+        states = torch.rand(3, 5, 12)
+        with torch.no_grad():
+            expected = torch.stack([net(states[i]) for i, net in enumerate(networks)])
+            assert torch.allclose(stacked(states), expected, atol=1e-5)
+
+    def test_train_round_publishes_weights(self, db_session, trainer, now):
+        """Test trained users get a checkpoint and serving weights."""
+        pytest.importorskip("torch")
+        for hour in range(6):
+            add_session(db_session, USER_ID, now - timedelta(hours=6 - hour))
+            add_log(db_session, USER_ID, now - timedelta(hours=6 - hour),
+                    now - timedelta(hours=5 - hour, minutes=30))
+        db_session.commit()
+        trainer.ingest(db_session)
+
+        losses = trainer.train_round(steps=3, batch_size=4, min_transitions=4)
+
+        assert set(losses) == {USER_ID}
+        weights = trainer.registry.get(USER_ID)
+        assert weights is not None and weights.training_step == 3
+        assert weights.get_q_values(np.zeros(12)).shape == (10,)
+
+    def test_target_sync_follows_each_users_step_count(self, trainer, monkeypatch):
+        """Test the target network syncs on the agent's own schedule, not the round's."""
+        torch = pytest.importorskip("torch")
+        from ai.dqn_agent import DQNAgent
+        from ai.replay_buffer import ReplayBuffer
+
+        agents = {1: DQNAgent(state_dim=12), 2: DQNAgent(state_dim=12)}
+        agents[1].training_step = agents[1].target_update_freq - 1  # Due on its next step
+        rng = np.random.default_rng(0)
+        for user_id in agents:
+            buffer = ReplayBuffer(capacity=16, state_dim=12)
+            buffer.push_batch(rng.random((8, 12)), rng.integers(0, 10, 8), rng.random(8),
+                              rng.random((8, 12)), np.zeros(8))
+            trainer.buffers[user_id] = buffer
+        monkeypatch.setattr(trainer, "_load_agent", lambda user_id: agents[user_id])
+
+        trainer._train_users([1, 2], steps=1, batch_size=4)
+
+        def same(a, b):
+            return all(torch.equal(x, y) for x, y in zip(a.parameters(), b.parameters()))
+
+        assert same(agents[1].target_net, agents[1].policy_net)
+        assert not same(agents[2].target_net, agents[2].policy_net)
+        assert agents[1].training_step == agents[1].target_update_freq
+
+    def test_stacked_adam_matches_per_agent_adam(self):
+        """Test stacked updates equal each agent's own Adam, at different step counts."""
+        torch = pytest.importorskip("torch")
+        import copy
+        from ai.dqn_agent import DQNAgent, StackedAdam, StackedDQN
+
+        states = torch.rand(2, 4, 12)
+        agents = [DQNAgent(state_dim=12), DQNAgent(state_dim=12)]
+        for _ in range(3):  # Give the first agent a head start
+            agents[0].optimizer.zero_grad()
+            agents[0].policy_net(states[0]).pow(2).mean().backward()
+            agents[0].optimizer.step()
+        reference = copy.deepcopy(agents)
+
+        for agent, user_states in zip(reference, states):
+            for _ in range(2):
+                agent.optimizer.zero_grad()
+                agent.policy_net(user_states).pow(2).mean().backward()
+                agent.optimizer.step()
+
+        policy = StackedDQN([agent.policy_net for agent in agents])
+        optimizer = StackedAdam(policy, agents)
+        for _ in range(2):
+            optimizer.zero_grad()
+            policy(states).pow(2).mean(dim=(1, 2)).sum().backward()
+            optimizer.step()
+        policy.copy_to([agent.policy_net for agent in agents])
+        optimizer.copy_to(agents)
+
+        for agent, expected in zip(agents, reference):
+            for param, expected_param in zip(agent.policy_net.parameters(), expected.policy_net.parameters()):
+                assert torch.allclose(param, expected_param, atol=1e-6)
+                assert float(agent.optimizer.state[param]["step"]) == float(
+                    expected.optimizer.state[expected_param]["step"]
+                )
+
+    def test_idle_users_are_not_retrained(self, db_session, trainer, now):
+        """Test a round without new transitions trains nobody, and Adam state is saved."""
+        pytest.importorskip("torch")
+        from ai.dqn_agent import DQNAgent
+
+        for hour in range(6):
+            add_session(db_session, USER_ID, now - timedelta(hours=6 - hour))
+            add_log(db_session, USER_ID, now - timedelta(hours=6 - hour),
+                    now - timedelta(hours=5 - hour, minutes=30))
+        db_session.commit()
+        trainer.ingest(db_session)
+
+        assert set(trainer.train_round(steps=3, batch_size=4, min_transitions=4)) == {USER_ID}
+        assert trainer.train_round(steps=3, batch_size=4, min_transitions=4) == {}
+
+        agent = DQNAgent(state_dim=12)
+        agent.load(trainer.checkpoint_path(USER_ID))
+        assert agent.training_step == 3
+        assert float(agent.optimizer.state[agent.policy_net.fc1.weight]["step"]) == 3
@@ -0,0 +1,131 @@
+"""
+DQN Serving Weights Tests
+Tests for the NumPy serving export and the per-user weight registry.
+"""
+
+import os
+
+import pytest
+
+np = pytest.importorskip("numpy")
+
+from ai.dqn_weights import DQNWeights, DQNWeightRegistry, SERVING_FORMAT_VERSION
+
+
+def make_weights(state_dim=12, hidden_dim=64, action_dim=10, seed=0, training_step=0):
+    """Random weights with DQNNetwork's shapes."""
+    rng = np.random.default_rng(seed)
+    state_dict = {
+        "fc1.weight": rng.normal(size=(hidden_dim, state_dim)),
+        "fc1.bias": rng.normal(size=hidden_dim),
+        "fc2.weight": rng.normal(size=(hidden_dim, hidden_dim)),
+        "fc2.bias": rng.normal(size=hidden_dim),
+        "fc3.weight": rng.normal(size=(action_dim, hidden_dim)),
+        "fc3.bias": rng.normal(size=action_dim),
+    }
+    return DQNWeights.from_state_dict(state_dict, epsilon=0.0, training_step=training_step)
+
+
+class TestDQNWeights:
+    """Tests for NumPy inference and the on-disk format."""
+
+    def test_forward_pass_matches_reference(self):
+        """Test the MLP applies ReLU between layers."""
+        ident = np.eye(2)
+        weights = DQNWeights.from_state_dict({
+            "fc1.weight": ident, "fc1.bias": np.array([0.0, -1.0]),
+            "fc2.weight": ident, "fc2.bias": np.zeros(2),
+            "fc3.weight": np.array([[1.0, 1.0]]), "fc3.bias": np.array([0.5]),
+        })
+        # [2, 0.5] -> relu([2, -0.5]) = [2, 0] -> [2, 0] -> 2.5
+        assert weights.get_q_values(np.array([2.0, 0.5])) == pytest.approx([2.5])
+        assert weights.state_dim == 2 and weights.action_dim == 1
+
+    def test_batch_matches_single(self):
+        """Test batched Q-values equal per-state evaluation."""
+        weights = make_weights()
+        states = np.random.default_rng(1).random((5, 12))
+        batch = weights.get_q_values_batch(states)
+        assert batch.shape == (5, 10)
+        for i in range(5):
+            np.testing.assert_allclose(batch[i], weights.get_q_values(states[i]), rtol=1e-5)
+
+    def test_select_actions_respects_mask(self):
+        """Test greedy selection only picks allowed actions."""
+        weights = make_weights()
+        states = np.random.default_rng(2).random((4, 12))
+        mask = np.zeros((4, 10), dtype=bool)
+        mask[:, 3] = True
+        actions, q_values = weights.select_actions_batch(states, mask, np.zeros(4))
+        assert list(actions) == [3, 3, 3, 3]
+        assert weights.select_action(states[0], available_actions=[7], epsilon=0.0) == 7
+
+    def test_save_load_round_trip_mmap(self, tmp_path):
+        """Test weights reload memory-mapped with identical outputs."""
+        weights = make_weights(training_step=42)
+        prefix = str(tmp_path / "user_1.dqn")
+        weights.save(prefix)
+
+        loaded = DQNWeights.load(prefix)
+        assert isinstance(loaded._flat, np.memmap)
+        assert loaded.training_step == 42
+        states = np.random.default_rng(3).random((3, 12))
+        np.testing.assert_allclose(
+            loaded.get_q_values_batch(states), weights.get_q_values_batch(states), rtol=1e-6
+        )
+        assert not any(name.endswith(".tmp") for name in os.listdir(tmp_path))
+
+    def test_load_rejects_unknown_format(self, tmp_path):
+        """Test a manifest from a newer serving format is refused."""
+        prefix = str(tmp_path / "user_1.dqn")
+        make_weights().save(prefix)
+        with open(f"{prefix}.json", "w") as f:
+            f.write(f'{{"format_version": {SERVING_FORMAT_VERSION + 1}}}')
+        with pytest.raises(ValueError):
+            DQNWeights.load(prefix)
+
+    def test_matches_torch_network(self):
+        """Test exported weights reproduce DQNAgent Q-values."""
+        pytest.importorskip("torch")
+        from ai.dqn_agent import DQNAgent
+
+        agent = DQNAgent(state_dim=12, action_dim=10)
+        states = np.random.default_rng(4).random((6, 12)).astype(np.float32)
+        np.testing.assert_allclose(
+            agent.export_weights().get_q_values_batch(states),
+            agent.get_q_values_batch(states),
+            rtol=1e-4, atol=1e-5
+        )
+
+
+class TestDQNWeightRegistry:
+    """Tests for per-user lookup, caching and reloads."""
+
+    def test_missing_user_returns_none(self, tmp_path):
+        """Test users without an export have no model."""
+        registry = DQNWeightRegistry(directory=str(tmp_path))
+        assert registry.get(1) is None
+        with pytest.raises(KeyError):
+            registry.require(1)
+
+    def test_get_caches_until_republished(self, tmp_path):
+        """Test repeated gets hit the cache and a re-export is picked up."""
+        registry = DQNWeightRegistry(directory=str(tmp_path))
+        registry.publish(1, make_weights(training_step=1))
+
+        first = registry.get(1)
+        assert registry.get(1) is first
+        assert registry.get_stats()["loads"] == 1
+
+        registry.publish(1, make_weights(seed=5, training_step=2))
+        assert registry.get(1).training_step == 2
+        assert registry.get_stats()["loads"] == 2
+
+    def test_lru_bounds_open_models(self, tmp_path):
+        """Test the least recently used model is closed past the limit."""
+        registry = DQNWeightRegistry(directory=str(tmp_path), max_models=2)
+        for user_id in (1, 2, 3):
+            registry.publish(user_id, make_weights(seed=user_id))
+            registry.get(user_id)
+        assert registry.get_stats()["open_models"] == 2
+        assert 1 not in registry._models
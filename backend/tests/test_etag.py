@@ -0,0 +1,53 @@
+"""
+ETag Tests
+Tests for conditional GET responses on JSON endpoints.
+"""
+
+from core.etag import etag_matches, make_etag
+
+
+class TestETagMatching:
+    """Tests for If-None-Match comparison."""
+
+    def test_weak_and_listed_tags_match(self):
+        """Test weak comparison, tag lists and the wildcard."""
+        etag = make_etag(b"[]")
+        assert etag_matches(etag, etag)
+        assert etag_matches(etag[2:], etag)  # Strong form of the same tag
+        assert etag_matches(f'"other", {etag}', etag)
+        assert etag_matches("*", etag)
+        assert not etag_matches('"other"', etag)
+
+
+class TestConditionalGet:
+    """Tests for 304 responses on unchanged lists."""
+
+    def _headers(self, client):
+        response = client.post("/auth/signup", json={
+            "email": "etag@example.com", "username": "etag", "password": "secret123"
+        })
+        return {"Authorization": f"Bearer {response.json()['access_token']}"}
+
+    def test_unchanged_list_returns_304(self, client):
+        """Test a repeat GET with the ETag gets 304 until the list changes."""
+        headers = self._headers(client)
+        first = client.get("/tasks", headers=headers)
+        etag = first.headers["etag"]
+        assert first.status_code == 200
+
+        repeat = client.get("/tasks", headers={**headers, "If-None-Match": etag})
+        assert repeat.status_code == 304
+        assert repeat.content == b""
+        assert repeat.headers["etag"] == etag
+
+        client.post("/tasks", json={"title": "New task", "duration": 1.0}, headers=headers)
+        changed = client.get("/tasks", headers={**headers, "If-None-Match": etag})
+        assert changed.status_code == 200
+        assert changed.headers["etag"] != etag
+        assert len(changed.json()) == 1
+
+    def test_writes_are_not_tagged(self, client):
+        """Test non-GET responses pass through without an ETag."""
+        headers = self._headers(client)
+        response = client.post("/tasks", json={"title": "Task", "duration": 1.0}, headers=headers)
+        assert "etag" not in response.headers
@@ -0,0 +1,182 @@
+"""
+Tests for browser extension API routes.
+"""
+
+import gzip
+import json
+
+import pytest
+from fastapi import status
+
+
+def _make_session(session_id: str, hour: int = 14) -> dict:
+    """Build a synced session payload as sent by the extension."""
+    return {
+        "session_id": session_id,
+        "timestamp": f"2025-01-15T{hour:02d}:00:00+00:00",
+        "hour_key": f"2025-01-15T{hour:02d}",
+        "duration_minutes": 60,
+        "category_distribution": {"work": 30, "leisure": 10, "social": 5, "neutral": 15},
+        "metrics": {
+            "tab_switches": 12,
+            "window_focus_changes": 4,
+            "avg_focus_duration_minutes": 6.5,
+            "distraction_rate_per_hour": 12.0,
+            "unique_domains": 7,
+        },
+        "event_count": 42,
+    }
+
+
+def _make_batch(session_ids, start_ms: int = 1736949600000) -> dict:
+    """Build a columnar protocol 2 batch with hourly, delta-encoded timestamps."""
+    n = len(session_ids)
+    return {
+        "v": 2,
+        "n": n,
+        "columns": {
+            "session_id": list(session_ids),
+            "timestamp": [start_ms] + [3600000] * (n - 1) if n else [],
+            "hour_key": [f"2025-01-15T{9 + i:02d}" for i in range(n)],
+            "duration_minutes": [60] * n,
+            "work": [30] * n,
+            "leisure": [10] * n,
+            "social": [5] * n,
+            "neutral": [15] * n,
+            "tab_switches": [12] * n,
+            "window_focus_changes": [4] * n,
+            "avg_focus_duration_minutes": [6.5] * n,
+            "distraction_rate_per_hour": [12.0] * n,
+            "unique_domains": [7] * n,
+            "event_count": [42] * n,
+        },
+    }
+
+
+def _post_batch(client, batch: dict, compress: bool = True):
+    body = json.dumps(batch).encode()
+    headers = {"Content-Type": "application/json"}
+    if compress:
+        body = gzip.compress(body)
+        headers["Content-Encoding"] = "gzip"
+    return client.post("/api/v1/extension/sync/batch", content=body, headers=headers)
+
+
+class TestExtensionSync:
+    """Test cases for the bulk session sync endpoint."""
+
+    def test_sync_inserts_sessions(self, client):
+        """Test syncing new sessions inserts all of them."""
+        payload = {
+            "sessions": [_make_session("s-1", 9), _make_session("s-2", 10)],
+            "timestamp": 1736949600000,
+        }
+        response = client.post("/api/v1/extension/sync", json=payload)
+        assert response.status_code == status.HTTP_200_OK
+
+        data = response.json()
+        assert data["success"] is True
+        assert data["synced_count"] == 2
+        assert data["duplicate_count"] == 0
+
+    def test_sync_skips_existing_sessions(self, client):
+        """Test re-syncing already stored sessions reports them as duplicates."""
+        first = {"sessions": [_make_session("s-1", 9)], "timestamp": 1}
+        client.post("/api/v1/extension/sync", json=first)
+
+        second = {
+            "sessions": [_make_session("s-1", 9), _make_session("s-3", 11)],
+            "timestamp": 2,
+        }
+        response = client.post("/api/v1/extension/sync", json=second)
+        assert response.status_code == status.HTTP_200_OK
+
+        data = response.json()
+        assert data["synced_count"] == 1
+        assert data["duplicate_count"] == 1
+
+    def test_sync_deduplicates_within_payload(self, client):
+        """Test the same session_id twice in one payload is inserted once."""
+        payload = {
+            "sessions": [_make_session("s-dup", 9), _make_session("s-dup", 9)],
+            "timestamp": 1,
+        }
+        response = client.post("/api/v1/extension/sync", json=payload)
+        assert response.status_code == status.HTTP_200_OK
+
+        data = response.json()
+        assert data["synced_count"] == 1
+        assert data["duplicate_count"] == 1
+
+        recent = client.get("/api/v1/extension/sessions/recent").json()
+        assert [s["session_id"] for s in recent].count("s-dup") == 1
+
+    def test_sync_empty_payload(self, client):
+        """Test syncing an empty batch succeeds with nothing stored."""
+        response = client.post("/api/v1/extension/sync", json={"sessions": [], "timestamp": 1})
+        assert response.status_code == status.HTTP_200_OK
+        assert response.json()["synced_count"] == 0
+
+
+class TestExtensionBatchSync:
+    """Test cases for the columnar (protocol 2) batch sync endpoint."""
+
+    def test_version_advertises_protocols(self, client):
+        """Test /version lists the supported sync protocols."""
+        data = client.get("/api/v1/extension/version").json()
+        assert 2 in data["sync_protocols"]
+        assert data["max_batch_sessions"] > 0
+
+    def test_gzip_batch_inserts_sessions(self, client):
+        """Test a gzip-encoded batch is decoded and stored."""
+        response = _post_batch(client, _make_batch(["b-1", "b-2", "b-3"]))
+        assert response.status_code == status.HTTP_200_OK
+
+        data = response.json()
+        assert data["synced_count"] == 3
+        assert data["duplicate_count"] == 0
+        assert data["cursor"] == {"timestamp": 1736949600000 + 2 * 3600000, "session_id": "b-3"}
+
+        recent = client.get("/api/v1/extension/sessions/recent").json()
+        by_id = {s["session_id"]: s for s in recent}
+        assert by_id["b-2"]["hour_key"] == "2025-01-15T10"
+        assert by_id["b-2"]["timestamp"].startswith("2025-01-15T15:00:00")
+
+    def test_uncompressed_batch_and_duplicates(self, client):
+        """Test identity-encoded batches work and re-sent rows count as duplicates."""
+        _post_batch(client, _make_batch(["b-1"]), compress=False)
+
+        data = _post_batch(client, _make_batch(["b-1", "b-2", "b-2"]), compress=False).json()
+        assert data["synced_count"] == 1
+        assert data["duplicate_count"] == 2
+
+    def test_rejects_mismatched_columns(self, client):
+        """Test a column shorter than n is a 400, not a partial insert."""
+        batch = _make_batch(["b-1", "b-2"])
+        batch["columns"]["work"] = [30]
+        assert _post_batch(client, batch).status_code == status.HTTP_400_BAD_REQUEST
+
+    def test_rejects_unknown_version_and_oversized_batches(self, client):
+        """Test protocol version and batch size limits."""
+        from routers.extension_router import SYNC_MAX_BATCH_SESSIONS
+
+        batch = _make_batch(["b-1"])
+        batch["v"] = 3
+        assert _post_batch(client, batch).status_code == status.HTTP_400_BAD_REQUEST
+
+        batch = _make_batch([f"b-{i}" for i in range(SYNC_MAX_BATCH_SESSIONS + 1)])
+        assert _post_batch(client, batch).status_code == status.HTTP_400_BAD_REQUEST
+
+    def test_rejects_bad_encoding(self, client):
+        """Test corrupt gzip and unknown encodings are refused."""
+        response = client.post(
+            "/api/v1/extension/sync/batch", content=b"not gzip",
+            headers={"Content-Encoding": "gzip"}
+        )
+        assert response.status_code == status.HTTP_400_BAD_REQUEST
+
+        response = client.post(
+            "/api/v1/extension/sync/batch", content=b"{}",
+            headers={"Content-Encoding": "br"}
+        )
+        assert response.status_code == status.HTTP_415_UNSUPPORTED_MEDIA_TYPE
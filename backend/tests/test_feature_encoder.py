@@ -0,0 +1,97 @@
+"""
+Feature Encoder Tests
+Tests that the columnar encoding paths match encode_session.
+"""
+
+from datetime import datetime, timedelta, timezone
+
+import pytest
+
+np = pytest.importorskip("numpy")
+
+from ai.feature_encoder import FeatureEncoder
+
+
+def make_sessions(n=200, seed=0):
+    """Random session dicts covering every hour, weekday and edge case."""
+    rng = np.random.default_rng(seed)
+    start = datetime(2025, 1, 6, tzinfo=timezone.utc)  # A Monday
+    sessions = []
+    for i in range(n):
+        work, leisure, social, neutral = rng.integers(0, 60, size=4).tolist()
+        if i % 17 == 0:
+            work = leisure = social = neutral = 0  # Empty hour (work_ratio = 0)
+        sessions.append({
+            "timestamp": start + timedelta(hours=i * 5),
+            "duration_minutes": int(rng.integers(1, 240)),
+            "category_distribution": {"work": work, "leisure": leisure, "social": social, "neutral": neutral},
+            "metrics": {
+                "tab_switches": int(rng.integers(0, 120)),
+                "avg_focus_duration_minutes": float(rng.uniform(0, 60)),
+                "distraction_rate_per_hour": float(rng.uniform(0, 100)),
+                "unique_domains": int(rng.integers(0, 40)),
+            },
+        })
+    return sessions
+
+
+def as_row(session):
+    """Session dict as a SESSION_COLUMNS tuple."""
+    categories, metrics = session["category_distribution"], session["metrics"]
+    return (
+        session["timestamp"], categories["work"], categories["leisure"], categories["social"],
+        categories["neutral"], metrics["avg_focus_duration_minutes"], metrics["distraction_rate_per_hour"],
+        metrics["tab_switches"], metrics["unique_domains"], session["duration_minutes"],
+    )
+
+
+class TestColumnarEncoding:
+    """Tests for encode_batch / encode_columns / encode_session_rows."""
+
+    def test_encode_batch_matches_encode_session(self):
+        """Test the vectorized batch equals row-by-row encoding."""
+        encoder = FeatureEncoder()
+        sessions = make_sessions()
+        expected = np.stack([encoder.encode_session(s) for s in sessions])
+
+        batch = encoder.encode_batch(sessions)
+
+        assert batch.shape == (len(sessions), 12)
+        assert batch.dtype == np.float32
+        np.testing.assert_allclose(batch, expected, rtol=0, atol=1e-7)
+
+    def test_session_rows_match_encode_session(self):
+        """Test SQL-style column tuples encode the same as dicts."""
+        encoder = FeatureEncoder()
+        sessions = make_sessions(seed=1)
+        expected = np.stack([encoder.encode_session(s) for s in sessions])
+
+        np.testing.assert_allclose(
+            encoder.encode_session_rows([as_row(s) for s in sessions]), expected, rtol=0, atol=1e-7
+        )
+
+    def test_datetime64_timestamps(self):
+        """Test vectorized timestamp splitting matches datetime attributes."""
+        encoder = FeatureEncoder()
+        stamps = [datetime(2025, 3, 1) + timedelta(hours=7 * i) for i in range(50)]
+        hour, day_of_week = encoder.timestamp_columns(np.array(stamps, dtype="datetime64[s]"))
+        assert hour.tolist() == [t.hour for t in stamps]
+        assert day_of_week.tolist() == [t.weekday() for t in stamps]
+
+    def test_fills_preallocated_output(self):
+        """Test encode_columns writes into a caller-provided matrix."""
+        encoder = FeatureEncoder()
+        out = np.full((2, 12), -1.0, dtype=np.float32)
+        ones = np.ones(2)
+        result = encoder.encode_columns(
+            np.array([10, 22]), np.array([0, 6]), ones, ones, ones, ones,
+            ones, ones, ones, ones, np.array([60, np.nan]), out=out
+        )
+        assert result is out
+        assert out[0, 10] == 1.0 and out[1, 10] == 0.0  # Working hours
+        assert out[0, 9] == 1.0 and out[1, 9] == 0.0    # Weekday
+        assert out[1, 6] == out[0, 6]                   # NULL duration counts as 60
+
+    def test_empty_rows(self):
+        """Test no rows gives an empty (0, 12) matrix."""
+        assert FeatureEncoder().encode_session_rows([]).shape == (0, 12)
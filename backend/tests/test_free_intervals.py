@@ -0,0 +1,113 @@
+"""
+Free Interval Index Tests
+Tests for the gap index shared by the fallback scheduler and available-slots.
+"""
+
+import pytest
+from unittest.mock import patch
+
+from ai.config import AIConfig
+from ai.free_intervals import FreeIntervalIndex
+from ai.llm_service import LLMService
+
+
+class TestFreeIntervalIndex:
+    """Tests for building, querying and allocating gaps."""
+
+    def test_gaps_from_overlapping_busy(self):
+        """Test overlapping and out-of-range busy intervals are handled."""
+        free = FreeIntervalIndex(9.0, 20.0, [(8.0, 9.5), (12.0, 13.0), (12.5, 14.0), (19.0, 22.0)])
+        assert free.gaps() == [(9.5, 12.0), (14.0, 19.0)]
+        assert free.gaps(min_duration=3.0) == [(14.0, 19.0)]
+        assert free.total_free == pytest.approx(7.5)
+
+    def test_first_fit_returns_to_earlier_gaps(self):
+        """Test a short task can use a gap before an earlier allocation."""
+        free = FreeIntervalIndex(9.0, 20.0, [(10.0, 11.0)])
+        assert free.first_fit(3.0) == 11.0
+        free.allocate(11.0, 3.0)
+        assert free.first_fit(0.5) == 9.0
+
+    def test_best_fit_picks_tightest_gap(self):
+        """Test best-fit prefers the smallest gap that holds the task."""
+        free = FreeIntervalIndex(9.0, 20.0, [(10.0, 12.0), (12.75, 13.0)])
+        assert free.best_fit(0.5) == 12.0
+        assert free.best_fit(1.0) == 9.0
+        assert free.best_fit(5.0) == 13.0
+        assert free.best_fit(8.0) is None
+
+    def test_not_before_restricts_start(self):
+        """Test queries respect the earliest acceptable start."""
+        free = FreeIntervalIndex(9.0, 20.0, [(10.0, 12.0)])
+        assert free.first_fit(1.0, not_before=9.5) == 12.0
+        assert free.best_fit(0.5, not_before=9.25) == 9.25
+
+    def test_allocate_splits_gap(self):
+        """Test allocation leaves the remainders on both sides."""
+        free = FreeIntervalIndex(9.0, 20.0)
+        free.allocate(12.0, 1.5)
+        assert free.gaps() == [(9.0, 12.0), (13.5, 20.0)]
+        assert free.is_free(9.0, 3.0)
+        assert not free.is_free(11.0, 1.5)
+
+    def test_allocate_taken_time_raises(self):
+        """Test double-booking is rejected."""
+        free = FreeIntervalIndex(9.0, 20.0, [(10.0, 11.0)])
+        with pytest.raises(ValueError):
+            free.allocate(9.5, 1.0)
+
+    def test_week_long_range(self):
+        """Test ranges spanning several days pack without overlap."""
+        busy = [(day * 24 + 12.0, day * 24 + 13.0) for day in range(7)]
+        free = FreeIntervalIndex(0.0, 7 * 24.0, busy)
+        placed = []
+        for _ in range(50):
+            start = free.best_fit(2.0)
+            free.allocate(start, 2.0)
+            placed.append((start, start + 2.0))
+        placed.sort()
+        assert all(a[1] <= b[0] for a, b in zip(placed, placed[1:]))
+        assert all(not (s < b_end and e > b_start) for s, e in placed for b_start, b_end in busy)
+
+
+class TestFallbackPacking:
+    """Tests for the rule-based scheduler's use of the index."""
+
+    def test_short_task_fills_earlier_gap(self):
+        """Test a gap skipped by a long task is used by a later short one."""
+        service = LLMService()
+        tasks = [
+            {"id": 1, "title": "Deep work", "priority": 5, "duration": 3.0},
+            {"id": 2, "title": "Email", "priority": 1, "duration": 0.5},
+        ]
+        fixed = [{"start": 10.0, "duration": 1.0}, {"start": 14.0, "duration": 6.0}]
+
+        blocks = service._fallback_schedule(tasks, fixed, {"current_hour": 9}, (9.0, 20.0))
+        starts = {b.task_id: b.start_hour for b in blocks if b.task_id}
+
+        assert starts[1] == 11.0
+        assert starts[2] == 9.0
+        assert [b.start_hour for b in blocks] == sorted(b.start_hour for b in blocks)
+
+    def test_default_keeps_high_load_in_morning_peak(self):
+        """Test the default strategy still puts a hard task in the earliest gap, not the tightest."""
+        service = LLMService()
+        tasks = [{"id": 1, "title": "Deep work", "priority": 5, "duration": 2.0}]
+        fixed = [{"start": 13.0, "duration": 1.0}, {"start": 16.5, "duration": 3.5}]
+
+        blocks = service._fallback_schedule(tasks, fixed, {"current_hour": 9}, (9.0, 20.0))
+
+        assert [b.start_hour for b in blocks if b.task_id] == [9.0]
+
+    def test_default_packs_light_task_into_tightest_gap(self):
+        """Test a light task takes the tightest gap, keeping the long one free."""
+        service = LLMService()
+        tasks = [{"id": 1, "title": "Email", "priority": 1, "duration": 1.0}]
+        fixed = [{"start": 11.0, "duration": 2.0}, {"start": 14.0, "duration": 6.0}]
+
+        blocks = service._fallback_schedule(tasks, fixed, {"current_hour": 9}, (9.0, 20.0))
+        assert [b.start_hour for b in blocks if b.task_id] == [13.0]
+
+        with patch.object(AIConfig, 'FALLBACK_SLOT_STRATEGY', "first_fit"):
+            blocks = service._fallback_schedule(tasks, fixed, {"current_hour": 9}, (9.0, 20.0))
+        assert [b.start_hour for b in blocks if b.task_id] == [9.0]
@@ -0,0 +1,125 @@
+"""
+Implicit Feedback Tests
+Tests for keyset-paginated, streaming outcome inference.
+"""
+
+import pytest
+from datetime import datetime, timedelta, timezone
+
+from sqlalchemy import event
+
+from ai.implicit_feedback import ImplicitFeedbackInferencer
+
+
+def _make_log(user_id, timestamp, **fields):
+    """Create a pending recommendation log."""
+    from models.recommendation_log import RecommendationLog
+
+    return RecommendationLog(
+        user_id=user_id,
+        timestamp=timestamp,
+        state_key="morning|monday|high|low",
+        action_type="break",
+        confidence=0.5,
+        strategy_used="rule",
+        **fields,
+    )
+
+
+@pytest.fixture
+def old_time():
+    """A time well past the inference age cutoff."""
+    return datetime.now(timezone.utc) - timedelta(days=1)
+
+
+@pytest.fixture
+def backlog(db_session, old_time):
+    """Create 25 old pending logs across three users (some sharing timestamps)."""
+    logs = [
+        _make_log(1 + i % 3, old_time + timedelta(minutes=i // 2))
+        for i in range(25)
+    ]
+    db_session.add_all(logs)
+    db_session.commit()
+    return db_session
+
+
+def _pending(db):
+    from models.recommendation_log import RecommendationLog
+    return db.query(RecommendationLog).filter(RecommendationLog.outcome == None).count()
+
+
+class TestStreamInferOutcomes:
+    """Tests for streaming inference."""
+
+    def test_drains_backlog_across_pages(self, backlog):
+        """Test every pending log is processed even with small pages."""
+        processed = ImplicitFeedbackInferencer().stream_infer_outcomes(backlog, page_size=4)
+        assert processed == 25
+        assert _pending(backlog) == 0
+
+    def test_commits_once_per_page(self, backlog):
+        """Test writes are committed in page-sized chunks."""
+        commits = []
+
+        def _on_commit(session):
+            commits.append(session)
+
+        event.listen(backlog, "after_commit", _on_commit)
+        try:
+            ImplicitFeedbackInferencer().stream_infer_outcomes(backlog, page_size=10)
+        finally:
+            event.remove(backlog, "after_commit", _on_commit)
+        assert len(commits) == 3
+
+    def test_max_logs_caps_work(self, backlog):
+        """Test max_logs processes exactly that many logs."""
+        processed = ImplicitFeedbackInferencer().stream_infer_outcomes(
+            backlog, page_size=4, max_logs=6
+        )
+        assert processed == 6
+        assert _pending(backlog) == 19
+
+    def test_partitions_are_disjoint_and_complete(self, backlog):
+        """Test user partitions together cover the backlog exactly once."""
+        inferencer = ImplicitFeedbackInferencer()
+        counts = [
+            inferencer.stream_infer_outcomes(backlog, page_size=5, partition=(index, 2))
+            for index in range(2)
+        ]
+        assert sum(counts) == 25
+        assert _pending(backlog) == 0
+
+    def test_successor_backfills_skip_detection(self, db_session, old_time):
+        """Test a quick follow-up recommendation marks the earlier one skipped."""
+        first = _make_log(5, old_time)
+        db_session.add_all([first, _make_log(5, old_time + timedelta(minutes=2))])
+        db_session.commit()
+
+        ImplicitFeedbackInferencer().stream_infer_outcomes(db_session)
+        db_session.refresh(first)
+        assert first.outcome == "skipped"
+        assert first.activity_gap_seconds == 120
+
+    def test_successor_is_users_next_log(self, db_session, old_time):
+        """Test each log gets its own user's nearest later log, or none."""
+        logs = [
+            _make_log(5, old_time),
+            _make_log(6, old_time + timedelta(minutes=1)),
+            _make_log(5, old_time + timedelta(minutes=3)),
+            _make_log(5, old_time + timedelta(minutes=9)),
+        ]
+        db_session.add_all(logs)
+        db_session.commit()
+
+        successors = ImplicitFeedbackInferencer()._prefetch_successor_times(db_session, logs)
+
+        assert successors == {
+            logs[0].id: logs[2].timestamp,
+            logs[2].id: logs[3].timestamp,
+        }
+
+    def test_batch_infer_respects_limit(self, backlog):
+        """Test the bounded batch API still honours its limit."""
+        assert ImplicitFeedbackInferencer().batch_infer_outcomes(backlog, limit=10) == 10
+        assert _pending(backlog) == 15
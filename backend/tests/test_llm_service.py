@@ -0,0 +1,251 @@
+"""
+LLM Service Tests
+Tests for the cached, deduplicated and time-limited LLM call layer.
+"""
+
+import asyncio
+import json
+import threading
+import time
+import pytest
+from unittest.mock import patch
+
+from ai.config import AIConfig
+from ai.json_stream import JSONArrayStreamParser
+from ai.llm_cache import LLMResponseCache, make_cache_key
+from ai.llm_service import LLMService
+
+
+SCHEDULE_JSON = json.dumps({
+    "schedule": [
+        {"task_id": 1, "title": "Write report", "start_hour": 9.0, "duration_hours": 1.5}
+    ]
+})
+
+TASKS = [{"id": 1, "title": "Write report", "priority": 5, "duration": 1.5}]
+CONTEXT = {"current_hour": 9, "energy_level": "high", "mood": "focused"}
+
+
+class _Response:
+    def __init__(self, text):
+        self.text = text
+
+
+class FakeModel:
+    """Stand-in for a Gemini model that counts calls."""
+
+    def __init__(self, text=SCHEDULE_JSON, delay=0.05, stall_after=None):
+        self.text = text
+        self.delay = delay
+        self.stall_after = stall_after
+        self.calls = 0
+
+    def generate_content(self, prompt, request_options=None):
+        self.calls += 1
+        time.sleep(self.delay)
+        return _Response(self.text)
+
+    async def generate_content_async(self, prompt, stream=False):
+        self.calls += 1
+        if stream:
+            return self._stream()
+        await asyncio.sleep(self.delay)
+        return _Response(self.text)
+
+    async def _stream(self):
+        """Yield the response in small chunks; stall_after chunks then hang."""
+        for i in range(0, len(self.text), 7):
+            if self.stall_after is not None and i // 7 >= self.stall_after:
+                await asyncio.sleep(10)
+            yield _Response(self.text[i:i + 7])
+
+
+@pytest.fixture
+def service():
+    """LLM service wired to a fake model."""
+    svc = LLMService()
+    svc.gemini_model = FakeModel()
+    return svc
+
+
+class TestCacheKey:
+    """Tests for prompt input normalization."""
+
+    def test_key_ignores_dict_order(self):
+        """Test equal inputs hash equally regardless of key order."""
+        assert make_cache_key("schedule", {"a": 1, "b": [1, 2]}) == \
+            make_cache_key("schedule", {"b": [1, 2], "a": 1})
+
+    def test_key_depends_on_inputs_and_kind(self):
+        """Test different inputs or prompt types never collide."""
+        assert make_cache_key("schedule", {"a": 1}) != make_cache_key("schedule", {"a": 2})
+        assert make_cache_key("schedule", {"a": 1}) != make_cache_key("breakdown", {"a": 1})
+
+    def test_lru_eviction(self):
+        """Test the least recently used entry is evicted first."""
+        cache = LLMResponseCache(ttl_seconds=60, max_entries=2)
+        cache.set("a", "1")
+        cache.set("b", "2")
+        cache.get("a")
+        cache.set("c", "3")
+        assert cache.get("a") == "1"
+        assert cache.get("b") is None
+
+
+class TestLLMService:
+    """Tests for caching, single-flight and timeouts."""
+
+    def test_repeat_request_is_cached(self, service):
+        """Test an identical request is served without calling the model."""
+        first = service.generate_intelligent_schedule(TASKS, [], CONTEXT)
+        second = service.generate_intelligent_schedule(TASKS, [], CONTEXT)
+
+        assert service.gemini_model.calls == 1
+        assert [b.title for b in first] == [b.title for b in second] == ["Write report"]
+        assert service.get_stats()["cache"]["hits"] == 1
+
+    def test_changed_inputs_miss_cache(self, service):
+        """Test a different mood generates again."""
+        service.generate_intelligent_schedule(TASKS, [], CONTEXT)
+        service.generate_intelligent_schedule(TASKS, [], {**CONTEXT, "mood": "tired"})
+        assert service.gemini_model.calls == 2
+
+    def test_concurrent_threads_share_one_call(self, service):
+        """Test identical in-flight sync requests are deduplicated."""
+        threads = [
+            threading.Thread(target=service.generate_intelligent_schedule, args=(TASKS, [], CONTEXT))
+            for _ in range(5)
+        ]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        assert service.gemini_model.calls == 1
+
+    def test_concurrent_async_calls_share_one_call(self, service):
+        """Test identical in-flight async requests are deduplicated."""
+        async def scenario():
+            return await asyncio.gather(*[
+                service.generate_intelligent_schedule_async(TASKS, [], CONTEXT) for _ in range(5)
+            ])
+
+        results = asyncio.run(scenario())
+        assert service.gemini_model.calls == 1
+        assert all(r[0].task_id == 1 for r in results)
+
+    def test_timeout_falls_back(self, service):
+        """Test a slow model falls back to rule-based scheduling."""
+        service.gemini_model = FakeModel(delay=0.5)
+        with patch.object(AIConfig, 'LLM_TIMEOUT_SECONDS', 0.05):
+            blocks = asyncio.run(service.generate_intelligent_schedule_async(TASKS, [], CONTEXT))
+
+        assert blocks  # Fallback still schedules the task
+        assert service.get_stats()["cache"]["size"] == 0
+
+    def test_malformed_response_not_cached(self, service):
+        """Test unparseable output is retried rather than replayed."""
+        service.gemini_model = FakeModel(text="not json")
+        service.generate_intelligent_schedule(TASKS, [], CONTEXT)
+        service.generate_intelligent_schedule(TASKS, [], CONTEXT)
+        assert service.gemini_model.calls == 2
+
+
+STREAM_JSON = json.dumps({
+    "schedule": [
+        {"task_id": 1, "title": "Write {report}", "start_hour": 9.0, "duration_hours": 1.0,
+         "reasoning": "Peak \\\"focus\\\" time [morning]"},
+        {"task_id": None, "title": "Break", "start_hour": 10.0, "duration_hours": 0.25,
+         "block_type": "break"},
+        {"task_id": 2, "title": "Email", "start_hour": 10.25, "duration_hours": 0.5},
+    ],
+    "optimization_notes": "ok",
+})
+
+STREAM_TASKS = [
+    {"id": 1, "title": "Write report", "priority": 5, "duration": 1.0},
+    {"id": 2, "title": "Email", "priority": 2, "duration": 0.5},
+    {"id": 3, "title": "Review PR", "priority": 4, "duration": 1.0},
+]
+
+
+def _collect(service, tasks=STREAM_TASKS):
+    async def scenario():
+        return [item async for item in service.stream_intelligent_schedule(tasks, [], CONTEXT)]
+    return asyncio.run(scenario())
+
+
+class TestJSONArrayStreamParser:
+    """Tests for incremental array parsing."""
+
+    def test_items_emitted_as_they_complete(self):
+        """Test one-character chunks yield every item exactly once, in order."""
+        parser = JSONArrayStreamParser("schedule")
+        items = []
+        for char in STREAM_JSON:
+            items.extend(parser.feed(char))
+
+        assert [item["task_id"] for item in items] == [1, None, 2]
+        assert items[0]["title"] == "Write {report}"
+        assert parser.done
+        assert json.loads(parser.text) == json.loads(STREAM_JSON)
+
+    def test_incomplete_item_is_held_back(self):
+        """Test a half-received item isn't returned."""
+        parser = JSONArrayStreamParser("schedule")
+        cut = STREAM_JSON.index('"Break"')
+        assert len(parser.feed(STREAM_JSON[:cut])) == 1
+        assert not parser.done
+
+
+class TestScheduleStreaming:
+    """Tests for streamed schedule generation."""
+
+    def test_stream_yields_model_blocks_and_caches(self, service):
+        """Test a complete stream is emitted block by block and cached."""
+        service.gemini_model = FakeModel(text=STREAM_JSON)
+        first = _collect(service)
+        second = _collect(service)
+
+        assert [source for source, _ in first] == ["llm", "llm", "llm"]
+        assert [b.task_id for _, b in first] == [b.task_id for _, b in second]
+        assert service.gemini_model.calls == 1
+
+    def test_stall_falls_back_for_remaining_tasks(self, service):
+        """Test a stalled stream keeps emitted blocks and schedules the rest."""
+        service.gemini_model = FakeModel(text=STREAM_JSON, stall_after=STREAM_JSON.index('"Break"') // 7 + 1)
+        with patch.object(AIConfig, 'LLM_STREAM_STALL_SECONDS', 0.1):
+            blocks = _collect(service)
+
+        llm = [b for source, b in blocks if source == "llm"]
+        fallback = [b for source, b in blocks if source == "fallback"]
+        assert [b.task_id for b in llm] == [1]
+        assert {b.task_id for b in fallback if b.task_id} == {2, 3}
+        # Fallback blocks never overlap what the model already placed
+        for block in fallback:
+            assert block.start_hour >= llm[0].start_hour + llm[0].duration_hours or \
+                block.start_hour + block.duration_hours <= llm[0].start_hour
+        assert service.get_stats()["cache"]["size"] == 0
+
+    def test_slow_consumer_does_not_hold_slot(self, service):
+        """Test the LLM slot is free once upstream finishes, before the consumer drains."""
+        service.gemini_model = FakeModel(text=STREAM_JSON)
+
+        async def scenario():
+            stream = service.stream_intelligent_schedule(STREAM_TASKS, [], CONTEXT)
+            await stream.__anext__()  # Consumer takes one block, then stalls
+            await asyncio.sleep(0.05)  # Upstream finishes meanwhile
+            other = await asyncio.wait_for(
+                service._call_llm_async("system", "user"), timeout=1
+            )
+            await stream.aclose()
+            return other
+
+        with patch.object(AIConfig, 'LLM_MAX_CONCURRENCY', 1):
+            assert asyncio.run(scenario()) == STREAM_JSON
+
+    def test_no_model_streams_fallback(self):
+        """Test the stream works without an LLM."""
+        service = LLMService()
+        service.gemini_model = None
+        blocks = _collect(service)
+        assert blocks and all(source == "fallback" for source, _ in blocks)
@@ -23,7 +23,18 @@ class TestMainRoutes:
         """Test the health check endpoint."""
         response = client.get("/health")
         assert response.status_code == status.HTTP_200_OK
-        assert response.json() == {"status": "healthy"}
+        
+        data = response.json()
+        assert data["status"] == "healthy"
+        assert data["background_tasks"] == "running"
+        
+        # Per-job run statistics and backlog are exposed
+        jobs = data["background"]["jobs"]
+        assert set(jobs) == {
+            "persist_agents", "infer_outcomes", "refresh_rollups", "archive_rows", "warm_agents"
+        }
+        assert "last_duration_seconds" in jobs["persist_agents"]
+        assert "backlog" in jobs["infer_outcomes"]
     
     def test_application_startup(self, client):
         """Test that the application starts up correctly."""
@@ -0,0 +1,139 @@
+"""
+Metrics Tests
+Tests for the in-process metrics registry, spans and the /metrics endpoint.
+"""
+
+import pytest
+
+from core import metrics
+from core.metrics import Counter, Histogram, MetricsRegistry, span
+
+
+class TestRegistry:
+    """Tests for metric recording and Prometheus rendering."""
+
+    def test_histogram_renders_cumulative_buckets(self):
+        """Test bucket counts are cumulative and end with +Inf, sum and count."""
+        registry = MetricsRegistry()
+        histogram = registry.histogram("h_seconds", "Test histogram", ("stage",), buckets=(0.1, 1.0))
+        for value in (0.05, 0.5, 5.0):
+            histogram.observe(value, stage="a")
+
+        lines = registry.render().splitlines()
+        assert 'h_seconds_bucket{stage="a",le="0.1"} 1' in lines
+        assert 'h_seconds_bucket{stage="a",le="1"} 2' in lines
+        assert 'h_seconds_bucket{stage="a",le="+Inf"} 3' in lines
+        assert 'h_seconds_sum{stage="a"} 5.55' in lines
+        assert 'h_seconds_count{stage="a"} 3' in lines
+        assert "# TYPE h_seconds histogram" in lines
+
+    def test_histogram_snapshot_counts_per_bucket(self):
+        """Test snapshot() reports per-bucket (not cumulative) counts for one label set."""
+        histogram = Histogram("h_ms", "Test histogram", buckets=[1, 5])
+        for value in (0.5, 1, 3, 10):
+            histogram.observe(value)
+
+        snapshot = histogram.snapshot()
+        assert snapshot["buckets"] == {"1": 2, "5": 1, "+Inf": 1}
+        assert snapshot["count"] == 4
+        assert snapshot["sum"] == pytest.approx(14.5)
+        assert Histogram("empty", "Unused", buckets=[1]).snapshot()["count"] == 0
+
+    def test_counter_escapes_label_values(self):
+        """Test quotes and backslashes in label values are escaped."""
+        registry = MetricsRegistry()
+        counter = registry.counter("c_total", "Test counter", ("route",))
+        counter.inc(route='say "hi"\\')
+        counter.inc(2, route='say "hi"\\')
+
+        assert 'c_total{route="say \\"hi\\"\\\\"} 3' in registry.render().splitlines()
+
+    def test_reregistering_returns_existing(self):
+        """Test registering a name twice shares one metric, and a kind clash fails."""
+        registry = MetricsRegistry()
+        first = registry.counter("x_total", "Test")
+        assert registry.counter("x_total", "Test") is first
+        with pytest.raises(ValueError):
+            registry.register(Histogram("x_total", "Test"))
+
+    def test_gauge_errors_do_not_break_scrape(self):
+        """Test a failing gauge callback is skipped."""
+        registry = MetricsRegistry()
+        registry.gauge("broken", "Fails", lambda: 1 / 0)
+        registry.register(Counter("ok_total", "Works")).inc()
+
+        lines = registry.render().splitlines()
+        assert "ok_total 1" in lines
+        assert not any(line.startswith("broken ") for line in lines)
+
+    def test_span_records_even_on_error(self):
+        """Test a span that raises is still timed."""
+        before = metrics.STAGE_SECONDS.count(stage="test.failing")
+        with pytest.raises(RuntimeError):
+            with span("test.failing"):
+                raise RuntimeError("boom")
+        assert metrics.STAGE_SECONDS.count(stage="test.failing") == before + 1
+
+
+class TestAgentCacheMetrics:
+    """Tests for the ScheduleAgent registry counters."""
+
+    def test_counts_miss_then_hit(self, tmp_path, monkeypatch):
+        """Test the first lookup of a user is a miss and the second a hit."""
+        from ai.agent import ScheduleAgent
+        from ai.config import AIConfig
+
+        monkeypatch.setattr(AIConfig, "MODEL_DIRECTORY", str(tmp_path))
+        ScheduleAgent.clear_cache()
+        misses = metrics.AGENT_CACHE.value(result="miss")
+        hits = metrics.AGENT_CACHE.value(result="hit")
+
+        ScheduleAgent.get_instance(4242)
+        ScheduleAgent.get_instance(4242)
+
+        assert metrics.AGENT_CACHE.value(result="miss") == misses + 1
+        assert metrics.AGENT_CACHE.value(result="hit") == hits + 1
+        ScheduleAgent.clear_cache()
+
+
+class TestMetricsEndpoint:
+    """Tests for per-request accounting and the scrape endpoint."""
+
+    def _headers(self, client):
+        response = client.post("/auth/signup", json={
+            "email": "metrics@example.com", "username": "metrics", "password": "secret123"
+        })
+        return {"Authorization": f"Bearer {response.json()['access_token']}"}
+
+    def test_requests_record_latency_and_queries(self, client):
+        """Test a request is labelled by its route template with its statement count."""
+        headers = self._headers(client)
+        before = metrics.REQUEST_QUERIES.count(route="/tasks")
+
+        assert client.get("/tasks", headers=headers).status_code == 200
+
+        assert metrics.REQUEST_QUERIES.count(route="/tasks") == before + 1
+        series = metrics.REQUEST_QUERIES._series[("/tasks",)]
+        assert series[1] >= 1  # At least the task query
+
+        body = client.get("/metrics").text
+        assert 'pulse_http_request_duration_seconds_count{method="GET",route="/tasks",status="200"}' in body
+        assert "pulse_agents_cached" in body
+
+    def test_unmatched_paths_share_one_label(self, client):
+        """Test 404s don't create a label per raw path."""
+        client.get("/no/such/path/123")
+        client.get("/no/such/path/456")
+
+        body = client.get("/metrics").text
+        assert 'route="unmatched"' in body
+        assert "/no/such/path" not in body
+
+    def test_token_protects_endpoint(self, client, monkeypatch):
+        """Test METRICS_TOKEN gates the scrape."""
+        monkeypatch.setattr(metrics, "METRICS_TOKEN", "scrape-secret")
+
+        assert client.get("/metrics").status_code == 401
+        response = client.get("/metrics", headers={"Authorization": "Bearer scrape-secret"})
+        assert response.status_code == 200
+        assert response.headers["content-type"].startswith("text/plain")
@@ -0,0 +1,111 @@
+"""
+Tests for the append-only record log behind the JSON-file CRUD modules.
+"""
+
+import json
+import os
+
+import pytest
+
+from crud import record_log
+from crud.record_log import RecordLog
+
+
+def open_log(path, **kwargs):
+    return RecordLog(str(path), collections=["tasks"], meta={"next_id": 1}, fsync_interval=0, **kwargs)
+
+
+class TestRecordLog:
+    """Tests for RecordLog persistence and recovery."""
+
+    def test_replays_mutations_after_reopen(self, tmp_path):
+        """A fresh instance rebuilds the same state from the log."""
+        path = tmp_path / "tasks.json"
+        log = open_log(path)
+        first = log.insert("tasks", {"title": "A", "completed": False})
+        log.insert("tasks", {"title": "B", "completed": False})
+        log.update("tasks", first["id"], {"completed": True})
+        log.delete("tasks", 2)
+        log.close()
+
+        reopened = open_log(path)
+        assert reopened.records("tasks") == [{"id": 1, "title": "A", "completed": True}]
+        assert reopened.get_meta("next_id") == 3
+
+    def test_single_mutation_appends_one_line(self, tmp_path):
+        """Updating one record appends a line instead of rewriting the file."""
+        path = tmp_path / "tasks.json"
+        log = open_log(path)
+        for i in range(200):
+            log.insert("tasks", {"title": f"Task {i}", "completed": False})
+        size = os.path.getsize(path)
+
+        log.update("tasks", 100, {"completed": True})
+
+        grown = os.path.getsize(path) - size
+        assert 0 < grown < 100
+        assert path.read_text().splitlines()[-1] == '{"c":"tasks","id":100,"set":{"completed":true}}'
+
+    def test_drops_torn_last_line(self, tmp_path):
+        """A partially written last line is discarded and truncated away."""
+        path = tmp_path / "tasks.json"
+        log = open_log(path)
+        log.insert("tasks", {"title": "Kept"})
+        log.close()
+        with open(path, "a") as f:
+            f.write('{"c":"tasks","put":{"id":2,"ti')
+
+        reopened = open_log(path)
+        assert [t["title"] for t in reopened.records("tasks")] == ["Kept"]
+        reopened.insert("tasks", {"title": "Next"})
+        assert [t["title"] for t in open_log(path).records("tasks")] == ["Kept", "Next"]
+
+    def test_compaction_replaces_log_with_snapshot(self, tmp_path, monkeypatch):
+        """Past the threshold the file is rewritten as a single snapshot."""
+        monkeypatch.setattr(record_log, "COMPACT_MIN_OPS", 10)
+        path = tmp_path / "tasks.json"
+        log = open_log(path)
+        log.insert("tasks", {"title": "A", "count": 0})
+        for i in range(20):
+            log.update("tasks", 1, {"count": i + 1})
+
+        lines = path.read_text().splitlines()
+        assert len(lines) < 10
+        assert json.loads(lines[0])["v"] == record_log.FORMAT_VERSION
+        assert not os.path.exists(f"{path}.tmp")
+        assert open_log(path).get("tasks", 1)["count"] == 20
+
+    def test_converts_legacy_json_file(self, tmp_path):
+        """Whole-document files from the old CRUD modules are migrated."""
+        path = tmp_path / "tasks.json"
+        path.write_text(json.dumps({"tasks": [{"id": 1, "title": "Old"}], "next_id": 2}, indent=2))
+
+        log = open_log(path)
+        assert log.get("tasks", 1) == {"id": 1, "title": "Old"}
+        assert log.insert("tasks", {"title": "New"})["id"] == 2
+        assert json.loads(path.read_text().splitlines()[0])["snapshot"]["next_id"] == 2
+
+    def test_reloads_when_file_removed(self, tmp_path):
+        """Deleting the file resets the in-memory state."""
+        path = tmp_path / "tasks.json"
+        log = open_log(path)
+        log.insert("tasks", {"title": "A"})
+        os.remove(path)
+
+        assert log.records("tasks") == []
+        assert log.insert("tasks", {"title": "B"})["id"] == 1
+
+    def test_returned_records_are_copies(self, tmp_path):
+        """Mutating a returned dict doesn't change the stored record."""
+        log = open_log(tmp_path / "tasks.json")
+        task = log.insert("tasks", {"title": "A"})
+        task["title"] = "changed"
+        log.get("tasks", 1)["title"] = "changed"
+        assert log.get("tasks", 1)["title"] == "A"
+
+    def test_rejects_newer_format(self, tmp_path):
+        """Files from a newer format version are not misread."""
+        path = tmp_path / "tasks.json"
+        path.write_text(json.dumps({"v": record_log.FORMAT_VERSION + 1, "snapshot": {}}) + "\n")
+        with pytest.raises(ValueError):
+            open_log(path).records("tasks")
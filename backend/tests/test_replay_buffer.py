@@ -0,0 +1,126 @@
+"""
+Replay Buffer Tests
+Tests for ring-buffer storage and sum-tree prioritized sampling.
+"""
+
+import pytest
+
+np = pytest.importorskip("numpy")
+
+from ai.replay_buffer import ReplayBuffer, PrioritizedReplayBuffer, SumTree
+
+
+def _fill(buffer, count, state_dim=4):
+    """Push `count` transitions whose action equals their insertion order."""
+    for i in range(count):
+        state = np.full(state_dim, i, dtype=np.float32)
+        buffer.push(state, i, float(i), state + 1, i % 2 == 0)
+
+
+class TestReplayBuffer:
+    """Tests for the struct-of-arrays ring buffer."""
+
+    def test_push_and_len(self):
+        """Test pushes grow the buffer up to capacity."""
+        buffer = ReplayBuffer(capacity=5)
+        _fill(buffer, 3)
+        assert len(buffer) == 3
+        _fill(buffer, 10)
+        assert len(buffer) == 5
+
+    def test_ring_overwrites_oldest(self):
+        """Test wrapping around keeps only the newest transitions."""
+        buffer = ReplayBuffer(capacity=4)
+        for i in range(6):
+            buffer.push(np.zeros(2), i, 0.0, np.zeros(2), False)
+        assert sorted(buffer.actions.tolist()) == [2, 3, 4, 5]
+
+    def test_sample_dtypes_and_shapes(self):
+        """Test sampled arrays are contiguous float32/int64 batches."""
+        buffer = ReplayBuffer(capacity=100, state_dim=4)
+        _fill(buffer, 50)
+        states, actions, rewards, next_states, dones = buffer.sample(16)
+
+        assert states.shape == (16, 4) and states.dtype == np.float32
+        assert next_states.shape == (16, 4)
+        assert actions.dtype == np.int64
+        assert rewards.dtype == np.float32 and dones.dtype == np.float32
+        # Rows stay aligned across fields
+        assert np.allclose(states[:, 0], actions)
+        assert np.allclose(next_states[:, 0], actions + 1)
+
+    def test_push_batch_matches_push(self):
+        """Test vectorized insertion wraps like repeated push."""
+        buffer = ReplayBuffer(capacity=4, state_dim=2)
+        states = np.arange(12, dtype=np.float32).reshape(6, 2)
+        buffer.push_batch(states, np.arange(6), np.zeros(6), states, np.zeros(6))
+
+        assert len(buffer) == 4
+        assert buffer.position == 2
+        assert sorted(buffer.actions.tolist()) == [2, 3, 4, 5]
+
+    def test_clear(self):
+        """Test clearing empties the buffer."""
+        buffer = ReplayBuffer(capacity=10)
+        _fill(buffer, 5)
+        buffer.clear()
+        assert len(buffer) == 0
+        assert not buffer.is_ready(1)
+
+
+class TestSumTree:
+    """Tests for the sum tree used by prioritized replay."""
+
+    def test_total_and_find(self):
+        """Test prefix-sum lookup maps points to the right leaves."""
+        tree = SumTree(5)
+        tree.update(np.arange(5), np.array([1.0, 2.0, 3.0, 4.0, 0.0]))
+        assert tree.total == pytest.approx(10.0)
+
+        leaves = tree.find(np.array([0.5, 1.5, 3.5, 9.9]))
+        assert leaves.tolist() == [0, 1, 2, 3]
+
+    def test_update_with_duplicate_indices(self):
+        """Test repeated indices in one update keep sums consistent."""
+        tree = SumTree(4)
+        tree.update(np.array([1, 1, 2]), np.array([5.0, 2.0, 1.0]))
+        assert tree.total == pytest.approx(3.0)
+
+
+class TestPrioritizedReplayBuffer:
+    """Tests for sum-tree backed prioritized replay."""
+
+    def test_sample_returns_weights_and_indices(self):
+        """Test prioritized sample returns normalized weights."""
+        buffer = PrioritizedReplayBuffer(capacity=64, state_dim=4)
+        _fill(buffer, 32)
+        *_, weights, indices = buffer.sample(8)
+
+        assert weights.shape == (8,)
+        assert weights.max() == pytest.approx(1.0)
+        assert np.all((indices >= 0) & (indices < 32))
+
+    def test_high_priority_sampled_more(self):
+        """Test raising one transition's priority makes it dominate sampling."""
+        np.random.seed(0)
+        buffer = PrioritizedReplayBuffer(capacity=16, alpha=1.0, state_dim=4)
+        _fill(buffer, 16)
+        buffer.update_priorities(np.arange(16), np.full(16, 0.01))
+        buffer.update_priorities([7], [100.0])
+
+        *_, indices = buffer.sample(16)
+        assert np.mean(indices == 7) > 0.5
+        assert buffer.max_priority == pytest.approx(100.0)
+
+    def test_sample_empty_or_short_buffer(self):
+        """Test both buffers raise on an empty buffer and clamp a short one."""
+        for buffer in (ReplayBuffer(capacity=16, state_dim=4),
+                       PrioritizedReplayBuffer(capacity=16, state_dim=4)):
+            with pytest.raises(ValueError, match="empty"):
+                buffer.sample(4)
+
+            _fill(buffer, 3)
+            with pytest.raises(ValueError, match="positive"):
+                buffer.sample(0)
+            states = buffer.sample(4)[0]
+            assert states.shape == (3, 4)
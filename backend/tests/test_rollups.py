@@ -0,0 +1,225 @@
+"""
+Daily Rollup Tests
+Tests for dirty-day marking, rollup rebuilds and the insights endpoints.
+"""
+
+from datetime import date, datetime, timezone
+
+import pytest
+
+from models.daily_rollup import DailyUserRollup, RollupDirtyDay
+from models.mood import MoodEntry
+from models.recommendation_log import RecommendationLog
+from models.reflection import Reflection
+from models.task import Task
+from models.user import User
+from tasks import rollups
+from tasks.rollups import mark_all_rollup_days, refresh_dirty_days
+
+DAY = date(2025, 1, 15)
+
+
+def _at(hour: int, day: date = DAY) -> datetime:
+    return datetime(day.year, day.month, day.day, hour, tzinfo=timezone.utc)
+
+
+def _log(user_id, hour, action="DEEP_FOCUS", strategy="rule", outcome=None, reward=None):
+    return RecommendationLog(
+        user_id=user_id, timestamp=_at(hour), state_key="morning|monday|high|low",
+        action_type=action, strategy_used=strategy, confidence=0.8,
+        outcome=outcome, reward=reward, was_followed=outcome == "completed",
+    )
+
+
+def _rollup(db, user_id=1, day=DAY):
+    return db.query(DailyUserRollup).filter(
+        DailyUserRollup.user_id == user_id, DailyUserRollup.day == day
+    ).first()
+
+
+@pytest.fixture
+def user(db_session):
+    user = User(id=1, username="rollup_user")
+    db_session.add(user)
+    db_session.commit()
+    return user
+
+
+class TestRollupMaintenance:
+    """Tests for marking on write and rebuilding in the background."""
+
+    def test_writes_mark_their_day_dirty(self, db_session, user):
+        """Test a flushed source row marks its (user, day) in the same transaction."""
+        db_session.add(MoodEntry(user_id=1, mood="focused", timestamp=_at(9)))
+        db_session.add(MoodEntry(mood="calm", timestamp=_at(10)))  # No user: not rolled up
+        db_session.commit()
+
+        marks = db_session.query(RollupDirtyDay.user_id, RollupDirtyDay.day).all()
+        assert marks == [(1, DAY)]
+
+    def test_dirty_count_uses_read_session(self, db_session, user, monkeypatch):
+        """Test the /health backlog count doesn't take the writer connection."""
+        from tests.conftest import TestingSessionLocal
+
+        def no_writer():
+            raise AssertionError("count_dirty_days opened a writer session")
+
+        monkeypatch.setattr(rollups, "SessionLocal", no_writer)
+        monkeypatch.setattr(rollups, "ReadSessionLocal", TestingSessionLocal)
+        db_session.add(MoodEntry(user_id=1, mood="focused", timestamp=_at(9)))
+        db_session.commit()
+
+        assert rollups.count_dirty_days() == 1
+
+    def test_rebuild_aggregates_sources(self, db_session, user):
+        """Test one rebuild rolls up recommendations, moods, reflections, tasks."""
+        db_session.add_all([
+            _log(1, 9, outcome="completed", reward=1.0),
+            _log(1, 11, outcome="skipped", reward=-0.5, strategy="rl"),
+            _log(1, 14, action="BREAK"),
+            MoodEntry(user_id=1, mood="focused", timestamp=_at(9)),
+            MoodEntry(user_id=1, mood="focused", timestamp=_at(12)),
+            MoodEntry(user_id=1, mood="tired", timestamp=_at(17)),
+            Reflection(user_id=1, date=DAY, mood_score=4, distractions=["phone"],
+                       completed_tasks=3, total_tasks=5),
+            Task(user_id=1, title="Done", duration=1.5, completed=True,
+                 status="completed", completed_at=_at(15)),
+        ])
+        db_session.commit()
+
+        assert refresh_dirty_days(db_session) == 1
+        rollup = _rollup(db_session)
+        assert rollup.recommendation_count == 3
+        assert rollup.recommendations_by_action == {"DEEP_FOCUS": 2, "BREAK": 1}
+        assert rollup.recommendations_by_outcome == {"completed": 1, "skipped": 1, "pending": 1}
+        assert rollup.recommendations_by_strategy == {"rule": 2, "rl": 1}
+        assert rollup.followed_count == 1
+        assert rollup.average_reward == pytest.approx(0.25)
+        assert rollup.mood_counts == {"focused": 2, "tired": 1}
+        assert rollup.reflection_mood_score == 4
+        assert rollup.reflection_distractions == ["phone"]
+        assert rollup.tasks_completed == 1
+        assert rollup.completed_task_hours == pytest.approx(1.5)
+        assert db_session.query(RollupDirtyDay).count() == 0
+
+    def test_late_outcome_updates_rollup(self, db_session, user):
+        """Test an outcome recorded after the rebuild re-marks and updates the day."""
+        log = _log(1, 9)
+        db_session.add(log)
+        db_session.commit()
+        refresh_dirty_days(db_session)
+
+        log.outcome = "completed"
+        log.reward = 0.8
+        db_session.commit()
+        assert refresh_dirty_days(db_session) == 1
+
+        rollup = _rollup(db_session)
+        assert rollup.recommendations_by_outcome == {"completed": 1}
+        assert rollup.average_reward == pytest.approx(0.8)
+
+    def test_deleting_last_row_removes_rollup(self, db_session, user):
+        """Test a day left without activity has no rollup row."""
+        entry = MoodEntry(user_id=1, mood="calm", timestamp=_at(9))
+        db_session.add(entry)
+        db_session.commit()
+        refresh_dirty_days(db_session)
+        assert _rollup(db_session) is not None
+
+        db_session.delete(entry)
+        db_session.commit()
+        refresh_dirty_days(db_session)
+        assert _rollup(db_session) is None
+
+    def test_mark_during_rebuild_survives(self, db_session, user, monkeypatch):
+        """Test a change landing mid-rebuild leaves its day dirty."""
+        db_session.add(MoodEntry(user_id=1, mood="calm", timestamp=_at(9)))
+        db_session.commit()
+
+        original = rollups.rebuild_rollup_day
+
+        def rebuild_with_concurrent_write(db, user_id, day, now=None):
+            rollups.mark_rollup_days(db, [(user_id, day)], datetime(2030, 1, 1, tzinfo=timezone.utc))
+            return original(db, user_id, day, now)
+
+        monkeypatch.setattr(rollups, "rebuild_rollup_day", rebuild_with_concurrent_write)
+        refresh_dirty_days(db_session)
+        assert db_session.query(RollupDirtyDay).count() == 1
+
+    def test_backfill_marks_existing_history(self, db_session, user):
+        """Test existing rows are queued by the backfill."""
+        db_session.add_all([
+            MoodEntry(user_id=1, mood="calm", timestamp=_at(9)),
+            MoodEntry(user_id=1, mood="calm", timestamp=_at(9, date(2025, 1, 16))),
+        ])
+        db_session.commit()
+        db_session.query(RollupDirtyDay).delete()
+        db_session.commit()
+
+        assert mark_all_rollup_days(db_session) == 2
+
+    def test_bulk_session_sync_marks_day(self, db_session, user):
+        """Test the Core bulk insert marks the days of attributed sessions."""
+        from routers.extension_router import _bulk_insert_sessions
+
+        _bulk_insert_sessions(db_session, [{
+            "session_id": "s1", "user_id": 1, "timestamp": _at(14), "hour_key": "2025-01-15T14",
+            "duration_minutes": 60, "work_time": 40, "leisure_time": 20,
+        }])
+        db_session.commit()
+        refresh_dirty_days(db_session)
+
+        rollup = _rollup(db_session)
+        assert rollup.focus_minutes == 40
+        assert rollup.tracked_minutes == 60
+
+
+class TestInsightsRoutes:
+    """Tests for the rollup-backed insights endpoints."""
+
+    def _signup(self, client, db_session):
+        response = client.post("/auth/signup", json={
+            "email": "ins@example.com", "username": "ins", "password": "secret123"
+        })
+        token = response.json()["access_token"]
+        user_id = db_session.query(User).filter(User.username == "ins").first().id
+        return {"Authorization": f"Bearer {token}"}, user_id
+
+    def test_summary_over_range(self, client, db_session):
+        """Test the summary totals only the rollups inside the range."""
+        headers, user_id = self._signup(client, db_session)
+        db_session.add_all([
+            _log(user_id, 9, outcome="completed", reward=1.0),
+            MoodEntry(user_id=user_id, mood="focused", timestamp=_at(9)),
+            MoodEntry(user_id=user_id, mood="tired", timestamp=_at(9, date(2025, 1, 20))),
+        ])
+        db_session.commit()
+        refresh_dirty_days(db_session)
+
+        response = client.get(
+            "/insights/summary?start_date=2025-01-14&end_date=2025-01-16", headers=headers
+        )
+        assert response.status_code == 200
+        data = response.json()
+        assert data["activeDays"] == 1
+        assert data["recommendations"] == 1
+        assert data["averageReward"] == 1.0
+        assert data["moodCounts"] == {"focused": 1}
+        assert data["pendingDays"] == 0
+
+        daily = client.get(
+            "/insights/daily?start_date=2025-01-14&end_date=2025-01-20", headers=headers
+        ).json()
+        assert [day["date"] for day in daily["days"]] == ["2025-01-15", "2025-01-20"]
+
+    def test_rejects_invalid_range(self, client, db_session):
+        """Test reversed and oversized ranges are rejected."""
+        headers, _ = self._signup(client, db_session)
+        reversed_range = client.get(
+            "/insights/daily?start_date=2025-02-01&end_date=2025-01-01", headers=headers
+        )
+        too_long = client.get(
+            "/insights/daily?start_date=2020-01-01&end_date=2025-01-01", headers=headers
+        )
+        assert reversed_range.status_code == 400
+        assert too_long.status_code == 400
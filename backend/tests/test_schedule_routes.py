@@ -130,3 +130,40 @@ class TestScheduleRoutes:
         get_response = client.get("/schedule")
         assert get_response.status_code == status.HTTP_200_OK
         assert get_response.json() == []
+
+    def test_available_slots_miss_loads_only_blocks(self, client, db_session):
+        """Test an uncached available-slots request runs one blocks query, not a full context load."""
+        from sqlalchemy import event
+        from models.schedule import ScheduleBlock
+
+        token = client.post("/auth/signup", json={
+            "email": "ada@example.com", "username": "ada", "password": "secret123"
+        }).json()["access_token"]
+        headers = {"Authorization": f"Bearer {token}"}
+        user_id = client.get("/auth/me", headers=headers).json()["id"]
+        db_session.add(ScheduleBlock(
+            user_id=user_id, title="Standup", start=10.0, duration=1.0, block_type="fixed"
+        ))
+        db_session.commit()
+
+        statements = []
+
+        def _record(conn, cursor, statement, *args):
+            if statement.lstrip().upper().startswith("SELECT"):
+                statements.append(statement)
+
+        engine = db_session.get_bind()
+        event.listen(engine, "before_cursor_execute", _record)
+        try:
+            response = client.get(
+                "/schedule/available-slots?start_hour=9&end_hour=12&duration=0.5", headers=headers
+            )
+        finally:
+            event.remove(engine, "before_cursor_execute", _record)
+
+        assert response.status_code == status.HTTP_200_OK
+        data = response.json()
+        assert [(s["start"], s["end"]) for s in data["available_slots"]] == [(9.0, 10.0), (11.0, 12.0)]
+        assert data["fixed_blocks"] == [{"start": 10.0, "end": 11.0, "title": "Standup"}]
+        assert len([s for s in statements if "FROM schedule_blocks" in s]) == 1
+        assert not [s for s in statements if "FROM tasks" in s or "FROM mood_entries" in s]
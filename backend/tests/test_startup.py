@@ -0,0 +1,89 @@
+"""
+Startup Tests
+Tests for the schema version check and the lazily imported AI components.
+"""
+
+import os
+import subprocess
+import sys
+
+import pytest
+from sqlalchemy import create_engine
+
+from models import base
+
+
+class TestSchemaVersion:
+    """Tests for skipping create_all and migrations on a current schema."""
+
+    @pytest.fixture
+    def scratch_engine(self, tmp_path, monkeypatch):
+        engine = create_engine(f"sqlite:///{tmp_path / 'schema.db'}")
+        monkeypatch.setattr(base, "engine", engine)
+        monkeypatch.setattr(base, "SessionLocal", base.sessionmaker(bind=engine))
+        monkeypatch.setattr(base, "FORCE_SCHEMA_CHECK", False)
+        yield engine
+        engine.dispose()
+
+    def _count_create_all(self, monkeypatch):
+        calls = []
+        create_all = base.Base.metadata.create_all
+        monkeypatch.setattr(
+            base.Base.metadata, "create_all", lambda *a, **kw: calls.append(1) or create_all(*a, **kw)
+        )
+        return calls
+
+    def test_second_start_skips_schema_work(self, scratch_engine, monkeypatch):
+        """Test the first init_db stamps the version and the next one skips create_all."""
+        calls = self._count_create_all(monkeypatch)
+        assert base.read_schema_version(scratch_engine) == ""
+
+        base.init_db()
+        assert base.read_schema_version(scratch_engine) == base.schema_fingerprint()
+        base.init_db()
+
+        assert len(calls) == 1
+
+    def test_changed_schema_or_force_runs_again(self, scratch_engine, monkeypatch):
+        """Test a stale stamp or FORCE_SCHEMA_CHECK runs create_all again."""
+        calls = self._count_create_all(monkeypatch)
+        base.stamp_schema_version(scratch_engine, "0:stale")
+        base.init_db()
+        assert len(calls) == 1
+
+        monkeypatch.setattr(base, "FORCE_SCHEMA_CHECK", True)
+        base.init_db()
+        assert len(calls) == 2
+
+    def test_restamp_upserts_single_row(self, scratch_engine):
+        """Test stamping again replaces the version in place."""
+        base.stamp_schema_version(scratch_engine, "1:old")
+        base.stamp_schema_version(scratch_engine, "2:new")
+
+        assert base.read_schema_version(scratch_engine) == "2:new"
+        with scratch_engine.connect() as conn:
+            assert conn.execute(base.text("SELECT COUNT(*) FROM schema_version")).scalar() == 1
+
+    def test_fingerprint_tracks_version(self, monkeypatch):
+        """Test bumping SCHEMA_VERSION changes the fingerprint."""
+        current = base.schema_fingerprint()
+        monkeypatch.setattr(base, "SCHEMA_VERSION", base.SCHEMA_VERSION + 1)
+        assert base.schema_fingerprint() != current
+
+
+class TestLazyImports:
+    """Tests that importing the AI package stays free of NumPy/torch."""
+
+    def test_import_ai_skips_dqn_modules(self):
+        """Test `import ai` doesn't load the DQN modules until they're used."""
+        backend = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+        code = (
+            "import sys, ai\n"
+            "print(sorted(m for m in ('ai.dqn_agent', 'ai.dqn_inference', 'ai.replay_buffer', 'torch')"
+            " if m in sys.modules))"
+        )
+        result = subprocess.run(
+            [sys.executable, "-c", code], cwd=backend, capture_output=True, text=True, timeout=60
+        )
+        assert result.returncode == 0, result.stderr
+        assert result.stdout.strip().splitlines()[-1] == "[]"
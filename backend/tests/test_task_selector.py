@@ -0,0 +1,98 @@
+"""
+Task Selector Tests
+Tests for SQL-filtered, bounded top-K task selection.
+"""
+
+import pytest
+from datetime import datetime, timedelta, timezone
+
+from ai.actions import ActionType
+from ai.state import UserState
+from ai.task_selector import TaskSelector
+from ai.user_context import TaskInfo, UserContextSnapshot
+
+
+USER_ID = 11
+
+
+@pytest.fixture
+def state():
+    """Create a test state."""
+    return UserState(
+        time_block="morning",
+        day_of_week="monday",
+        energy_level="high",
+        workload_pressure="high",
+    )
+
+
+@pytest.fixture
+def backlog(db_session):
+    """Create a mixed backlog for one user plus another user's task."""
+    from models.task import Task
+
+    now = datetime.now(timezone.utc)
+    tasks = [
+        Task(user_id=USER_ID, title=f"Task {i}", priority=1 + i % 5, status="pending",
+             estimated_duration=30 + (i % 4) * 30,
+             deadline=now + timedelta(hours=i) if i % 3 == 0 else None)
+        for i in range(40)
+    ]
+    tasks.append(Task(user_id=USER_ID, title="Too long", priority=5, status="pending",
+                      estimated_duration=500, deadline=now))
+    tasks.append(Task(user_id=USER_ID + 1, title="Other user", priority=5, status="pending"))
+    db_session.add_all(tasks)
+    db_session.commit()
+    return db_session
+
+
+class TestTaskSelector:
+    """Tests for task selection."""
+
+    def test_top_k_matches_full_ranking(self, backlog, state):
+        """Test bounded selection returns the same order as scoring everything."""
+        from models.task import Task
+
+        selector = TaskSelector()
+        top = selector.select_top_tasks(ActionType.DEEP_FOCUS, state, backlog, USER_ID, 5)
+
+        rows = backlog.query(*TaskInfo.columns()).filter(
+            Task.user_id == USER_ID,
+            Task.priority >= 3,
+            (Task.estimated_duration == None) | (Task.estimated_duration <= 120),
+        ).all()
+        now = datetime.now(timezone.utc)
+        expected = sorted(
+            (TaskInfo.from_row(row) for row in rows),
+            key=lambda t: (selector._score_task(t, ActionType.DEEP_FOCUS, state, now), -t.id),
+            reverse=True,
+        )[:5]
+
+        assert [t.id for t in top] == [t.id for t in expected]
+
+    def test_select_task_respects_filters(self, backlog, state):
+        """Test duration cap and user isolation are applied in SQL."""
+        task = TaskSelector().select_task(ActionType.DEEP_FOCUS, state, backlog, USER_ID)
+        assert task is not None
+        assert task.title not in ("Too long", "Other user")
+
+    def test_suggestions_skip_duration_filter(self, backlog, state):
+        """Test suggestions may include tasks longer than the action's cap."""
+        suggestions = TaskSelector().get_task_suggestions(
+            ActionType.DEEP_FOCUS, state, backlog, USER_ID, limit=50
+        )
+        assert "Too long" in [t.title for t in suggestions]
+
+    def test_snapshot_and_sql_paths_agree(self, backlog, state):
+        """Test ranking from a context snapshot matches the SQL path."""
+        selector = TaskSelector()
+        snapshot = UserContextSnapshot.load(backlog, USER_ID)
+
+        for action in (ActionType.DEEP_FOCUS, ActionType.LIGHT_TASK):
+            from_sql = selector.select_top_tasks(action, state, backlog, USER_ID, 3)
+            from_snapshot = selector.select_top_tasks(action, state, backlog, USER_ID, 3, snapshot)
+            assert [t.id for t in from_sql] == [t.id for t in from_snapshot]
+
+    def test_non_task_action_returns_nothing(self, backlog, state):
+        """Test actions without tasks never query."""
+        assert TaskSelector().select_task(ActionType.BREAK, state, backlog, USER_ID) is None
@@ -0,0 +1,174 @@
+"""
+User Context Snapshot Tests
+Tests for the shared per-request snapshot and its TTL cache.
+"""
+
+import pytest
+from datetime import datetime, timedelta, timezone
+from unittest.mock import patch
+
+from sqlalchemy import event
+
+from ai.config import AIConfig
+from ai.actions import ActionType
+from ai.context_encoder import ContextEncoder
+from ai.action_masker import ActionMasker
+from ai.task_selector import TaskSelector
+from ai.hybrid_recommender import HybridRecommender
+from ai.user_context import UserContextSnapshot, UserContextCache
+
+
+USER_ID = 7
+
+
+@pytest.fixture
+def now():
+    """Fixed reference time (mid-morning UTC)."""
+    return datetime.now(timezone.utc).replace(hour=10, minute=0, second=0, microsecond=0)
+
+
+@pytest.fixture
+def user_data(db_session, now):
+    """Create pending/completed tasks, a mood entry and a schedule block."""
+    from models.task import Task
+    from models.mood import MoodEntry
+    from models.schedule import ScheduleBlock
+
+    db_session.add_all([
+        Task(user_id=USER_ID, title="Write report", priority=5, status="pending",
+             estimated_duration=60, deadline=now + timedelta(hours=3)),
+        Task(user_id=USER_ID, title="Reply to email", priority=2, status="pending",
+             estimated_duration=15),
+        Task(user_id=USER_ID, title="Archived", priority=4, status="pending",
+             is_archived=True),
+        Task(user_id=USER_ID, title="Done", priority=3, status="completed",
+             completed_at=now - timedelta(hours=1)),
+        MoodEntry(user_id=USER_ID, mood="focused", timestamp=now - timedelta(minutes=30)),
+        ScheduleBlock(user_id=USER_ID, title="Standup", start=9.0, duration=0.5),
+    ])
+    db_session.commit()
+    return db_session
+
+
+@pytest.fixture
+def query_counter(db_session):
+    """Count SQL statements executed on the test engine."""
+    statements = []
+
+    def _count(conn, cursor, statement, *args):
+        statements.append(statement)
+
+    engine = db_session.get_bind()
+    event.listen(engine, "before_cursor_execute", _count)
+    yield statements
+    event.remove(engine, "before_cursor_execute", _count)
+
+
+class TestUserContextSnapshot:
+    """Tests for loading and reading a snapshot."""
+
+    def test_load_collects_user_data(self, user_data, now):
+        """Test snapshot holds pending tasks, mood, completions and blocks."""
+        snapshot = UserContextSnapshot.load(user_data, USER_ID, now)
+
+        assert snapshot.pending_count == 3
+        assert snapshot.count_pending_with_priority(4) == 2
+        assert snapshot.tasks_completed_today == 1
+        assert snapshot.latest_mood.mood == "focused"
+        assert [block.title for block in snapshot.schedule_blocks] == ["Standup"]
+        assert snapshot.has_deadline_before(now + timedelta(hours=24))
+
+    def test_load_uses_fixed_query_count(self, user_data, now, query_counter):
+        """Test loading costs four queries regardless of data volume."""
+        UserContextSnapshot.load(user_data, USER_ID, now)
+        assert len(query_counter) == 4
+
+    def test_stages_match_query_path(self, user_data, now):
+        """Test encoder, masker and selector agree with and without a snapshot."""
+        snapshot = UserContextSnapshot.load(user_data, USER_ID, now)
+        encoder, masker, selector = ContextEncoder(), ActionMasker(), TaskSelector()
+
+        state = encoder.encode(user_data, now, USER_ID)
+        assert encoder.encode(user_data, now, USER_ID, snapshot) == state
+
+        assert set(masker.get_valid_actions(state, user_data, USER_ID, snapshot)) == \
+            set(masker.get_valid_actions(state, user_data, USER_ID))
+
+        for action in (ActionType.DEEP_FOCUS, ActionType.LIGHT_TASK):
+            from_db = selector.select_task(action, state, user_data, USER_ID)
+            from_snapshot = selector.select_task(action, state, user_data, USER_ID, snapshot)
+            assert (from_db.id if from_db else None) == (from_snapshot.id if from_snapshot else None)
+
+
+class TestUserContextCache:
+    """Tests for the TTL cache and write invalidation."""
+
+    def test_second_get_is_cached(self, user_data, now, query_counter):
+        """Test a warm snapshot is served without queries."""
+        cache = UserContextCache(ttl_seconds=60)
+        first = cache.get(user_data, USER_ID, now)
+        queries_after_load = len(query_counter)
+
+        assert cache.get(user_data, USER_ID, now) is first
+        assert len(query_counter) == queries_after_load
+        assert cache.get_stats()["hits"] == 1
+
+    def test_write_invalidates_snapshot(self, user_data, now):
+        """Test committing a task for the user drops the cached snapshot."""
+        from models.task import Task
+        from ai.user_context import user_context_cache
+
+        first = user_context_cache.get(user_data, USER_ID, now)
+        user_data.add(Task(user_id=USER_ID, title="New", priority=3, status="pending"))
+        user_data.commit()
+
+        second = user_context_cache.get(user_data, USER_ID, now)
+        assert second is not first
+        assert second.pending_count == first.pending_count + 1
+
+    def test_invalidation_waits_for_commit(self, user_data, now):
+        """Test a snapshot loaded between flush and commit is dropped by the commit."""
+        from models.task import Task
+        from ai.user_context import user_context_cache
+
+        user_data.add(Task(user_id=USER_ID, title="New", priority=3, status="pending"))
+        user_data.flush()
+        during = user_context_cache.get(user_data, USER_ID, now)
+        assert user_context_cache.get(user_data, USER_ID, now) is during  # Not invalidated yet
+
+        user_data.commit()
+        assert user_context_cache.get(user_data, USER_ID, now) is not during
+
+    def test_rollback_discards_pending_invalidation(self, user_data, now):
+        """Test a rolled-back write leaves the cached snapshot alone."""
+        from models.task import Task
+        from ai.user_context import user_context_cache
+
+        first = user_context_cache.get(user_data, USER_ID, now)
+        user_data.add(Task(user_id=USER_ID, title="Discarded", priority=3, status="pending"))
+        user_data.flush()
+        user_data.rollback()
+
+        assert "user_context_invalidations" not in user_data.info
+        assert user_context_cache.get(user_data, USER_ID, now) is first
+
+    def test_zero_ttl_disables_caching(self, user_data, now):
+        """Test ttl 0 always reloads."""
+        cache = UserContextCache(ttl_seconds=0)
+        assert cache.get(user_data, USER_ID, now) is not cache.get(user_data, USER_ID, now)
+
+
+class TestRecommendationQueryBudget:
+    """Tests that a recommendation costs a fixed number of queries."""
+
+    def test_recommendation_reads_snapshot_once(self, user_data, now, query_counter, tmp_path):
+        """Test the full pipeline issues only the snapshot queries."""
+        with patch.object(AIConfig, 'MODEL_DIRECTORY', str(tmp_path)):
+            recommender = HybridRecommender(context_cache=UserContextCache(ttl_seconds=60))
+            result = recommender.get_recommendation(user_data, USER_ID, now)
+            assert len(query_counter) == 4
+            assert result.context is not None
+
+            # Warm cache: no queries at all
+            recommender.get_recommendation(user_data, USER_ID, now)
+            assert len(query_counter) == 4
@@ -0,0 +1,81 @@
+"""
+DQN Trainer Process
+Trains per-user DQNs outside the API workers and publishes serving weights.
+
+Usage:
+    python train_dqn.py            # Poll forever
+    python train_dqn.py --once     # Ingest and train once, then exit
+    python train_dqn.py --archive-days 180   # Backfill from cold storage first
+
+Serving workers read the published weights through DQNWeightRegistry and
+hot-swap them on their next lookup; no restart is needed.
+"""
+
+import argparse
+import os
+import sys
+import time
+from datetime import datetime, timedelta, timezone
+
+# Add parent directory to path for imports
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+
+from models.base import SessionLocal
+from ai.config import AIConfig
+from ai.dqn_trainer import DQNTrainer
+from tasks.archive import ColdArchive
+
+
+def run_round(trainer: DQNTrainer, steps: int) -> None:
+    """Ingest newly labelled recommendations and train the ready users."""
+    db = SessionLocal()
+    try:
+        added = trainer.ingest(db)
+    finally:
+        db.close()
+
+    started = time.perf_counter()
+    losses = trainer.train_round(steps=steps)
+    elapsed = time.perf_counter() - started
+
+    if added or losses:
+        mean_loss = sum(losses.values()) / len(losses) if losses else 0.0
+        print(
+            f"[TRAINER] +{added} transitions, trained {len(losses)} users "
+            f"in {elapsed:.2f}s (mean loss {mean_loss:.4f})"
+        )
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Out-of-band DQN trainer")
+    parser.add_argument("--once", action="store_true", help="Run one round and exit")
+    parser.add_argument("--interval", type=float, default=AIConfig.DQN_TRAINER_POLL_SECONDS,
+                        help="Seconds between rounds")
+    parser.add_argument("--steps", type=int, default=AIConfig.DQN_TRAINER_STEPS_PER_ROUND,
+                        help="Gradient steps per user per round")
+    parser.add_argument("--archive-days", type=int, default=0,
+                        help="Backfill transitions from cold storage covering this many days")
+    args = parser.parse_args()
+
+    trainer = DQNTrainer()
+    print(f"[TRAINER] Publishing serving weights to {trainer.registry.directory}")
+
+    if args.archive_days > 0:
+        since = datetime.now(timezone.utc) - timedelta(days=args.archive_days)
+        added = trainer.ingest_archive(ColdArchive(), since=since)
+        print(f"[TRAINER] +{added} transitions from cold storage since {since.date()}")
+
+    while True:
+        try:
+            run_round(trainer, args.steps)
+        except Exception as e:
+            print(f"[TRAINER] Round failed: {e}")
+            if args.once:
+                raise
+        if args.once:
+            break
+        time.sleep(args.interval)
+
+
+if __name__ == "__main__":
+    main()
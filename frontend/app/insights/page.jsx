@@ -4,9 +4,7 @@ import { useState, useEffect } from "react"
 import { Card } from "@/components/ui/card"
 import { Navigation } from "@/components/navigation"
 import { TrendingUp, TrendingDown, Clock, Target, Brain, Zap, Shield, Heart, Coffee } from "lucide-react"
-import { getReflections, getMoodAverage, getCommonDistractions } from "@/lib/api/reflections"
-import { getMoodCounts, getMostCommonMood } from "@/lib/api/mood"
-import { getTasks } from "@/lib/api/tasks"
+import { getDailyInsights, getInsightsSummary, lastDays, toUtcDay } from "@/lib/api/insights"
 import { useToast } from "@/hooks/use-toast"
 import { useAuth } from "@/lib/auth-context"
 
@@ -25,7 +23,6 @@ export default function InsightsPage() {
   const [stats, setStats] = useState({
     totalFocusTime: 0,
     tasksCompleted: 0,
-    totalTasks: 0,
     avgProductivity: 0,
     breaksTaken: 0,
   })
@@ -47,57 +44,55 @@ export default function InsightsPage() {
     try {
       setLoading(true)
 
-      // Load reflections for mood data
-      const reflections = await getReflections(7)
+      // Everything comes from daily rollups: the week for the charts and
+      // stats, 30 days for the most common mood and distractions
+      const week = lastDays(7)
+      const month = lastDays(30)
+      const [daily, weekSummary, monthSummary] = await Promise.all([
+        getDailyInsights(week.startDate, week.endDate),
+        getInsightsSummary(week.startDate, week.endDate),
+        getInsightsSummary(month.startDate, month.endDate),
+      ])
 
-      // Load mood analytics
-      const moodAvg = await getMoodAverage(7)
-      setMoodAverage(moodAvg)
+      setMoodAverage({ average_mood: weekSummary.averageReflectionMood })
+      setMostCommonMood({ most_common: monthSummary.mostCommonMood })
+      setCommonDistractions(monthSummary.distractions || [])
 
-      const mostCommon = await getMostCommonMood(100)
-      setMostCommonMood(mostCommon)
-
-      // Load distractions
-      const distractions = await getCommonDistractions(30)
-      setCommonDistractions(distractions.distractions || [])
-
-      // Load tasks for completion stats
-      const allTasks = await getTasks()
-      const completedTasks = allTasks.filter(t => t.completed).length
-      const totalTasks = allTasks.length
-
-      // Calculate focus time (sum of completed task durations)
-      const totalFocusTime = allTasks
-        .filter(t => t.completed)
-        .reduce((sum, t) => sum + (t.duration || 0), 0)
+      // Focus time from the extension (minutes), else completed task hours
+      const totalFocusTime = weekSummary.focusMinutes > 0
+        ? weekSummary.focusMinutes / 60
+        : weekSummary.completedTaskHours
 
       setStats({
         totalFocusTime: Math.round(totalFocusTime * 10) / 10, // Round to 1 decimal
-        tasksCompleted: completedTasks,
-        totalTasks: totalTasks,
-        avgProductivity: totalTasks > 0 ? Math.round((completedTasks / totalTasks) * 100) : 0,
+        tasksCompleted: weekSummary.tasksCompleted,
+        avgProductivity: weekSummary.reflectionCompletionRate != null
+          ? Math.round(weekSummary.reflectionCompletionRate * 100)
+          : 0,
         breaksTaken: Math.floor(totalFocusTime / 2), // Estimate breaks
       })
 
-      // Map reflections to week data (simplified - using last 7 reflections)
-      if (reflections.length > 0) {
-        const mappedData = reflections.slice(0, 7).reverse().map((reflection, index) => {
-          const days = ['Sun', 'Mon', 'Tue', 'Wed', 'Thu', 'Fri', 'Sat']
-          return {
-            day: days[index] || days[reflections.length - index - 1],
-            focus: Math.min(100, (reflection.completedTasks / Math.max(1, reflection.totalTasks)) * 100),
-            mood: reflection.moodScore || 3,
-          }
-        })
+      // One bar per day of the week, oldest first; days without a rollup stay at zero
+      const days = ['Sun', 'Mon', 'Tue', 'Wed', 'Thu', 'Fri', 'Sat']
+      const byDate = Object.fromEntries((daily.days || []).map(day => [day.date, day]))
+      const maxFocus = Math.max(0, ...(daily.days || []).map(day => day.focusMinutes))
+      const start = new Date(`${week.startDate}T00:00:00Z`)
 
-        // Fill remaining days with zeros
-        while (mappedData.length < 7) {
-          const days = ['Mon', 'Tue', 'Wed', 'Thu', 'Fri', 'Sat', 'Sun']
-          mappedData.push({ day: days[mappedData.length], focus: 0, mood: 0 })
+      setWeekData(Array.from({ length: 7 }, (_, i) => {
+        const date = new Date(start.getTime() + i * 24 * 60 * 60 * 1000)
+        const rollup = byDate[toUtcDay(date)]
+        let focus = 0
+        if (rollup && maxFocus > 0) {
+          focus = (rollup.focusMinutes / maxFocus) * 100
+        } else if (rollup && rollup.reflectionTotalTasks) {
+          focus = Math.min(100, (rollup.reflectionCompletedTasks / rollup.reflectionTotalTasks) * 100)
         }
-
-        setWeekData(mappedData.slice(0, 7))
-      }
+        return {
+          day: days[date.getUTCDay()],
+          focus,
+          mood: rollup?.reflectionMoodScore || 0,
+        }
+      }))
     } catch (error) {
       toast({
         title: "Error loading insights",
@@ -208,8 +203,8 @@ export default function InsightsPage() {
           </Card>
           <Card className="p-6 text-center">
             <Target className="w-10 h-10 mx-auto mb-3 text-chart-2" />
-            <div className="text-3xl font-bold mb-1">{loading ? '...' : `${stats.tasksCompleted}/${stats.totalTasks}`}</div>
-            <div className="text-sm text-muted-foreground">Tasks completed</div>
+            <div className="text-3xl font-bold mb-1">{loading ? '...' : stats.tasksCompleted}</div>
+            <div className="text-sm text-muted-foreground">Tasks completed this week</div>
           </Card>
           <Card className="p-6 text-center">
             <Zap className="w-10 h-10 mx-auto mb-3 text-chart-3" />
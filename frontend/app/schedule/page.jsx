@@ -7,7 +7,7 @@ import { Card, CardContent, CardDescription, CardHeader, CardTitle } from "@/com
 import { Input } from "@/components/ui/input"
 import { getTasks, createTask, deleteTask, transformTask } from "@/lib/api/tasks"
 import { getScheduleBlocks, createScheduleBlock, clearAllScheduleBlocks, transformScheduleBlock, uploadClassSchedule, getAvailableSlots, deleteScheduleBlock } from "@/lib/api/schedule"
-import { breakdownTask, generateAiSchedule } from "@/lib/api/ai"
+import { breakdownTask, streamAiSchedule } from "@/lib/api/ai"
 import { useToast } from "@/hooks/use-toast"
 import { useAuth } from "@/lib/auth-context"
 import {
@@ -168,34 +168,61 @@ export default function SchedulePage() {
     setGenerating(true)
 
     try {
-      // Call backend AI schedule generation endpoint
-      const result = await generateAiSchedule()
+      // Stream blocks from the backend as they are generated
+      let summary = null
+      let streamError = null
+      let streamed = []
+
+      const result = await streamAiSchedule((event, data) => {
+        if (event === "start") {
+          // Keep fixed commitments; task/break blocks are being regenerated
+          setSchedule(prev => prev.filter(block => block.type === "fixed"))
+        } else if (event === "block") {
+          const block = {
+            ...transformScheduleBlock(data),
+            id: `stream-${data.index}`,
+            aiTip: getAITip(data.title)
+          }
+          streamed = [...streamed, block]
+          setSchedule(prev => [...prev, block])
+        } else if (event === "saved") {
+          setSchedule(prev => prev.map(block => {
+            const index = String(block.id).startsWith("stream-") ? block.id.slice(7) : null
+            return index !== null && data.ids[index] !== undefined
+              ? { ...block, id: data.ids[index] }
+              : block
+          }))
+        } else if (event === "done") {
+          summary = data
+        } else if (event === "error") {
+          streamError = data.detail
+        }
+      })
 
-      if (result.blocks && result.blocks.length > 0) {
-        // Transform and add AI tips to blocks
-        const blocksWithTips = result.blocks.map(block => ({
-          ...transformScheduleBlock(block),
-          aiTip: getAITip(block.title)
-        }))
+      if (streamError) {
+        throw new Error(streamError)
+      }
 
-        setSchedule(blocksWithTips)
+      // Plain JSON means there was nothing to schedule
+      summary = summary || result || {}
 
+      if (streamed.length > 0) {
         toast({
           title: "Schedule generated",
-          description: result.message || `Created ${result.blocks.length} task blocks`,
+          description: summary.message || `Created ${streamed.length} task blocks`,
         })
 
-        if (result.unscheduled_tasks > 0) {
+        if (summary.unscheduled_tasks > 0) {
           toast({
             title: "Some tasks could not be scheduled",
-            description: `${result.unscheduled_tasks} task(s) didn't fit in available time slots`,
+            description: `${summary.unscheduled_tasks} task(s) didn't fit in available time slots`,
             variant: "destructive",
           })
         }
       } else {
         toast({
           title: "No schedule generated",
-          description: result.message || "No tasks were scheduled",
+          description: summary.message || "No tasks were scheduled",
         })
       }
     } catch (error) {
@@ -1,4 +1,5 @@
-import { apiRequest } from './config';
+import { apiRequest, apiStream, cachedRequest, dedupedRequest } from './config';
+import { CACHE_TTL, INVALIDATES, invalidate } from './cache';
 
 /**
  * AI API Service
@@ -7,10 +8,12 @@ import { apiRequest } from './config';
 
 /**
  * Get an AI-powered task recommendation
+ * Never cached: every call logs a new recommendation (and supersedes the
+ * previous one), so only simultaneous calls share a response
  */
 export async function getRecommendation(userId = null) {
   const query = userId ? `?user_id=${userId}` : '';
-  return apiRequest(`/ai/recommendation${query}`);
+  return dedupedRequest(`/ai/recommendation${query}`);
 }
 
 /**
@@ -20,6 +23,7 @@ export async function submitFeedback(feedback) {
   return apiRequest('/ai/feedback', {
     method: 'POST',
     body: JSON.stringify(feedback),
+    invalidates: 'feedback',
   });
 }
 
@@ -36,7 +40,7 @@ export async function getStats(userId = null) {
  */
 export async function getPhase(userId = null) {
   const query = userId ? `?user_id=${userId}` : '';
-  return apiRequest(`/ai/phase${query}`);
+  return cachedRequest(`/ai/phase${query}`, { ttl: CACHE_TTL.phase, tags: ['phase'] });
 }
 
 /**
@@ -45,6 +49,7 @@ export async function getPhase(userId = null) {
 export async function inferFeedbackBatch(minAgeHours = 2, limit = 100) {
   return apiRequest(`/ai/infer-feedback?min_age_hours=${minAgeHours}&limit=${limit}`, {
     method: 'POST',
+    invalidates: 'feedback',
   });
 }
 
@@ -63,6 +68,7 @@ export async function persistAgentModels() {
 export async function breakdownTask(taskId) {
   return apiRequest(`/ai/breakdown-task/${taskId}`, {
     method: 'POST',
+    invalidates: 'tasks',
   });
 }
 
@@ -73,6 +79,26 @@ export async function breakdownTask(taskId) {
 export async function generateAiSchedule() {
   return apiRequest('/ai/generate-schedule', {
     method: 'POST',
+    invalidates: 'schedule',
   });
 }
 
+
+/**
+ * Stream a task breakdown; onEvent receives subtask/saved/done/error events.
+ * Resolves to the JSON body if the task was already broken down.
+ */
+export async function streamBreakdownTask(taskId, onEvent) {
+  return apiStream(`/ai/breakdown-task/${taskId}/stream`, onEvent)
+    .finally(() => invalidate(...INVALIDATES.tasks));
+}
+
+/**
+ * Stream an AI-optimized schedule; onEvent receives start/block/saved/done/error
+ * events as blocks are generated. Resolves to the JSON body when there is
+ * nothing to schedule.
+ */
+export async function streamAiSchedule(onEvent) {
+  return apiStream('/ai/generate-schedule/stream', onEvent)
+    .finally(() => invalidate(...INVALIDATES.schedule));
+}
@@ -0,0 +1,159 @@
+/**
+ * Client-side Request Cache
+ *
+ * Keyed stale-while-revalidate cache for GET endpoints, shared by every
+ * component on the page:
+ * - Fresh entries (younger than their TTL) are returned without a request
+ * - Stale entries (within STALE_WINDOW_MS past the TTL) are returned at once
+ *   and refreshed in the background for the next caller
+ * - Older or invalidated entries are refetched before returning
+ * - Concurrent reads of one key share a single in-flight request
+ *
+ * Refetches send the stored ETag as If-None-Match, so an unchanged list
+ * costs a 304 instead of a full body. Mutations invalidate entries by tag
+ * (see invalidate()); invalidated entries keep their ETag for that refetch.
+ *
+ * Cached data is shared between callers - treat it as read-only.
+ *
+ * Only side-effect-free GETs belong here. GET /ai/recommendation logs a
+ * recommendation per call, so it only shares in-flight calls (dedupe()):
+ * a background refresh would log recommendations nobody saw and mark the
+ * displayed one as superseded.
+ */
+
+// Per-resource freshness, in milliseconds
+export const CACHE_TTL = {
+  tasks: 30_000,
+  mood: 60_000,
+  schedule: 60_000,
+  reflections: 60_000,
+  phase: 5 * 60_000,
+};
+
+// How long past its TTL an entry may still be served while it refreshes
+export const STALE_WINDOW_MS = 5 * 60_000;
+
+// What each kind of mutation makes stale
+export const INVALIDATES = {
+  tasks: ['tasks', 'schedule'],
+  mood: ['mood'],
+  schedule: ['schedule'],
+  reflections: ['reflections'],
+  feedback: ['phase'],
+};
+
+const entries = new Map();   // key -> { data, etag, fetchedAt, tags, invalid }
+const inflight = new Map();  // key -> { promise, epoch }
+const shared = new Map();    // key -> promise (dedupe() only)
+let epoch = 0;               // Bumped by every invalidate()
+let resets = 0;              // Bumped by every clearCache()
+let owner = null;            // Auth token the cached data belongs to
+
+/**
+ * Drop everything if the signed-in user changed since the data was cached
+ */
+export function ensureOwner(token) {
+  if (token !== owner) {
+    clearCache();
+    owner = token;
+  }
+}
+
+/**
+ * Read through the cache.
+ *
+ * @param {string} key - Cache key (the endpoint)
+ * @param {(etag: string|null) => Promise<{data: any, etag: string|null, notModified: boolean}>} fetcher
+ * @param {{ttl: number, tags: string[]}} policy
+ * @returns {Promise<any>} Cached or fetched data
+ */
+export async function cachedFetch(key, fetcher, { ttl, tags = [] }) {
+  const entry = entries.get(key);
+  if (entry && !entry.invalid) {
+    const age = Date.now() - entry.fetchedAt;
+    if (age < ttl) {
+      return entry.data;
+    }
+    if (age < ttl + STALE_WINDOW_MS) {
+      revalidate(key, fetcher, tags).catch(() => {});  // Errors surface on the next miss
+      return entry.data;
+    }
+  }
+  return revalidate(key, fetcher, tags);
+}
+
+/**
+ * Share one in-flight request per key between concurrent callers, without
+ * keeping the result (for GETs that are not pure reads).
+ */
+export function dedupe(key, fetcher) {
+  const pending = shared.get(key);
+  if (pending) {
+    return pending;
+  }
+  const promise = fetcher().finally(() => shared.delete(key));
+  shared.set(key, promise);
+  return promise;
+}
+
+/**
+ * Fetch a key (conditionally, if an ETag is stored), sharing a request
+ * already in flight unless an invalidation happened since it started.
+ */
+function revalidate(key, fetcher, tags) {
+  const pending = inflight.get(key);
+  if (pending && pending.epoch === epoch) {
+    return pending.promise;
+  }
+
+  const startedEpoch = epoch;
+  const startedResets = resets;
+  const entry = entries.get(key);
+  const promise = (async () => {
+    try {
+      const result = await fetcher(entry ? entry.etag : null);
+      const data = result.notModified ? entry.data : result.data;
+      if (resets !== startedResets) {
+        return data;  // Cache was cleared (e.g. logout) while this was in flight
+      }
+      entries.set(key, {
+        data,
+        etag: result.notModified ? entry.etag : result.etag,
+        fetchedAt: Date.now(),
+        tags,
+        // The answer may predate a mutation made while it was in flight:
+        // keep it for its ETag, but refetch on the next read
+        invalid: epoch !== startedEpoch,
+      });
+      return data;
+    } finally {
+      if (inflight.get(key)?.promise === promise) {
+        inflight.delete(key);
+      }
+    }
+  })();
+  inflight.set(key, { promise, epoch: startedEpoch });
+  return promise;
+}
+
+/**
+ * Mark every entry carrying one of `tags` as stale. The next read refetches
+ * (with If-None-Match) instead of serving it.
+ */
+export function invalidate(...tags) {
+  epoch += 1;
+  for (const entry of entries.values()) {
+    if (entry.tags.some(tag => tags.includes(tag))) {
+      entry.invalid = true;
+    }
+  }
+}
+
+/**
+ * Drop all cached data (logout, user switch)
+ */
+export function clearCache() {
+  resets += 1;
+  entries.clear();
+  inflight.clear();
+}
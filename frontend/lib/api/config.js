@@ -3,6 +3,7 @@
  */
 
 import { getStoredToken } from '../auth-context';
+import { cachedFetch, dedupe, ensureOwner, invalidate, INVALIDATES } from './cache';
 
 export const API_BASE_URL = process.env.NEXT_PUBLIC_API_URL || 'http://localhost:8000';
 
@@ -55,17 +56,18 @@ function getAuthHeaders() {
 }
 
 /**
- * Helper function to make API requests with automatic auth headers
+ * Send an authenticated request and parse the JSON response.
+ * Resolves to { data, etag, notModified }.
  */
-export async function apiRequest(endpoint, options = {}) {
+async function sendRequest(endpoint, options = {}) {
   const url = `${API_BASE_URL}${endpoint}`;
   const config = {
+    ...options,
     headers: {
       'Content-Type': 'application/json',
       ...getAuthHeaders(),
       ...options.headers,
     },
-    ...options,
   };
 
   // Stringify body if it's an object
@@ -73,49 +75,101 @@ export async function apiRequest(endpoint, options = {}) {
     config.body = JSON.stringify(config.body);
   }
 
-  try {
-    const response = await fetch(url, config);
+  const response = await fetch(url, config);
 
-    // Handle 401 Unauthorized - redirect to login
-    if (response.status === 401) {
-      if (typeof window !== 'undefined') {
-        // Check if we actually have a token - if we do, this might be a stale request
-        // from before login completed. Don't logout in this case.
-        const currentToken = localStorage.getItem('pulse_auth_token');
-        if (!currentToken) {
-          // No token exists - user is definitely logged out
-          localStorage.removeItem('pulse_auth_token');
-          localStorage.removeItem('pulse_user');
-          // Only redirect if not already on auth page
-          if (!window.location.pathname.includes('/auth')) {
-            window.location.href = '/auth';
-          }
+  // Handle 401 Unauthorized - redirect to login
+  if (response.status === 401) {
+    if (typeof window !== 'undefined') {
+      // Check if we actually have a token - if we do, this might be a stale request
+      // from before login completed. Don't logout in this case.
+      const currentToken = localStorage.getItem('pulse_auth_token');
+      if (!currentToken) {
+        // No token exists - user is definitely logged out
+        localStorage.removeItem('pulse_auth_token');
+        localStorage.removeItem('pulse_user');
+        // Only redirect if not already on auth page
+        if (!window.location.pathname.includes('/auth')) {
+          window.location.href = '/auth';
         }
-        // If token exists but request failed, it might be a race condition
-        // Don't logout - let the request fail silently and retry naturally
       }
-      throw new Error('Session expired. Please log in again.');
+      // If token exists but request failed, it might be a race condition
+      // Don't logout - let the request fail silently and retry naturally
     }
+    throw new Error('Session expired. Please log in again.');
+  }
 
-    // Handle 204 No Content (for DELETE requests)
-    if (response.status === 204) {
-      return null;
-    }
+  const etag = response.headers.get('etag');
 
-    const data = await response.json();
+  // Unchanged since the ETag we sent (conditional GET)
+  if (response.status === 304) {
+    return { data: null, etag, notModified: true };
+  }
 
-    if (!response.ok) {
-      const errorMessage = formatErrorDetail(data.detail) || `API Error: ${response.status}`;
-      throw new Error(errorMessage);
-    }
+  // Handle 204 No Content (for DELETE requests)
+  if (response.status === 204) {
+    return { data: null, etag: null, notModified: false };
+  }
+
+  const data = await response.json();
 
+  if (!response.ok) {
+    const errorMessage = formatErrorDetail(data.detail) || `API Error: ${response.status}`;
+    throw new Error(errorMessage);
+  }
+
+  return { data, etag, notModified: false };
+}
+
+/**
+ * Helper function to make API requests with automatic auth headers.
+ * Pass `invalidates` (a key of INVALIDATES, e.g. 'tasks') on mutations so
+ * cached reads they affect are refetched.
+ */
+export async function apiRequest(endpoint, options = {}) {
+  const { invalidates, ...fetchOptions } = options;
+  try {
+    const { data } = await sendRequest(endpoint, fetchOptions);
     return data;
   } catch (error) {
     console.error(`API Request failed: ${endpoint}`, error);
     throw error;
+  } finally {
+    // Also on failure: the write may have applied before the error
+    if (invalidates) {
+      invalidate(...INVALIDATES[invalidates]);
+    }
+  }
+}
+
+/**
+ * Cached GET through the shared request cache (see ./cache.js): repeat
+ * calls within `ttl` share one response, concurrent calls share one
+ * request, and refetches are conditional on the last ETag.
+ *
+ * @param {string} endpoint - API path (also the cache key)
+ * @param {{ttl: number, tags: string[]}} policy - Freshness and invalidation tags
+ */
+export async function cachedRequest(endpoint, policy) {
+  ensureOwner(getStoredToken());
+  try {
+    return await cachedFetch(endpoint, (etag) => sendRequest(endpoint, {
+      cache: 'no-store',  // This layer caches; keep the browser from adding its own validators
+      headers: etag ? { 'If-None-Match': etag } : {},
+    }), policy);
+  } catch (error) {
+    console.error(`API Request failed: ${endpoint}`, error);
+    throw error;
   }
 }
 
+/**
+ * Uncached GET whose concurrent calls share one request (for endpoints
+ * with side effects, e.g. /ai/recommendation). Keyed by user and endpoint.
+ */
+export async function dedupedRequest(endpoint) {
+  return dedupe(`${getStoredToken()} ${endpoint}`, () => apiRequest(endpoint));
+}
+
 /**
  * API request without auth (for public endpoints)
  */
@@ -153,3 +207,69 @@ export async function publicApiRequest(endpoint, options = {}) {
     throw error;
   }
 }
+
+/**
+ * POST to a Server-Sent Events endpoint and dispatch each event as it arrives.
+ * Endpoints may answer with plain JSON instead of a stream (e.g. nothing to
+ * generate); that body is returned as-is without calling onEvent.
+ *
+ * @param {string} endpoint - API path
+ * @param {(event: string, data: object) => void} onEvent - Called per event
+ * @returns {Promise<object|null>} JSON body for non-stream responses, else null
+ */
+export async function apiStream(endpoint, onEvent, options = {}) {
+  const url = `${API_BASE_URL}${endpoint}`;
+  const response = await fetch(url, {
+    method: 'POST',
+    ...options,
+    headers: {
+      'Accept': 'text/event-stream',
+      ...getAuthHeaders(),
+      ...options.headers,
+    },
+  });
+
+  if (response.status === 401) {
+    throw new Error('Session expired. Please log in again.');
+  }
+
+  const contentType = response.headers.get('content-type') || '';
+  if (!response.ok || !contentType.includes('text/event-stream')) {
+    const data = await response.json();
+    if (!response.ok) {
+      throw new Error(formatErrorDetail(data.detail) || `API Error: ${response.status}`);
+    }
+    return data;
+  }
+
+  const reader = response.body.getReader();
+  const decoder = new TextDecoder();
+  let buffer = '';
+
+  // Events are separated by a blank line; each has "event:" and "data:" lines
+  const dispatch = (raw) => {
+    let event = 'message';
+    const dataLines = [];
+    for (const line of raw.split('\n')) {
+      if (line.startsWith('event:')) event = line.slice(6).trim();
+      else if (line.startsWith('data:')) dataLines.push(line.slice(5).trim());
+    }
+    if (dataLines.length > 0) {
+      onEvent(event, JSON.parse(dataLines.join('\n')));
+    }
+  };
+
+  while (true) {
+    const { value, done } = await reader.read();
+    if (done) break;
+    buffer += decoder.decode(value, { stream: true });
+    let boundary;
+    while ((boundary = buffer.indexOf('\n\n')) !== -1) {
+      dispatch(buffer.slice(0, boundary));
+      buffer = buffer.slice(boundary + 2);
+    }
+  }
+  if (buffer.trim()) dispatch(buffer);
+
+  return null;
+}
@@ -0,0 +1,44 @@
+import { apiRequest } from './config';
+
+/**
+ * Insights API Service
+ * Daily per-user rollups; cost depends on the date range, not on history size
+ */
+
+/**
+ * Format a Date as the YYYY-MM-DD (UTC) day the backend rolls up by
+ */
+export function toUtcDay(date) {
+  return date.toISOString().slice(0, 10);
+}
+
+/**
+ * The last `days` UTC days ending today, as { startDate, endDate }
+ */
+export function lastDays(days) {
+  const end = new Date();
+  const start = new Date(end.getTime() - (days - 1) * 24 * 60 * 60 * 1000);
+  return { startDate: toUtcDay(start), endDate: toUtcDay(end) };
+}
+
+function rangeQuery(startDate, endDate) {
+  const params = new URLSearchParams();
+  if (startDate) params.append('start_date', startDate);
+  if (endDate) params.append('end_date', endDate);
+  const query = params.toString();
+  return query ? `?${query}` : '';
+}
+
+/**
+ * Per-day rollups for a range (days without activity are omitted)
+ */
+export async function getDailyInsights(startDate = null, endDate = null) {
+  return apiRequest(`/insights/daily${rangeQuery(startDate, endDate)}`);
+}
+
+/**
+ * Totals for a range: recommendations, rewards, moods, reflections, focus time
+ */
+export async function getInsightsSummary(startDate = null, endDate = null) {
+  return apiRequest(`/insights/summary${rangeQuery(startDate, endDate)}`);
+}
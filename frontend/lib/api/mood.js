@@ -1,4 +1,5 @@
-import { apiRequest } from './config';
+import { apiRequest, cachedRequest } from './config';
+import { CACHE_TTL } from './cache';
 
 /**
  * Mood API Service
@@ -25,7 +26,7 @@ const MOOD_DISPLAY = {
 };
 
 export async function getCurrentMood() {
-  return apiRequest('/mood/current');
+  return cachedRequest('/mood/current', { ttl: CACHE_TTL.mood, tags: ['mood'] });
 }
 
 export async function setMood(moodValue) {
@@ -34,11 +35,12 @@ export async function setMood(moodValue) {
   return apiRequest('/mood', {
     method: 'POST',
     body: JSON.stringify({ mood: backendMood }),
+    invalidates: 'mood',
   });
 }
 
 export async function getMoodHistory(limit = 100) {
-  return apiRequest(`/mood/history?limit=${limit}`);
+  return cachedRequest(`/mood/history?limit=${limit}`, { ttl: CACHE_TTL.mood, tags: ['mood'] });
 }
 
 export async function getMoodCounts(limit = 100) {
@@ -52,6 +54,7 @@ export async function getMostCommonMood(limit = 100) {
 export async function deleteMoodEntry(entryId) {
   return apiRequest(`/mood/${entryId}`, {
     method: 'DELETE',
+    invalidates: 'mood',
   });
 }
 
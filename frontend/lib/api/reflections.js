@@ -1,4 +1,5 @@
-import { apiRequest } from './config';
+import { apiRequest, cachedRequest } from './config';
+import { CACHE_TTL } from './cache';
 
 /**
  * Reflections API Service
@@ -10,11 +11,11 @@ export async function getReflections(limit = null) {
     params.append('limit', limit);
   }
   const query = params.toString();
-  return apiRequest(`/reflections${query ? `?${query}` : ''}`);
+  return cachedRequest(`/reflections${query ? `?${query}` : ''}`, { ttl: CACHE_TTL.reflections, tags: ['reflections'] });
 }
 
 export async function getTodayReflection() {
-  return apiRequest('/reflections/today');
+  return cachedRequest('/reflections/today', { ttl: CACHE_TTL.reflections, tags: ['reflections'] });
 }
 
 export async function getReflection(reflectionId) {
@@ -38,6 +39,7 @@ export async function createReflection(reflectionData) {
   return apiRequest('/reflections', {
     method: 'POST',
     body: JSON.stringify(backendData),
+    invalidates: 'reflections',
   });
 }
 
@@ -56,12 +58,14 @@ export async function updateReflection(reflectionId, reflectionData) {
   return apiRequest(`/reflections/${reflectionId}`, {
     method: 'PATCH',
     body: JSON.stringify(backendData),
+    invalidates: 'reflections',
   });
 }
 
 export async function deleteReflection(reflectionId) {
   return apiRequest(`/reflections/${reflectionId}`, {
     method: 'DELETE',
+    invalidates: 'reflections',
   });
 }
 
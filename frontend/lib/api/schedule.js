@@ -1,4 +1,5 @@
-import { apiRequest } from './config';
+import { apiRequest, cachedRequest } from './config';
+import { CACHE_TTL, INVALIDATES, invalidate } from './cache';
 
 /**
  * Schedule API Service
@@ -10,7 +11,7 @@ export async function getScheduleBlocks(blockType = null) {
     params.append('block_type', blockType);
   }
   const query = params.toString();
-  return apiRequest(`/schedule${query ? `?${query}` : ''}`);
+  return cachedRequest(`/schedule${query ? `?${query}` : ''}`, { ttl: CACHE_TTL.schedule, tags: ['schedule'] });
 }
 
 export async function getScheduleBlocksInRange(startHour, endHour) {
@@ -39,6 +40,7 @@ export async function createScheduleBlock(blockData) {
   return apiRequest('/schedule', {
     method: 'POST',
     body: JSON.stringify(backendData),
+    invalidates: 'schedule',
   });
 }
 
@@ -60,18 +62,21 @@ export async function updateScheduleBlock(blockId, blockData) {
   return apiRequest(`/schedule/${blockId}`, {
     method: 'PATCH',
     body: JSON.stringify(backendData),
+    invalidates: 'schedule',
   });
 }
 
 export async function deleteScheduleBlock(blockId) {
   return apiRequest(`/schedule/${blockId}`, {
     method: 'DELETE',
+    invalidates: 'schedule',
   });
 }
 
 export async function clearAllScheduleBlocks() {
   return apiRequest('/schedule', {
     method: 'DELETE',
+    invalidates: 'schedule',
   });
 }
 
@@ -95,6 +100,7 @@ export async function uploadClassSchedule(file) {
     },
     body: formData,
   });
+  invalidate(...INVALIDATES.schedule);
 
   if (!response.ok) {
     const error = await response.json();
@@ -1,4 +1,5 @@
-import { apiRequest } from './config';
+import { apiRequest, cachedRequest } from './config';
+import { CACHE_TTL } from './cache';
 
 /**
  * Tasks API Service
@@ -10,11 +11,11 @@ export async function getTasks(completed = null) {
     params.append('completed', completed);
   }
   const query = params.toString();
-  return apiRequest(`/tasks${query ? `?${query}` : ''}`);
+  return cachedRequest(`/tasks${query ? `?${query}` : ''}`, { ttl: CACHE_TTL.tasks, tags: ['tasks'] });
 }
 
 export async function getTask(taskId) {
-  return apiRequest(`/tasks/${taskId}`);
+  return cachedRequest(`/tasks/${taskId}`, { ttl: CACHE_TTL.tasks, tags: ['tasks'] });
 }
 
 export async function createTask(taskData) {
@@ -33,6 +34,7 @@ export async function createTask(taskData) {
   return apiRequest('/tasks', {
     method: 'POST',
     body: JSON.stringify(backendData),
+    invalidates: 'tasks',
   });
 }
 
@@ -57,24 +59,28 @@ export async function updateTask(taskId, taskData) {
   return apiRequest(`/tasks/${taskId}`, {
     method: 'PATCH',
     body: JSON.stringify(backendData),
+    invalidates: 'tasks',
   });
 }
 
 export async function deleteTask(taskId) {
   return apiRequest(`/tasks/${taskId}`, {
     method: 'DELETE',
+    invalidates: 'tasks',
   });
 }
 
 export async function toggleTask(taskId) {
   return apiRequest(`/tasks/${taskId}/toggle`, {
     method: 'POST',
+    invalidates: 'tasks',
   });
 }
 
 export async function scheduleTask(taskId, startTime) {
   return apiRequest(`/tasks/${taskId}/schedule?start_time=${startTime}`, {
     method: 'POST',
+    invalidates: 'tasks',
   });
 }
 
@@ -2,6 +2,7 @@
 
 import React, { createContext, useContext, useState, useEffect } from 'react';
 import { API_BASE_URL } from './api/config';
+import { clearCache } from './api/cache';
 
 /**
  * Auth Context for managing user authentication state.
@@ -142,6 +143,7 @@ export function AuthProvider({ children }) {
     const logout = () => {
         localStorage.removeItem(TOKEN_KEY);
         localStorage.removeItem(USER_KEY);
+        clearCache();
         setToken(null);
         setUser(null);
     };
@@ -12,6 +12,10 @@ import aggregator from '../lib/aggregator.js';
 let extensionInitialized = false;
 let dataCollectionActive = false;
 
+// Raw events are folded into hourly aggregates as they arrive; keeping a
+// copy in IndexedDB is only needed for debugging
+const RETAIN_RAW_EVENTS = false;
+
 /**
  * Initialize extension on installation
  */
@@ -131,7 +135,9 @@ async function initializeExtension() {
 }
 
 /**
- * Handle activity events from content scripts
+ * Handle messages from content scripts and extension pages
+ * (single activity_event messages come from content scripts injected
+ * before the coalescer; current ones send batches over a port)
  */
 chrome.runtime.onMessage.addListener((message, sender, sendResponse) => {
   if (message.type === 'activity_event') {
@@ -170,6 +176,54 @@ chrome.runtime.onMessage.addListener((message, sender, sendResponse) => {
   return false;
 });
 
+/**
+ * Receive coalesced activity batches from content scripts over their
+ * long-lived ports (one message per page, hour and flush interval)
+ */
+chrome.runtime.onConnect.addListener((port) => {
+  if (port.name !== 'activity') {
+    return;
+  }
+
+  port.onMessage.addListener((message) => {
+    if (message.type === 'activity_batch') {
+      handleActivityBatch(message.batch, port.sender?.tab);
+    }
+  });
+});
+
+/**
+ * Handle a coalesced batch as one event that counts for all it contains
+ */
+async function handleActivityBatch(batch, tab) {
+  if (!dataCollectionActive || !batch || !(batch.event_count > 0)) {
+    return;
+  }
+
+  try {
+    const event = {
+      event_type: 'activity_batch',
+      url: batch.url,
+      title: batch.title,
+      coalesced_count: batch.event_count,
+      counts: batch.counts,
+      interactions: batch.interactions,
+      durations: batch.durations,
+      first_event_at: batch.first_event_at
+    };
+    if (tab) {
+      event.tab_id = tab.id;
+      event.window_id = tab.windowId;
+    }
+
+    // File the batch under the hour of its last event (a batch never spans
+    // an hour), not the hour it arrived in
+    await recordActivityEvent(event, Math.min(batch.last_event_at || Date.now(), Date.now()));
+  } catch (error) {
+    console.error('Failed to handle activity batch:', error);
+  }
+}
+
 /**
  * Handle activity events
  */
@@ -186,7 +240,7 @@ async function handleActivityEvent(event, tab) {
     }
 
     // Store event
-    await storageManager.addActivityEvent(event);
+    await recordActivityEvent(event);
 
     console.debug('Activity event stored:', event.event_type);
   } catch (error) {
@@ -194,6 +248,24 @@ async function handleActivityEvent(event, tab) {
   }
 }
 
+/**
+ * Fold an event into the streaming hourly aggregate; hours it closes are
+ * stored as sessions right away
+ */
+async function recordActivityEvent(event, timestamp = Date.now()) {
+  const stamped = { ...event, timestamp };
+
+  await aggregator.restore();
+  const closedSessions = aggregator.addEvent(stamped);
+  if (closedSessions.length > 0) {
+    await storageManager.addAggregatedSessions(closedSessions);
+  }
+
+  if (RETAIN_RAW_EVENTS) {
+    await storageManager.addActivityEvent(event);
+  }
+}
+
 /**
  * Track tab activations
  */
@@ -203,7 +275,7 @@ chrome.tabs.onActivated.addListener(async (activeInfo) => {
   try {
     const tab = await chrome.tabs.get(activeInfo.tabId);
 
-    await storageManager.addActivityEvent({
+    await recordActivityEvent({
       event_type: 'tab_activated',
       tab_id: activeInfo.tabId,
       window_id: activeInfo.windowId,
@@ -225,7 +297,7 @@ chrome.tabs.onUpdated.addListener(async (tabId, changeInfo, tab) => {
   // Only track complete loads with URL changes
   if (changeInfo.status === 'complete' && changeInfo.url) {
     try {
-      await storageManager.addActivityEvent({
+      await recordActivityEvent({
         event_type: 'tab_updated',
         tab_id: tabId,
         window_id: tab.windowId,
@@ -246,7 +318,7 @@ chrome.windows.onFocusChanged.addListener(async (windowId) => {
   if (!dataCollectionActive) return;
 
   try {
-    await storageManager.addActivityEvent({
+    await recordActivityEvent({
       event_type: 'window_focus_changed',
       window_id: windowId,
       timestamp: Date.now()
@@ -265,7 +337,7 @@ chrome.idle.onStateChanged.addListener(async (newState) => {
   if (!dataCollectionActive) return;
 
   try {
-    await storageManager.addActivityEvent({
+    await recordActivityEvent({
       event_type: 'idle_state_changed',
       idle_state: newState, // 'active', 'idle', or 'locked'
       timestamp: Date.now()
@@ -287,34 +359,21 @@ chrome.alarms.onAlarm.addListener(async (alarm) => {
 });
 
 /**
- * Aggregate raw events into hourly sessions
+ * Close elapsed hours into sessions (events are aggregated as they arrive)
  */
 async function aggregateData() {
   if (!dataCollectionActive) return;
 
   try {
-    console.log('Aggregating activity data...');
-
-    // Get events from the last hour
-    const oneHourAgo = Date.now() - (60 * 60 * 1000);
-    const events = await storageManager.getActivityEvents(oneHourAgo);
-
-    if (events.length === 0) {
-      console.log('No events to aggregate');
-      return;
-    }
-
-    // Aggregate into sessions
-    const sessions = await aggregator.aggregateEvents(events);
+    await aggregator.restore();
+    const sessions = aggregator.closeCompletedHours();
 
-    // Store aggregated sessions
-    for (const session of sessions) {
-      await storageManager.addAggregatedSession(session);
+    if (sessions.length > 0) {
+      await storageManager.addAggregatedSessions(sessions);
+      console.log(`Closed ${sessions.length} hourly sessions`);
     }
 
-    console.log(`Aggregated ${events.length} events into ${sessions.length} sessions`);
-
-    // Trigger sync after aggregation
+    // Trigger sync after aggregation (also retries earlier unsynced sessions)
     await syncScheduler.syncData();
   } catch (error) {
     console.error('Failed to aggregate data:', error);
@@ -334,6 +393,16 @@ async function cleanupData() {
   }
 }
 
+/**
+ * Save open hours and flush buffered writes before the service worker is unloaded
+ */
+chrome.runtime.onSuspend.addListener(() => {
+  aggregator.persist(true);
+  storageManager.flush().catch((error) => {
+    console.error('Failed to flush activity events on suspend:', error);
+  });
+});
+
 /**
  * Handle extension uninstall (for cleanup tracking)
  */
@@ -0,0 +1,167 @@
+/**
+ * Activity Coalescer Benchmark
+ * Replays a simulated browsing day against a model of the MV3 worker
+ * lifetime: one sendMessage per content event (previous tracker) against
+ * coalesced batches over a port. Tab switches wake the worker through
+ * chrome.tabs in both cases.
+ *
+ * Usage (from pulse-extension/):
+ *   node --experimental-detect-module bench/activity-coalescer.bench.mjs
+ */
+
+const IDLE_TIMEOUT_MS = 30 * 1000; // MV3 worker is unloaded after 30s without events
+const HOURS = 8;
+const TABS = 6;
+
+// Virtual clock and timers so the coalescer's flush timer runs in simulated time
+let clock = Date.UTC(2025, 0, 15, 8, 0, 0);
+const timers = new Map();
+let nextTimerId = 1;
+globalThis.setTimeout = (fn, delay) => {
+  const id = nextTimerId++;
+  timers.set(id, { at: clock + delay, fn });
+  return id;
+};
+globalThis.clearTimeout = (id) => timers.delete(id);
+
+await import('../content/activity-coalescer.js');
+const { PulseActivityCoalescer } = globalThis;
+
+/**
+ * Deterministic PRNG (mulberry32)
+ */
+function random(seed) {
+  return () => {
+    seed = (seed + 0x6D2B79F5) | 0;
+    let t = Math.imul(seed ^ (seed >>> 15), 1 | seed);
+    t = (t + Math.imul(t ^ (t >>> 7), 61 | t)) ^ t;
+    return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+  };
+}
+
+/**
+ * Events the tracker emits (after its debouncing): [time, tab, type, url]
+ */
+function buildTrace() {
+  const rand = random(42);
+  const end = clock + HOURS * 60 * 60 * 1000;
+  const urls = Array.from({ length: TABS }, (_, tab) => `https://site${tab}.example.com/`);
+  const trace = [];
+  let active = 0;
+
+  for (let t = clock; t < end;) {
+    // Stay on a tab for 1-8 minutes: interactions every 2-20s, sometimes idle
+    const stay = (1 + rand() * 7) * 60 * 1000;
+    const stayEnd = Math.min(t + stay, end);
+    trace.push([t, active, 'tab_activated', urls[active]]); // chrome.tabs, not the content script
+    trace.push([t, active, 'page_visible', urls[active]]);
+    trace.push([t, active, 'window_focused', urls[active]]);
+
+    while (t < stayEnd) {
+      if (rand() < 0.03) {
+        // Idle for a few minutes: idle_detected once a minute after 5 minutes
+        const idle = (5 + rand() * 5) * 60 * 1000;
+        for (let at = t + 5 * 60 * 1000; at < t + idle; at += 60 * 1000) {
+          trace.push([at, active, 'idle_detected', urls[active]]);
+        }
+        t += idle;
+      } else {
+        t += 2000 + rand() * 18000;
+      }
+      if (rand() < 0.02) {
+        urls[active] = `https://site${active}.example.com/page${Math.floor(rand() * 100)}`;
+        trace.push([t, active, 'url_changed', urls[active]]);
+      }
+      trace.push([t, active, 'user_interaction', urls[active]]);
+    }
+
+    trace.push([t, active, 'window_blurred', urls[active]]);
+    trace.push([t, active, 'page_hidden', urls[active]]);
+    active = Math.floor(rand() * TABS);
+  }
+  return trace;
+}
+
+/**
+ * Counts content script messages, wakeups of an unloaded worker and the
+ * time the worker stays loaded
+ */
+class WorkerModel {
+  constructor() {
+    this.messages = 0;
+    this.wakeups = 0;
+    this.events = 0;
+    this.awakeMs = 0;
+    this.lastEventAt = -Infinity;
+  }
+
+  receive(at, events, fromContent = true) {
+    if (fromContent) {
+      this.messages++;
+      this.events += events;
+    }
+    const gap = at - this.lastEventAt;
+    if (gap > IDLE_TIMEOUT_MS) {
+      this.wakeups++;
+    }
+    this.awakeMs += Math.min(gap, IDLE_TIMEOUT_MS);
+    this.lastEventAt = at;
+  }
+}
+
+/**
+ * Advance the virtual clock, firing due flush timers in order
+ */
+function advanceTo(time) {
+  for (;;) {
+    let due = null;
+    for (const [id, timer] of timers) {
+      if (timer.at <= time && (!due || timer.at < due[1].at)) {
+        due = [id, timer];
+      }
+    }
+    if (!due) break;
+    timers.delete(due[0]);
+    clock = due[1].at;
+    due[1].fn();
+  }
+  clock = time;
+}
+
+const trace = buildTrace();
+
+const perEvent = new WorkerModel();
+for (const [at, , type] of trace) {
+  perEvent.receive(at, 1, type !== 'tab_activated');
+}
+
+const coalesced = new WorkerModel();
+const pages = Array.from({ length: TABS }, () => ({ url: null, title: '' }));
+const coalescers = pages.map((page) => new PulseActivityCoalescer(
+  (batch) => coalesced.receive(clock, batch.event_count),
+  { getPage: () => page, now: () => clock }
+));
+for (const [at, tab, type, url] of trace) {
+  advanceTo(at);
+  if (type === 'tab_activated') {
+    coalesced.receive(at, 1, false);
+    continue;
+  }
+  pages[tab].url = url;
+  coalescers[tab].record(type);
+  if (type === 'page_hidden') {
+    coalescers[tab].flush(); // The tracker flushes when the page is hidden
+  }
+}
+advanceTo(Infinity);
+
+const contentEvents = trace.filter(([, , type]) => type !== 'tab_activated').length;
+console.log(`${contentEvents} content events from ${TABS} tabs over ${HOURS}h`);
+for (const [label, model] of [['sendMessage per event', perEvent], ['coalesced over port', coalesced]]) {
+  const awake = (model.awakeMs + IDLE_TIMEOUT_MS) / (HOURS * 60 * 60 * 1000);
+  console.log(
+    `${label.padEnd(22)} ${String(model.messages).padStart(6)} messages ` +
+    `${String(model.wakeups).padStart(5)} wakeups  worker loaded ${(awake * 100).toFixed(0).padStart(3)}% ` +
+    `(${model.events} events delivered)`
+  );
+}
@@ -0,0 +1,108 @@
+/**
+ * Activity Coalescer
+ * Folds page activity into one batch per page and hour. activity-tracker.js
+ * flushes the batch to the background worker on a fixed cadence.
+ *
+ * Loaded before activity-tracker.js, in the same content script world.
+ */
+
+(function(root) {
+  'use strict';
+
+  const COALESCER_CONFIG = {
+    FLUSH_INTERVAL_MS: 5 * 60 * 1000, // Lets the worker unload (30s idle timeout) between flushes
+    PORT_NAME: 'activity'
+  };
+
+  /**
+   * Start of the next local clock hour (batches never span an hour, so the
+   * aggregator can file each one under a single hour)
+   */
+  function nextHourStart(timestamp) {
+    const date = new Date(timestamp);
+    date.setMinutes(60, 0, 0);
+    return date.getTime();
+  }
+
+  class ActivityCoalescer {
+    /**
+     * @param {Function} send - Called with each non-empty batch
+     * @param {Object} [options]
+     * @param {Function} [options.getPage] - Returns the current { url, title }
+     * @param {Function} [options.now] - Clock (ms)
+     * @param {number} [options.flushIntervalMs] - Longest time a batch stays open
+     */
+    constructor(send, options = {}) {
+      this.send = send;
+      this.getPage = options.getPage || (() => ({ url: window.location.href, title: document.title }));
+      this.now = options.now || Date.now;
+      this.flushIntervalMs = options.flushIntervalMs ?? COALESCER_CONFIG.FLUSH_INTERVAL_MS;
+
+      this.batch = null;
+      this.flushTimer = null;
+    }
+
+    /**
+     * Count one activity event. Fields named duration_* are summed, and
+     * interaction_type is counted per type.
+     */
+    record(eventType, data = {}) {
+      const now = this.now();
+      const page = this.getPage();
+
+      // A new page or hour starts a new batch
+      if (this.batch && (this.batch.url !== page.url || now >= this.batch.hourEnd)) {
+        this.flush();
+      }
+      if (!this.batch) {
+        this.batch = {
+          url: page.url,
+          title: page.title,
+          first_event_at: now,
+          last_event_at: now,
+          hourEnd: nextHourStart(now),
+          event_count: 0,
+          counts: {},
+          interactions: {},
+          durations: {}
+        };
+        this.flushTimer = setTimeout(() => this.flush(), this.flushIntervalMs);
+      }
+
+      const batch = this.batch;
+      batch.event_count++;
+      batch.last_event_at = now;
+      batch.title = page.title;
+      batch.counts[eventType] = (batch.counts[eventType] || 0) + 1;
+
+      for (const key in data) {
+        if (key.startsWith('duration_') && typeof data[key] === 'number') {
+          batch.durations[key] = (batch.durations[key] || 0) + data[key];
+        }
+      }
+      if (data.interaction_type) {
+        batch.interactions[data.interaction_type] = (batch.interactions[data.interaction_type] || 0) + 1;
+      }
+    }
+
+    /**
+     * Hand the open batch to `send` (no-op when nothing was recorded)
+     */
+    flush() {
+      if (this.flushTimer) {
+        clearTimeout(this.flushTimer);
+        this.flushTimer = null;
+      }
+      if (!this.batch) {
+        return;
+      }
+
+      const { hourEnd, ...batch } = this.batch;
+      this.batch = null;
+      this.send(batch);
+    }
+  }
+
+  root.PulseActivityCoalescer = ActivityCoalescer;
+  root.PULSE_COALESCER_CONFIG = COALESCER_CONFIG;
+})(globalThis);
@@ -1,6 +1,7 @@
 /**
  * Activity Tracker Content Script
- * Monitors user activity on web pages and sends events to background worker
+ * Monitors user activity on web pages and sends it to the background worker
+ * in coalesced batches (see activity-coalescer.js)
  */
 
 (function() {
@@ -13,22 +14,41 @@
   let sessionStartTime = Date.now();
 
   /**
-   * Send activity event to background worker
+   * Long-lived port to the background worker, opened on the first flush.
+   * It drops when the worker is unloaded and is reopened by the next flush.
    */
-  function sendActivityEvent(eventType, data = {}) {
-    chrome.runtime.sendMessage({
-      type: 'activity_event',
-      event: {
-        event_type: eventType,
-        url: window.location.href,
-        title: document.title,
-        timestamp: Date.now(),
-        ...data
+  let port = null;
+
+  function postBatch(batch) {
+    for (let attempt = 0; attempt < 2; attempt++) {
+      try {
+        if (!port) {
+          port = chrome.runtime.connect({ name: PULSE_COALESCER_CONFIG.PORT_NAME });
+          port.onDisconnect.addListener(() => {
+            port = null;
+          });
+        }
+        port.postMessage({ type: 'activity_batch', batch });
+        return;
+      } catch (error) {
+        // Stale port (retry once on a new one) or extension context invalidated
+        port = null;
+        if (attempt === 1) {
+          console.debug('Failed to send activity batch:', error);
+        }
       }
-    }).catch(error => {
-      // Extension context may be invalidated, ignore
-      console.debug('Failed to send activity event:', error);
-    });
+    }
+  }
+
+  // Events are counted locally and reach the worker in one message per
+  // page, hour and flush interval instead of one message each
+  const coalescer = new PulseActivityCoalescer(postBatch);
+
+  /**
+   * Record an activity event for the next batch
+   */
+  function recordActivity(eventType, data = {}) {
+    coalescer.record(eventType, data);
   }
 
   /**
@@ -40,16 +60,19 @@
 
     if (pageVisible && !wasVisible) {
       // Page became visible
-      sendActivityEvent('page_visible', {
+      recordActivity('page_visible', {
         duration_hidden: Date.now() - lastActivityTime
       });
       lastActivityTime = Date.now();
     } else if (!pageVisible && wasVisible) {
       // Page became hidden
-      sendActivityEvent('page_hidden', {
+      recordActivity('page_hidden', {
         duration_visible: Date.now() - lastActivityTime
       });
       lastActivityTime = Date.now();
+
+      // The tab may never become visible again: send what we have
+      coalescer.flush();
     }
   });
 
@@ -59,7 +82,7 @@
   window.addEventListener('focus', () => {
     if (!pageFocused) {
       pageFocused = true;
-      sendActivityEvent('window_focused', {
+      recordActivity('window_focused', {
         duration_blurred: Date.now() - lastActivityTime
       });
       lastActivityTime = Date.now();
@@ -69,7 +92,7 @@
   window.addEventListener('blur', () => {
     if (pageFocused) {
       pageFocused = false;
-      sendActivityEvent('window_blurred', {
+      recordActivity('window_blurred', {
         duration_focused: Date.now() - lastActivityTime
       });
       lastActivityTime = Date.now();
@@ -88,7 +111,7 @@
     }
 
     interactionTimeout = setTimeout(() => {
-      sendActivityEvent('user_interaction', {
+      recordActivity('user_interaction', {
         interaction_type: eventType,
         time_since_last: Date.now() - lastActivityTime
       });
@@ -131,7 +154,7 @@
     const timeSinceLastActivity = Date.now() - lastActivityTime;
 
     if (timeSinceLastActivity > IDLE_THRESHOLD && pageVisible) {
-      sendActivityEvent('idle_detected', {
+      recordActivity('idle_detected', {
         idle_duration: timeSinceLastActivity
       });
     }
@@ -142,20 +165,22 @@
 
   /**
    * Track session duration when page unloads
+   * (pagehide also fires for pages entering the back/forward cache)
    */
-  window.addEventListener('beforeunload', () => {
+  window.addEventListener('pagehide', () => {
     const sessionDuration = Date.now() - sessionStartTime;
 
-    sendActivityEvent('page_unload', {
+    recordActivity('page_unload', {
       session_duration: sessionDuration,
       total_visible_time: pageVisible ? sessionDuration : 0
     });
+    coalescer.flush();
   });
 
   /**
    * Initial page load event
    */
-  sendActivityEvent('page_load', {
+  recordActivity('page_load', {
     referrer: document.referrer || 'direct',
     is_visible: pageVisible,
     is_focused: pageFocused
@@ -170,7 +195,7 @@
     const currentUrl = window.location.href;
 
     if (currentUrl !== lastUrl) {
-      sendActivityEvent('url_changed', {
+      recordActivity('url_changed', {
         previous_url: lastUrl,
         new_url: currentUrl,
         change_type: 'spa_navigation'
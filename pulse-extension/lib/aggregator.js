@@ -5,198 +5,311 @@
 
 import categoryDB from './category-db.js';
 
-class Aggregator {
-  constructor() {
-    this.currentSession = null;
+const HOUR_MS = 60 * 60 * 1000;
+const MINUTE_MS = 60 * 1000;
+
+const AGGREGATION_CONFIG = {
+  CATEGORY_GAP_CAP_MS: 10 * MINUTE_MS, // Cap per tab interval to avoid idle time inflation
+  FOCUS_GAP_CAP_MS: 30 * MINUTE_MS,    // Cap per focus interval
+  PERSIST_DELAY_MS: 5000,              // Debounce for saving open hours to chrome.storage
+  STORAGE_KEY: 'openAggregationHours',
+};
+
+/**
+ * Running totals for one local clock hour.
+ * Every field is updated in O(1) per event, so closing the hour never
+ * revisits raw events.
+ */
+class HourAccumulator {
+  constructor(hourKey, start) {
+    this.hourKey = hourKey;
+    this.start = start;
+    this.end = start + HOUR_MS;
+
+    this.categoryMs = { work: 0, leisure: 0, social: 0, neutral: 0 };
+    this.lastTabEventAt = null;   // Last tab_activated/tab_updated timestamp
+    this.lastCategory = null;     // Category of the last categorized tab URL
+
+    this.tabSwitches = 0;
+    this.windowFocusChanges = 0;
+    this.lastActivationAt = null; // Last tab_activated timestamp
+    this.focusMinutesSum = 0;
+    this.focusCount = 0;
+
+    this.domains = new Set();
+    this.eventCount = 0;
   }
 
   /**
-   * Aggregate events into hourly sessions
+   * Fold one event into the totals (events should arrive in time order)
    */
-  async aggregateEvents(events) {
-    if (!events || events.length === 0) {
-      return [];
+  add(event) {
+    this.eventCount += event.coalesced_count || 1; // Batches from content scripts stand for many events
+    const type = event.event_type;
+
+    let hostname = null;
+    if (event.url) {
+      try {
+        hostname = new URL(event.url).hostname;
+        this.domains.add(hostname);
+      } catch (error) {
+        // Invalid URL, skip
+      }
     }
 
-    // Group events by hour
-    const hourlyGroups = this.groupByHour(events);
-
-    // Convert each hourly group into an aggregated session
-    const sessions = [];
-    for (const [hourKey, hourEvents] of Object.entries(hourlyGroups)) {
-      const session = this.createSessionFromEvents(hourKey, hourEvents);
-      sessions.push(session);
+    if (type === 'tab_activated' || type === 'tab_updated') {
+      if (this.lastTabEventAt !== null && this.lastCategory) {
+        const duration = Math.max(0, event.timestamp - this.lastTabEventAt);
+        this.categoryMs[this.lastCategory] += Math.min(duration, AGGREGATION_CONFIG.CATEGORY_GAP_CAP_MS);
+      }
+      if (event.url) {
+        this.lastCategory = categoryDB.categorizeUrl(event.url).category;
+      }
+      this.lastTabEventAt = event.timestamp;
     }
 
-    return sessions;
+    if (type === 'tab_activated') {
+      this.tabSwitches++;
+      if (this.lastActivationAt !== null) {
+        const duration = Math.max(0, event.timestamp - this.lastActivationAt);
+        this.focusMinutesSum += Math.min(duration, AGGREGATION_CONFIG.FOCUS_GAP_CAP_MS) / MINUTE_MS;
+        this.focusCount++;
+      }
+      this.lastActivationAt = event.timestamp;
+    } else if (type === 'window_focus_changed') {
+      this.windowFocusChanges++;
+    }
   }
 
   /**
-   * Group events by hour
+   * Build the aggregated session for this hour
    */
-  groupByHour(events) {
-    const groups = {};
+  toSession(now = Date.now()) {
+    const categoryTime = {};
+    for (const category in this.categoryMs) {
+      categoryTime[category] = Math.round(this.categoryMs[category] / MINUTE_MS);
+    }
 
-    for (const event of events) {
-      const hourKey = this.getHourKey(event.timestamp);
+    const avgFocusDuration = this.focusCount > 0 ? this.focusMinutesSum / this.focusCount : 0;
+    const sessionDuration = 60; // minutes
+    const distractionRate = (this.tabSwitches / sessionDuration) * 60; // Per hour
 
-      if (!groups[hourKey]) {
-        groups[hourKey] = [];
-      }
+    return {
+      session_id: `session_${this.hourKey}_${now}`,
+      timestamp: this.start,
+      hour: this.hourKey,
+      duration_minutes: 60,
+      category_distribution: categoryTime,
+      metrics: {
+        tab_switches: this.tabSwitches,
+        window_focus_changes: this.windowFocusChanges,
+        avg_focus_duration_minutes: Math.round(avgFocusDuration),
+        distraction_rate_per_hour: Math.round(distractionRate * 10) / 10, // 1 decimal
+        unique_domains: this.domains.size
+      },
+      event_count: this.eventCount,
+      synced: false,
+      created_at: now
+    };
+  }
 
-      groups[hourKey].push(event);
-    }
+  toJSON() {
+    return { ...this, domains: Array.from(this.domains) };
+  }
+
+  static fromJSON(data) {
+    const acc = new HourAccumulator(data.hourKey, data.start);
+    Object.assign(acc, data, { domains: new Set(data.domains) });
+    return acc;
+  }
+}
+
+class Aggregator {
+  constructor() {
+    this.currentSession = null;
 
-    return groups;
+    // Streaming state: open hours keyed by hour start (ms)
+    this.openHours = new Map();
+    this.currentHour = null;   // Accumulator for the most recent hour seen
+    this.persistTimer = null;
+    this.restored = null;
   }
 
+  // ===========================================================================
+  // Streaming aggregation
+  // ===========================================================================
+
   /**
-   * Get hour key from timestamp (e.g., "2025-01-15T14")
+   * Load open hours saved before the service worker was last unloaded
    */
-  getHourKey(timestamp) {
-    const date = new Date(timestamp);
-    const year = date.getFullYear();
-    const month = String(date.getMonth() + 1).padStart(2, '0');
-    const day = String(date.getDate()).padStart(2, '0');
-    const hour = String(date.getHours()).padStart(2, '0');
+  async restore() {
+    if (!this.restored) {
+      this.restored = (async () => {
+        try {
+          const result = await chrome.storage.local.get(AGGREGATION_CONFIG.STORAGE_KEY);
+          for (const data of result[AGGREGATION_CONFIG.STORAGE_KEY] || []) {
+            const acc = HourAccumulator.fromJSON(data);
+            if (!this.openHours.has(acc.start)) {
+              this.openHours.set(acc.start, acc);
+            }
+          }
+        } catch (error) {
+          console.error('Failed to restore aggregation state:', error);
+        }
+      })();
+    }
+    return this.restored;
+  }
 
-    return `${year}-${month}-${day}T${hour}`;
+  /**
+   * Save open hours to chrome.storage (debounced unless immediate)
+   */
+  async persist(immediate = false) {
+    if (this.persistTimer) {
+      clearTimeout(this.persistTimer);
+      this.persistTimer = null;
+    }
+    if (!immediate) {
+      this.persistTimer = setTimeout(() => this.persist(true), AGGREGATION_CONFIG.PERSIST_DELAY_MS);
+      return;
+    }
+    try {
+      await chrome.storage.local.set({
+        [AGGREGATION_CONFIG.STORAGE_KEY]: Array.from(this.openHours.values(), (acc) => acc.toJSON())
+      });
+    } catch (error) {
+      console.error('Failed to persist aggregation state:', error);
+    }
   }
 
   /**
-   * Create aggregated session from events
+   * Drop all open hours (local data deletion)
    */
-  createSessionFromEvents(hourKey, events) {
-    const startTime = new Date(hourKey).getTime();
-    const endTime = startTime + (60 * 60 * 1000); // +1 hour
+  async reset() {
+    await this.restore();
+    this.openHours.clear();
+    this.currentHour = null;
+    await this.persist(true);
+  }
 
-    // Calculate category time distribution
-    const categoryTime = this.calculateCategoryTime(events);
+  /**
+   * Fold one activity event into its hour.
+   * The first event of a new hour closes every earlier open hour.
+   *
+   * @returns {Array} Sessions for hours closed by this event (usually empty)
+   */
+  addEvent(event) {
+    const previous = this.currentHour;
+
+    // A late event for an hour that was already closed into a session goes
+    // into the current hour rather than reopening the old one
+    if (previous && event.timestamp < previous.start &&
+        !this.openHours.has(this.getHourStart(event.timestamp))) {
+      event = { ...event, timestamp: previous.start };
+    }
 
-    // Calculate behavioral metrics
-    const metrics = this.calculateMetrics(events);
+    const acc = this._accumulate(this.openHours, event, previous);
 
-    // Generate unique session ID
-    const sessionId = `session_${hourKey}_${Date.now()}`;
+    let closed = [];
+    if (!previous || acc.start > previous.start) {
+      this.currentHour = acc;
+      if (previous) {
+        closed = this.closeCompletedHours(acc.start);
+      }
+    }
 
-    return {
-      session_id: sessionId,
-      timestamp: startTime,
-      hour: hourKey,
-      duration_minutes: 60,
-      category_distribution: categoryTime,
-      metrics,
-      event_count: events.length,
-      synced: false,
-      created_at: Date.now()
-    };
+    this.persist();
+    return closed;
   }
 
   /**
-   * Calculate time spent per category
+   * Close every open hour that ended at or before `now`
+   *
+   * @returns {Array} Aggregated sessions for the closed hours, oldest first
    */
-  calculateCategoryTime(events) {
-    const categoryTime = {
-      work: 0,
-      leisure: 0,
-      social: 0,
-      neutral: 0
-    };
-
-    let lastEvent = null;
-    let lastCategory = null;
-
-    for (const event of events.sort((a, b) => a.timestamp - b.timestamp)) {
-      if (event.event_type === 'tab_activated' || event.event_type === 'tab_updated') {
-        // Calculate time since last event
-        if (lastEvent && lastCategory) {
-          const duration = event.timestamp - lastEvent.timestamp;
-          // Cap at 10 minutes to avoid idle time inflation
-          const cappedDuration = Math.min(duration, 10 * 60 * 1000);
-          categoryTime[lastCategory] += cappedDuration;
-        }
+  closeCompletedHours(now = Date.now()) {
+    const sessions = [];
 
-        // Categorize current URL
-        if (event.url) {
-          const categoryInfo = categoryDB.categorizeUrl(event.url);
-          lastCategory = categoryInfo.category;
+    for (const [start, acc] of Array.from(this.openHours).sort((a, b) => a[0] - b[0])) {
+      if (acc.end <= now) {
+        sessions.push(acc.toSession());
+        this.openHours.delete(start);
+        if (this.currentHour === acc) {
+          this.currentHour = null;
         }
-
-        lastEvent = event;
       }
     }
 
-    // Convert milliseconds to minutes
-    for (const category in categoryTime) {
-      categoryTime[category] = Math.round(categoryTime[category] / (60 * 1000));
+    if (sessions.length > 0) {
+      this.persist(true);
     }
-
-    return categoryTime;
+    return sessions;
   }
 
   /**
-   * Calculate behavioral metrics
+   * Add an event to its hour's accumulator in `hours`.
+   * Hour bounds are computed only when an event falls outside `last`'s
+   * hour, i.e. once per hour rather than once per event.
+   *
+   * @returns {HourAccumulator} The accumulator the event went into
    */
-  calculateMetrics(events) {
-    const tabSwitches = events.filter(e => e.event_type === 'tab_activated').length;
-    const windowFocusChanges = events.filter(e => e.event_type === 'window_focus_changed').length;
-
-    // Calculate focus duration (time without switches)
-    const focusDurations = this.calculateFocusDurations(events);
-    const avgFocusDuration = focusDurations.length > 0
-      ? focusDurations.reduce((a, b) => a + b, 0) / focusDurations.length
-      : 0;
-
-    // Calculate distraction rate (switches per hour)
-    const sessionDuration = 60; // minutes
-    const distractionRate = (tabSwitches / sessionDuration) * 60; // Per hour
-
-    return {
-      tab_switches: tabSwitches,
-      window_focus_changes: windowFocusChanges,
-      avg_focus_duration_minutes: Math.round(avgFocusDuration),
-      distraction_rate_per_hour: Math.round(distractionRate * 10) / 10, // 1 decimal
-      unique_domains: this.countUniqueDomains(events)
-    };
+  _accumulate(hours, event, last) {
+    let acc = last;
+    if (!acc || event.timestamp < acc.start || event.timestamp >= acc.end) {
+      const start = this.getHourStart(event.timestamp);
+      acc = hours.get(start);
+      if (!acc) {
+        acc = new HourAccumulator(this.getHourKey(start), start);
+        hours.set(start, acc);
+      }
+    }
+    acc.add(event);
+    return acc;
   }
 
+  // ===========================================================================
+  // Batch aggregation
+  // ===========================================================================
+
   /**
-   * Calculate focus durations (time between tab switches)
+   * Aggregate events into hourly sessions
    */
-  calculateFocusDurations(events) {
-    const durations = [];
-    const activationEvents = events
-      .filter(e => e.event_type === 'tab_activated')
-      .sort((a, b) => a.timestamp - b.timestamp);
-
-    for (let i = 1; i < activationEvents.length; i++) {
-      const duration = activationEvents[i].timestamp - activationEvents[i - 1].timestamp;
-      // Cap at 30 minutes to avoid idle time
-      const cappedDuration = Math.min(duration, 30 * 60 * 1000);
-      durations.push(cappedDuration / (60 * 1000)); // Convert to minutes
+  async aggregateEvents(events) {
+    if (!events || events.length === 0) {
+      return [];
     }
 
-    return durations;
+    // Same accumulators as the streaming path, over a private map
+    const hours = new Map();
+    let last = null;
+    for (const event of [...events].sort((a, b) => a.timestamp - b.timestamp)) {
+      last = this._accumulate(hours, event, last);
+    }
+
+    const now = Date.now();
+    return Array.from(hours.values(), (acc) => acc.toSession(now));
   }
 
   /**
-   * Count unique domains visited
+   * Start of the local clock hour containing the timestamp
    */
-  countUniqueDomains(events) {
-    const domains = new Set();
+  getHourStart(timestamp) {
+    const date = new Date(timestamp);
+    date.setMinutes(0, 0, 0);
+    return date.getTime();
+  }
 
-    for (const event of events) {
-      if (event.url) {
-        try {
-          const url = new URL(event.url);
-          domains.add(url.hostname);
-        } catch (error) {
-          // Invalid URL, skip
-        }
-      }
-    }
+  /**
+   * Get hour key from timestamp (e.g., "2025-01-15T14")
+   */
+  getHourKey(timestamp) {
+    const date = new Date(timestamp);
+    const year = date.getFullYear();
+    const month = String(date.getMonth() + 1).padStart(2, '0');
+    const day = String(date.getDate()).padStart(2, '0');
+    const hour = String(date.getHours()).padStart(2, '0');
 
-    return domains.size;
+    return `${year}-${month}-${day}T${hour}`;
   }
 
   /**
@@ -261,22 +374,14 @@ class Aggregator {
    * Aggregate current active session (real-time)
    */
   async getCurrentSessionSummary() {
-    // This would aggregate the last hour of activity on-demand
-    const storageManager = (await import('./storage-manager.js')).default;
-    await storageManager.init();
-
-    const oneHourAgo = Date.now() - (60 * 60 * 1000);
-    const recentEvents = await storageManager.getActivityEvents(oneHourAgo);
-
-    if (recentEvents.length === 0) {
-      return null;
-    }
+    await this.restore();
 
-    const hourKey = this.getHourKey(Date.now());
-    return this.createSessionFromEvents(hourKey, recentEvents);
+    const acc = this.openHours.get(this.getHourStart(Date.now()));
+    return acc ? acc.toSession() : null;
   }
 }
 
 // Export singleton instance
 const aggregator = new Aggregator();
+export { Aggregator, HourAccumulator, AGGREGATION_CONFIG };
 export default aggregator;
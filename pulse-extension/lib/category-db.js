@@ -144,6 +144,38 @@ const PATH_PATTERNS = {
   leisure: ['/watch/', '/video/', '/play/', '/game/'],
 };
 
+/**
+ * Compile an ordered list of regex sources into one matcher.
+ * Each rule becomes a lookahead that may match anywhere in the input,
+ * followed by an empty named group (r0, r1, ...). Alternation tries rules
+ * in order, so the one defined group names the first rule that matches.
+ */
+function compileOrderedMatcher(sources) {
+  const combined = new RegExp(
+    '^(?:' + sources.map((source, i) => `(?=[\\s\\S]*?(?:${source}))(?<r${i}>)`).join('|') + ')'
+  );
+  return (input) => {
+    const match = combined.exec(input);
+    if (!match) return -1;
+    for (let i = 0; i < sources.length; i++) {
+      if (match.groups[`r${i}`] !== undefined) return i;
+    }
+    return -1;
+  };
+}
+
+function escapeRegExp(text) {
+  return text.replace(/[.*+?^${}()|[\]\\]/g, '\\$&');
+}
+
+// One matcher for all hostname heuristics, one for all path patterns
+// (path categories keep their declaration order as priority)
+const matchHeuristic = compileOrderedMatcher(HEURISTIC_RULES.map((rule) => rule.pattern.source));
+const PATH_CATEGORIES = Object.keys(PATH_PATTERNS);
+const matchPathCategory = compileOrderedMatcher(
+  PATH_CATEGORIES.map((category) => PATH_PATTERNS[category].map(escapeRegExp).join('|'))
+);
+
 class CategoryDatabase {
   constructor() {
     this.userOverrides = {};
@@ -197,21 +229,16 @@ class CategoryDatabase {
         return this.userOverrides[domain];
       }
 
-      // Tier 1: Curated domains
-      if (CURATED_DOMAINS[domain]) {
-        return CURATED_DOMAINS[domain];
-      }
-
-      // Check for wildcard matches in curated domains
-      const wildcardMatch = this.findWildcardMatch(domain);
-      if (wildcardMatch) {
-        return wildcardMatch;
+      // Tier 1 and hostname heuristics depend only on the hostname
+      const hostMatch = this.lookupHost(urlObj.hostname, domain);
+      if (hostMatch) {
+        return hostMatch;
       }
 
-      // Tier 2: Heuristic rules
-      const heuristicMatch = this.applyHeuristics(urlObj.hostname, path);
-      if (heuristicMatch) {
-        return heuristicMatch;
+      // Tier 2: Path heuristics
+      const pathMatch = this.applyPathHeuristics(path);
+      if (pathMatch) {
+        return pathMatch;
       }
 
       // Default: neutral
@@ -242,47 +269,66 @@ class CategoryDatabase {
   }
 
   /**
-   * Find wildcard match in curated domains
+   * Curated or hostname-heuristic match (null = fall through to path)
+   */
+  lookupHost(hostname, domain) {
+    return this.findWildcardMatch(domain) || this.applyHostHeuristics(hostname);
+  }
+
+  /**
+   * Find the most specific curated domain the domain equals or is a subdomain of
+   * (hash lookup per label suffix: a.b.example.com, b.example.com, example.com)
    */
   findWildcardMatch(domain) {
-    // Check if any curated domain is a suffix of the current domain
-    for (const [curatedDomain, metadata] of Object.entries(CURATED_DOMAINS)) {
-      if (domain.endsWith(curatedDomain)) {
-        return metadata;
+    let suffix = domain;
+    while (true) {
+      if (Object.prototype.hasOwnProperty.call(CURATED_DOMAINS, suffix)) {
+        return CURATED_DOMAINS[suffix];
       }
+      const dot = suffix.indexOf('.');
+      if (dot === -1) {
+        return null;
+      }
+      suffix = suffix.substring(dot + 1);
     }
-    return null;
   }
 
   /**
    * Apply heuristic rules
    */
   applyHeuristics(hostname, path) {
-    // Check domain patterns
-    for (const rule of HEURISTIC_RULES) {
-      if (rule.pattern.test(hostname)) {
-        return {
-          category: rule.category,
-          confidence: rule.confidence,
-          source: 'heuristic'
-        };
-      }
-    }
+    return this.applyHostHeuristics(hostname) || this.applyPathHeuristics(path);
+  }
 
-    // Check path patterns
-    for (const [category, patterns] of Object.entries(PATH_PATTERNS)) {
-      for (const pattern of patterns) {
-        if (path.includes(pattern)) {
-          return {
-            category,
-            confidence: 0.7,
-            source: 'heuristic_path'
-          };
-        }
-      }
+  /**
+   * Apply hostname heuristic rules (first matching rule wins)
+   */
+  applyHostHeuristics(hostname) {
+    const index = matchHeuristic(hostname);
+    if (index === -1) {
+      return null;
     }
+    const rule = HEURISTIC_RULES[index];
+    return {
+      category: rule.category,
+      confidence: rule.confidence,
+      source: 'heuristic'
+    };
+  }
 
-    return null;
+  /**
+   * Apply URL path patterns (earlier categories win)
+   */
+  applyPathHeuristics(path) {
+    const index = matchPathCategory(path);
+    if (index === -1) {
+      return null;
+    }
+    return {
+      category: PATH_CATEGORIES[index],
+      confidence: 0.7,
+      source: 'heuristic_path'
+    };
   }
 
   /**
@@ -310,4 +356,5 @@ class CategoryDatabase {
 
 // Export singleton instance
 const categoryDB = new CategoryDatabase();
+export { CategoryDatabase, CURATED_DOMAINS, HEURISTIC_RULES, PATH_PATTERNS };
 export default categoryDB;
@@ -227,6 +227,10 @@ class ConsentManager {
       await storageManager.init();
       await storageManager.clearAll();
 
+      // Drop in-progress hourly aggregates
+      const aggregator = (await import('./aggregator.js')).default;
+      await aggregator.reset();
+
       // Clear chrome.storage (except consent state for record-keeping)
       const keysToRemove = [
         'categoryOverrides',
@@ -324,6 +328,13 @@ class ConsentManager {
       const sessions = await storageManager.getUnsyncedSessions();
       const events = await storageManager.getActivityEvents();
 
+      // Include the current, not yet closed hours
+      const aggregator = (await import('./aggregator.js')).default;
+      await aggregator.restore();
+      for (const acc of aggregator.openHours.values()) {
+        sessions.push(acc.toSession());
+      }
+
       const exportData = {
         exportDate: new Date().toISOString(),
         consentState: this.consentState,
@@ -14,15 +14,37 @@ const STORES = {
   SYNC_QUEUE: 'sync_queue',                // Failed syncs (max 100 entries)
 };
 
+// Write-behind buffer for activity events
+const WRITE_BUFFER = {
+  MAX_EVENTS: 50,        // Flush once this many events are pending
+  FLUSH_DELAY_MS: 5000,  // ...or this long after the first pending event
+};
+
 class StorageManager {
   constructor() {
     this.db = null;
+    this.initPromise = null;
+
+    // Activity events waiting to be written in one transaction
+    this.pendingEvents = [];
+    this.flushTimer = null;
+    this.flushChain = Promise.resolve();
   }
 
   /**
-   * Initialize the IndexedDB database
+   * Initialize the IndexedDB database (opened once; later calls reuse it)
    */
   async init() {
+    if (!this.initPromise) {
+      this.initPromise = this._open().catch((error) => {
+        this.initPromise = null;
+        throw error;
+      });
+    }
+    return this.initPromise;
+  }
+
+  _open() {
     return new Promise((resolve, reject) => {
       const request = indexedDB.open(DB_NAME, DB_VERSION);
 
@@ -68,21 +90,86 @@ class StorageManager {
   }
 
   /**
-   * Add an activity event
+   * Add an activity event.
+   * Events are buffered in memory and written in batches (see flush), so a
+   * burst of tab and focus events costs one IndexedDB transaction.
    */
   async addActivityEvent(event) {
-    const transaction = this.db.transaction([STORES.ACTIVITY_EVENTS], 'readwrite');
-    const store = transaction.objectStore(STORES.ACTIVITY_EVENTS);
-
-    const eventData = {
+    this.pendingEvents.push({
       ...event,
       timestamp: Date.now()
-    };
+    });
+
+    if (this.pendingEvents.length >= WRITE_BUFFER.MAX_EVENTS) {
+      await this.flush();
+    } else if (!this.flushTimer) {
+      this.flushTimer = setTimeout(() => {
+        this.flush().catch((error) => console.error('Failed to flush activity events:', error));
+      }, WRITE_BUFFER.FLUSH_DELAY_MS);
+    }
+  }
+
+  /**
+   * Write all buffered activity events in one transaction.
+   * Flushes run one at a time; events that fail to write are put back at
+   * the front of the buffer for the next flush.
+   */
+  async flush() {
+    if (this.flushTimer) {
+      clearTimeout(this.flushTimer);
+      this.flushTimer = null;
+    }
+
+    // A failed flush must not block later ones
+    this.flushChain = this.flushChain.catch(() => {}).then(async () => {
+      if (this.pendingEvents.length === 0) {
+        return;
+      }
+      const batch = this.pendingEvents;
+      this.pendingEvents = [];
+      try {
+        await this._bulkWrite(STORES.ACTIVITY_EVENTS, batch, 'add');
+      } catch (error) {
+        this.pendingEvents = batch.concat(this.pendingEvents);
+        throw error;
+      }
+    });
+    return this.flushChain;
+  }
+
+  /**
+   * Write many records to one store in a single transaction.
+   *
+   * @param {string} storeName - Object store
+   * @param {Array} records - Records to write
+   * @param {'add'|'put'} method - 'add' skips records whose key already exists
+   * @returns {Promise<number>} Number of records written
+   */
+  async _bulkWrite(storeName, records, method = 'put') {
+    if (records.length === 0) {
+      return 0;
+    }
+
+    const transaction = this.db.transaction([storeName], 'readwrite');
+    const store = transaction.objectStore(storeName);
+    let written = 0;
+
+    for (const record of records) {
+      const request = store[method](record);
+      request.onsuccess = () => { written++; };
+      request.onerror = (event) => {
+        if (request.error && request.error.name === 'ConstraintError') {
+          // Duplicate key: skip this record without aborting the batch
+          event.preventDefault();
+          event.stopPropagation();
+        }
+      };
+    }
 
     return new Promise((resolve, reject) => {
-      const request = store.add(eventData);
-      request.onsuccess = () => resolve(request.result);
-      request.onerror = () => reject(request.error);
+      transaction.oncomplete = () => resolve(written);
+      transaction.onerror = () => reject(transaction.error);
+      transaction.onabort = () => reject(transaction.error);
     });
   }
 
@@ -90,14 +177,15 @@ class StorageManager {
    * Add an aggregated session
    */
   async addAggregatedSession(session) {
-    const transaction = this.db.transaction([STORES.AGGREGATED_SESSIONS], 'readwrite');
-    const store = transaction.objectStore(STORES.AGGREGATED_SESSIONS);
+    return this.addAggregatedSessions([session]);
+  }
 
-    return new Promise((resolve, reject) => {
-      const request = store.add(session);
-      request.onsuccess = () => resolve(request.result);
-      request.onerror = () => reject(request.error);
-    });
+  /**
+   * Add many aggregated sessions in one transaction
+   * (sessions whose session_id already exists are left untouched)
+   */
+  async addAggregatedSessions(sessions) {
+    return this._bulkWrite(STORES.AGGREGATED_SESSIONS, sessions, 'add');
   }
 
   /**
@@ -119,26 +207,38 @@ class StorageManager {
    * Mark session as synced
    */
   async markSessionSynced(sessionId) {
+    return this.markSessionsSynced([sessionId]);
+  }
+
+  /**
+   * Mark many sessions as synced in one transaction
+   */
+  async markSessionsSynced(sessionIds) {
+    if (sessionIds.length === 0) {
+      return;
+    }
+
     const transaction = this.db.transaction([STORES.AGGREGATED_SESSIONS], 'readwrite');
     const store = transaction.objectStore(STORES.AGGREGATED_SESSIONS);
+    const syncedAt = Date.now();
 
-    return new Promise((resolve, reject) => {
+    for (const sessionId of sessionIds) {
       const getRequest = store.get(sessionId);
-
       getRequest.onsuccess = () => {
         const session = getRequest.result;
         if (session) {
           session.synced = true;
-          session.synced_at = Date.now();
-          const updateRequest = store.put(session);
-          updateRequest.onsuccess = () => resolve();
-          updateRequest.onerror = () => reject(updateRequest.error);
-        } else {
-          resolve(); // Session not found, already deleted
+          session.synced_at = syncedAt;
+          store.put(session);
         }
+        // Session not found: already deleted
       };
+    }
 
-      getRequest.onerror = () => reject(getRequest.error);
+    return new Promise((resolve, reject) => {
+      transaction.oncomplete = () => resolve();
+      transaction.onerror = () => reject(transaction.error);
+      transaction.onabort = () => reject(transaction.error);
     });
   }
 
@@ -146,20 +246,19 @@ class StorageManager {
    * Add to sync queue (for failed syncs)
    */
   async addToSyncQueue(data) {
-    const transaction = this.db.transaction([STORES.SYNC_QUEUE], 'readwrite');
-    const store = transaction.objectStore(STORES.SYNC_QUEUE);
+    return this.addManyToSyncQueue([data]);
+  }
 
-    const queueItem = {
+  /**
+   * Add many items to the sync queue in one transaction
+   */
+  async addManyToSyncQueue(items) {
+    const now = Date.now();
+    return this._bulkWrite(STORES.SYNC_QUEUE, items.map((data) => ({
       ...data,
-      timestamp: Date.now(),
+      timestamp: now,
       retry_count: 0
-    };
-
-    return new Promise((resolve, reject) => {
-      const request = store.add(queueItem);
-      request.onsuccess = () => resolve(request.result);
-      request.onerror = () => reject(request.error);
-    });
+    })), 'add');
   }
 
   /**
@@ -192,13 +291,27 @@ class StorageManager {
    * Remove from sync queue
    */
   async removeFromSyncQueue(id) {
+    return this.removeManyFromSyncQueue([id]);
+  }
+
+  /**
+   * Remove many items from the sync queue in one transaction
+   */
+  async removeManyFromSyncQueue(ids) {
+    if (ids.length === 0) {
+      return;
+    }
+
     const transaction = this.db.transaction([STORES.SYNC_QUEUE], 'readwrite');
     const store = transaction.objectStore(STORES.SYNC_QUEUE);
+    for (const id of ids) {
+      store.delete(id);
+    }
 
     return new Promise((resolve, reject) => {
-      const request = store.delete(id);
-      request.onsuccess = () => resolve();
-      request.onerror = () => reject(request.error);
+      transaction.oncomplete = () => resolve();
+      transaction.onerror = () => reject(transaction.error);
+      transaction.onabort = () => reject(transaction.error);
     });
   }
 
@@ -213,6 +326,8 @@ class StorageManager {
     const oneDayAgo = now - (24 * 60 * 60 * 1000);
     const sevenDaysAgo = now - (7 * 24 * 60 * 60 * 1000);
 
+    await this.flush();
+
     // Clean up activity events older than 24 hours
     await this._cleanupStore(STORES.ACTIVITY_EVENTS, oneDayAgo);
 
@@ -339,6 +454,9 @@ class StorageManager {
    * Get all activity events (for aggregation)
    */
   async getActivityEvents(since = 0) {
+    // Include events still in the write buffer
+    await this.flush();
+
     const transaction = this.db.transaction([STORES.ACTIVITY_EVENTS], 'readonly');
     const store = transaction.objectStore(STORES.ACTIVITY_EVENTS);
     const index = store.index('timestamp');
@@ -354,6 +472,14 @@ class StorageManager {
    * Clear all data (for testing or user request)
    */
   async clearAll() {
+    // Buffered events are dropped along with the stored ones
+    if (this.flushTimer) {
+      clearTimeout(this.flushTimer);
+      this.flushTimer = null;
+    }
+    this.pendingEvents = [];
+    await this.flushChain.catch(() => {});
+
     const stores = [
       STORES.ACTIVITY_EVENTS,
       STORES.AGGREGATED_SESSIONS,
@@ -9,15 +9,49 @@ const SYNC_CONFIG = {
   BACKOFF_MULTIPLIER: 2,
   MAX_ATTEMPTS_PER_SESSION: 10,
   SYNC_INTERVAL: 60 * 60 * 1000,       // 1 hour
-  API_ENDPOINT: 'https://back-end-304.up.railway.app/api/v1/extension'
+  API_ENDPOINT: 'https://back-end-304.up.railway.app/api/v1/extension',
+  SYNC_PROTOCOL: 2,                    // Newest protocol this build speaks
+  MAX_BATCH_SESSIONS: 200,             // Sessions per request (server may lower it)
+  CURSOR_KEY: 'syncCursor'             // chrome.storage.local key of the last acked batch
 };
 
+// Protocol 2 value columns, in wire order: [wire name, session accessor]
+const COLUMNAR_FIELDS = [
+  ['hour_key', (s) => s.hour_key ?? s.hour],
+  ['duration_minutes', (s) => s.duration_minutes],
+  ['work', (s) => s.category_distribution.work],
+  ['leisure', (s) => s.category_distribution.leisure],
+  ['social', (s) => s.category_distribution.social],
+  ['neutral', (s) => s.category_distribution.neutral],
+  ['tab_switches', (s) => s.metrics.tab_switches],
+  ['window_focus_changes', (s) => s.metrics.window_focus_changes],
+  ['avg_focus_duration_minutes', (s) => s.metrics.avg_focus_duration_minutes],
+  ['distraction_rate_per_hour', (s) => s.metrics.distraction_rate_per_hour],
+  ['unique_domains', (s) => s.metrics.unique_domains],
+  ['event_count', (s) => s.event_count]
+];
+
+/**
+ * Session sync timestamp (older builds could store NaN; fall back to creation time)
+ */
+function sessionTime(session) {
+  return Number.isFinite(session.timestamp) ? session.timestamp : session.created_at;
+}
+
+/**
+ * Order sessions by (timestamp, session_id), the cursor order
+ */
+function compareSessions(a, b) {
+  return (sessionTime(a) - sessionTime(b)) || (a.session_id < b.session_id ? -1 : a.session_id > b.session_id ? 1 : 0);
+}
+
 class SyncScheduler {
   constructor() {
     this.isSyncing = false;
     this.retryTimeout = null;
     this.currentRetryDelay = SYNC_CONFIG.INITIAL_RETRY_DELAY;
     this.syncAttempts = 0;
+    this.protocol = null; // { version, batchSize } once negotiated
   }
 
   /**
@@ -88,26 +122,45 @@ class SyncScheduler {
         return;
       }
 
-      console.log(`Syncing ${unsyncedSessions.length} sessions...`);
-
-      // Sync sessions
-      const result = await this.syncSessions(unsyncedSessions);
-
-      if (result.success) {
-        // Mark sessions as synced
-        for (const session of unsyncedSessions) {
-          await storageManager.markSessionSynced(session.session_id);
+      unsyncedSessions.sort(compareSessions);
+
+      // Resume: sessions the server acknowledged before the worker stopped
+      // short of marking them are marked now instead of being re-sent.
+      // Late-created older sessions are never acknowledged, so the
+      // acknowledged ones are not necessarily a prefix of the sorted list
+      const cursor = await this.getSyncCursor();
+      const acknowledged = cursor ? unsyncedSessions.filter((session) => this.isAcknowledged(session, cursor)) : [];
+      await storageManager.markSessionsSynced(acknowledged.map((session) => session.session_id));
+      const ackedIds = new Set(acknowledged.map((session) => session.session_id));
+      const pending = unsyncedSessions.filter((session) => !ackedIds.has(session.session_id));
+
+      const { version, batchSize } = await this.negotiateProtocol();
+      console.log(`Syncing ${pending.length} sessions (protocol ${version}, batches of ${batchSize})...`);
+
+      for (let i = 0; i < pending.length; i += batchSize) {
+        const batch = pending.slice(i, i + batchSize);
+        const result = await this.syncBatch(batch, version);
+
+        if (!result.success) {
+          // Only this batch is retried; later ones wait for the next sync
+          await this.handleSyncFailure(batch, result.error);
+          return;
         }
 
-        // Reset retry state on success
-        this.currentRetryDelay = SYNC_CONFIG.INITIAL_RETRY_DELAY;
-        this.syncAttempts = 0;
-
-        console.log(`Successfully synced ${unsyncedSessions.length} sessions`);
-      } else {
-        // Sync failed - add to retry queue
-        await this.handleSyncFailure(unsyncedSessions, result.error);
+        // Record the ack before marking, so a stop in between resumes cleanly
+        const last = batch[batch.length - 1];
+        await this.setSyncCursor(result.data?.cursor ?? {
+          timestamp: sessionTime(last),
+          session_id: last.session_id
+        });
+        await storageManager.markSessionsSynced(batch.map((session) => session.session_id));
       }
+
+      // Reset retry state on success
+      this.currentRetryDelay = SYNC_CONFIG.INITIAL_RETRY_DELAY;
+      this.syncAttempts = 0;
+
+      console.log(`Successfully synced ${pending.length} sessions`);
     } catch (error) {
       console.error('Sync error:', error);
       await this.handleSyncFailure([], error);
@@ -116,6 +169,149 @@ class SyncScheduler {
     }
   }
 
+  /**
+   * Agree on a sync protocol with the backend via the /version check.
+   * Falls back to protocol 1 (plain JSON) on older servers, or when this
+   * browser has no CompressionStream.
+   */
+  async negotiateProtocol() {
+    if (this.protocol) {
+      return this.protocol;
+    }
+
+    const api = await this.checkApiCompatibility();
+    const serverProtocols = api.syncProtocols || [1];
+
+    const version = serverProtocols.includes(2) && SYNC_CONFIG.SYNC_PROTOCOL >= 2 ? 2 : 1;
+    const batchSize = Math.max(1, Math.min(
+      SYNC_CONFIG.MAX_BATCH_SESSIONS,
+      api.maxBatchSessions || SYNC_CONFIG.MAX_BATCH_SESSIONS
+    ));
+
+    this.protocol = { version, batchSize };
+    return this.protocol;
+  }
+
+  /**
+   * Send one bounded batch with the negotiated protocol
+   */
+  async syncBatch(sessions, version) {
+    const result = version >= 2
+      ? await this.syncColumnarBatch(sessions)
+      : await this.syncSessions(sessions);
+
+    if (!result.success) {
+      this.protocol = null; // Renegotiate next time in case the server changed
+    }
+    return result;
+  }
+
+  /**
+   * Sync a batch to backend in the columnar protocol 2 encoding
+   */
+  async syncColumnarBatch(sessions) {
+    try {
+      const authToken = await this.getAuthToken();
+      const { body, encoding } = await this.compressBody(JSON.stringify(this.encodeColumnarBatch(sessions)));
+
+      const headers = {
+        'Content-Type': 'application/json',
+        'X-Extension-Version': chrome.runtime.getManifest().version,
+        'Authorization': `Bearer ${authToken}`
+      };
+      if (encoding) {
+        headers['Content-Encoding'] = encoding;
+      }
+
+      const response = await fetch(`${SYNC_CONFIG.API_ENDPOINT}/sync/batch`, {
+        method: 'POST',
+        headers,
+        body
+      });
+
+      if (!response.ok) {
+        throw new Error(`HTTP ${response.status}: ${response.statusText}`);
+      }
+
+      return {
+        success: true,
+        data: await response.json()
+      };
+    } catch (error) {
+      return {
+        success: false,
+        error: error.message
+      };
+    }
+  }
+
+  /**
+   * Encode sessions (sorted by time) as one array per field.
+   * Timestamps are delta-encoded: the first is absolute, the rest are
+   * offsets from the previous session (an hour apart, so short numbers).
+   */
+  encodeColumnarBatch(sessions) {
+    const columns = {
+      session_id: sessions.map((session) => session.session_id),
+      timestamp: []
+    };
+
+    let previous = 0;
+    for (const session of sessions) {
+      const time = Math.round(sessionTime(session));
+      columns.timestamp.push(time - previous);
+      previous = time;
+    }
+
+    for (const [name, read] of COLUMNAR_FIELDS) {
+      columns[name] = sessions.map(read);
+    }
+
+    return { v: 2, n: sessions.length, columns };
+  }
+
+  /**
+   * Gzip a request body with CompressionStream when the browser has it
+   */
+  async compressBody(text) {
+    if (typeof CompressionStream === 'undefined') {
+      return { body: text, encoding: null };
+    }
+
+    const stream = new Blob([text]).stream().pipeThrough(new CompressionStream('gzip'));
+    return { body: await new Response(stream).arrayBuffer(), encoding: 'gzip' };
+  }
+
+  /**
+   * Last acknowledged batch position, or null
+   */
+  async getSyncCursor() {
+    const result = await chrome.storage.local.get(SYNC_CONFIG.CURSOR_KEY);
+    return result[SYNC_CONFIG.CURSOR_KEY] || null;
+  }
+
+  /**
+   * Persist the position of an acknowledged batch
+   */
+  async setSyncCursor(cursor) {
+    await chrome.storage.local.set({
+      [SYNC_CONFIG.CURSOR_KEY]: { ...cursor, acked_at: Date.now() }
+    });
+  }
+
+  /**
+   * Whether the server already acknowledged a session: at or before the
+   * cursor, and created before the ack (a late older hour was never sent)
+   */
+  isAcknowledged(session, cursor) {
+    if (!(session.created_at <= cursor.acked_at)) {
+      return false;
+    }
+    const time = sessionTime(session);
+    return time < cursor.timestamp ||
+      (time === cursor.timestamp && session.session_id <= cursor.session_id);
+  }
+
   /**
    * Sync sessions to backend
    */
@@ -170,13 +366,11 @@ class SyncScheduler {
       const storageManager = (await import('./storage-manager.js')).default;
       await storageManager.init();
 
-      for (const session of sessions) {
-        await storageManager.addToSyncQueue({
-          type: 'session',
-          data: session,
-          error: error
-        });
-      }
+      await storageManager.addManyToSyncQueue(sessions.map((session) => ({
+        type: 'session',
+        data: session,
+        error: error
+      })));
 
       return;
     }
@@ -226,6 +420,7 @@ class SyncScheduler {
       isSyncing: this.isSyncing,
       syncAttempts: this.syncAttempts,
       nextRetryDelay: this.currentRetryDelay,
+      protocol: this.protocol,
       isOnline: typeof navigator !== 'undefined' ? navigator.onLine : true
     };
   }
@@ -245,19 +440,23 @@ class SyncScheduler {
 
     console.log(`Processing ${queueItems.length} queued sync items...`);
 
-    for (const item of queueItems) {
-      try {
-        if (item.type === 'session') {
-          const result = await this.syncSessions([item.data]);
+    // Queued sessions go out as one batch (the queue page is smaller than a batch)
+    const sessionItems = queueItems.filter((item) => item.type === 'session');
+    if (sessionItems.length === 0) {
+      return;
+    }
+
+    try {
+      const { version } = await this.negotiateProtocol();
+      const sessions = sessionItems.map((item) => item.data).sort(compareSessions);
+      const result = await this.syncBatch(sessions, version);
 
-          if (result.success) {
-            await storageManager.removeFromSyncQueue(item.id);
-            console.log('Queued session synced successfully');
-          }
-        }
-      } catch (error) {
-        console.error('Error processing queue item:', error);
+      if (result.success) {
+        await storageManager.removeManyFromSyncQueue(sessionItems.map((item) => item.id));
+        console.log(`${sessionItems.length} queued sessions synced successfully`);
       }
+    } catch (error) {
+      console.error('Error processing queue items:', error);
     }
   }
 
@@ -282,7 +481,9 @@ class SyncScheduler {
       return {
         compatible: data.compatible !== false,
         upgradeRequired: data.upgrade_required === true,
-        message: data.message
+        message: data.message,
+        syncProtocols: data.sync_protocols || [1],
+        maxBatchSessions: data.max_batch_sessions
       };
     } catch (error) {
       console.error('Failed to check API compatibility:', error);